@@ -0,0 +1,350 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright (c) 2022 MediaTek Inc.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mtk_cam-ctrl-state.h"
+
+#define NONE           "\033[m"
+#define RED            "\033[0;32;31m"
+#define GREEN          "\033[0;32;32m"
+
+#define UT_FRAMES	64
+/* STATE_NUM_AT_SOF of mtk_cam-ctrl.c */
+#define UT_STATE_NUM_AT_SOF	3
+
+static int ut_fail;
+static int ut_cnt;
+
+#define UT_CHECK(cond, fmt, args...)					\
+do {									\
+	ut_cnt++;							\
+	if (!(cond)) {							\
+		ut_fail++;						\
+		printf(RED "[FAIL] %s:%d " fmt NONE "\n",		\
+		       __func__, __LINE__, ##args);			\
+	}								\
+} while (0)
+
+/* the state is embedded in the request stream data in the driver */
+struct mtk_camsys_ctrl_state {
+	enum MTK_CAMSYS_STATE_IDX estate;
+	unsigned int seq;
+	bool queued;
+};
+
+/* camsys_state_list and state_ring of a mtk_camsys_sensor_ctrl */
+struct ut_ctrl {
+	enum mtk_camsys_state_mode mode;
+	struct mtk_camsys_state_ring ring;
+	struct mtk_camsys_ctrl_state states[UT_FRAMES];
+	unsigned int sensor_seq;
+};
+
+enum ut_ev {
+	UT_SENSOR,	/* state queued at the sensor setting */
+	UT_SET,		/* moved by the driver, out of the tables */
+	UT_CQ_DONE,
+	UT_SOF,		/* outer registers of the frame loaded */
+	UT_SOF_HW_DELAY,	/* inner frame not done */
+	UT_FRAME_DONE,	/* dequeued after the check */
+	UT_EXPECT,
+};
+
+struct ut_trace {
+	enum ut_ev ev;
+	unsigned int seq;
+	__u8 state;	/* UT_SENSOR and UT_SET */
+	__u8 expect;
+};
+
+/* walking the list, as mtk_camsys_state_find() on unindexed states */
+static struct mtk_camsys_ctrl_state *ut_list_find(struct ut_ctrl *c, int seq)
+{
+	if (seq < 0 || seq >= UT_FRAMES || !c->states[seq].queued)
+		return NULL;
+
+	return &c->states[seq];
+}
+
+static struct mtk_camsys_ctrl_state *ut_find(struct ut_ctrl *c, int seq)
+{
+	struct mtk_camsys_ctrl_state *s;
+
+	s = mtk_camsys_state_ring_find(&c->ring, seq);
+	if (s || !c->ring.unindexed)
+		return s;
+
+	return ut_list_find(c, seq);
+}
+
+static void ut_enq(struct ut_ctrl *c, unsigned int seq,
+		   enum MTK_CAMSYS_STATE_IDX estate)
+{
+	struct mtk_camsys_ctrl_state *s = &c->states[seq];
+
+	s->estate = estate;
+	s->seq = seq;
+	s->queued = true;
+	mtk_camsys_state_ring_add(&c->ring, s, seq);
+	c->sensor_seq = seq;
+}
+
+static bool ut_deq(struct ut_ctrl *c, struct mtk_camsys_ctrl_state *s)
+{
+	if (!mtk_camsys_state_ring_del(&c->ring, s)) {
+		if (!c->ring.unindexed || !s->queued)
+			return false;
+		mtk_camsys_state_ring_del_unindexed(&c->ring);
+	}
+	s->queued = false;
+
+	return true;
+}
+
+static void ut_event(struct ut_ctrl *c, struct mtk_camsys_ctrl_state *s,
+		     enum mtk_camsys_state_event event)
+{
+	if (s)
+		s->estate = mtk_camsys_state_next(c->mode, s->estate, event);
+}
+
+static void ut_replay(const char *name, enum mtk_camsys_state_mode mode,
+		     const struct ut_trace *trace, int n)
+{
+	static struct ut_ctrl c;
+	struct mtk_camsys_ctrl_state *s;
+	int i, j, queued;
+
+	memset(&c, 0, sizeof(c));
+	c.mode = mode;
+	mtk_camsys_state_ring_reset(&c.ring);
+
+	for (i = 0; i < n; i++) {
+		const struct ut_trace *t = &trace[i];
+
+		switch (t->ev) {
+		case UT_SENSOR:
+			ut_enq(&c, t->seq, t->state);
+			break;
+		case UT_SET:
+			s = ut_find(&c, t->seq);
+			UT_CHECK(s, "%s[%d] frame %u not queued", name, i, t->seq);
+			if (s)
+				s->estate = t->state;
+			break;
+		case UT_CQ_DONE:
+			ut_event(&c, ut_find(&c, t->seq), MTK_CAMSYS_EVENT_CQ_DONE);
+			break;
+		case UT_SOF:
+			ut_event(&c, ut_find(&c, t->seq), MTK_CAMSYS_EVENT_DBLOAD);
+			break;
+		case UT_SOF_HW_DELAY:
+			for (j = 0; j < UT_STATE_NUM_AT_SOF; j++)
+				ut_event(&c, ut_find(&c, c.sensor_seq - j),
+					 MTK_CAMSYS_EVENT_HW_DELAY);
+			break;
+		case UT_FRAME_DONE:
+			ut_event(&c, ut_find(&c, t->seq),
+				 MTK_CAMSYS_EVENT_FRAME_DONE);
+			break;
+		default:
+			break;
+		}
+
+		s = ut_list_find(&c, t->seq);
+		UT_CHECK(s && s->estate == t->expect,
+			 "%s[%d] frame %u state 0x%x, expected 0x%x", name, i,
+			 t->seq, s ? s->estate : 0xff, t->expect);
+		if (t->ev == UT_FRAME_DONE && s)
+			UT_CHECK(ut_deq(&c, s), "%s[%d] frame %u not dequeued",
+				 name, i, t->seq);
+
+		for (j = 0, queued = 0; j < UT_FRAMES; j++) {
+			if (!c.states[j].queued)
+				continue;
+			queued++;
+			UT_CHECK(ut_find(&c, j) == &c.states[j],
+				 "%s[%d] frame %d not found", name, i, j);
+		}
+		UT_CHECK(c.ring.cnt == queued, "%s[%d] %u states, %d queued",
+			 name, i, c.ring.cnt, queued);
+	}
+	UT_CHECK(!c.ring.cnt && !c.ring.unindexed, "%s: %u states left",
+		 name, c.ring.cnt);
+}
+
+/* SOF, CQ done and frame done of the raw, one HW delay on frame 3 */
+static const struct ut_trace ut_trace_normal[] = {
+	{ UT_SENSOR, 1, E_STATE_SENSOR, E_STATE_SENSOR },
+	{ UT_SET, 1, E_STATE_CQ, E_STATE_CQ },
+	{ UT_CQ_DONE, 1, 0, E_STATE_OUTER },
+	{ UT_SOF, 1, 0, E_STATE_INNER },
+	{ UT_SENSOR, 2, E_STATE_SENSOR, E_STATE_SENSOR },
+	{ UT_SET, 2, E_STATE_CQ_SCQ_DELAY, E_STATE_CQ_SCQ_DELAY },
+	{ UT_CQ_DONE, 2, 0, E_STATE_OUTER },
+	{ UT_FRAME_DONE, 1, 0, E_STATE_DONE_NORMAL },
+	{ UT_SOF, 2, 0, E_STATE_INNER },
+	{ UT_SENSOR, 3, E_STATE_SENSOR, E_STATE_SENSOR },
+	{ UT_SET, 3, E_STATE_CQ, E_STATE_CQ },
+	{ UT_CQ_DONE, 3, 0, E_STATE_OUTER },
+	{ UT_SENSOR, 4, E_STATE_SENSOR, E_STATE_SENSOR },
+	{ UT_SOF_HW_DELAY, 3, 0, E_STATE_OUTER_HW_DELAY },
+	{ UT_EXPECT, 2, 0, E_STATE_INNER_HW_DELAY },
+	{ UT_EXPECT, 4, 0, E_STATE_SENSOR },
+	{ UT_FRAME_DONE, 2, 0, E_STATE_DONE_MISMATCH },
+	{ UT_SOF, 3, 0, E_STATE_INNER_HW_DELAY },
+	{ UT_SET, 4, E_STATE_CAMMUX_OUTER, E_STATE_CAMMUX_OUTER },
+	{ UT_FRAME_DONE, 3, 0, E_STATE_DONE_MISMATCH },
+	{ UT_SOF, 4, 0, E_STATE_INNER },
+	{ UT_FRAME_DONE, 4, 0, E_STATE_DONE_NORMAL },
+};
+
+/* subsample, the sensor is applied after the CQ done */
+static const struct ut_trace ut_trace_subspl[] = {
+	{ UT_SENSOR, 1, E_STATE_SUBSPL_READY, E_STATE_SUBSPL_READY },
+	{ UT_SET, 1, E_STATE_SUBSPL_SCQ, E_STATE_SUBSPL_SCQ },
+	{ UT_CQ_DONE, 1, 0, E_STATE_SUBSPL_OUTER },
+	{ UT_SET, 1, E_STATE_SUBSPL_SENSOR, E_STATE_SUBSPL_SENSOR },
+	{ UT_SOF, 1, 0, E_STATE_SUBSPL_INNER },
+	{ UT_SENSOR, 2, E_STATE_SUBSPL_READY, E_STATE_SUBSPL_READY },
+	{ UT_SET, 2, E_STATE_SUBSPL_SCQ_DELAY, E_STATE_SUBSPL_SCQ_DELAY },
+	{ UT_FRAME_DONE, 1, 0, E_STATE_SUBSPL_DONE_NORMAL },
+	{ UT_CQ_DONE, 2, 0, E_STATE_SUBSPL_OUTER },
+	/* sensor not applied yet, no move */
+	{ UT_SOF, 2, 0, E_STATE_SUBSPL_OUTER },
+	{ UT_SET, 2, E_STATE_SUBSPL_SENSOR, E_STATE_SUBSPL_SENSOR },
+	{ UT_SOF, 2, 0, E_STATE_SUBSPL_INNER },
+	{ UT_FRAME_DONE, 2, 0, E_STATE_SUBSPL_DONE_NORMAL },
+};
+
+/* time shared, the raw is triggered on the CQ done of the memory input */
+static const struct ut_trace ut_trace_ts[] = {
+	{ UT_SENSOR, 1, E_STATE_TS_READY, E_STATE_TS_READY },
+	{ UT_SET, 1, E_STATE_TS_SENSOR, E_STATE_TS_SENSOR },
+	{ UT_SET, 1, E_STATE_TS_SV, E_STATE_TS_SV },
+	{ UT_SENSOR, 2, E_STATE_TS_READY, E_STATE_TS_READY },
+	{ UT_SET, 1, E_STATE_TS_MEM, E_STATE_TS_MEM },
+	{ UT_CQ_DONE, 1, 0, E_STATE_TS_MEM },
+	{ UT_SET, 1, E_STATE_TS_CQ, E_STATE_TS_CQ },
+	{ UT_CQ_DONE, 1, 0, E_STATE_TS_INNER },
+	{ UT_SOF, 1, 0, E_STATE_TS_INNER },
+	{ UT_FRAME_DONE, 1, 0, E_STATE_TS_DONE_NORMAL },
+	{ UT_SET, 2, E_STATE_TS_CQ, E_STATE_TS_CQ },
+	{ UT_CQ_DONE, 2, 0, E_STATE_TS_INNER },
+	{ UT_FRAME_DONE, 2, 0, E_STATE_TS_DONE_NORMAL },
+};
+
+/* a long stream, three frames in flight */
+static void ut_check_stream(void)
+{
+	static struct ut_trace trace[UT_FRAMES * 4];
+	unsigned int seq;
+	int n = 0;
+
+	for (seq = 1; seq < UT_FRAMES; seq++) {
+		trace[n++] = (struct ut_trace){ UT_SENSOR, seq, E_STATE_CQ,
+						E_STATE_CQ };
+		trace[n++] = (struct ut_trace){ UT_CQ_DONE, seq, 0,
+						E_STATE_OUTER };
+		if (seq > 2)
+			trace[n++] = (struct ut_trace){ UT_FRAME_DONE, seq - 2,
+							0, E_STATE_DONE_NORMAL };
+		trace[n++] = (struct ut_trace){ UT_SOF, seq, 0, E_STATE_INNER };
+	}
+	for (seq = UT_FRAMES - 2; seq < UT_FRAMES; seq++)
+		trace[n++] = (struct ut_trace){ UT_FRAME_DONE, seq, 0,
+						E_STATE_DONE_NORMAL };
+
+	ut_replay("stream", MTK_CAMSYS_STATE_MODE_NORMAL, trace, n);
+}
+
+/* more states than slots, the colliding ones are found on the list */
+static void ut_check_unindexed(void)
+{
+	static struct ut_ctrl c;
+	unsigned int n = MTK_CAMSYS_STATE_RING_SIZE + 2;
+	unsigned int seq;
+
+	memset(&c, 0, sizeof(c));
+	for (seq = 1; seq <= n; seq++)
+		ut_enq(&c, seq, E_STATE_OUTER);
+
+	UT_CHECK(c.ring.cnt == n && c.ring.unindexed == 2,
+		 "%u states, %u unindexed", c.ring.cnt, c.ring.unindexed);
+	UT_CHECK(!mtk_camsys_state_ring_find(&c.ring, n),
+		 "unindexed frame %u in the ring", n);
+	for (seq = 1; seq <= n; seq++)
+		UT_CHECK(ut_find(&c, seq) == &c.states[seq],
+			 "frame %u not found", seq);
+	UT_CHECK(!ut_find(&c, n + 1) && !ut_find(&c, 0) && !ut_find(&c, -1),
+		 "frame not queued found");
+
+	UT_CHECK(ut_deq(&c, &c.states[n]), "unindexed frame %u not dequeued", n);
+	UT_CHECK(ut_deq(&c, &c.states[1]), "frame 1 not dequeued");
+	UT_CHECK(!ut_deq(&c, &c.states[1]), "frame 1 dequeued twice");
+	UT_CHECK(c.ring.cnt == n - 2 && c.ring.unindexed == 1,
+		 "%u states, %u unindexed", c.ring.cnt, c.ring.unindexed);
+	/* frame n - 1 stays unindexed once frame 1 frees its slot */
+	UT_CHECK(ut_find(&c, n - 1) == &c.states[n - 1],
+		 "frame %u not found", n - 1);
+
+	for (seq = 2; seq < n; seq++)
+		UT_CHECK(ut_deq(&c, &c.states[seq]), "frame %u not dequeued", seq);
+	UT_CHECK(!c.ring.cnt && !c.ring.unindexed,
+		 "%u states, %u unindexed", c.ring.cnt, c.ring.unindexed);
+
+	/* the slot of a dequeued frame is taken again */
+	ut_enq(&c, n + MTK_CAMSYS_STATE_RING_SIZE, E_STATE_SENSOR);
+	UT_CHECK(mtk_camsys_state_ring_find(&c.ring, n + MTK_CAMSYS_STATE_RING_SIZE),
+		 "frame not indexed");
+	UT_CHECK(!c.ring.unindexed, "%u unindexed", c.ring.unindexed);
+}
+
+/* the events each mode does not move on */
+static void ut_check_tables(void)
+{
+	UT_CHECK(mtk_camsys_state_next(MTK_CAMSYS_STATE_MODE_NORMAL,
+				       E_STATE_SENSOR, MTK_CAMSYS_EVENT_DBLOAD) ==
+		 E_STATE_SENSOR, "normal sensor moved on dbload");
+	UT_CHECK(mtk_camsys_state_next(MTK_CAMSYS_STATE_MODE_NORMAL,
+				       E_STATE_INNER_HW_DELAY,
+				       MTK_CAMSYS_EVENT_HW_DELAY) ==
+		 E_STATE_INNER_HW_DELAY, "normal inner delayed twice");
+	UT_CHECK(mtk_camsys_state_next(MTK_CAMSYS_STATE_MODE_NORMAL,
+				       E_STATE_SUBSPL_INNER,
+				       MTK_CAMSYS_EVENT_FRAME_DONE) ==
+		 E_STATE_SUBSPL_INNER, "normal mode moved a subsample state");
+	UT_CHECK(mtk_camsys_state_next(MTK_CAMSYS_STATE_MODE_SUBSPL,
+				       E_STATE_INNER,
+				       MTK_CAMSYS_EVENT_FRAME_DONE) ==
+		 E_STATE_INNER, "subsample mode moved a normal state");
+	UT_CHECK(mtk_camsys_state_next(MTK_CAMSYS_STATE_MODE_TS,
+				       E_STATE_TS_INNER,
+				       MTK_CAMSYS_EVENT_HW_DELAY) ==
+		 E_STATE_TS_INNER, "time shared moved on hw delay");
+}
+
+int main(void)
+{
+	ut_replay("normal", MTK_CAMSYS_STATE_MODE_NORMAL, ut_trace_normal,
+		  sizeof(ut_trace_normal) / sizeof(ut_trace_normal[0]));
+	ut_replay("subspl", MTK_CAMSYS_STATE_MODE_SUBSPL, ut_trace_subspl,
+		  sizeof(ut_trace_subspl) / sizeof(ut_trace_subspl[0]));
+	ut_replay("ts", MTK_CAMSYS_STATE_MODE_TS, ut_trace_ts,
+		  sizeof(ut_trace_ts) / sizeof(ut_trace_ts[0]));
+	ut_check_stream();
+	ut_check_unindexed();
+	ut_check_tables();
+
+	if (ut_fail) {
+		printf(RED "%d/%d checks failed\n" NONE, ut_fail, ut_cnt);
+		return EXIT_FAILURE;
+	}
+	printf(GREEN "all %d checks passed\n" NONE, ut_cnt);
+
+	return EXIT_SUCCESS;
+}
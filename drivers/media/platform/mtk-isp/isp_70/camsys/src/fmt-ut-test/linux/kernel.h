@@ -0,0 +1,24 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Copyright (c) 2022 MediaTek Inc.
+ */
+
+#ifndef __FMT_UT_LINUX_KERNEL_H
+#define __FMT_UT_LINUX_KERNEL_H
+
+/* host stand-in for the kernel header, FMT_DESC_UT only */
+#include <stdio.h>
+
+#define __ALIGN_KERNEL_MASK(x, mask)	(((x) + (mask)) & ~(mask))
+#define __ALIGN_KERNEL(x, a)	__ALIGN_KERNEL_MASK(x, (typeof(x))(a) - 1)
+#define ALIGN(x, a)		__ALIGN_KERNEL((x), (a))
+#define DIV_ROUND_UP(n, d)	(((n) + (d) - 1) / (d))
+#define ARRAY_SIZE(arr)		(sizeof(arr) / sizeof((arr)[0]))
+#define BUILD_BUG_ON(cond)	_Static_assert(!(cond), #cond)
+
+#define unlikely(x)		__builtin_expect(!!(x), 0)
+
+#define pr_debug(fmt, args...)	do { } while (0)
+#define pr_info(fmt, args...)	printf(fmt, ##args)
+
+#endif
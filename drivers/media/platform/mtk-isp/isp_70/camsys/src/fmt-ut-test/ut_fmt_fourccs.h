@@ -0,0 +1,122 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Copyright (c) 2022 MediaTek Inc.
+ */
+
+#ifndef __UT_FMT_FOURCCS_H
+#define __UT_FMT_FOURCCS_H
+
+/* every fourcc the legacy helpers name */
+static const u32 ut_fourccs[] = {
+	V4L2_PIX_FMT_GREY,
+	V4L2_PIX_FMT_MTISP_BAYER10_UFBC,
+	V4L2_PIX_FMT_MTISP_BAYER12_UFBC,
+	V4L2_PIX_FMT_MTISP_BAYER14_UFBC,
+	V4L2_PIX_FMT_MTISP_BAYER8_UFBC,
+	V4L2_PIX_FMT_MTISP_NV12_10P,
+	V4L2_PIX_FMT_MTISP_NV12_10_UFBC,
+	V4L2_PIX_FMT_MTISP_NV12_12P,
+	V4L2_PIX_FMT_MTISP_NV12_12_UFBC,
+	V4L2_PIX_FMT_MTISP_NV12_UFBC,
+	V4L2_PIX_FMT_MTISP_NV16_10P,
+	V4L2_PIX_FMT_MTISP_NV16_12P,
+	V4L2_PIX_FMT_MTISP_NV21_10P,
+	V4L2_PIX_FMT_MTISP_NV21_10_UFBC,
+	V4L2_PIX_FMT_MTISP_NV21_12P,
+	V4L2_PIX_FMT_MTISP_NV21_12_UFBC,
+	V4L2_PIX_FMT_MTISP_NV21_UFBC,
+	V4L2_PIX_FMT_MTISP_NV61_10P,
+	V4L2_PIX_FMT_MTISP_NV61_12P,
+	V4L2_PIX_FMT_MTISP_SBGGR10,
+	V4L2_PIX_FMT_MTISP_SBGGR10F,
+	V4L2_PIX_FMT_MTISP_SBGGR12,
+	V4L2_PIX_FMT_MTISP_SBGGR12F,
+	V4L2_PIX_FMT_MTISP_SBGGR14,
+	V4L2_PIX_FMT_MTISP_SBGGR14F,
+	V4L2_PIX_FMT_MTISP_SBGGR8F,
+	V4L2_PIX_FMT_MTISP_SGBRG10,
+	V4L2_PIX_FMT_MTISP_SGBRG10F,
+	V4L2_PIX_FMT_MTISP_SGBRG12,
+	V4L2_PIX_FMT_MTISP_SGBRG12F,
+	V4L2_PIX_FMT_MTISP_SGBRG14,
+	V4L2_PIX_FMT_MTISP_SGBRG14F,
+	V4L2_PIX_FMT_MTISP_SGBRG8F,
+	V4L2_PIX_FMT_MTISP_SGRB10F,
+	V4L2_PIX_FMT_MTISP_SGRB12F,
+	V4L2_PIX_FMT_MTISP_SGRB8F,
+	V4L2_PIX_FMT_MTISP_SGRBG10,
+	V4L2_PIX_FMT_MTISP_SGRBG10F,
+	V4L2_PIX_FMT_MTISP_SGRBG12,
+	V4L2_PIX_FMT_MTISP_SGRBG12F,
+	V4L2_PIX_FMT_MTISP_SGRBG14,
+	V4L2_PIX_FMT_MTISP_SGRBG14F,
+	V4L2_PIX_FMT_MTISP_SGRBG8F,
+	V4L2_PIX_FMT_MTISP_SRGGB10,
+	V4L2_PIX_FMT_MTISP_SRGGB10F,
+	V4L2_PIX_FMT_MTISP_SRGGB12,
+	V4L2_PIX_FMT_MTISP_SRGGB12F,
+	V4L2_PIX_FMT_MTISP_SRGGB14,
+	V4L2_PIX_FMT_MTISP_SRGGB14F,
+	V4L2_PIX_FMT_MTISP_SRGGB8F,
+	V4L2_PIX_FMT_MTISP_UYVY10P,
+	V4L2_PIX_FMT_MTISP_UYVY12P,
+	V4L2_PIX_FMT_MTISP_VYUY10P,
+	V4L2_PIX_FMT_MTISP_VYUY12P,
+	V4L2_PIX_FMT_MTISP_YUYV10P,
+	V4L2_PIX_FMT_MTISP_YUYV12P,
+	V4L2_PIX_FMT_MTISP_YVYU10P,
+	V4L2_PIX_FMT_MTISP_YVYU12P,
+	V4L2_PIX_FMT_NV12,
+	V4L2_PIX_FMT_NV12_10,
+	V4L2_PIX_FMT_NV12_12,
+	V4L2_PIX_FMT_NV16,
+	V4L2_PIX_FMT_NV16_10,
+	V4L2_PIX_FMT_NV16_12,
+	V4L2_PIX_FMT_NV21,
+	V4L2_PIX_FMT_NV21_10,
+	V4L2_PIX_FMT_NV21_12,
+	V4L2_PIX_FMT_NV61,
+	V4L2_PIX_FMT_NV61_10,
+	V4L2_PIX_FMT_NV61_12,
+	V4L2_PIX_FMT_SBGGR10,
+	V4L2_PIX_FMT_SBGGR10P,
+	V4L2_PIX_FMT_SBGGR12,
+	V4L2_PIX_FMT_SBGGR14,
+	V4L2_PIX_FMT_SBGGR16,
+	V4L2_PIX_FMT_SBGGR8,
+	V4L2_PIX_FMT_SGBRG10,
+	V4L2_PIX_FMT_SGBRG10P,
+	V4L2_PIX_FMT_SGBRG12,
+	V4L2_PIX_FMT_SGBRG14,
+	V4L2_PIX_FMT_SGBRG16,
+	V4L2_PIX_FMT_SGBRG8,
+	V4L2_PIX_FMT_SGRBG10,
+	V4L2_PIX_FMT_SGRBG10P,
+	V4L2_PIX_FMT_SGRBG12,
+	V4L2_PIX_FMT_SGRBG14,
+	V4L2_PIX_FMT_SGRBG16,
+	V4L2_PIX_FMT_SGRBG8,
+	V4L2_PIX_FMT_SRGGB10,
+	V4L2_PIX_FMT_SRGGB10P,
+	V4L2_PIX_FMT_SRGGB12,
+	V4L2_PIX_FMT_SRGGB14,
+	V4L2_PIX_FMT_SRGGB16,
+	V4L2_PIX_FMT_SRGGB8,
+	V4L2_PIX_FMT_UYVY,
+	V4L2_PIX_FMT_UYVY10,
+	V4L2_PIX_FMT_UYVY12,
+	V4L2_PIX_FMT_VYUY,
+	V4L2_PIX_FMT_VYUY10,
+	V4L2_PIX_FMT_VYUY12,
+	V4L2_PIX_FMT_YUV420,
+	V4L2_PIX_FMT_YUV422P,
+	V4L2_PIX_FMT_YUYV,
+	V4L2_PIX_FMT_YUYV10,
+	V4L2_PIX_FMT_YUYV12,
+	V4L2_PIX_FMT_YVU420,
+	V4L2_PIX_FMT_YVYU,
+	V4L2_PIX_FMT_YVYU10,
+	V4L2_PIX_FMT_YVYU12,
+};
+
+#endif
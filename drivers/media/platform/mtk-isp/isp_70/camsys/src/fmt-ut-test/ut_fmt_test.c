@@ -0,0 +1,285 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright (c) 2022 MediaTek Inc.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* built in, so the checks can reach the hash internals */
+#include "../mtk_cam-fmt-desc.c"
+
+/* layouts as v4l2_format_info() in v4l2-common.c, for the legacy path */
+struct v4l2_format_info {
+	u32 format;
+	u8 mem_planes;
+	u8 comp_planes;
+	u8 bpp[4];
+	u8 hdiv;
+	u8 vdiv;
+};
+
+static const struct v4l2_format_info ut_v4l2_formats[] = {
+	{ V4L2_PIX_FMT_GREY,    1, 1, { 1, 0, 0, 0 }, 1, 1 },
+	{ V4L2_PIX_FMT_YUYV,    1, 1, { 2, 0, 0, 0 }, 2, 1 },
+	{ V4L2_PIX_FMT_YVYU,    1, 1, { 2, 0, 0, 0 }, 2, 1 },
+	{ V4L2_PIX_FMT_UYVY,    1, 1, { 2, 0, 0, 0 }, 2, 1 },
+	{ V4L2_PIX_FMT_VYUY,    1, 1, { 2, 0, 0, 0 }, 2, 1 },
+	{ V4L2_PIX_FMT_NV12,    1, 2, { 1, 2, 0, 0 }, 2, 2 },
+	{ V4L2_PIX_FMT_NV21,    1, 2, { 1, 2, 0, 0 }, 2, 2 },
+	{ V4L2_PIX_FMT_NV16,    1, 2, { 1, 2, 0, 0 }, 2, 1 },
+	{ V4L2_PIX_FMT_NV61,    1, 2, { 1, 2, 0, 0 }, 2, 1 },
+	{ V4L2_PIX_FMT_YUV420,  1, 3, { 1, 1, 1, 0 }, 2, 2 },
+	{ V4L2_PIX_FMT_YVU420,  1, 3, { 1, 1, 1, 0 }, 2, 2 },
+	{ V4L2_PIX_FMT_YUV422P, 1, 3, { 1, 1, 1, 0 }, 2, 1 },
+};
+
+static const struct v4l2_format_info *ut_v4l2_format_info(u32 format)
+{
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(ut_v4l2_formats); i++)
+		if (ut_v4l2_formats[i].format == format)
+			return &ut_v4l2_formats[i];
+	return NULL;
+}
+
+#include "ut_fmt_legacy.h"
+#include "ut_fmt_fourccs.h"
+
+#define NONE           "\033[m"
+#define RED            "\033[0;32;31m"
+#define GREEN          "\033[0;32;32m"
+
+static int ut_fail;
+static int ut_cnt;
+static int ut_skip;
+
+#define UT_CHECK(cond, fmt, args...)					\
+do {									\
+	ut_cnt++;							\
+	if (!(cond)) {							\
+		ut_fail++;						\
+		printf(RED "[FAIL] %s:%d " fmt NONE "\n",		\
+		       __func__, __LINE__, ##args);			\
+	}								\
+} while (0)
+
+/* what the mtk_cam-video.c wrappers return */
+static unsigned int ut_img_fmt(u32 fourcc)
+{
+	const struct mtk_cam_fmt_desc *desc = mtk_cam_fmt_desc_find(fourcc);
+
+	return desc ? desc->ipi_fmt : MTKCAM_IPI_IMG_FMT_UNKNOWN;
+}
+
+static int ut_flag(u32 fourcc, u8 flag)
+{
+	const struct mtk_cam_fmt_desc *desc = mtk_cam_fmt_desc_find(fourcc);
+
+	return desc && (desc->flags & flag);
+}
+
+static const struct mtk_format_info *ut_mtk_format_info(u32 fourcc)
+{
+	const struct mtk_cam_fmt_desc *desc = mtk_cam_fmt_desc_find(fourcc);
+
+	return desc && (desc->flags & MTK_CAM_FMT_MTK) ? &desc->info : NULL;
+}
+
+static bool ut_is_ufbc_bayer(unsigned int ipi_fmt)
+{
+	return ipi_fmt >= MTKCAM_IPI_IMG_FMT_UFBC_BAYER8 &&
+	       ipi_fmt <= MTKCAM_IPI_IMG_FMT_UFBC_BAYER14;
+}
+
+static void ut_check_ipi(void)
+{
+	const struct mtk_cam_ipi_fmt_desc *ipi;
+	unsigned int bits, ipi_fmt;
+	int factor;
+
+	for (ipi_fmt = 0; ipi_fmt < MTK_CAM_IPI_FMT_NUM + 4; ipi_fmt++) {
+		ipi = mtk_cam_ipi_fmt_desc(ipi_fmt);
+		bits = ipi && ipi->pixel_bits ? ipi->pixel_bits : -1;
+		UT_CHECK(bits == legacy_mtk_cam_get_pixel_bits(ipi_fmt),
+			 "ipi %u: pixel bits %u", ipi_fmt, bits);
+
+		/*
+		 * the legacy switch matched UFBC bayer against fourccs, so it
+		 * never returned the 100 it meant to
+		 */
+		factor = ipi ? ipi->size_factor : -1;
+		if (ut_is_ufbc_bayer(ipi_fmt))
+			UT_CHECK(factor == 100, "ipi %u: factor %d", ipi_fmt,
+				 factor);
+		else
+			UT_CHECK(factor ==
+				 legacy_mtk_cam_get_fmt_size_factor(ipi_fmt),
+				 "ipi %u: factor %d", ipi_fmt, factor);
+	}
+	UT_CHECK(!mtk_cam_ipi_fmt_desc(MTKCAM_IPI_IMG_FMT_UNKNOWN),
+		 "unknown ipi has a descriptor");
+}
+
+static void ut_check_fourcc(u32 f)
+{
+	const struct mtk_format_info *info = ut_mtk_format_info(f);
+	const struct mtk_format_info *ref = legacy_mtk_format_info(f);
+
+	UT_CHECK(ut_img_fmt(f) == legacy_mtk_cam_get_img_fmt(f),
+		 "0x%08x: ipi %u", f, ut_img_fmt(f));
+	UT_CHECK(!!ut_flag(f, MTK_CAM_FMT_MTK) == legacy_is_mtk_format(f),
+		 "0x%08x: mtk", f);
+	UT_CHECK(!!ut_flag(f, MTK_CAM_FMT_YUV_UFO) == legacy_is_yuv_ufo(f),
+		 "0x%08x: yuv ufo", f);
+	UT_CHECK(!!ut_flag(f, MTK_CAM_FMT_RAW_UFO) == legacy_is_raw_ufo(f),
+		 "0x%08x: raw ufo", f);
+	UT_CHECK(!!ut_flag(f, MTK_CAM_FMT_FULLG_RB) == legacy_is_fullg_rb(f),
+		 "0x%08x: fullg rb", f);
+	UT_CHECK(!info == !ref && (!info || !memcmp(info, ref, sizeof(*info))),
+		 "0x%08x: mtk format info", f);
+}
+
+static void ut_check_lookup(void)
+{
+	u32 f = 0x12345678;
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(ut_fourccs); i++)
+		ut_check_fourcc(ut_fourccs[i]);
+
+	/* anything else must miss, like the switch default */
+	for (i = 0; i < 200000; i++) {
+		f = f * 1664525 + 1013904223;
+		ut_check_fourcc(f);
+	}
+	ut_check_fourcc(0);
+	ut_check_fourcc(~0U);
+	ut_check_fourcc(V4L2_PIX_FMT_RGB24);
+	ut_check_fourcc(V4L2_PIX_FMT_MJPEG);
+
+	UT_CHECK(ARRAY_SIZE(ut_fourccs) == ARRAY_SIZE(mtk_cam_fmt_descs),
+		 "table has %zu formats, legacy %zu",
+		 ARRAY_SIZE(mtk_cam_fmt_descs), ARRAY_SIZE(ut_fourccs));
+}
+
+/* the legacy path dereferences a NULL v4l2_format_info for these */
+static bool ut_legacy_crashes(u32 f)
+{
+	const struct mtk_cam_ipi_fmt_desc *ipi =
+		mtk_cam_ipi_fmt_desc(legacy_mtk_cam_get_img_fmt(f));
+
+	return ipi && (ipi->flags & MTK_CAM_IPI_FMT_FILL) &&
+	       !legacy_is_mtk_format(f) && !ut_v4l2_format_info(f);
+}
+
+static void ut_check_size(u32 f, u32 w, u32 h, u32 bpl, u8 planes,
+			  unsigned int pixel_mode)
+{
+	struct v4l2_pix_format_mplane mp, ref;
+	unsigned int i;
+
+	memset(&mp, 0, sizeof(mp));
+	mp.pixelformat = f;
+	mp.width = w;
+	mp.height = h;
+	mp.num_planes = planes;
+	for (i = 0; i < planes; i++)
+		mp.plane_fmt[i].bytesperline = bpl;
+	ref = mp;
+
+	mtk_cam_fmt_calc_pixfmt_mp(&mp, pixel_mode);
+	if (ut_legacy_crashes(f)) {
+		UT_CHECK(mp.plane_fmt[0].sizeimage == 0,
+			 "0x%08x: no layout but size %u", f,
+			 mp.plane_fmt[0].sizeimage);
+		ut_skip++;
+		return;
+	}
+	legacy_cal_image_pix_mp(0, &ref, pixel_mode);
+
+	UT_CHECK(!memcmp(&mp, &ref, sizeof(mp)),
+		 "0x%08x %ux%u bpl %u planes %u pxl %u: %u/%u vs %u/%u",
+		 f, w, h, bpl, planes, pixel_mode,
+		 mp.plane_fmt[0].bytesperline, mp.plane_fmt[0].sizeimage,
+		 ref.plane_fmt[0].bytesperline, ref.plane_fmt[0].sizeimage);
+}
+
+static void ut_check_sizes(void)
+{
+	static const u32 heights[] = { 1, 2, 3, 7, 480, 1080, 1081, 3000 };
+	static const u32 bpls[] = { 0, 1, 999, 20000 };
+	unsigned int i, h, b, p, pxl;
+	u32 w;
+
+	for (i = 0; i < ARRAY_SIZE(ut_fourccs); i++)
+		for (w = 1; w <= 8192; w += (w < 300) ? 1 : 37)
+			for (h = 0; h < ARRAY_SIZE(heights); h++)
+				for (b = 0; b < ARRAY_SIZE(bpls); b++)
+					for (p = 1; p <= 2; p++)
+						for (pxl = 0; pxl <= 3; pxl += 3)
+							ut_check_size(ut_fourccs[i],
+								      w, heights[h],
+								      bpls[b], p, pxl);
+}
+
+static double ut_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void ut_bench(void)
+{
+	const int rounds = 20000;
+	volatile unsigned int sink = 0;
+	double t0, t1, t2;
+	unsigned int i;
+	int r;
+
+	t0 = ut_now_ns();
+	for (r = 0; r < rounds; r++)
+		for (i = 0; i < ARRAY_SIZE(ut_fourccs); i++)
+			sink += legacy_mtk_cam_get_img_fmt(ut_fourccs[i]) +
+				!!legacy_mtk_format_info(ut_fourccs[i]);
+	t1 = ut_now_ns();
+	for (r = 0; r < rounds; r++)
+		for (i = 0; i < ARRAY_SIZE(ut_fourccs); i++)
+			sink += ut_img_fmt(ut_fourccs[i]) +
+				!!ut_mtk_format_info(ut_fourccs[i]);
+	t2 = ut_now_ns();
+
+	printf("lookup ns/format: legacy %.1f, table %.1f\n",
+	       (t1 - t0) / rounds / ARRAY_SIZE(ut_fourccs),
+	       (t2 - t1) / rounds / ARRAY_SIZE(ut_fourccs));
+}
+
+int main(void)
+{
+	UT_CHECK(mtk_cam_fmt_desc_init() == 0, "perfect hash not built");
+
+	ut_check_ipi();
+	ut_check_lookup();
+	ut_check_sizes();
+
+	/* the fallback scan must agree too */
+	fmt_hash_ready = false;
+	ut_check_lookup();
+	UT_CHECK(mtk_cam_fmt_desc_init() == 0, "perfect hash not rebuilt");
+
+	ut_bench();
+
+	printf("size checks skipped, legacy has no layout: %d\n", ut_skip);
+	if (ut_fail) {
+		printf(RED "%d/%d checks failed\n" NONE, ut_fail, ut_cnt);
+		return EXIT_FAILURE;
+	}
+	printf(GREEN "all %d checks passed\n" NONE, ut_cnt);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,422 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright (c) 2022 MediaTek Inc.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* built in, so the checks can reach the rings and the window update */
+#include "../mtk_cam-raw-irq.c"
+
+#define NONE           "\033[m"
+#define RED            "\033[0;32;31m"
+#define GREEN          "\033[0;32;32m"
+
+/* module param defaults in mtk_cam-raw.c */
+#define UT_RATE_THR	800
+#define UT_BUDGET	4
+#define UT_FLUSH_NS	4000000ULL
+
+static int ut_fail;
+static int ut_cnt;
+
+#define UT_CHECK(cond, fmt, args...)					\
+do {									\
+	ut_cnt++;							\
+	if (!(cond)) {							\
+		ut_fail++;						\
+		printf(RED "[FAIL] %s:%d " fmt NONE "\n",		\
+		       __func__, __LINE__, ##args);			\
+	}								\
+} while (0)
+
+/* what the irq thread would find in the msg queue */
+struct ut_pipe {
+	struct mtk_raw_irq_coal c;
+	struct mtk_cam_irq_queue q;
+	u64 ts_ns;
+	unsigned int frame;
+	unsigned int backlog;
+	unsigned int max_backlog;
+	unsigned int frames_polled;
+	unsigned int popped;
+	u64 timer_ns;	/* flush timer expiry, 0 when not armed */
+	u64 held_ns;	/* arrival of the oldest event in the queue */
+	u64 max_hold_ns;
+};
+
+/* same order mtk_irq_raw queues them in one frame, SOF is urgent */
+static const struct {
+	u32 irq_type;
+	unsigned int at_pct; /* offset in the frame period */
+} ut_frame_events[] = {
+	{ 1 << CAMSYS_IRQ_FRAME_START, 0 },
+	{ 1 << CAMSYS_IRQ_SETTING_DONE, 20 },
+	{ 1 << CAMSYS_IRQ_AFO_DONE, 80 },
+	{ 1 << CAMSYS_IRQ_FRAME_DONE, 90 },
+};
+
+#define UT_FRAME_EVENTS \
+	(sizeof(ut_frame_events) / sizeof(ut_frame_events[0]))
+
+/* the thread drains the whole queue per wakeup, in order */
+static void ut_drain(struct ut_pipe *p, u64 now)
+{
+	struct mtk_cam_irq_msg msg;
+	unsigned int last = 0;
+
+	if (p->backlog && now - p->held_ns > p->max_hold_ns)
+		p->max_hold_ns = now - p->held_ns;
+
+	while (mtk_cam_irq_queue_pop(&p->q, &msg)) {
+		UT_CHECK(msg.seq > last, "seq %u after %u", msg.seq, last);
+		last = msg.seq;
+		p->popped += msg.count;
+	}
+	p->backlog = 0;
+}
+
+/* time goes by to @now, the flush timer of mtk_cam-raw.c may expire */
+static void ut_advance(struct ut_pipe *p, u64 now)
+{
+	u64 expiry = p->timer_ns;
+
+	if (!expiry || expiry > now)
+		return;
+
+	p->timer_ns = 0;
+	if (mtk_raw_irq_coal_flush(&p->c))
+		ut_drain(p, expiry);
+}
+
+/* inject one frame worth of events, the way mtk_raw_inject_irq does */
+static void ut_run_frame(struct ut_pipe *p, unsigned int fps)
+{
+	u64 period = NSEC_PER_SEC / fps;
+	struct mtk_camsys_irq_info info = { 0 };
+	enum mtk_cam_irq_class cls;
+	unsigned int i;
+	bool wake;
+
+	info.frame_idx = p->frame;
+	info.frame_idx_inner = p->frame;
+
+	for (i = 0; i < UT_FRAME_EVENTS; i++) {
+		info.irq_type = ut_frame_events[i].irq_type;
+		info.ts_ns = p->ts_ns +
+			period * ut_frame_events[i].at_pct / 100;
+		cls = mtk_cam_irq_raw_class(info.irq_type);
+		ut_advance(p, info.ts_ns);
+
+		wake = mtk_raw_irq_coal_event(&p->c,
+					      cls != MTK_CAM_IRQ_CLASS_DONE,
+					      info.ts_ns);
+		UT_CHECK(mtk_cam_irq_queue_push(&p->q, cls, &info),
+			 "frame %u: event %u folded", p->frame, i);
+		if (!p->backlog)
+			p->held_ns = info.ts_ns;
+		p->backlog++;
+		if (p->backlog > p->max_backlog)
+			p->max_backlog = p->backlog;
+
+		if (cls != MTK_CAM_IRQ_CLASS_DONE)
+			UT_CHECK(wake, "urgent event at %llu not signalled",
+				 (unsigned long long)p->ts_ns);
+		if (!p->c.polling)
+			UT_CHECK(wake, "event deferred while not polling");
+		if (wake) {
+			ut_drain(p, info.ts_ns);
+			continue;
+		}
+
+		/* as queue_msgfifo arms it */
+		if (p->c.pending == 1)
+			p->timer_ns = info.ts_ns + p->c.flush_ns;
+	}
+	p->frames_polled += p->c.polling;
+	p->frame++;
+	p->ts_ns += period;
+}
+
+static void ut_run(struct ut_pipe *p, unsigned int fps, unsigned int sec)
+{
+	unsigned int i;
+
+	for (i = 0; i < fps * sec; i++)
+		ut_run_frame(p, fps);
+}
+
+static void ut_pipe_init(struct ut_pipe *p, u32 rate_thr)
+{
+	memset(p, 0, sizeof(*p));
+	mtk_raw_irq_coal_reset(&p->c, rate_thr, UT_BUDGET, UT_FLUSH_NS);
+	mtk_cam_irq_queue_reset(&p->q);
+	p->ts_ns = 1000000000ULL;
+}
+
+static void ut_check_low_rate(void)
+{
+	static const unsigned int fps[] = { 30, 60, 120 };
+	struct ut_pipe p;
+	unsigned int i;
+
+	for (i = 0; i < sizeof(fps) / sizeof(fps[0]); i++) {
+		ut_pipe_init(&p, UT_RATE_THR);
+		ut_run(&p, fps[i], 2);
+		UT_CHECK(!p.c.poll_enter, "%ufps entered polling", fps[i]);
+		UT_CHECK(p.c.wakeups == p.c.events, "%ufps: %llu/%llu wakeups",
+			 fps[i], (unsigned long long)p.c.wakeups,
+			 (unsigned long long)p.c.events);
+	}
+}
+
+static void ut_check_high_rate(void)
+{
+	static const unsigned int fps[] = { 240, 480, 960 };
+	struct ut_pipe p;
+	unsigned int i;
+
+	for (i = 0; i < sizeof(fps) / sizeof(fps[0]); i++) {
+		ut_pipe_init(&p, UT_RATE_THR);
+		ut_run(&p, fps[i], 2);
+		UT_CHECK(p.c.poll_enter == 1, "%ufps: poll_enter %u", fps[i],
+			 p.c.poll_enter);
+		/* polling starts once the first window has been sampled */
+		UT_CHECK(p.frames_polled + fps[i] / 5 >= fps[i] * 2,
+			 "%ufps: polled %u frames", fps[i], p.frames_polled);
+		UT_CHECK(p.max_backlog <= UT_BUDGET, "%ufps: backlog %u",
+			 fps[i], p.max_backlog);
+		UT_CHECK(p.c.wakeups + p.c.coalesced == p.c.events,
+			 "%ufps: stats do not add up", fps[i]);
+		UT_CHECK(p.max_hold_ns <= UT_FLUSH_NS, "%ufps: held %lluns",
+			 fps[i], (unsigned long long)p.max_hold_ns);
+		UT_CHECK(p.popped + p.backlog == p.c.events,
+			 "%ufps: %u events popped of %llu", fps[i], p.popped,
+			 (unsigned long long)p.c.events);
+		/* CQ, AFO and frame done of a frame share one message */
+		UT_CHECK(p.q.ring[MTK_CAM_IRQ_CLASS_DONE].coalesced,
+			 "%ufps: done events not merged", fps[i]);
+		UT_CHECK(p.c.wakeups * 2 < p.c.events,
+			 "%ufps: %llu/%llu wakeups", fps[i],
+			 (unsigned long long)p.c.wakeups,
+			 (unsigned long long)p.c.events);
+		printf("%4ufps: %6llu events %6llu wakeups\n", fps[i],
+		       (unsigned long long)p.c.events,
+		       (unsigned long long)p.c.wakeups);
+	}
+}
+
+static void ut_check_leave(void)
+{
+	struct ut_pipe p;
+	u64 wakeups, events;
+
+	ut_pipe_init(&p, UT_RATE_THR);
+	ut_run(&p, 240, 1);
+	UT_CHECK(p.c.polling, "240fps not polling");
+
+	/* a rate between thr/2 and thr keeps polling */
+	ut_run(&p, 150, 1);
+	UT_CHECK(p.c.polling, "left polling above half the threshold");
+
+	ut_run(&p, 30, 1);
+	UT_CHECK(!p.c.polling, "still polling at 30fps");
+	UT_CHECK(p.c.poll_enter == 1, "poll_enter %u", p.c.poll_enter);
+
+	wakeups = p.c.wakeups;
+	events = p.c.events;
+	ut_run(&p, 30, 1);
+	UT_CHECK(p.c.wakeups - wakeups == p.c.events - events,
+		 "events deferred after leaving polling");
+}
+
+static void ut_check_disabled(void)
+{
+	struct ut_pipe p;
+
+	ut_pipe_init(&p, 0);
+	ut_run(&p, 960, 1);
+	UT_CHECK(!p.c.poll_enter, "polling with rate_thr 0");
+	UT_CHECK(p.c.wakeups == p.c.events, "coalesced with rate_thr 0");
+}
+
+/* the sensor stops, no SOF comes to hand the last done events over */
+static void ut_check_stranded(void)
+{
+	struct ut_pipe p;
+	u64 held_ns;
+
+	ut_pipe_init(&p, UT_RATE_THR);
+	ut_run(&p, 240, 1);
+	UT_CHECK(p.c.polling, "240fps not polling");
+	UT_CHECK(p.backlog == UT_FRAME_EVENTS - 1, "backlog %u", p.backlog);
+	UT_CHECK(p.timer_ns, "flush timer not armed");
+
+	held_ns = p.held_ns;
+	ut_advance(&p, held_ns + UT_FLUSH_NS - 1);
+	UT_CHECK(p.backlog, "flushed before the deadline");
+
+	ut_advance(&p, held_ns + UT_FLUSH_NS);
+	UT_CHECK(!p.backlog, "%u events stranded", p.backlog);
+	UT_CHECK(p.popped == p.c.events, "%u events popped of %llu",
+		 p.popped, (unsigned long long)p.c.events);
+	UT_CHECK(p.c.flushes == 1, "flushes %llu",
+		 (unsigned long long)p.c.flushes);
+	UT_CHECK(p.c.wakeups + p.c.coalesced == p.c.events,
+		 "stats do not add up");
+
+	/* a stale expiry has nothing to hand over */
+	UT_CHECK(!mtk_raw_irq_coal_flush(&p.c), "flushed an empty queue");
+
+	/* the timer is late, the next event past the deadline wakes */
+	held_ns += 2 * UT_FLUSH_NS;
+	UT_CHECK(!mtk_raw_irq_coal_event(&p.c, false, held_ns),
+		 "first done event not held");
+	UT_CHECK(mtk_raw_irq_coal_event(&p.c, false, held_ns + UT_FLUSH_NS),
+		 "done event past the deadline held");
+	UT_CHECK(!p.c.pending, "pending %u", p.c.pending);
+}
+
+static void ut_push(struct mtk_cam_irq_queue *q, u32 irq_type, int frame,
+		    int err_status, bool expect)
+{
+	struct mtk_camsys_irq_info info = { 0 };
+
+	info.irq_type = irq_type;
+	info.frame_idx = frame;
+	info.frame_idx_inner = frame;
+	info.e.err_status = err_status;
+	UT_CHECK(mtk_cam_irq_queue_push(q, mtk_cam_irq_raw_class(irq_type),
+					&info) == expect,
+		 "push 0x%x frame %d", irq_type, frame);
+}
+
+static void ut_pop(struct mtk_cam_irq_queue *q, u32 irq_type, int frame,
+		   u32 count)
+{
+	struct mtk_cam_irq_msg msg;
+
+	if (!mtk_cam_irq_queue_pop(q, &msg)) {
+		UT_CHECK(0, "queue empty, expected 0x%x", irq_type);
+		return;
+	}
+	UT_CHECK(msg.info.irq_type == irq_type &&
+		 msg.info.frame_idx == frame && msg.count == count,
+		 "got 0x%x frame %d count %u", msg.info.irq_type,
+		 msg.info.frame_idx, msg.count);
+}
+
+#define UT_SOF		(1 << CAMSYS_IRQ_FRAME_START)
+#define UT_CQD		(1 << CAMSYS_IRQ_SETTING_DONE)
+#define UT_AFO		(1 << CAMSYS_IRQ_AFO_DONE)
+#define UT_SWD		(1 << CAMSYS_IRQ_FRAME_DONE)
+#define UT_ERR		(1 << CAMSYS_IRQ_ERROR)
+
+static void ut_check_queue(void)
+{
+	static struct mtk_cam_irq_queue q;
+	struct mtk_cam_irq_msg msg;
+	char buf[256];
+	int i;
+
+	memset(&q, 0, sizeof(q));
+	mtk_cam_irq_queue_reset(&q);
+
+	/* arrival order across classes, consecutive done bits merge */
+	ut_push(&q, UT_SOF, 1, 0, true);
+	ut_push(&q, UT_CQD, 1, 0, true);
+	ut_push(&q, UT_AFO, 1, 0, true);
+	ut_push(&q, UT_ERR, 1, 0x10, true);
+	ut_push(&q, UT_SWD, 1, 0, true);
+	ut_push(&q, UT_SWD, 2, 0, true);
+	ut_pop(&q, UT_SOF, 1, 1);
+	ut_pop(&q, UT_CQD | UT_AFO, 1, 2);
+	ut_pop(&q, UT_ERR, 1, 1);
+	ut_pop(&q, UT_SWD, 1, 1);
+	ut_pop(&q, UT_SWD, 2, 1);
+	UT_CHECK(!mtk_cam_irq_queue_pop(&q, &msg), "queue not empty");
+
+	/* a repeated SOF keeps the latest frame, errors accumulate */
+	ut_push(&q, UT_SOF, 3, 0, true);
+	ut_push(&q, UT_SOF, 4, 0, true);
+	ut_push(&q, UT_ERR, 4, 0x1, true);
+	ut_push(&q, UT_ERR, 4, 0x2, true);
+	ut_pop(&q, UT_SOF, 4, 2);
+	UT_CHECK(mtk_cam_irq_queue_pop(&q, &msg) && msg.count == 2 &&
+		 msg.info.e.err_status == 0x3, "err_status 0x%x",
+		 msg.info.e.err_status);
+
+	/* a full ring folds, the SOF is still delivered, after the done */
+	for (i = 0; i < MTK_CAM_IRQ_RING_NUM; i++) {
+		ut_push(&q, UT_SOF, 10 + i, 0, true);
+		ut_push(&q, UT_SWD, 10 + i, 0, true);
+	}
+	ut_push(&q, UT_SOF, 20, 0, false);
+	UT_CHECK(q.ring[MTK_CAM_IRQ_CLASS_SOF].lost == 1, "lost %u",
+		 q.ring[MTK_CAM_IRQ_CLASS_SOF].lost);
+	for (i = 0; i < MTK_CAM_IRQ_RING_NUM - 1; i++) {
+		ut_pop(&q, UT_SOF, 10 + i, 1);
+		ut_pop(&q, UT_SWD, 10 + i, 1);
+	}
+	ut_pop(&q, UT_SWD, 10 + i, 1);
+	ut_pop(&q, UT_SOF, 20, 2);
+	UT_CHECK(!mtk_cam_irq_queue_pop(&q, &msg), "queue not empty");
+
+	mtk_cam_irq_queue_show(&q, buf, sizeof(buf));
+	UT_CHECK(strstr(buf, "sof: queued 6 coalesced 1 lost 1"), "show: %s",
+		 buf);
+	UT_CHECK(mtk_cam_irq_queue_show(&q, buf, 8) == 7, "show truncation");
+}
+
+/* a done of another frame folded keeps the older frame done apart */
+static void ut_check_fold(void)
+{
+	static struct mtk_cam_irq_queue q;
+	struct mtk_cam_irq_msg msg;
+	struct mtk_camsys_irq_info info;
+	int i;
+
+	memset(&q, 0, sizeof(q));
+	mtk_cam_irq_queue_reset(&q);
+
+	for (i = 0; i < MTK_CAM_IRQ_RING_NUM; i++)
+		ut_push(&q, UT_SWD, 30 + i, 0, true);
+	ut_push(&q, UT_AFO, 30 + MTK_CAM_IRQ_RING_NUM, 0, false);
+	for (i = 0; i < MTK_CAM_IRQ_RING_NUM - 1; i++) {
+		UT_CHECK(mtk_cam_irq_queue_pop(&q, &msg), "queue empty");
+		UT_CHECK(!mtk_cam_irq_msg_split(&msg, &info),
+			 "frame %d split", msg.info.frame_idx);
+	}
+	UT_CHECK(mtk_cam_irq_queue_pop(&q, &msg), "queue empty");
+	UT_CHECK(msg.info.irq_type == UT_AFO &&
+		 msg.info.frame_idx == 30 + MTK_CAM_IRQ_RING_NUM && msg.count == 2, "got 0x%x frame %d count %u",
+		 msg.info.irq_type, msg.info.frame_idx, msg.count);
+	UT_CHECK(mtk_cam_irq_msg_split(&msg, &info) &&
+		 info.irq_type == UT_SWD && info.frame_idx_inner == 29 + MTK_CAM_IRQ_RING_NUM,
+		 "older frame done 0x%x frame %d", info.irq_type,
+		 info.frame_idx_inner);
+	UT_CHECK(!mtk_cam_irq_queue_pop(&q, &msg), "queue not empty");
+
+	UT_CHECK(q.ring[MTK_CAM_IRQ_CLASS_DONE].lost == 1, "lost %u",
+		 q.ring[MTK_CAM_IRQ_CLASS_DONE].lost);
+}
+
+int main(void)
+{
+	ut_check_low_rate();
+	ut_check_high_rate();
+	ut_check_leave();
+	ut_check_disabled();
+	ut_check_stranded();
+	ut_check_queue();
+	ut_check_fold();
+
+	if (ut_fail) {
+		printf(RED "%d/%d checks failed\n" NONE, ut_fail, ut_cnt);
+		return EXIT_FAILURE;
+	}
+	printf(GREEN "all %d checks passed\n" NONE, ut_cnt);
+
+	return EXIT_SUCCESS;
+}
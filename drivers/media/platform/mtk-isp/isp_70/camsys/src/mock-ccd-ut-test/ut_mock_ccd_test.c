@@ -0,0 +1,494 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright (c) 2022 MediaTek Inc.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "mtk_cam-ipi-tlv.h"
+#include "mtk_cam-mock-ccd.h"
+
+#define NONE           "\033[m"
+#define RED            "\033[0;32;31m"
+#define GREEN          "\033[0;32;32m"
+
+/* struct ccd_worker_item sbuf */
+#define UT_BUF_MAX_SIZE	512
+
+static int ut_fail;
+static int ut_cnt;
+
+#define UT_CHECK(cond, fmt, args...)					\
+do {									\
+	ut_cnt++;							\
+	if (!(cond)) {							\
+		ut_fail++;						\
+		printf(RED "[FAIL] %s:%d " fmt NONE "\n",		\
+		       __func__, __LINE__, ##args);			\
+	}								\
+} while (0)
+
+static u64 ut_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void ut_event(struct mtkcam_ipi_event *ev, u8 cmd_id,
+		     u32 session_id, u32 frame_no)
+{
+	memset(ev, 0, sizeof(*ev));
+	ev->cmd_id = cmd_id;
+	ev->cookie.session_id = session_id;
+	ev->cookie.frame_no = frame_no;
+}
+
+static void ut_check_session(void)
+{
+	struct mtk_cam_mock_ccd m = { 0 };
+	struct mtkcam_ipi_event ev, ack;
+
+	ut_event(&ev, CAM_CMD_CREATE_SESSION, 2, 0);
+	UT_CHECK(!mtk_cam_mock_ccd_reply(&m, &ev, sizeof(ev), &ack),
+		 "create session acked");
+
+	ut_event(&ev, CAM_CMD_CONFIG, 2, 0);
+	UT_CHECK(!mtk_cam_mock_ccd_reply(&m, &ev, sizeof(ev), &ack),
+		 "config acked");
+
+	ut_event(&ev, CAM_CMD_FRAME, 2, 7);
+	memset(&ack, 0xa5, sizeof(ack));
+	UT_CHECK(mtk_cam_mock_ccd_reply(&m, &ev, sizeof(ev), &ack),
+		 "frame not acked");
+	UT_CHECK(ack.cmd_id == CAM_CMD_ACK &&
+		 ack.ack_data.ack_cmd_id == CAM_CMD_FRAME,
+		 "frame ack %u/%u", ack.cmd_id, ack.ack_data.ack_cmd_id);
+	UT_CHECK(ack.cookie.session_id == 2 && ack.cookie.frame_no == 7,
+		 "cookie %u/%u", ack.cookie.session_id, ack.cookie.frame_no);
+	UT_CHECK(!ack.ack_data.ret && !ack.ack_data.frame_result.cq_desc_size &&
+		 !ack.ack_data.frame_result.sub_cq_desc_size,
+		 "frame ack ret %d", ack.ack_data.ret);
+
+	ut_event(&ev, CAM_CMD_DESTROY_SESSION, 2, 0);
+	UT_CHECK(mtk_cam_mock_ccd_reply(&m, &ev, sizeof(ev), &ack),
+		 "destroy not acked");
+	UT_CHECK(ack.cmd_id == CAM_CMD_ACK &&
+		 ack.ack_data.ack_cmd_id == CAM_CMD_DESTROY_SESSION,
+		 "destroy ack %u/%u", ack.cmd_id, ack.ack_data.ack_cmd_id);
+
+	ut_event(&ev, CAM_CMD_ACK, 2, 0);
+	UT_CHECK(!mtk_cam_mock_ccd_reply(&m, &ev, sizeof(ev), &ack),
+		 "ack acked");
+	UT_CHECK(!mtk_cam_mock_ccd_reply(&m, &ev, 1, &ack),
+		 "short message acked");
+
+	UT_CHECK(m.stats.sessions == 1 && m.stats.configs == 1 &&
+		 m.stats.frames == 1 && m.stats.destroyed == 1 &&
+		 m.stats.unknown == 2,
+		 "stats %u %u %u %u %u", m.stats.sessions, m.stats.configs,
+		 m.stats.frames, m.stats.destroyed, m.stats.unknown);
+}
+
+static void ut_check_faults(void)
+{
+	struct mtk_cam_mock_ccd m = { 0 };
+	struct mtkcam_ipi_event ev, ack;
+	unsigned int i, acked = 0, failed = 0;
+
+	m.cfg.fail_every = 3;
+	m.cfg.drop_every = 4;
+
+	for (i = 1; i <= 24; i++) {
+		bool replied;
+
+		ut_event(&ev, CAM_CMD_FRAME, 0, i);
+		replied = mtk_cam_mock_ccd_reply(&m, &ev, sizeof(ev), &ack);
+		UT_CHECK(replied == !!(i % 4), "frame %u replied %d", i, replied);
+		if (!replied)
+			continue;
+
+		acked++;
+		UT_CHECK((ack.ack_data.ret == -EIO) == !(i % 3),
+			 "frame %u ret %d", i, ack.ack_data.ret);
+		if (ack.ack_data.ret)
+			failed++;
+	}
+
+	/* 12 and 24 are dropped, not failed */
+	UT_CHECK(acked == 18 && failed == 6, "acked %u failed %u",
+		 acked, failed);
+	UT_CHECK(m.stats.frames == 24 && m.stats.dropped == 6 &&
+		 m.stats.failed == 6,
+		 "stats %u %u %u", m.stats.frames, m.stats.dropped,
+		 m.stats.failed);
+}
+
+static void ut_check_caps(void)
+{
+	struct mtk_cam_mock_ccd m = { 0 };
+	struct mtkcam_ipi_event ev, ack;
+
+	m.cfg.caps = MTK_CAM_IPI_CAP_FRAME_TLV;
+
+	/* nothing offered, nothing to ack */
+	ut_event(&ev, CAM_CMD_CREATE_SESSION, 1, 0);
+	UT_CHECK(!mtk_cam_mock_ccd_reply(&m, &ev, sizeof(ev), &ack),
+		 "create session acked without caps");
+
+	ev.session_data.caps = MTK_CAM_IPI_CAP_FRAME_TLV | 0x8000;
+	UT_CHECK(mtk_cam_mock_ccd_reply(&m, &ev, sizeof(ev), &ack),
+		 "create session not acked");
+	UT_CHECK(ack.ack_data.ack_cmd_id == CAM_CMD_CREATE_SESSION &&
+		 ack.cookie.session_id == 1 &&
+		 ack.ack_data.caps == MTK_CAM_IPI_CAP_FRAME_TLV,
+		 "create session ack %u caps 0x%x", ack.ack_data.ack_cmd_id,
+		 ack.ack_data.caps);
+
+	ut_event(&ev, CAM_CMD_FRAME, 1, 1);
+	ev.frame_data.fmt = MTK_CAM_IPI_FRAME_FMT_TLV;
+	mtk_cam_mock_ccd_reply(&m, &ev, sizeof(ev), &ack);
+	UT_CHECK(m.stats.tlv_frames == 1, "tlv frames %u", m.stats.tlv_frames);
+}
+
+/* a preview stream: rawi, imgo, yuvo, meta in and 2 meta outs */
+static void ut_frame_preview(struct mtkcam_ipi_frame_param *fp)
+{
+	memset(fp, 0, sizeof(*fp));
+	fp->cur_workbuf_offset = 0x10000;
+	fp->cur_workbuf_size = 0x8000;
+	fp->raw_param.exposure_num = 1;
+	fp->raw_param.bin_flag = 0x1;
+
+	fp->img_ins[0].uid.id = 1;
+	fp->img_ins[0].fmt.s.w = 4000;
+	fp->img_ins[0].buf[0].iova = 0x40000000;
+
+	fp->img_outs[0].uid.id = 10;
+	fp->img_outs[0].fmt.s.w = 4000;
+	fp->img_outs[0].fmt.stride[0] = 5000;
+	fp->img_outs[0].buf[0][0].iova = 0x41000000;
+	fp->img_outs[0].buf[0][0].size = 0x1000000;
+
+	fp->img_outs[3].uid.id = 13;
+	fp->img_outs[3].fmt.s.w = 1920;
+	fp->img_outs[3].buf[0][0].iova = 0x42000000;
+	fp->img_outs[3].buf[0][1].iova = 0x42300000;
+	fp->img_outs[3].crop.s.w = 1920;
+
+	fp->meta_inputs[0].uid.id = 30;
+	fp->meta_inputs[0].buf.iova = 0x43000000;
+	fp->meta_outputs[0].uid.id = 40;
+	fp->meta_outputs[0].buf.iova = 0x44000000;
+	fp->meta_outputs[2].uid.id = 42;
+	fp->meta_outputs[2].buf.ccd_fd = 7;
+}
+
+static void ut_check_frame_tlv(void)
+{
+	struct mtkcam_ipi_frame_param *fp, *dec;
+	struct mtkcam_ipi_frame_tlv_hdr *hdr;
+	unsigned char *buf;
+	u32 size, n;
+
+	fp = calloc(1, sizeof(*fp));
+	dec = calloc(1, sizeof(*dec));
+	buf = calloc(1, 2 * sizeof(*fp));
+	hdr = (struct mtkcam_ipi_frame_tlv_hdr *)buf;
+
+	/* nothing in use */
+	size = mtkcam_ipi_frame_tlv_encode(buf, sizeof(*fp), fp);
+	UT_CHECK(size == sizeof(*hdr) && hdr->n_tlvs == 0, "empty %u", size);
+	memset(dec, 0xa5, sizeof(*dec));
+	UT_CHECK(!mtkcam_ipi_frame_tlv_decode(dec, buf, size) &&
+		 !memcmp(dec, fp, sizeof(*fp)), "empty decode");
+
+	ut_frame_preview(fp);
+	size = mtkcam_ipi_frame_tlv_encode(buf, sizeof(*fp), fp);
+	UT_CHECK(size && size == hdr->size && hdr->n_tlvs == 6,
+		 "preview %u n %u", size, hdr->n_tlvs);
+	UT_CHECK(!mtkcam_ipi_frame_tlv_decode(dec, buf, size) &&
+		 !memcmp(dec, fp, sizeof(*fp)), "preview decode");
+
+	/* subsample buffers up to the last one set */
+	fp->img_outs[0].buf[7][2].size = 1;
+	size = mtkcam_ipi_frame_tlv_encode(buf, sizeof(*fp), fp);
+	UT_CHECK(!mtkcam_ipi_frame_tlv_decode(dec, buf, size) &&
+		 !memcmp(dec, fp, sizeof(*fp)), "subsample decode");
+	UT_CHECK(mtkcam_ipi_img_output_n_bufs(&fp->img_outs[0]) == 8,
+		 "n_bufs %u", mtkcam_ipi_img_output_n_bufs(&fp->img_outs[0]));
+
+	/* a port with only its crop set is still sent */
+	fp->img_outs[9].crop.p.x = 16;
+	size = mtkcam_ipi_frame_tlv_encode(buf, sizeof(*fp), fp);
+	UT_CHECK(hdr->n_tlvs == 7 && !mtkcam_ipi_frame_tlv_decode(dec, buf, size) &&
+		 !memcmp(dec, fp, sizeof(*fp)), "crop only decode");
+
+	/* too small for the records */
+	UT_CHECK(!mtkcam_ipi_frame_tlv_encode(buf, 256, fp), "fits in 256");
+
+	/* every port with all its subsample buffers is over the full frame */
+	memset(fp, 0x11, sizeof(*fp));
+	size = mtkcam_ipi_frame_tlv_encode(buf, 2 * sizeof(*fp), fp);
+	UT_CHECK(size > sizeof(*fp) &&
+		 !mtkcam_ipi_frame_tlv_encode(buf, sizeof(*fp), fp),
+		 "worst case %u of %zu", size, sizeof(*fp));
+	UT_CHECK(!mtkcam_ipi_frame_tlv_decode(dec, buf, size) &&
+		 !memcmp(dec, fp, sizeof(*fp)), "worst case decode");
+
+	/* corrupted frames */
+	ut_frame_preview(fp);
+	size = mtkcam_ipi_frame_tlv_encode(buf, sizeof(*fp), fp);
+	UT_CHECK(mtkcam_ipi_frame_tlv_decode(dec, buf, size - 1) == -EINVAL,
+		 "truncated frame");
+	n = hdr->n_tlvs;
+	hdr->n_tlvs = n + 1;
+	UT_CHECK(mtkcam_ipi_frame_tlv_decode(dec, buf, size) == -EINVAL,
+		 "record past the frame");
+	hdr->n_tlvs = n;
+	buf[sizeof(*hdr) + 1] = CAM_MAX_IMAGE_INPUT;
+	UT_CHECK(mtkcam_ipi_frame_tlv_decode(dec, buf, size) == -EINVAL,
+		 "index out of range");
+
+	free(buf);
+	free(dec);
+	free(fp);
+}
+
+/*
+ * Bytes written to the msg buffer per frame, and the time to put a frame
+ * in it then get it out on the composer side, full against compact.
+ */
+static void ut_bench_frame_fmt(unsigned int frames)
+{
+	struct mtkcam_ipi_frame_param *fp, *dec;
+	unsigned char *msg;
+	u64 t, full_ns, tlv_ns, rx_ns = 0;
+	u32 size = 0;
+	unsigned int i;
+
+	fp = calloc(1, sizeof(*fp));
+	dec = calloc(1, sizeof(*dec));
+	msg = calloc(1, sizeof(*fp));
+	ut_frame_preview(fp);
+
+	t = ut_now_ns();
+	for (i = 0; i < frames; i++) {
+		fp->cur_workbuf_offset = i;
+		memcpy(msg, fp, sizeof(*fp));
+		memcpy(dec, msg, sizeof(*dec));
+		__asm__ volatile("" : : "r"(dec) : "memory");
+	}
+	full_ns = ut_now_ns() - t;
+
+	t = ut_now_ns();
+	for (i = 0; i < frames; i++) {
+		u64 t1;
+
+		fp->cur_workbuf_offset = i;
+		size = mtkcam_ipi_frame_tlv_encode(msg, sizeof(*fp), fp);
+		t1 = ut_now_ns();
+		mtkcam_ipi_frame_tlv_decode(dec, msg, size);
+		__asm__ volatile("" : : "r"(dec) : "memory");
+		rx_ns += ut_now_ns() - t1;
+	}
+	tlv_ns = ut_now_ns() - t;
+
+	UT_CHECK(size && size < sizeof(*fp) / 8, "compact %u of %zu bytes",
+		 size, sizeof(*fp));
+	UT_CHECK(!memcmp(dec, fp, sizeof(*fp)), "bench decode");
+
+	printf("frame full %5zu bytes: %llu ns/frame\n", sizeof(*fp),
+	       (unsigned long long)(full_ns / frames));
+	printf("frame tlv  %5u bytes: %llu ns/frame (encode %llu, decode %llu)\n",
+	       size, (unsigned long long)(tlv_ns / frames),
+	       (unsigned long long)((tlv_ns - rx_ns) / frames),
+	       (unsigned long long)(rx_ns / frames));
+
+	free(msg);
+	free(dec);
+	free(fp);
+}
+
+/*
+ * Round trip through a worker thread, standing in for the rpmsg queue,
+ * ccd_worker_read() and ccd_worker_write() around the mock.
+ */
+struct ut_mbox {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	bool full;
+	u32 len;
+	unsigned char sbuf[UT_BUF_MAX_SIZE];
+};
+
+struct ut_ipi {
+	struct ut_mbox tx;
+	struct ut_mbox rx;
+	struct mtk_cam_mock_ccd m;
+	bool exit;
+};
+
+static void ut_mbox_init(struct ut_mbox *b)
+{
+	pthread_mutex_init(&b->lock, NULL);
+	pthread_cond_init(&b->cond, NULL);
+	b->full = false;
+}
+
+static void ut_mbox_put(struct ut_mbox *b, const void *buf, u32 len)
+{
+	pthread_mutex_lock(&b->lock);
+	while (b->full)
+		pthread_cond_wait(&b->cond, &b->lock);
+	memcpy(b->sbuf, buf, len);
+	b->len = len;
+	b->full = true;
+	pthread_cond_broadcast(&b->cond);
+	pthread_mutex_unlock(&b->lock);
+}
+
+/* false on timeout */
+static bool ut_mbox_get(struct ut_mbox *b, void *buf, u32 *len,
+			unsigned int timeout_ms)
+{
+	struct timespec ts;
+	bool got;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	ts.tv_sec += timeout_ms / 1000;
+	ts.tv_nsec += (timeout_ms % 1000) * 1000000l;
+	if (ts.tv_nsec >= 1000000000l) {
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000l;
+	}
+
+	pthread_mutex_lock(&b->lock);
+	while (!b->full)
+		if (pthread_cond_timedwait(&b->cond, &b->lock, &ts))
+			break;
+	got = b->full;
+	if (got) {
+		memcpy(buf, b->sbuf, b->len);
+		*len = b->len;
+		b->full = false;
+		pthread_cond_broadcast(&b->cond);
+	}
+	pthread_mutex_unlock(&b->lock);
+
+	return got;
+}
+
+static void *ut_worker(void *data)
+{
+	struct ut_ipi *ipi = data;
+	unsigned char sbuf[UT_BUF_MAX_SIZE];
+	struct mtkcam_ipi_event ack;
+	struct timespec lat;
+	u32 len;
+
+	lat.tv_sec = 0;
+	lat.tv_nsec = ipi->m.cfg.latency_us * 1000l;
+
+	while (!__atomic_load_n(&ipi->exit, __ATOMIC_ACQUIRE)) {
+		if (!ut_mbox_get(&ipi->tx, sbuf, &len, 10))
+			continue;
+		if (!mtk_cam_mock_ccd_reply(&ipi->m, sbuf, len, &ack))
+			continue;
+		if (lat.tv_nsec)
+			nanosleep(&lat, NULL);
+		ut_mbox_put(&ipi->rx, &ack, sizeof(ack));
+	}
+
+	return NULL;
+}
+
+static void ut_bench(u32 latency_us, unsigned int frames)
+{
+	struct ut_ipi *ipi;
+	struct mtkcam_ipi_event ev, ack;
+	pthread_t worker;
+	u64 start, t, rtt, sum = 0, min = ~0ull, max = 0;
+	unsigned int i, acked = 0, in_order = 0;
+	u32 len;
+
+	ipi = calloc(1, sizeof(*ipi));
+	ut_mbox_init(&ipi->tx);
+	ut_mbox_init(&ipi->rx);
+	ipi->m.cfg.latency_us = latency_us;
+	pthread_create(&worker, NULL, ut_worker, ipi);
+
+	ut_event(&ev, CAM_CMD_CREATE_SESSION, 0, 0);
+	ut_mbox_put(&ipi->tx, &ev, sizeof(ev));
+	ut_event(&ev, CAM_CMD_CONFIG, 0, 0);
+	ut_mbox_put(&ipi->tx, &ev, sizeof(ev));
+
+	start = ut_now_ns();
+	for (i = 1; i <= frames; i++) {
+		ut_event(&ev, CAM_CMD_FRAME, 0, i);
+		t = ut_now_ns();
+		ut_mbox_put(&ipi->tx, &ev, sizeof(ev));
+		if (!ut_mbox_get(&ipi->rx, &ack, &len, 1000))
+			break;
+		rtt = ut_now_ns() - t;
+
+		acked++;
+		if (ack.cookie.frame_no == i &&
+		    ack.ack_data.ack_cmd_id == CAM_CMD_FRAME)
+			in_order++;
+		sum += rtt;
+		min = rtt < min ? rtt : min;
+		max = rtt > max ? rtt : max;
+	}
+	t = ut_now_ns() - start;
+
+	ut_event(&ev, CAM_CMD_DESTROY_SESSION, 0, 0);
+	ut_mbox_put(&ipi->tx, &ev, sizeof(ev));
+	UT_CHECK(ut_mbox_get(&ipi->rx, &ack, &len, 1000) &&
+		 ack.ack_data.ack_cmd_id == CAM_CMD_DESTROY_SESSION,
+		 "no destroy ack");
+
+	__atomic_store_n(&ipi->exit, true, __ATOMIC_RELEASE);
+	pthread_join(worker, NULL);
+
+	UT_CHECK(acked == frames && in_order == frames,
+		 "latency %u: %u/%u acked, %u in order", latency_us,
+		 acked, frames, in_order);
+	UT_CHECK(min >= latency_us * 1000ull, "latency %u: min rtt %llu ns",
+		 latency_us, (unsigned long long)min);
+	UT_CHECK(ipi->m.stats.sessions == 1 && ipi->m.stats.configs == 1 &&
+		 ipi->m.stats.destroyed == 1, "session stats");
+
+	if (acked)
+		printf("latency %4u us: %u frames, rtt avg %llu us max %llu us, %llu frames/s\n",
+		       latency_us, acked,
+		       (unsigned long long)(sum / acked / 1000),
+		       (unsigned long long)(max / 1000),
+		       (unsigned long long)(acked * 1000000000ull / (t ? t : 1)));
+
+	free(ipi);
+}
+
+int main(void)
+{
+	ut_check_session();
+	ut_check_faults();
+	ut_check_caps();
+	ut_check_frame_tlv();
+	ut_bench_frame_fmt(20000);
+	ut_bench(0, 5000);
+	ut_bench(100, 500);
+	ut_bench(1000, 100);
+
+	if (ut_fail) {
+		printf(RED "%d/%d checks failed\n" NONE, ut_fail, ut_cnt);
+		return EXIT_FAILURE;
+	}
+	printf(GREEN "all %d checks passed\n" NONE, ut_cnt);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright (c) 2022 MediaTek Inc.
+ *
+ * Mock composer daemon: acks the camsys IPI through /dev/mtk_ccd instead
+ * of the CCD daemon, see mtk_cam-mock-ccd.h. Stop the daemon first.
+ *
+ *   mock_ccd [-c caps] [-l latency_us] [-f fail_every] [-d drop_every]
+ *
+ * The counters of each composer are printed on SIGINT or SIGTERM.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/mtk_ccd_controls.h>
+
+#include "mtk_cam-mock-ccd.h"
+
+#define MOCK_CCD_DEV		"/dev/mtk_ccd"
+/* wait for the endpoint of a worker to be created */
+#define MOCK_CCD_IDLE_US	10000
+
+struct mock_ccd_worker {
+	int fd;
+	unsigned int src;
+	pthread_t thread;
+	struct mtk_cam_mock_ccd m;
+	struct ccd_worker_item item;
+};
+
+static void *mock_ccd_master(void *data)
+{
+	int fd = *(int *)data;
+	struct ccd_master_listen_item listen;
+
+	/* consume the endpoint create and destroy, or they would block */
+	for (;;) {
+		memset(&listen, 0, sizeof(listen));
+		if (ioctl(fd, IOCTL_CCD_MASTER_LISTEN, &listen) < 0) {
+			perror("IOCTL_CCD_MASTER_LISTEN");
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+static void *mock_ccd_work(void *data)
+{
+	struct mock_ccd_worker *w = data;
+	struct ccd_worker_item *item = &w->item;
+	struct mtkcam_ipi_event ack;
+	struct timespec lat;
+
+	lat.tv_sec = w->m.cfg.latency_us / 1000000;
+	lat.tv_nsec = (w->m.cfg.latency_us % 1000000) * 1000l;
+
+	for (;;) {
+		/* nothing is copied back when there is no message */
+		memset(item, 0, sizeof(*item));
+		item->src = w->src;
+		if (ioctl(w->fd, IOCTL_CCD_WORKER_READ, item) < 0) {
+			perror("IOCTL_CCD_WORKER_READ");
+			break;
+		}
+
+		if (!item->len) {
+			usleep(MOCK_CCD_IDLE_US);
+			continue;
+		}
+
+		if (!mtk_cam_mock_ccd_reply(&w->m, item->sbuf, item->len, &ack))
+			continue;
+
+		if (lat.tv_sec || lat.tv_nsec)
+			nanosleep(&lat, NULL);
+
+		memcpy(item->sbuf, &ack, sizeof(ack));
+		item->len = sizeof(ack);
+		if (ioctl(w->fd, IOCTL_CCD_WORKER_WRITE, item) < 0) {
+			perror("IOCTL_CCD_WORKER_WRITE");
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [-c caps] [-l latency_us] [-f fail_every] [-d drop_every]\n",
+		name);
+}
+
+int main(int argc, char **argv)
+{
+	static struct mock_ccd_worker workers[MTK_CAM_MOCK_CCD_WORKERS];
+	struct mtk_cam_mock_ccd_cfg cfg = {
+		.caps = MTK_CAM_IPI_CAP_FRAME_TLV,
+	};
+	struct ccd_master_status_item status = { 0 };
+	pthread_t master;
+	sigset_t set;
+	int fd, opt, sig, i;
+
+	while ((opt = getopt(argc, argv, "c:l:f:d:h")) != -1) {
+		switch (opt) {
+		case 'c':
+			cfg.caps = strtoul(optarg, NULL, 0);
+			break;
+		case 'l':
+			cfg.latency_us = strtoul(optarg, NULL, 0);
+			break;
+		case 'f':
+			cfg.fail_every = strtoul(optarg, NULL, 0);
+			break;
+		case 'd':
+			cfg.drop_every = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	fd = open(MOCK_CCD_DEV, O_RDWR);
+	if (fd < 0) {
+		perror(MOCK_CCD_DEV);
+		return EXIT_FAILURE;
+	}
+
+	if (ioctl(fd, IOCTL_CCD_MASTER_INIT, &status) < 0) {
+		perror("IOCTL_CCD_MASTER_INIT");
+		close(fd);
+		return EXIT_FAILURE;
+	}
+
+	/* signals are only taken by sigwait() below */
+	sigemptyset(&set);
+	sigaddset(&set, SIGINT);
+	sigaddset(&set, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+	pthread_create(&master, NULL, mock_ccd_master, &fd);
+	for (i = 0; i < MTK_CAM_MOCK_CCD_WORKERS; i++) {
+		struct mock_ccd_worker *w = &workers[i];
+
+		w->fd = fd;
+		w->src = CCD_IPI_ISP_MAIN + i;
+		w->m.cfg = cfg;
+		pthread_create(&w->thread, NULL, mock_ccd_work, w);
+	}
+
+	printf("mock composer: caps 0x%x, latency %u us, fail every %u, drop every %u\n",
+	       cfg.caps, cfg.latency_us, cfg.fail_every, cfg.drop_every);
+
+	sigwait(&set, &sig);
+
+	for (i = 0; i < MTK_CAM_MOCK_CCD_WORKERS; i++) {
+		struct mtk_cam_mock_ccd_stats *s = &workers[i].m.stats;
+
+		printf("mock composer %u: session %u config %u frame %u (tlv %u failed %u dropped %u) destroy %u unknown %u\n",
+		       workers[i].src, s->sessions, s->configs, s->frames,
+		       s->tlv_frames, s->failed, s->dropped, s->destroyed,
+		       s->unknown);
+	}
+
+	/* the threads are blocked in the driver, closing the ccd ends them */
+	close(fd);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,222 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Copyright (c) 2022 MediaTek Inc.
+ */
+
+#ifndef __MTK_CAM_CTRL_STATE_H
+#define __MTK_CAM_CTRL_STATE_H
+
+/*
+ * Camsys request states in flight, see mtk_cam-ctrl.c.
+ *
+ * The states queued on camsys_state_list are also indexed by frame
+ * sequence number in a ring, so SOF and frame done find the few frames
+ * they look at without walking the list. A state whose slot is taken by
+ * another one is left unindexed, the list is walked again until it is
+ * dequeued.
+ *
+ * The moves done on the hardware events are kept in one transition table
+ * per feature mode. The ones depending on more than the state and the
+ * event, such as the sensor and CQ applying, stay in mtk_cam-ctrl.c.
+ *
+ * Built on the host as well, see ctrl-state-ut-test.
+ */
+
+#ifdef __KERNEL__
+#include <linux/string.h>
+#include <linux/types.h>
+#else
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <linux/types.h>
+#endif
+
+/*For state analysis and controlling for request*/
+enum MTK_CAMSYS_STATE_IDX {
+	E_STATE_READY = 0x0,
+	E_STATE_SENINF,
+	E_STATE_SENSOR,
+	E_STATE_CQ,
+	E_STATE_OUTER,
+	E_STATE_CAMMUX_OUTER_CFG,
+	E_STATE_CAMMUX_OUTER,
+	E_STATE_INNER,
+	E_STATE_DONE_NORMAL,
+	E_STATE_CQ_SCQ_DELAY,
+	E_STATE_CAMMUX_OUTER_CFG_DELAY,
+	E_STATE_OUTER_HW_DELAY,
+	E_STATE_INNER_HW_DELAY,
+	E_STATE_DONE_MISMATCH,
+	E_STATE_SUBSPL_READY = 0x10,
+	E_STATE_SUBSPL_SCQ,
+	E_STATE_SUBSPL_OUTER,
+	E_STATE_SUBSPL_SENSOR,
+	E_STATE_SUBSPL_INNER,
+	E_STATE_SUBSPL_DONE_NORMAL,
+	E_STATE_SUBSPL_SCQ_DELAY,
+	E_STATE_TS_READY = 0x20,
+	E_STATE_TS_SENSOR,
+	E_STATE_TS_SV,
+	E_STATE_TS_MEM,
+	E_STATE_TS_CQ,
+	E_STATE_TS_INNER,
+	E_STATE_TS_DONE_NORMAL,
+};
+
+enum mtk_camsys_state_mode {
+	MTK_CAMSYS_STATE_MODE_NORMAL,
+	MTK_CAMSYS_STATE_MODE_SUBSPL,
+	MTK_CAMSYS_STATE_MODE_TS,
+	MTK_CAMSYS_STATE_MODE_NUM,
+};
+
+enum mtk_camsys_state_event {
+	/* CQ of the frame applied, it is in the outer registers */
+	MTK_CAMSYS_EVENT_CQ_DONE,
+	/* outer registers loaded, the frame is the inner one */
+	MTK_CAMSYS_EVENT_DBLOAD,
+	/* SOF while the inner frame is not done */
+	MTK_CAMSYS_EVENT_HW_DELAY,
+	MTK_CAMSYS_EVENT_FRAME_DONE,
+	MTK_CAMSYS_EVENT_NUM,
+};
+
+struct mtk_camsys_state_trans {
+	__u8 from;
+	__u8 event;
+	__u8 to;
+};
+
+/* the state after @event, @estate when the mode does not move on it */
+static inline enum MTK_CAMSYS_STATE_IDX
+mtk_camsys_state_next(enum mtk_camsys_state_mode mode,
+		      enum MTK_CAMSYS_STATE_IDX estate,
+		      enum mtk_camsys_state_event event)
+{
+	static const struct mtk_camsys_state_trans normal[] = {
+		{ E_STATE_SENINF, MTK_CAMSYS_EVENT_CQ_DONE, E_STATE_OUTER },
+		{ E_STATE_CQ, MTK_CAMSYS_EVENT_CQ_DONE, E_STATE_OUTER },
+		{ E_STATE_CQ_SCQ_DELAY, MTK_CAMSYS_EVENT_CQ_DONE, E_STATE_OUTER },
+		{ E_STATE_OUTER, MTK_CAMSYS_EVENT_DBLOAD, E_STATE_INNER },
+		{ E_STATE_CAMMUX_OUTER, MTK_CAMSYS_EVENT_DBLOAD, E_STATE_INNER },
+		{ E_STATE_OUTER_HW_DELAY, MTK_CAMSYS_EVENT_DBLOAD,
+		  E_STATE_INNER_HW_DELAY },
+		{ E_STATE_INNER, MTK_CAMSYS_EVENT_HW_DELAY, E_STATE_INNER_HW_DELAY },
+		{ E_STATE_OUTER, MTK_CAMSYS_EVENT_HW_DELAY, E_STATE_OUTER_HW_DELAY },
+		{ E_STATE_CAMMUX_OUTER, MTK_CAMSYS_EVENT_HW_DELAY,
+		  E_STATE_OUTER_HW_DELAY },
+		{ E_STATE_INNER, MTK_CAMSYS_EVENT_FRAME_DONE, E_STATE_DONE_NORMAL },
+		{ E_STATE_INNER_HW_DELAY, MTK_CAMSYS_EVENT_FRAME_DONE,
+		  E_STATE_DONE_MISMATCH },
+	};
+	static const struct mtk_camsys_state_trans subspl[] = {
+		{ E_STATE_SUBSPL_SCQ, MTK_CAMSYS_EVENT_CQ_DONE,
+		  E_STATE_SUBSPL_OUTER },
+		{ E_STATE_SUBSPL_SCQ_DELAY, MTK_CAMSYS_EVENT_CQ_DONE,
+		  E_STATE_SUBSPL_OUTER },
+		{ E_STATE_SUBSPL_SENSOR, MTK_CAMSYS_EVENT_DBLOAD,
+		  E_STATE_SUBSPL_INNER },
+		{ E_STATE_SUBSPL_INNER, MTK_CAMSYS_EVENT_FRAME_DONE,
+		  E_STATE_SUBSPL_DONE_NORMAL },
+	};
+	static const struct mtk_camsys_state_trans ts[] = {
+		/* the raw is triggered by software on the CQ done */
+		{ E_STATE_TS_CQ, MTK_CAMSYS_EVENT_CQ_DONE, E_STATE_TS_INNER },
+		{ E_STATE_TS_INNER, MTK_CAMSYS_EVENT_FRAME_DONE,
+		  E_STATE_TS_DONE_NORMAL },
+	};
+	const struct mtk_camsys_state_trans *trans;
+	unsigned int i, n;
+
+	switch (mode) {
+	case MTK_CAMSYS_STATE_MODE_SUBSPL:
+		trans = subspl;
+		n = sizeof(subspl) / sizeof(subspl[0]);
+		break;
+	case MTK_CAMSYS_STATE_MODE_TS:
+		trans = ts;
+		n = sizeof(ts) / sizeof(ts[0]);
+		break;
+	default:
+		trans = normal;
+		n = sizeof(normal) / sizeof(normal[0]);
+		break;
+	}
+
+	for (i = 0; i < n; i++)
+		if (trans[i].from == estate && trans[i].event == event)
+			return trans[i].to;
+
+	return estate;
+}
+
+/* a power of 2, larger than the frames in flight */
+#define MTK_CAMSYS_STATE_RING_SIZE	8
+
+struct mtk_camsys_ctrl_state;
+
+struct mtk_camsys_state_ring {
+	struct mtk_camsys_ctrl_state *state[MTK_CAMSYS_STATE_RING_SIZE];
+	unsigned int seq[MTK_CAMSYS_STATE_RING_SIZE];
+	unsigned int cnt;	/* states queued */
+	unsigned int unindexed;	/* states queued without a slot */
+};
+
+static inline void mtk_camsys_state_ring_reset(struct mtk_camsys_state_ring *ring)
+{
+	memset(ring, 0, sizeof(*ring));
+}
+
+static inline void mtk_camsys_state_ring_add(struct mtk_camsys_state_ring *ring,
+					     struct mtk_camsys_ctrl_state *state,
+					     unsigned int seq)
+{
+	unsigned int i = seq & (MTK_CAMSYS_STATE_RING_SIZE - 1);
+
+	ring->cnt++;
+	if (ring->state[i]) {
+		ring->unindexed++;
+		return;
+	}
+
+	ring->state[i] = state;
+	ring->seq[i] = seq;
+}
+
+/* false when @state has no slot, it may still be an unindexed one */
+static inline bool mtk_camsys_state_ring_del(struct mtk_camsys_state_ring *ring,
+					     struct mtk_camsys_ctrl_state *state)
+{
+	unsigned int i;
+
+	for (i = 0; i < MTK_CAMSYS_STATE_RING_SIZE; i++) {
+		if (ring->state[i] == state) {
+			ring->state[i] = NULL;
+			ring->cnt--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* an unindexed state is dequeued, see mtk_camsys_state_ring_del() */
+static inline void mtk_camsys_state_ring_del_unindexed(struct mtk_camsys_state_ring *ring)
+{
+	ring->cnt--;
+	ring->unindexed--;
+}
+
+static inline struct mtk_camsys_ctrl_state *
+mtk_camsys_state_ring_find(const struct mtk_camsys_state_ring *ring, int seq)
+{
+	unsigned int i = (unsigned int)seq & (MTK_CAMSYS_STATE_RING_SIZE - 1);
+
+	if (seq < 0 || !ring->state[i] || ring->seq[i] != (unsigned int)seq)
+		return NULL;
+
+	return ring->state[i];
+}
+
+#endif /* __MTK_CAM_CTRL_STATE_H */
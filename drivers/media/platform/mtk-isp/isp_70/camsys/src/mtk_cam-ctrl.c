@@ -60,6 +60,98 @@ void state_transition(struct mtk_camsys_ctrl_state *state_entry,
 		state_entry->estate = to;
 }
 
+static void state_event(struct mtk_camsys_ctrl_state *state_entry,
+			enum mtk_camsys_state_mode mode,
+			enum mtk_camsys_state_event event)
+{
+	state_entry->estate = mtk_camsys_state_next(mode, state_entry->estate,
+						    event);
+}
+
+static enum mtk_camsys_state_mode mtk_camsys_state_mode(struct mtk_cam_ctx *ctx)
+{
+	if (mtk_cam_is_subsample(ctx))
+		return MTK_CAMSYS_STATE_MODE_SUBSPL;
+	if (mtk_cam_is_time_shared(ctx))
+		return MTK_CAMSYS_STATE_MODE_TS;
+
+	return MTK_CAMSYS_STATE_MODE_NORMAL;
+}
+
+/* the camsys_state_lock is held by the callers of the state queue */
+static void mtk_camsys_state_enq(struct mtk_camsys_sensor_ctrl *sensor_ctrl,
+				 struct mtk_cam_request_stream_data *s_data)
+{
+	list_add_tail(&s_data->state.state_element,
+		      &sensor_ctrl->camsys_state_list);
+	mtk_camsys_state_ring_add(&sensor_ctrl->state_ring, &s_data->state,
+				  s_data->frame_seq_no);
+}
+
+static bool mtk_camsys_state_deq(struct mtk_camsys_sensor_ctrl *sensor_ctrl,
+				 struct mtk_camsys_ctrl_state *state)
+{
+	struct mtk_camsys_ctrl_state *state_entry;
+	bool found = false;
+
+	if (!mtk_camsys_state_ring_del(&sensor_ctrl->state_ring, state)) {
+		if (!sensor_ctrl->state_ring.unindexed)
+			return false;
+
+		list_for_each_entry(state_entry, &sensor_ctrl->camsys_state_list,
+				    state_element) {
+			if (state_entry == state) {
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+			return false;
+
+		mtk_camsys_state_ring_del_unindexed(&sensor_ctrl->state_ring);
+	}
+	list_del(&state->state_element);
+
+	return true;
+}
+
+static struct mtk_camsys_ctrl_state *
+mtk_camsys_state_find(struct mtk_camsys_sensor_ctrl *sensor_ctrl, int seq)
+{
+	struct mtk_camsys_ctrl_state *state_entry;
+	struct mtk_cam_request_stream_data *s_data;
+
+	state_entry = mtk_camsys_state_ring_find(&sensor_ctrl->state_ring, seq);
+	if (state_entry || !sensor_ctrl->state_ring.unindexed)
+		return state_entry;
+
+	list_for_each_entry(state_entry, &sensor_ctrl->camsys_state_list,
+			    state_element) {
+		s_data = mtk_cam_ctrl_state_to_req_s_data(state_entry);
+		if (s_data->frame_seq_no == seq)
+			return state_entry;
+	}
+
+	return NULL;
+}
+
+/*
+ * Fill state_rec[N] with the state of frame seq - N, N below
+ * STATE_NUM_AT_SOF, and return the number of states queued.
+ */
+static int mtk_camsys_state_window(struct mtk_camsys_sensor_ctrl *sensor_ctrl,
+				   int seq,
+				   struct mtk_camsys_ctrl_state **state_rec)
+{
+	int stateidx;
+
+	for (stateidx = 0; stateidx < STATE_NUM_AT_SOF; stateidx++)
+		state_rec[stateidx] = mtk_camsys_state_find(sensor_ctrl,
+							    seq - stateidx);
+
+	return sensor_ctrl->state_ring.cnt;
+}
+
 static void mtk_cam_event_eos(struct mtk_raw_pipeline *pipeline)
 {
 	struct v4l2_event event = {
@@ -1150,8 +1242,7 @@ static void mtk_cam_subspl_req_prepare(struct mtk_camsys_sensor_ctrl *sensor_ctr
 
 			/* EnQ this request's state element to state_list (STATE:READY) */
 			spin_lock(&sensor_ctrl->camsys_state_lock);
-			list_add_tail(&data->state.state_element,
-				      &sensor_ctrl->camsys_state_list);
+			mtk_camsys_state_enq(sensor_ctrl, data);
 			state_transition(&data->state,
 					 E_STATE_READY, E_STATE_SUBSPL_READY);
 			spin_unlock(&sensor_ctrl->camsys_state_lock);
@@ -1222,6 +1313,52 @@ static void mtk_cam_set_sensor_subspl(struct mtk_cam_request_stream_data *data,
 	mtk_cam_complete_sensor_hdl(data);
 }
 
+/*
+ * The sensor may apply its AE controls from its own worker (imgsensor
+ * ae_async) after v4l2_ctrl_request_setup() returns. What was staged for
+ * the previous frame must have reached the sensor before the SOF that
+ * triggered this one.
+ */
+static void mtk_cam_check_sensor_ae_commit(struct mtk_cam_ctx *ctx,
+					   struct v4l2_subdev *sensor,
+					   unsigned int frame_seq_no)
+{
+	struct mtk_camsys_sensor_ctrl *sensor_ctrl = &ctx->sensor_ctrl;
+	struct mtk_ae_commit info;
+	u64 sof_ns = sensor_ctrl->sof_time * 1000000;
+
+	if (v4l2_subdev_call(sensor, core, ioctl,
+			     VIDIOC_MTK_G_AE_COMMIT, &info))
+		return;
+
+	if (sensor_ctrl->ae_commit_seq &&
+	    (info.done_seq < sensor_ctrl->ae_commit_seq ||
+	     info.done_ns > sof_ns)) {
+		sensor_ctrl->ae_commit_late++;
+		dev_info_ratelimited(ctx->cam->dev,
+			"%s:ctx(%d) req(%d): AE %u/%u late, queued SOF%+lldus done SOF%+lldus msgs:%u/%u late:%u\n",
+			__func__, ctx->stream_id, frame_seq_no,
+			info.done_seq, info.seq,
+			((s64)info.queue_ns - (s64)sof_ns) / 1000,
+			info.done_seq < sensor_ctrl->ae_commit_seq ? 0 :
+			((s64)info.done_ns - (s64)sof_ns) / 1000,
+			info.n_msgs, info.n_xfers,
+			sensor_ctrl->ae_commit_late);
+	}
+	sensor_ctrl->ae_commit_seq = 0;
+}
+
+static void mtk_cam_record_sensor_ae_commit(struct mtk_cam_ctx *ctx,
+					    struct v4l2_subdev *sensor)
+{
+	struct mtk_ae_commit info;
+
+	if (!v4l2_subdev_call(sensor, core, ioctl,
+			      VIDIOC_MTK_G_AE_COMMIT, &info) &&
+	    info.seq != info.done_seq)
+		ctx->sensor_ctrl.ae_commit_seq = info.seq;
+}
+
 void mtk_cam_set_sensor_full(struct mtk_cam_request_stream_data *s_data,
 			     struct mtk_camsys_sensor_ctrl *sensor_ctrl)
 {
@@ -1234,8 +1371,7 @@ void mtk_cam_set_sensor_full(struct mtk_cam_request_stream_data *s_data,
 
 	/* EnQ this request's state element to state_list (STATE:READY) */
 	spin_lock(&sensor_ctrl->camsys_state_lock);
-	list_add_tail(&s_data->state.state_element,
-		      &sensor_ctrl->camsys_state_list);
+	mtk_camsys_state_enq(sensor_ctrl, s_data);
 	atomic_set(&sensor_ctrl->sensor_request_seq_no, s_data->frame_seq_no);
 	spin_unlock(&sensor_ctrl->camsys_state_lock);
 
@@ -1278,8 +1414,11 @@ void mtk_cam_set_sensor_full(struct mtk_cam_request_stream_data *s_data,
 	 */
 	if (!mtk_cam_is_m2m(ctx) && !is_mstream_last_exposure) {
 		if (s_data->flags & MTK_CAM_REQ_S_DATA_FLAG_SENSOR_HDL_EN) {
+			mtk_cam_check_sensor_ae_commit(ctx, s_data->sensor,
+						       s_data->frame_seq_no);
 			v4l2_ctrl_request_setup(&req->req,
 						s_data->sensor->ctrl_handler);
+			mtk_cam_record_sensor_ae_commit(ctx, s_data->sensor);
 			time_after_sof =
 				ktime_get_boottime_ns() / 1000000 - ctx->sensor_ctrl.sof_time;
 			dev_dbg(cam->dev,
@@ -1390,43 +1529,42 @@ static void mtk_cam_try_set_sensor(struct mtk_cam_ctx *ctx)
 	}
 	spin_lock(&sensor_ctrl->camsys_state_lock);
 	/* Check if previous state was without cq done */
-	list_for_each_entry(state_entry, &sensor_ctrl->camsys_state_list,
-			    state_element) {
+	state_entry = mtk_camsys_state_find(sensor_ctrl,
+			atomic_read(&sensor_ctrl->sensor_request_seq_no) - 1);
+	if (state_entry && state_entry->estate < E_STATE_INNER) {
 		req_stream_data = mtk_cam_ctrl_state_to_req_s_data(state_entry);
-		if (req_stream_data->frame_seq_no ==
-			atomic_read(&sensor_ctrl->sensor_request_seq_no)) {
-			if (state_entry->estate == E_STATE_CQ && USINGSCQ &&
-			    req_stream_data->frame_seq_no > INITIAL_DROP_FRAME_CNT &&
-			    !mtk_cam_is_stagger(ctx)) {
-				state_entry->estate = E_STATE_CQ_SCQ_DELAY;
-				spin_unlock(&sensor_ctrl->camsys_state_lock);
-				dev_dbg(ctx->cam->dev,
-					 "[%s] SCQ DELAY STATE at SOF+%dms\n", __func__,
-					 time_after_sof);
-				return;
-			} else if (state_entry->estate == E_STATE_CAMMUX_OUTER_CFG) {
-				state_entry->estate = E_STATE_CAMMUX_OUTER_CFG_DELAY;
-				dev_dbg(ctx->cam->dev,
-					"[%s] CAMMUX OUTTER CFG DELAY STATE\n", __func__);
-				spin_unlock(&sensor_ctrl->camsys_state_lock);
-				return;
+		spin_unlock(&sensor_ctrl->camsys_state_lock);
+		dev_dbg(ctx->cam->dev,
+			 "[%s] req:%d isn't arrive inner at SOF+%dms\n",
+			 __func__, req_stream_data->frame_seq_no, time_after_sof);
+		return;
+	}
+	state_entry = mtk_camsys_state_find(sensor_ctrl,
+			atomic_read(&sensor_ctrl->sensor_request_seq_no));
+	if (state_entry) {
+		req_stream_data = mtk_cam_ctrl_state_to_req_s_data(state_entry);
+		if (state_entry->estate == E_STATE_CQ && USINGSCQ &&
+		    req_stream_data->frame_seq_no > INITIAL_DROP_FRAME_CNT &&
+		    !mtk_cam_is_stagger(ctx)) {
+			state_entry->estate = E_STATE_CQ_SCQ_DELAY;
+			spin_unlock(&sensor_ctrl->camsys_state_lock);
+			dev_dbg(ctx->cam->dev,
+				 "[%s] SCQ DELAY STATE at SOF+%dms\n", __func__,
+				 time_after_sof);
+			return;
+		} else if (state_entry->estate == E_STATE_CAMMUX_OUTER_CFG) {
+			state_entry->estate = E_STATE_CAMMUX_OUTER_CFG_DELAY;
+			dev_dbg(ctx->cam->dev,
+				"[%s] CAMMUX OUTTER CFG DELAY STATE\n", __func__);
+			spin_unlock(&sensor_ctrl->camsys_state_lock);
+			return;
 
-			} else if (state_entry->estate <= E_STATE_SENSOR) {
-				spin_unlock(&sensor_ctrl->camsys_state_lock);
-				dev_dbg(ctx->cam->dev,
-					 "[%s] wrong state:%d (sensor workqueue delay)\n",
-					 __func__, state_entry->estate);
-				return;
-			}
-		} else if (req_stream_data->frame_seq_no ==
-			atomic_read(&sensor_ctrl->sensor_request_seq_no) - 1) {
-			if (state_entry->estate < E_STATE_INNER) {
-				spin_unlock(&sensor_ctrl->camsys_state_lock);
-				dev_dbg(ctx->cam->dev,
-					 "[%s] req:%d isn't arrive inner at SOF+%dms\n",
-					 __func__, req_stream_data->frame_seq_no, time_after_sof);
-				return;
-			}
+		} else if (state_entry->estate <= E_STATE_SENSOR) {
+			spin_unlock(&sensor_ctrl->camsys_state_lock);
+			dev_dbg(ctx->cam->dev,
+				 "[%s] wrong state:%d (sensor workqueue delay)\n",
+				 __func__, state_entry->estate);
+			return;
 		}
 	}
 	spin_unlock(&sensor_ctrl->camsys_state_lock);
@@ -1647,32 +1785,30 @@ static int mtk_camsys_raw_subspl_state_handle(struct mtk_raw_device *raw_dev,
 	mtk_cam_subspl_req_prepare(sensor_ctrl);
 	/* List state-queue status*/
 	spin_lock(&sensor_ctrl->camsys_state_lock);
-	list_for_each_entry(state_temp, &sensor_ctrl->camsys_state_list,
-			    state_element) {
+	que_cnt = mtk_camsys_state_window(sensor_ctrl,
+			atomic_read(&sensor_ctrl->isp_enq_seq_no) + 1, state_rec);
+	/* the newest frame wins */
+	for (stateidx = STATE_NUM_AT_SOF - 1; stateidx >= 0; stateidx--) {
+		state_temp = state_rec[stateidx];
+		if (!state_temp)
+			continue;
 		req = mtk_cam_ctrl_state_get_req(state_temp);
 		req_stream_data = mtk_cam_req_get_s_data(req, ctx->stream_id, 0);
-		stateidx = atomic_read(&sensor_ctrl->isp_enq_seq_no) + 1 -
-			   req_stream_data->frame_seq_no;
-		if (stateidx < STATE_NUM_AT_SOF && stateidx > -1) {
-			state_rec[stateidx] = state_temp;
-			/* Find outer state element */
-			if (state_temp->estate == E_STATE_SUBSPL_SENSOR ||
-				state_temp->estate == E_STATE_SUBSPL_OUTER) {
-				state_outer = state_temp;
-				mtk_cam_set_timestamp(req_stream_data,
-						      time_boot, time_mono);
-			}
-			if (state_temp->estate == E_STATE_SUBSPL_READY ||
-				state_temp->estate == E_STATE_SUBSPL_SCQ_DELAY) {
-				state_ready = state_temp;
-			}
-			dev_dbg(raw_dev->dev,
-			"[SOF-subsample] STATE_CHECK [N-%d] Req:%d / State:0x%x\n",
-			stateidx, req_stream_data->frame_seq_no,
-			state_rec[stateidx]->estate);
+		/* Find outer state element */
+		if (state_temp->estate == E_STATE_SUBSPL_SENSOR ||
+			state_temp->estate == E_STATE_SUBSPL_OUTER) {
+			state_outer = state_temp;
+			mtk_cam_set_timestamp(req_stream_data,
+					      time_boot, time_mono);
 		}
-		/* counter for state queue*/
-		que_cnt++;
+		if (state_temp->estate == E_STATE_SUBSPL_READY ||
+			state_temp->estate == E_STATE_SUBSPL_SCQ_DELAY) {
+			state_ready = state_temp;
+		}
+		dev_dbg(raw_dev->dev,
+		"[SOF-subsample] STATE_CHECK [N-%d] Req:%d / State:0x%x\n",
+		stateidx, req_stream_data->frame_seq_no,
+		state_rec[stateidx]->estate);
 	}
 	spin_unlock(&sensor_ctrl->camsys_state_lock);
 	/* HW imcomplete case */
@@ -1705,8 +1841,8 @@ static int mtk_camsys_raw_subspl_state_handle(struct mtk_raw_device *raw_dev,
 						sensor_ctrl->sensorsetting_wq, sensor_ctrl);
 					dev_dbg(raw_dev->dev, "sensor delay to SOF\n");
 				}
-				state_transition(state_outer, E_STATE_SUBSPL_SENSOR,
-						 E_STATE_SUBSPL_INNER);
+				state_event(state_outer, MTK_CAMSYS_STATE_MODE_SUBSPL,
+					    MTK_CAMSYS_EVENT_DBLOAD);
 				atomic_set(&sensor_ctrl->isp_request_seq_no, frame_idx_inner);
 				dev_dbg(raw_dev->dev,
 					"[SOF-subsample] frame_seq_no:%d, SENSOR/OUTER->INNER state:0x%x\n",
@@ -1762,35 +1898,33 @@ static int mtk_camsys_raw_state_handle(struct mtk_raw_device *raw_dev,
 
 	/* List state-queue status*/
 	spin_lock(&sensor_ctrl->camsys_state_lock);
-	list_for_each_entry(state_temp, &sensor_ctrl->camsys_state_list,
-			    state_element) {
+	que_cnt = mtk_camsys_state_window(sensor_ctrl,
+			atomic_read(&sensor_ctrl->sensor_request_seq_no), state_rec);
+	/* the newest frame wins */
+	for (stateidx = STATE_NUM_AT_SOF - 1; stateidx >= 0; stateidx--) {
+		state_temp = state_rec[stateidx];
+		if (!state_temp)
+			continue;
 		req_stream_data = mtk_cam_ctrl_state_to_req_s_data(state_temp);
-		stateidx = atomic_read(&sensor_ctrl->sensor_request_seq_no) -
-			   req_stream_data->frame_seq_no;
-		if (stateidx < STATE_NUM_AT_SOF && stateidx > -1) {
-			state_rec[stateidx] = state_temp;
-			if (stateidx == 0)
-				working_req_found = 1;
-			/* Find outer state element */
-			if (state_temp->estate == E_STATE_OUTER ||
-				state_temp->estate == E_STATE_CAMMUX_OUTER ||
-			    state_temp->estate == E_STATE_OUTER_HW_DELAY) {
-				state_outer = state_temp;
-				mtk_cam_set_timestamp(req_stream_data,
-						      time_boot, time_mono);
-			}
-			/* Find inner state element request*/
-			if (state_temp->estate == E_STATE_INNER ||
-			    state_temp->estate == E_STATE_INNER_HW_DELAY) {
-				state_inner = state_temp;
-			}
-			dev_dbg(raw_dev->dev,
-			"[SOF] STATE_CHECK [N-%d] Req:%d / State:%d\n",
-			stateidx, req_stream_data->frame_seq_no,
-			state_rec[stateidx]->estate);
+		if (stateidx == 0)
+			working_req_found = 1;
+		/* Find outer state element */
+		if (state_temp->estate == E_STATE_OUTER ||
+			state_temp->estate == E_STATE_CAMMUX_OUTER ||
+		    state_temp->estate == E_STATE_OUTER_HW_DELAY) {
+			state_outer = state_temp;
+			mtk_cam_set_timestamp(req_stream_data,
+					      time_boot, time_mono);
 		}
-		/* counter for state queue*/
-		que_cnt++;
+		/* Find inner state element request*/
+		if (state_temp->estate == E_STATE_INNER ||
+		    state_temp->estate == E_STATE_INNER_HW_DELAY) {
+			state_inner = state_temp;
+		}
+		dev_dbg(raw_dev->dev,
+		"[SOF] STATE_CHECK [N-%d] Req:%d / State:%d\n",
+		stateidx, req_stream_data->frame_seq_no,
+		state_rec[stateidx]->estate);
 	}
 	spin_unlock(&sensor_ctrl->camsys_state_lock);
 	/* HW imcomplete case */
@@ -1819,14 +1953,11 @@ static int mtk_camsys_raw_state_handle(struct mtk_raw_device *raw_dev,
 						      time_boot - 1000, time_mono - 1000);
 			mtk_camsys_frame_done(ctx, write_cnt + 1, ctx->stream_id);
 		} else {
-			state_transition(state_inner, E_STATE_INNER,
-				 E_STATE_INNER_HW_DELAY);
-			if (state_outer) {
-				state_transition(state_outer, E_STATE_OUTER,
-				 E_STATE_OUTER_HW_DELAY);
-				state_transition(state_outer, E_STATE_CAMMUX_OUTER,
-				 E_STATE_OUTER_HW_DELAY);
-			}
+			state_event(state_inner, MTK_CAMSYS_STATE_MODE_NORMAL,
+				    MTK_CAMSYS_EVENT_HW_DELAY);
+			if (state_outer)
+				state_event(state_outer, MTK_CAMSYS_STATE_MODE_NORMAL,
+					    MTK_CAMSYS_EVENT_HW_DELAY);
 			dev_info_ratelimited(raw_dev->dev,
 				"[SOF] HW_IMCOMPLETE state cnt(%d,%d),req(%d),ts(%llu)\n",
 				write_cnt, irq_info->write_cnt, req_stream_data->frame_seq_no,
@@ -1850,13 +1981,8 @@ static int mtk_camsys_raw_state_handle(struct mtk_raw_device *raw_dev,
 		if (atomic_read(&sensor_ctrl->initial_drop_frame_cnt) == 0 &&
 			req_stream_data->frame_seq_no == frame_idx_inner) {
 			if (frame_idx_inner > atomic_read(&sensor_ctrl->isp_request_seq_no)) {
-				state_transition(state_outer,
-						 E_STATE_OUTER_HW_DELAY,
-						 E_STATE_INNER_HW_DELAY);
-				state_transition(state_outer, E_STATE_OUTER,
-						 E_STATE_INNER);
-				state_transition(state_outer, E_STATE_CAMMUX_OUTER,
-						 E_STATE_INNER);
+				state_event(state_outer, MTK_CAMSYS_STATE_MODE_NORMAL,
+					    MTK_CAMSYS_EVENT_DBLOAD);
 				atomic_set(&sensor_ctrl->isp_request_seq_no, frame_idx_inner);
 				dev_dbg(raw_dev->dev,
 					"[SOF-DBLOAD] frame_seq_no:%d, OUTER->INNER state:%d,ts:%llu\n",
@@ -2062,25 +2188,22 @@ static int mtk_camsys_ts_state_handle(
 
 	/* List state-queue status*/
 	spin_lock(&sensor_ctrl->camsys_state_lock);
-	list_for_each_entry(state_temp, &sensor_ctrl->camsys_state_list,
-			    state_element) {
+	que_cnt = mtk_camsys_state_window(sensor_ctrl,
+			atomic_read(&sensor_ctrl->sensor_request_seq_no), state_rec);
+	for (stateidx = STATE_NUM_AT_SOF - 1; stateidx >= 0; stateidx--) {
+		state_temp = state_rec[stateidx];
+		if (!state_temp)
+			continue;
 		req = mtk_cam_ctrl_state_get_req(state_temp);
 		req_stream_data = mtk_cam_req_get_s_data(req, ctx->stream_id, 0);
-		stateidx = atomic_read(&sensor_ctrl->sensor_request_seq_no) -
-			   req_stream_data->frame_seq_no;
-		if (stateidx < STATE_NUM_AT_SOF && stateidx > -1) {
-			state_rec[stateidx] = state_temp;
-			if (state_temp->estate == E_STATE_TS_SV) {
-				req_stream_data->timestamp = time_boot;
-				req_stream_data->timestamp_mono = time_mono;
-			}
-			dev_dbg(ctx->cam->dev,
-			"[TS-SOF] ctx:%d STATE_CHECK [N-%d] Req:%d / State:0x%x\n",
-			ctx->stream_id, stateidx, req_stream_data->frame_seq_no,
-			state_rec[stateidx]->estate);
+		if (state_temp->estate == E_STATE_TS_SV) {
+			req_stream_data->timestamp = time_boot;
+			req_stream_data->timestamp_mono = time_mono;
 		}
-		/* counter for state queue*/
-		que_cnt++;
+		dev_dbg(ctx->cam->dev,
+		"[TS-SOF] ctx:%d STATE_CHECK [N-%d] Req:%d / State:0x%x\n",
+		ctx->stream_id, stateidx, req_stream_data->frame_seq_no,
+		state_rec[stateidx]->estate);
 	}
 	spin_unlock(&sensor_ctrl->camsys_state_lock);
 	if (que_cnt > 0 && state_rec[0]) {
@@ -2462,6 +2585,8 @@ static void mtk_camsys_raw_frame_start(struct mtk_raw_device *raw_dev,
 	/* inner register dequeue number */
 	if (!mtk_cam_is_stagger(ctx))
 		ctx->dequeued_frame_seq_no = dequeued_frame_seq_no;
+	mtk_cam_virt_stamp(&ctx->virt, dequeued_frame_seq_no,
+			   MTK_CAM_VIRT_SOF);
 	/* Send V4L2_EVENT_FRAME_SYNC event */
 	if (mtk_cam_is_mstream(ctx) || ctx->next_sof_mask_frame_seq_no != 0) {
 		mtk_cam_mstream_frame_sync(raw_dev, ctx, dequeued_frame_seq_no);
@@ -2710,10 +2835,10 @@ static int mtk_cam_hdr_last_frame_start(struct mtk_raw_device *raw_dev,
 	struct mtk_camsys_ctrl_state *state_temp;
 	struct mtk_camsys_ctrl_state *state_switch = NULL;
 	struct mtk_camsys_ctrl_state *state_sensor = NULL;
+	struct mtk_camsys_ctrl_state *state_rec[STATE_NUM_AT_SOF];
 	struct mtk_cam_request *req;
 	struct mtk_cam_request_stream_data *req_stream_data;
 	int stateidx;
-	int que_cnt = 0;
 #ifdef ISP7_1
 	struct mtk_camsys_ctrl_state *state_cq = NULL;
 #endif
@@ -2722,36 +2847,34 @@ static int mtk_cam_hdr_last_frame_start(struct mtk_raw_device *raw_dev,
 
 	/* List state-queue status*/
 	spin_lock(&sensor_ctrl->camsys_state_lock);
-	list_for_each_entry(state_temp, &sensor_ctrl->camsys_state_list,
-			    state_element) {
+	mtk_camsys_state_window(sensor_ctrl,
+			atomic_read(&sensor_ctrl->sensor_request_seq_no), state_rec);
+	/* the newest frame wins */
+	for (stateidx = STATE_NUM_AT_SOF - 1; stateidx >= 0; stateidx--) {
+		state_temp = state_rec[stateidx];
+		if (!state_temp)
+			continue;
 		req = mtk_cam_ctrl_state_get_req(state_temp);
 		req_stream_data = mtk_cam_req_get_s_data(req, ctx->stream_id, 0);
 
-		stateidx = atomic_read(&sensor_ctrl->sensor_request_seq_no) -
-			req_stream_data->frame_seq_no;
-
-		if (stateidx < STATE_NUM_AT_SOF && stateidx > -1) {
-			/* Find sensor element for last sof cq*/
-			if (state_temp->estate == E_STATE_SENSOR)
-				state_sensor = state_temp;
-			/*Find switch element*/
-			if (mtk_cam_hdr_last_frame_switch_check(state_temp,
-				req_stream_data)) {
-				state_switch = state_temp;
-				state_sensor = state_temp;
-			}
+		/* Find sensor element for last sof cq*/
+		if (state_temp->estate == E_STATE_SENSOR)
+			state_sensor = state_temp;
+		/*Find switch element*/
+		if (mtk_cam_hdr_last_frame_switch_check(state_temp,
+			req_stream_data)) {
+			state_switch = state_temp;
+			state_sensor = state_temp;
+		}
 #ifdef ISP7_1
-			/*Find CQ element for DCIF stagger*/
-			if (state_temp->estate == E_STATE_CQ)
-				state_cq = state_temp;
+		/*Find CQ element for DCIF stagger*/
+		if (state_temp->estate == E_STATE_CQ)
+			state_cq = state_temp;
 #endif
-			dev_dbg(ctx->cam->dev,
-				"[%s] STATE_CHECK [N-%d] Req:%d / State:%d\n",
-				__func__, stateidx,
-				req_stream_data->frame_seq_no, state_temp->estate);
-		}
-		/* counter for state queue*/
-		que_cnt++;
+		dev_dbg(ctx->cam->dev,
+			"[%s] STATE_CHECK [N-%d] Req:%d / State:%d\n",
+			__func__, stateidx,
+			req_stream_data->frame_seq_no, state_temp->estate);
 	}
 	spin_unlock(&sensor_ctrl->camsys_state_lock);
 	/*1-exp - as normal mode*/
@@ -3061,10 +3184,8 @@ static void mtk_camsys_raw_cq_done(struct mtk_raw_device *raw_dev,
 						 E_STATE_SUBSPL_OUTER);
 			if (state_entry->estate >= E_STATE_SUBSPL_SCQ &&
 				state_entry->estate < E_STATE_SUBSPL_INNER) {
-				state_transition(state_entry, E_STATE_SUBSPL_SCQ,
-						 E_STATE_SUBSPL_OUTER);
-				state_transition(state_entry, E_STATE_SUBSPL_SCQ_DELAY,
-						 E_STATE_SUBSPL_OUTER);
+				state_event(state_entry, MTK_CAMSYS_STATE_MODE_SUBSPL,
+					    MTK_CAMSYS_EVENT_CQ_DONE);
 				atomic_set(&sensor_ctrl->isp_enq_seq_no,
 							req_stream_data->frame_seq_no);
 				dev_dbg(raw_dev->dev,
@@ -3075,8 +3196,8 @@ static void mtk_camsys_raw_cq_done(struct mtk_raw_device *raw_dev,
 			if (req_stream_data->frame_seq_no == frame_seq_no_outer &&
 				frame_seq_no_outer >
 				atomic_read(&sensor_ctrl->isp_request_seq_no)) {
-				state_transition(state_entry, E_STATE_TS_CQ,
-						E_STATE_TS_INNER);
+				state_event(state_entry, MTK_CAMSYS_STATE_MODE_TS,
+					    MTK_CAMSYS_EVENT_CQ_DONE);
 				dev_dbg(raw_dev->dev, "[TS-SOF] ctx:%d sw trigger rawi_r2 req:%d->%d, state:0x%x\n",
 						ctx->stream_id, ctx->dequeued_frame_seq_no,
 						req_stream_data->frame_seq_no, state_entry->estate);
@@ -3093,12 +3214,8 @@ static void mtk_camsys_raw_cq_done(struct mtk_raw_device *raw_dev,
 				 */
 				if (frame_seq_no_outer == 1)
 					state_entry->estate = E_STATE_OUTER;
-				state_transition(state_entry, E_STATE_CQ,
-						 E_STATE_OUTER);
-				state_transition(state_entry, E_STATE_CQ_SCQ_DELAY,
-						 E_STATE_OUTER);
-				state_transition(state_entry, E_STATE_SENINF,
-						 E_STATE_OUTER);
+				state_event(state_entry, MTK_CAMSYS_STATE_MODE_NORMAL,
+					    MTK_CAMSYS_EVENT_CQ_DONE);
 
 				type = req_stream_data->feature.switch_feature_type;
 				if (type != 0 && (!mtk_cam_is_mstream(ctx) &&
@@ -3238,63 +3355,49 @@ mtk_camsys_raw_prepare_frame_done(struct mtk_raw_device *raw_dev,
 	 * Find inner register number's request and transit to
 	 * STATE_DONE_xxx
 	 */
-	list_for_each_entry(state_entry,
-			    &camsys_sensor_ctrl->camsys_state_list,
-			    state_element) {
+	state_entry = mtk_camsys_state_find(camsys_sensor_ctrl,
+					    dequeued_frame_seq_no);
+	if (state_entry) {
 		state_req = mtk_cam_ctrl_state_get_req(state_entry);
 		s_data = mtk_cam_ctrl_state_to_req_s_data(state_entry);
-		if (s_data->frame_seq_no == dequeued_frame_seq_no) {
-			if (mtk_cam_is_subsample(ctx)) {
-				state_transition(state_entry,
-						 E_STATE_SUBSPL_INNER,
-						 E_STATE_SUBSPL_DONE_NORMAL);
-
-				dev_dbg(cam->dev, "[SWD-subspl] req:%d/state:0x%x/time:%lld\n",
-					s_data->frame_seq_no, state_entry->estate,
-					s_data->timestamp);
-			} else if (mtk_cam_is_time_shared(ctx)) {
-				state_transition(state_entry,
-						 E_STATE_TS_INNER,
-						 E_STATE_TS_DONE_NORMAL);
-
-				dev_dbg(cam->dev, "[TS-SWD] ctx:%d req:%d/state:0x%x/time:%lld\n",
-					ctx->stream_id, s_data->frame_seq_no,
-					state_entry->estate, s_data->timestamp);
-			} else {
+		state_event(state_entry, mtk_camsys_state_mode(ctx),
+			    MTK_CAMSYS_EVENT_FRAME_DONE);
+		if (mtk_cam_is_subsample(ctx)) {
+			dev_dbg(cam->dev, "[SWD-subspl] req:%d/state:0x%x/time:%lld\n",
+				s_data->frame_seq_no, state_entry->estate,
+				s_data->timestamp);
+		} else if (mtk_cam_is_time_shared(ctx)) {
+			dev_dbg(cam->dev, "[TS-SWD] ctx:%d req:%d/state:0x%x/time:%lld\n",
+				ctx->stream_id, s_data->frame_seq_no,
+				state_entry->estate, s_data->timestamp);
+		} else {
+			if (atomic_read(&camsys_sensor_ctrl->isp_request_seq_no) == 0)
 				state_transition(state_entry,
-						 E_STATE_INNER_HW_DELAY,
-						 E_STATE_DONE_MISMATCH);
-				state_transition(state_entry, E_STATE_INNER,
-						 E_STATE_DONE_NORMAL);
-
-				if (atomic_read(&camsys_sensor_ctrl->isp_request_seq_no) == 0)
-					state_transition(state_entry,
-					 E_STATE_CQ,
-					 E_STATE_OUTER);
-
-				/* mstream 2 and 1 exposure */
-				if ((mtk_cam_feature_is_mstream(
-					s_data->feature.raw_feature) ||
-					mtk_cam_feature_is_mstream_m2m(
-					s_data->feature.raw_feature)) ||
-				    ctx->next_sof_mask_frame_seq_no != 0) {
-					if (!mtk_cam_raw_prepare_mstream_frame_done
-						(ctx, s_data)) {
-						spin_unlock(&camsys_sensor_ctrl->camsys_state_lock);
-						return false;
-					}
-				} else {
-					dev_dbg(cam->dev,
-						"[SWD] req:%d/state:%d/time:%lld/sync_id:%lld\n",
-						s_data->frame_seq_no,
-						state_entry->estate,
-						s_data->timestamp,
-						state_req->sync_id);
+				 E_STATE_CQ,
+				 E_STATE_OUTER);
+
+			/* mstream 2 and 1 exposure */
+			if ((mtk_cam_feature_is_mstream(
+				s_data->feature.raw_feature) ||
+				mtk_cam_feature_is_mstream_m2m(
+				s_data->feature.raw_feature)) ||
+			    ctx->next_sof_mask_frame_seq_no != 0) {
+				if (!mtk_cam_raw_prepare_mstream_frame_done
+					(ctx, s_data)) {
+					spin_unlock(&camsys_sensor_ctrl->camsys_state_lock);
+					return false;
 				}
-
-				// if (state_req->sync_id != -1)
-				//	imgsys_cmdq_setevent(state_req->sync_id);
+			} else {
+				dev_dbg(cam->dev,
+					"[SWD] req:%d/state:%d/time:%lld/sync_id:%lld\n",
+					s_data->frame_seq_no,
+					state_entry->estate,
+					s_data->timestamp,
+					state_req->sync_id);
 			}
+
+			// if (state_req->sync_id != -1)
+			//	imgsys_cmdq_setevent(state_req->sync_id);
 		}
 	}
 	spin_unlock(&camsys_sensor_ctrl->camsys_state_lock);
@@ -3659,6 +3762,8 @@ void mtk_camsys_frame_done(struct mtk_cam_ctx *ctx,
 		return;
 	}
 
+	mtk_cam_virt_stamp(&ctx->virt, frame_seq_no, MTK_CAM_VIRT_DONE);
+
 	atomic_set(&req_stream_data->seninf_dump_state, MTK_CAM_REQ_DBGWORK_S_FINISHED);
 	atomic_set(&req_stream_data->frame_done_work.is_queued, 1);
 	frame_done_work = &req_stream_data->frame_done_work;
@@ -3693,36 +3798,20 @@ void mtk_camsys_state_delete(struct mtk_cam_ctx *ctx,
 				struct mtk_camsys_sensor_ctrl *sensor_ctrl,
 				struct mtk_cam_request *req)
 {
-	struct mtk_camsys_ctrl_state *state_entry, *state_entry_prev;
 	struct mtk_cam_request_stream_data *s_data;
-	struct mtk_camsys_ctrl_state *req_state;
 	int state_found = 0;
 
 	if (ctx->sensor) {
 		spin_lock(&sensor_ctrl->camsys_state_lock);
-		list_for_each_entry_safe(state_entry, state_entry_prev,
-				&sensor_ctrl->camsys_state_list,
-				state_element) {
-			s_data = mtk_cam_req_get_s_data(req, ctx->stream_id, 0);
-			req_state = &s_data->state;
-
-			if (state_entry == req_state) {
-				list_del(&state_entry->state_element);
-				state_found = 1;
-			}
+		s_data = mtk_cam_req_get_s_data(req, ctx->stream_id, 0);
+		if (mtk_camsys_state_deq(sensor_ctrl, &s_data->state))
+			state_found = 1;
 
-			if (mtk_cam_feature_is_mstream(
-					s_data->feature.raw_feature) ||
-					mtk_cam_feature_is_mstream_m2m(
-					s_data->feature.raw_feature)) {
-				s_data = mtk_cam_req_get_s_data(req,
-								ctx->stream_id, 1);
-				req_state = &s_data->state;
-				if (state_entry == req_state) {
-					list_del(&state_entry->state_element);
-					state_found = 1;
-				}
-			}
+		if (mtk_cam_feature_is_mstream(s_data->feature.raw_feature) ||
+		    mtk_cam_feature_is_mstream_m2m(s_data->feature.raw_feature)) {
+			s_data = mtk_cam_req_get_s_data(req, ctx->stream_id, 1);
+			if (mtk_camsys_state_deq(sensor_ctrl, &s_data->state))
+				state_found = 1;
 		}
 		spin_unlock(&sensor_ctrl->camsys_state_lock);
 		if (state_found == 0)
@@ -3748,28 +3837,25 @@ static int mtk_camsys_camsv_state_handle(
 
 	/* List state-queue status*/
 	spin_lock(&sensor_ctrl->camsys_state_lock);
-	list_for_each_entry(state_temp,
-	&sensor_ctrl->camsys_state_list, state_element) {
+	que_cnt = mtk_camsys_state_window(sensor_ctrl,
+			atomic_read(&sensor_ctrl->sensor_request_seq_no), state_rec);
+	/* the newest frame wins */
+	for (stateidx = STATE_NUM_AT_SOF - 1; stateidx >= 0; stateidx--) {
+		state_temp = state_rec[stateidx];
+		if (!state_temp)
+			continue;
 		req = mtk_cam_ctrl_state_get_req(state_temp);
 		req_stream_data = mtk_cam_req_get_s_data(req, ctx->stream_id, 0);
-		stateidx = atomic_read(&sensor_ctrl->sensor_request_seq_no) -
-			   req_stream_data->frame_seq_no;
-
-		if (stateidx < STATE_NUM_AT_SOF && stateidx > -1) {
-			state_rec[stateidx] = state_temp;
-			/* Find outer state element */
-			if (state_temp->estate == E_STATE_OUTER ||
-				state_temp->estate == E_STATE_OUTER_HW_DELAY) {
-				mtk_cam_set_timestamp(req_stream_data, time_boot, time_mono);
-				state_outer = state_temp;
-			}
-			dev_dbg(camsv_dev->dev,
-				"[SOF] STATE_CHECK [N-%d] Req:%d / State:%d\n",
-				stateidx, req_stream_data->frame_seq_no,
-				state_rec[stateidx]->estate);
+		/* Find outer state element */
+		if (state_temp->estate == E_STATE_OUTER ||
+			state_temp->estate == E_STATE_OUTER_HW_DELAY) {
+			mtk_cam_set_timestamp(req_stream_data, time_boot, time_mono);
+			state_outer = state_temp;
 		}
-		/* counter for state queue*/
-		que_cnt++;
+		dev_dbg(camsv_dev->dev,
+			"[SOF] STATE_CHECK [N-%d] Req:%d / State:%d\n",
+			stateidx, req_stream_data->frame_seq_no,
+			state_rec[stateidx]->estate);
 	}
 	spin_unlock(&sensor_ctrl->camsys_state_lock);
 
@@ -3796,9 +3882,8 @@ static int mtk_camsys_camsv_state_handle(
 		if (req_stream_data->frame_seq_no == frame_idx_inner) {
 			if (frame_idx_inner ==
 				(atomic_read(&sensor_ctrl->isp_request_seq_no) + 1)) {
-				state_transition(state_outer,
-					E_STATE_OUTER_HW_DELAY, E_STATE_INNER_HW_DELAY);
-				state_transition(state_outer, E_STATE_OUTER, E_STATE_INNER);
+				state_event(state_outer, MTK_CAMSYS_STATE_MODE_NORMAL,
+					    MTK_CAMSYS_EVENT_DBLOAD);
 				atomic_set(&sensor_ctrl->isp_request_seq_no, frame_idx_inner);
 				dev_dbg(camsv_dev->dev, "[SOF-DBLOAD] req:%d, OUTER->INNER state:%d\n",
 						req_stream_data->frame_seq_no, state_outer->estate);
@@ -4300,6 +4385,8 @@ int mtk_camsys_ctrl_start(struct mtk_cam_ctx *ctx)
 	atomic_set(&camsys_sensor_ctrl->last_drained_seq_no, 0);
 	camsys_sensor_ctrl->initial_cq_done = 0;
 	camsys_sensor_ctrl->sof_time = 0;
+	camsys_sensor_ctrl->ae_commit_seq = 0;
+	camsys_sensor_ctrl->ae_commit_late = 0;
 	if (ctx->used_raw_num) {
 		if (is_first_request_sync(ctx))
 			atomic_set(&camsys_sensor_ctrl->initial_drop_frame_cnt,
@@ -4320,6 +4407,7 @@ int mtk_camsys_ctrl_start(struct mtk_cam_ctx *ctx)
 			SENSOR_SET_STAGGER_RESERVED_MS;
 	}
 	INIT_LIST_HEAD(&camsys_sensor_ctrl->camsys_state_list);
+	mtk_camsys_state_ring_reset(&camsys_sensor_ctrl->state_ring);
 	spin_lock_init(&camsys_sensor_ctrl->camsys_state_lock);
 	if (ctx->sensor) {
 		hrtimer_init(&camsys_sensor_ctrl->sensor_deadline_timer,
@@ -4375,6 +4463,7 @@ void mtk_camsys_ctrl_stop(struct mtk_cam_ctx *ctx)
 				 state_element) {
 		list_del(&state_entry->state_element);
 	}
+	mtk_camsys_state_ring_reset(&camsys_sensor_ctrl->state_ring);
 	spin_unlock(&camsys_sensor_ctrl->camsys_state_lock);
 	if (ctx->sensor) {
 		hrtimer_cancel(&camsys_sensor_ctrl->sensor_deadline_timer);
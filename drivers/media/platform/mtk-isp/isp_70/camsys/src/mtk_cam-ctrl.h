@@ -8,7 +8,9 @@
 
 #include <linux/hrtimer.h>
 #include <linux/timer.h>
+#include "mtk_cam-ctrl-state.h"
 #include "mtk_cam-dvfs_qos.h"
+#include "mtk_cam-raw-irq.h"
 
 #define MTK_CAM_INITIAL_REQ_SYNC 0
 
@@ -22,72 +24,6 @@ enum MTK_CAMSYS_ENGINE_TYPE {
 	CAMSYS_ENGINE_SENINF,
 };
 
-enum MTK_CAMSYS_IRQ_EVENT {
-	/* with normal_data */
-	CAMSYS_IRQ_SETTING_DONE = 0,
-	CAMSYS_IRQ_FRAME_START,
-	CAMSYS_IRQ_AFO_DONE,
-	CAMSYS_IRQ_FRAME_DONE,
-	CAMSYS_IRQ_SUBSAMPLE_SENSOR_SET,
-	CAMSYS_IRQ_FRAME_DROP,
-
-	/* with error_data */
-	CAMSYS_IRQ_ERROR,
-};
-
-struct mtk_camsys_irq_normal_data {
-};
-
-struct mtk_camsys_irq_error_data {
-	int err_status;
-};
-
-struct mtk_camsys_irq_info {
-	enum MTK_CAMSYS_IRQ_EVENT irq_type;
-	u64 ts_ns;
-	int frame_idx;
-	int frame_idx_inner;
-	bool slave_engine;
-	int write_cnt;
-	int fbc_cnt;
-	union {
-		struct mtk_camsys_irq_normal_data	n;
-		struct mtk_camsys_irq_error_data	e;
-	};
-};
-
-/*For state analysis and controlling for request*/
-enum MTK_CAMSYS_STATE_IDX {
-	E_STATE_READY = 0x0,
-	E_STATE_SENINF,
-	E_STATE_SENSOR,
-	E_STATE_CQ,
-	E_STATE_OUTER,
-	E_STATE_CAMMUX_OUTER_CFG,
-	E_STATE_CAMMUX_OUTER,
-	E_STATE_INNER,
-	E_STATE_DONE_NORMAL,
-	E_STATE_CQ_SCQ_DELAY,
-	E_STATE_CAMMUX_OUTER_CFG_DELAY,
-	E_STATE_OUTER_HW_DELAY,
-	E_STATE_INNER_HW_DELAY,
-	E_STATE_DONE_MISMATCH,
-	E_STATE_SUBSPL_READY = 0x10,
-	E_STATE_SUBSPL_SCQ,
-	E_STATE_SUBSPL_OUTER,
-	E_STATE_SUBSPL_SENSOR,
-	E_STATE_SUBSPL_INNER,
-	E_STATE_SUBSPL_DONE_NORMAL,
-	E_STATE_SUBSPL_SCQ_DELAY,
-	E_STATE_TS_READY = 0x20,
-	E_STATE_TS_SENSOR,
-	E_STATE_TS_SV,
-	E_STATE_TS_MEM,
-	E_STATE_TS_CQ,
-	E_STATE_TS_INNER,
-	E_STATE_TS_DONE_NORMAL,
-};
-
 struct mtk_camsys_ctrl_state {
 	enum MTK_CAMSYS_STATE_IDX estate;
 	struct list_head state_element;
@@ -118,10 +54,14 @@ struct mtk_camsys_sensor_ctrl {
 	int initial_cq_done;
 	atomic_t initial_drop_frame_cnt;
 	struct list_head camsys_state_list;
+	struct mtk_camsys_state_ring state_ring;
 	spinlock_t camsys_state_lock;
 	/* link change ctrl */
 	struct mtk_camsys_link_ctrl link_ctrl;
 	struct mtk_cam_request *link_change_req;
+	/* sensor AE commits, see mtk_cam_check_sensor_ae_commit() */
+	u32 ae_commit_seq;
+	u32 ae_commit_late;
 };
 
 enum {
@@ -5,6 +5,8 @@
 #ifdef CONFIG_DEBUG_FS
 
 #include <linux/freezer.h>
+#include <linux/mm.h>
+#include <linux/vmalloc.h>
 #include <linux/videodev2.h>
 #include <media/v4l2-event.h>
 #include "mtk_cam.h"
@@ -266,12 +268,145 @@ mtk_cam_dump_ctrl_block_next(struct mtk_cam_debug_fs *debug_fs,
 	return ctrl_block;
 }
 
+static void mtk_cam_dump_ring_release(struct kref *kref)
+{
+	struct mtk_cam_dump_ring *ring =
+		container_of(kref, struct mtk_cam_dump_ring, kref);
+
+	vfree(ring->vaddr);
+	kfree(ring);
+}
+
+static struct mtk_cam_dump_ring *
+mtk_cam_dump_ring_get(struct mtk_cam_debug_fs *debug_fs)
+{
+	struct mtk_cam_dump_ring *ring;
+
+	spin_lock(&debug_fs->ring_lock);
+	ring = debug_fs->ring;
+	if (ring)
+		kref_get(&ring->kref);
+	spin_unlock(&debug_fs->ring_lock);
+
+	return ring;
+}
+
+static void mtk_cam_dump_ring_put(struct mtk_cam_dump_ring *ring)
+{
+	kref_put(&ring->kref, mtk_cam_dump_ring_release);
+}
+
+static struct mtk_cam_dump_ring *
+mtk_cam_dump_ring_alloc(struct mtk_cam_debug_fs *debug_fs, int num)
+{
+	struct mtk_cam_dump_ring *ring;
+
+	ring = kzalloc(sizeof(*ring), GFP_KERNEL);
+	if (!ring)
+		return NULL;
+
+	kref_init(&ring->kref);
+	ring->num = num;
+	ring->rec_size = PAGE_ALIGN(sizeof(struct mtk_cam_dump_rec_hdr) +
+				    debug_fs->buf_size);
+	ring->size = PAGE_SIZE + (size_t)ring->rec_size * num;
+	ring->vaddr = vmalloc_user(ring->size);
+	if (!ring->vaddr) {
+		kfree(ring);
+		return NULL;
+	}
+
+	ring->hdr = ring->vaddr;
+	ring->hdr->magic = MTK_CAM_DUMP_RING_MAGIC;
+	ring->hdr->num_records = num;
+	ring->hdr->record_size = ring->rec_size;
+	ring->hdr->data_offset = PAGE_SIZE;
+
+	return ring;
+}
+
+static void mtk_cam_dump_ring_swap(struct mtk_cam_debug_fs *debug_fs,
+				   struct mtk_cam_dump_ring *ring)
+{
+	struct mtk_cam_dump_ring *old;
+
+	spin_lock(&debug_fs->ring_lock);
+	old = debug_fs->ring;
+	debug_fs->ring = ring;
+	spin_unlock(&debug_fs->ring_lock);
+
+	if (!old)
+		return;
+
+	/* the force dumps were requested for the old ring only */
+	if (old->force)
+		debug_fs->force_dump = 0;
+	mtk_cam_dump_ring_put(old);
+}
+
+/**
+ * Write one record into the dump ring. Records are never blocked by
+ * readers: the oldest record is overwritten and a reader notices it by
+ * the changed snap_seq.
+ */
+static int mtk_cam_dump_ring_write(struct mtk_cam_debug_fs *debug_fs,
+				   struct mtk_cam_dump_ring *ring,
+				   struct mtk_cam_dump_param *param,
+				   u32 type)
+{
+	struct mtk_cam_dump_rec_hdr *rec;
+	u64 seq;
+
+	spin_lock(&debug_fs->ring_lock);
+	seq = ++ring->seq;
+	rec = ring->vaddr + ring->hdr->data_offset +
+	      (size_t)ring->rec_size * ((seq - 1) % ring->num);
+	WRITE_ONCE(rec->snap_seq, 0);
+	spin_unlock(&debug_fs->ring_lock);
+
+	/* a reused record must not show the payload of the previous one */
+	if (seq > ring->num)
+		memset(rec + 1, 0, ring->rec_size - sizeof(*rec));
+
+	rec->pipe_id = param->stream_id;
+	rec->type = type;
+	rec->sequence = param->sequence;
+	mtk_cam_debug_dump_all_content(debug_fs, rec + 1, param);
+
+	/* content must be visible before the record is published */
+	smp_wmb();
+	WRITE_ONCE(rec->snap_seq, seq);
+
+	spin_lock(&debug_fs->ring_lock);
+	if (seq > ring->hdr->head)
+		WRITE_ONCE(ring->hdr->head, seq);
+	spin_unlock(&debug_fs->ring_lock);
+
+	dev_dbg(debug_fs->cam->dev, "%s:pipe(%d):req(%d):snap(%llu) type(%d)\n",
+		__func__, param->stream_id, param->sequence, seq, type);
+
+	return 0;
+}
+
 static int mtk_cam_debug_dump(struct mtk_cam_debug_fs *debug_fs,
 			      struct mtk_cam_dump_param *param)
 {
 	struct device *dev = debug_fs->cam->dev;
 	struct mtk_cam_dump_buf_ctrl *ctrl = &debug_fs->ctrl[param->stream_id];
 	struct mtk_cam_dump_ctrl_block *ctrl_block;
+	struct mtk_cam_dump_ring *ring;
+	int ret;
+
+	ring = mtk_cam_dump_ring_get(debug_fs);
+	if (ring) {
+		ret = -EINVAL;
+		if (ring->force)
+			ret = mtk_cam_dump_ring_write(debug_fs, ring, param,
+						      MTK_CAM_DUMP_REC_FORCE);
+		mtk_cam_dump_ring_put(ring);
+		if (!ret || !ctrl->num)
+			return ret;
+	}
 
 	mutex_lock(&ctrl->ctrl_lock);
 	ctrl_block = mtk_cam_dump_ctrl_block_next(debug_fs, ctrl);
@@ -300,6 +435,17 @@ static int mtk_cam_debug_exp_dump(struct mtk_cam_debug_fs *debug_fs,
 {
 	struct device *dev = debug_fs->cam->dev;
 	void *dump_buf = debug_fs->exp_dump_buf;
+	struct mtk_cam_dump_ring *ring;
+	int ret;
+
+	/* with the ring armed, each exception gets its own record */
+	ring = mtk_cam_dump_ring_get(debug_fs);
+	if (ring) {
+		ret = mtk_cam_dump_ring_write(debug_fs, ring, param,
+					      MTK_CAM_DUMP_REC_EXCEPTION);
+		mtk_cam_dump_ring_put(ring);
+		return ret;
+	}
 
 	if (!dump_buf) {
 		dev_info(dev, "%s:pipe(%d):req(%d):no dump buffer. sz(%d)\n",
@@ -699,6 +845,128 @@ static int exp_release(struct inode *inode, struct file *file)
 	return 0;
 }
 
+static void ring_vm_open(struct vm_area_struct *vma)
+{
+	struct mtk_cam_dump_ring *ring = vma->vm_private_data;
+
+	kref_get(&ring->kref);
+}
+
+static void ring_vm_close(struct vm_area_struct *vma)
+{
+	mtk_cam_dump_ring_put(vma->vm_private_data);
+}
+
+static const struct vm_operations_struct ring_vm_ops = {
+	.open = ring_vm_open,
+	.close = ring_vm_close,
+};
+
+static int ring_open(struct inode *inode, struct file *file)
+{
+	if (inode->i_private)
+		file->private_data = inode->i_private;
+
+	return 0;
+}
+
+static int ring_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	struct mtk_cam_debug_fs *debug_fs = file->private_data;
+	struct mtk_cam_dump_ring *ring;
+	int ret;
+
+	ring = mtk_cam_dump_ring_get(debug_fs);
+	if (!ring)
+		return -ENODEV;
+
+	if (vma->vm_flags & VM_WRITE) {
+		ret = -EPERM;
+		goto EXIT;
+	}
+	/* no mprotect() to writable later on */
+	vma->vm_flags &= ~VM_MAYWRITE;
+
+	ret = remap_vmalloc_range(vma, ring->vaddr, vma->vm_pgoff);
+	if (ret)
+		goto EXIT;
+
+	/* the mapping keeps the reference taken above */
+	vma->vm_private_data = ring;
+	vma->vm_ops = &ring_vm_ops;
+
+	return 0;
+EXIT:
+	mtk_cam_dump_ring_put(ring);
+	return ret;
+}
+
+/**
+ * Control commands:
+ *   "s:<num>"   arm the ring with <num> records (exception dumps)
+ *   "f:<num>"   same as "s", force dumps go to the ring as well
+ *   "e"         disarm; existing mappings stay valid until unmapped
+ */
+static ssize_t ring_write(struct file *file, const char __user *data,
+			  size_t count, loff_t *ppos)
+{
+	struct mtk_cam_debug_fs *debug_fs = file->private_data;
+	struct device *dev = debug_fs->cam->dev;
+	struct mtk_cam_dump_ring *ring;
+	char tmp[16];
+	char *parse_str = tmp;
+	char *cmd_str;
+	char *param_str;
+	unsigned long num;
+
+	if (count >= sizeof(tmp))
+		return -EINVAL;
+
+	memset(tmp, 0, sizeof(tmp));
+	if (copy_from_user(tmp, data, count))
+		return -EFAULT;
+
+	cmd_str = strsep(&parse_str, ":");
+	param_str = strsep(&parse_str, ":");
+
+	mutex_lock(&debug_fs->ring_ctrl_lock);
+	if (cmd_str[0] == 's' || cmd_str[0] == 'f') {
+		if (!param_str || kstrtoul(strim(param_str), 10, &num) ||
+		    num < MTK_CAM_DUMP_RING_MIN_RECORDS ||
+		    num > MTK_CAM_DUMP_RING_MAX_RECORDS) {
+			mutex_unlock(&debug_fs->ring_ctrl_lock);
+			return -EINVAL;
+		}
+
+		ring = mtk_cam_dump_ring_alloc(debug_fs, num);
+		if (!ring) {
+			mutex_unlock(&debug_fs->ring_ctrl_lock);
+			return -ENOMEM;
+		}
+		ring->force = (cmd_str[0] == 'f');
+		mtk_cam_dump_ring_swap(debug_fs, ring);
+		if (ring->force)
+			debug_fs->force_dump = MTK_CAM_REQ_DUMP_FORCE;
+		dev_info(dev, "%s: dump ring armed, num(%lu) rec_sz(%d) force(%d)\n",
+			 __func__, num, ring->rec_size, ring->force);
+	} else if (cmd_str[0] == 'e') {
+		mtk_cam_dump_ring_swap(debug_fs, NULL);
+		dev_info(dev, "%s: dump ring disarmed\n", __func__);
+	} else {
+		mutex_unlock(&debug_fs->ring_ctrl_lock);
+		return -EINVAL;
+	}
+	mutex_unlock(&debug_fs->ring_ctrl_lock);
+
+	return count;
+}
+
+static const struct file_operations ring_fops = {
+	.open = ring_open,
+	.write = ring_write,
+	.mmap = ring_mmap,
+};
+
 static const struct file_operations dbg_ctrl_fops = {
 	.open = dbg_ctrl_open,
 	.write = dbg_ctrl_write,
@@ -767,6 +1035,13 @@ static int mtk_cam_debug_init(struct mtk_cam_debug_fs *debug_fs,
 		return -ENOMEM;
 	}
 
+	spin_lock_init(&debug_fs->ring_lock);
+	mutex_init(&debug_fs->ring_ctrl_lock);
+	debug_fs->ring = NULL;
+	debug_fs->ring_entry = debugfs_create_file("mtk_cam_dump_ring",
+						   0644, NULL, debug_fs,
+						   &ring_fops);
+
 	debug_fs->dbg_entry = debugfs_create_dir("mtk_cam_dbg", NULL);
 	for (i = 0; i < cam->max_stream_num; i++) {
 		char name[4];
@@ -823,6 +1098,8 @@ static void mtk_cam_debug_deinit(struct mtk_cam_debug_fs *debug_fs)
 	}
 
 	debugfs_remove(debug_fs->dbg_entry);
+	debugfs_remove(debug_fs->ring_entry);
+	mtk_cam_dump_ring_swap(debug_fs, NULL);
 	kfree(debug_fs->exp_dump_buf);
 	dev_dbg(debug_fs->cam->dev, "Free exception dump buffer\n");
 	debugfs_remove(debug_fs->exp_dump_entry);
@@ -995,7 +1272,8 @@ int mtk_cam_req_dump(struct mtk_cam_request_stream_data *s_data,
 	switch (dump_flag) {
 	case MTK_CAM_REQ_DUMP_FORCE:
 		if (!ctx->cam->debug_fs->force_dump ||
-		    !ctx->cam->debug_fs->ctrl[ctx->stream_id].num)
+		    (!ctx->cam->debug_fs->ctrl[ctx->stream_id].num &&
+		     !READ_ONCE(ctx->cam->debug_fs->ring)))
 			return false;
 
 		dbg_work = &s_data->dbg_work;
@@ -7,6 +7,7 @@
 #define __MTK_CAM_DEBUG__
 
 #include <linux/debugfs.h>
+#include <linux/kref.h>
 struct mtk_cam_debug_fs;
 struct mtk_cam_device;
 struct mtk_cam_dump_param;
@@ -198,6 +199,49 @@ struct mtk_cam_dump_header {
 	__u32	used_stream_num;
 };
 
+/*
+ * mmap'able dump ring of /sys/kernel/debug/mtk_cam_dump_ring.
+ * Page 0 holds struct mtk_cam_dump_ring_hdr, records start at data_offset
+ * and are record_size bytes apart. A record is made of
+ * struct mtk_cam_dump_rec_hdr followed by struct mtk_cam_dump_header and
+ * its payload. snap_seq is 0 while the record is being written; readers
+ * copy the record and check snap_seq again to detect an overwrite. The
+ * records before head - num_records + 1 have been overwritten.
+ */
+#define MTK_CAM_DUMP_RING_MAGIC			0x4d434452 /* MCDR */
+#define MTK_CAM_DUMP_RING_MIN_RECORDS		2
+#define MTK_CAM_DUMP_RING_MAX_RECORDS		16
+
+#define MTK_CAM_DUMP_REC_FORCE			0
+#define MTK_CAM_DUMP_REC_EXCEPTION		1
+
+struct mtk_cam_dump_ring_hdr {
+	__u32	magic;
+	__u32	num_records;
+	__u32	record_size;
+	__u32	data_offset;
+	__u64	head;		/* snap_seq of the latest record */
+};
+
+struct mtk_cam_dump_rec_hdr {
+	__u64	snap_seq;
+	__u32	pipe_id;
+	__u32	type;
+	__u32	sequence;
+	__u32	reserved[11];
+};
+
+struct mtk_cam_dump_ring {
+	struct kref kref;
+	void *vaddr;		/* vmalloc_user */
+	size_t size;
+	struct mtk_cam_dump_ring_hdr *hdr;
+	u32 num;
+	u32 rec_size;
+	u64 seq;
+	bool force;		/* also take MTK_CAM_REQ_DUMP_FORCE dumps */
+};
+
 struct mtk_cam_dump_ctrl_block {
 	atomic_t state;
 	void *buf;
@@ -244,6 +288,11 @@ struct mtk_cam_debug_fs {
 	struct dentry *dbg_entry;
 	struct mtk_cam_dump_buf_ctrl ctrl[MTKCAM_SUBDEV_MAX];
 	struct mtk_cam_debug_ops *ops;
+	/* dump ring, protected by ring_lock */
+	struct mtk_cam_dump_ring *ring;
+	spinlock_t ring_lock;
+	struct mutex ring_ctrl_lock;
+	struct dentry *ring_entry;
 };
 
 #ifndef CONFIG_DEBUG_FS
@@ -0,0 +1,577 @@
+// SPDX-License-Identifier: GPL-2.0
+//
+// Copyright (c) 2022 MediaTek Inc.
+
+#ifdef FMT_DESC_UT
+#include <string.h>
+#else
+#include <linux/string.h>
+#endif
+#include <linux/errno.h>
+#include <linux/kernel.h>
+
+#include "mtk_cam-fmt-desc.h"
+#include "mtk_cam-ufbc-def.h"
+
+#define IPI_FMT(bits, fl, factor) \
+	{ .pixel_bits = bits, .flags = fl, .size_factor = factor }
+
+const struct mtk_cam_ipi_fmt_desc mtk_cam_ipi_fmt_descs[MTK_CAM_IPI_FMT_NUM] = {
+	[MTKCAM_IPI_IMG_FMT_BAYER8] = IPI_FMT(8, MTK_CAM_IPI_FMT_DMAO, 100),
+	[MTKCAM_IPI_IMG_FMT_BAYER10] = IPI_FMT(10, MTK_CAM_IPI_FMT_DMAO, 100),
+	[MTKCAM_IPI_IMG_FMT_BAYER12] = IPI_FMT(12, MTK_CAM_IPI_FMT_DMAO, 100),
+	[MTKCAM_IPI_IMG_FMT_BAYER14] = IPI_FMT(14, MTK_CAM_IPI_FMT_DMAO, 100),
+	[MTKCAM_IPI_IMG_FMT_BAYER16] = IPI_FMT(16, MTK_CAM_IPI_FMT_DMAO, -1),
+	[MTKCAM_IPI_IMG_FMT_BAYER10_UNPACKED] =
+		IPI_FMT(16, MTK_CAM_IPI_FMT_DMAO, -1),
+	[MTKCAM_IPI_IMG_FMT_BAYER12_UNPACKED] =
+		IPI_FMT(16, MTK_CAM_IPI_FMT_DMAO, -1),
+	[MTKCAM_IPI_IMG_FMT_BAYER14_UNPACKED] =
+		IPI_FMT(16, MTK_CAM_IPI_FMT_DMAO, -1),
+	[MTKCAM_IPI_IMG_FMT_RGB565] = IPI_FMT(0, 0, -1),
+	[MTKCAM_IPI_IMG_FMT_RGB888] = IPI_FMT(0, 0, -1),
+	[MTKCAM_IPI_IMG_FMT_JPEG] = IPI_FMT(0, 0, -1),
+	[MTKCAM_IPI_IMG_FMT_FG_BAYER8] =
+		IPI_FMT(8, MTK_CAM_IPI_FMT_DMAO | MTK_CAM_IPI_FMT_FULLG, 100),
+	[MTKCAM_IPI_IMG_FMT_FG_BAYER10] =
+		IPI_FMT(10, MTK_CAM_IPI_FMT_DMAO | MTK_CAM_IPI_FMT_FULLG, 100),
+	[MTKCAM_IPI_IMG_FMT_FG_BAYER12] =
+		IPI_FMT(12, MTK_CAM_IPI_FMT_DMAO | MTK_CAM_IPI_FMT_FULLG, 100),
+	/* no pixel bits, dmao xsize comes out as 0 */
+	[MTKCAM_IPI_IMG_FMT_FG_BAYER14] =
+		IPI_FMT(0, MTK_CAM_IPI_FMT_DMAO | MTK_CAM_IPI_FMT_FULLG, -1),
+	[MTKCAM_IPI_IMG_FMT_YUYV] = IPI_FMT(16, MTK_CAM_IPI_FMT_FILL, 100),
+	[MTKCAM_IPI_IMG_FMT_YVYU] = IPI_FMT(16, MTK_CAM_IPI_FMT_FILL, 100),
+	[MTKCAM_IPI_IMG_FMT_UYVY] = IPI_FMT(16, MTK_CAM_IPI_FMT_FILL, 100),
+	[MTKCAM_IPI_IMG_FMT_VYUY] = IPI_FMT(16, MTK_CAM_IPI_FMT_FILL, 100),
+	[MTKCAM_IPI_IMG_FMT_YUV_422_2P] = IPI_FMT(8, MTK_CAM_IPI_FMT_FILL, 200),
+	[MTKCAM_IPI_IMG_FMT_YVU_422_2P] = IPI_FMT(8, MTK_CAM_IPI_FMT_FILL, 200),
+	[MTKCAM_IPI_IMG_FMT_YUV_422_3P] = IPI_FMT(8, MTK_CAM_IPI_FMT_FILL, 200),
+	[MTKCAM_IPI_IMG_FMT_YVU_422_3P] = IPI_FMT(8, MTK_CAM_IPI_FMT_FILL, 200),
+	[MTKCAM_IPI_IMG_FMT_YUV_420_2P] = IPI_FMT(8, MTK_CAM_IPI_FMT_FILL, 150),
+	[MTKCAM_IPI_IMG_FMT_YVU_420_2P] = IPI_FMT(8, MTK_CAM_IPI_FMT_FILL, 150),
+	[MTKCAM_IPI_IMG_FMT_YUV_420_3P] = IPI_FMT(8, MTK_CAM_IPI_FMT_FILL, 150),
+	[MTKCAM_IPI_IMG_FMT_YVU_420_3P] = IPI_FMT(8, MTK_CAM_IPI_FMT_FILL, 150),
+	[MTKCAM_IPI_IMG_FMT_Y8] = IPI_FMT(8, MTK_CAM_IPI_FMT_FILL, 100),
+	[MTKCAM_IPI_IMG_FMT_YUYV_Y210] = IPI_FMT(32, MTK_CAM_IPI_FMT_FILL, 100),
+	[MTKCAM_IPI_IMG_FMT_YVYU_Y210] = IPI_FMT(32, MTK_CAM_IPI_FMT_FILL, 100),
+	[MTKCAM_IPI_IMG_FMT_UYVY_Y210] = IPI_FMT(32, MTK_CAM_IPI_FMT_FILL, 100),
+	[MTKCAM_IPI_IMG_FMT_VYUY_Y210] = IPI_FMT(32, MTK_CAM_IPI_FMT_FILL, 100),
+	[MTKCAM_IPI_IMG_FMT_YUYV_Y210_PACKED] =
+		IPI_FMT(20, MTK_CAM_IPI_FMT_FILL, 100),
+	[MTKCAM_IPI_IMG_FMT_YVYU_Y210_PACKED] =
+		IPI_FMT(20, MTK_CAM_IPI_FMT_FILL, 100),
+	[MTKCAM_IPI_IMG_FMT_UYVY_Y210_PACKED] =
+		IPI_FMT(20, MTK_CAM_IPI_FMT_FILL, 100),
+	[MTKCAM_IPI_IMG_FMT_VYUY_Y210_PACKED] =
+		IPI_FMT(20, MTK_CAM_IPI_FMT_FILL, 100),
+	[MTKCAM_IPI_IMG_FMT_YUV_P210] = IPI_FMT(16, MTK_CAM_IPI_FMT_FILL, 200),
+	[MTKCAM_IPI_IMG_FMT_YVU_P210] = IPI_FMT(16, MTK_CAM_IPI_FMT_FILL, 200),
+	[MTKCAM_IPI_IMG_FMT_YUV_P010] = IPI_FMT(16, MTK_CAM_IPI_FMT_FILL, 150),
+	[MTKCAM_IPI_IMG_FMT_YVU_P010] = IPI_FMT(16, MTK_CAM_IPI_FMT_FILL, 150),
+	[MTKCAM_IPI_IMG_FMT_YUV_P210_PACKED] =
+		IPI_FMT(10, MTK_CAM_IPI_FMT_FILL, 200),
+	[MTKCAM_IPI_IMG_FMT_YVU_P210_PACKED] =
+		IPI_FMT(10, MTK_CAM_IPI_FMT_FILL, 200),
+	[MTKCAM_IPI_IMG_FMT_YUV_P010_PACKED] =
+		IPI_FMT(10, MTK_CAM_IPI_FMT_FILL, 150),
+	[MTKCAM_IPI_IMG_FMT_YVU_P010_PACKED] =
+		IPI_FMT(10, MTK_CAM_IPI_FMT_FILL, 150),
+	[MTKCAM_IPI_IMG_FMT_YUV_P212] = IPI_FMT(16, MTK_CAM_IPI_FMT_FILL, 200),
+	[MTKCAM_IPI_IMG_FMT_YVU_P212] = IPI_FMT(16, MTK_CAM_IPI_FMT_FILL, 200),
+	[MTKCAM_IPI_IMG_FMT_YUV_P012] = IPI_FMT(16, MTK_CAM_IPI_FMT_FILL, 150),
+	[MTKCAM_IPI_IMG_FMT_YVU_P012] = IPI_FMT(16, MTK_CAM_IPI_FMT_FILL, 150),
+	[MTKCAM_IPI_IMG_FMT_YUV_P212_PACKED] =
+		IPI_FMT(12, MTK_CAM_IPI_FMT_FILL, 200),
+	[MTKCAM_IPI_IMG_FMT_YVU_P212_PACKED] =
+		IPI_FMT(12, MTK_CAM_IPI_FMT_FILL, 200),
+	[MTKCAM_IPI_IMG_FMT_YUV_P012_PACKED] =
+		IPI_FMT(12, MTK_CAM_IPI_FMT_FILL, 150),
+	[MTKCAM_IPI_IMG_FMT_YVU_P012_PACKED] =
+		IPI_FMT(12, MTK_CAM_IPI_FMT_FILL, 150),
+	[MTKCAM_IPI_IMG_FMT_RGB_8B_3P] = IPI_FMT(8, 0, -1),
+	[MTKCAM_IPI_IMG_FMT_RGB_10B_3P] = IPI_FMT(16, 0, -1),
+	[MTKCAM_IPI_IMG_FMT_RGB_12B_3P] = IPI_FMT(16, 0, -1),
+	[MTKCAM_IPI_IMG_FMT_RGB_10B_3P_PACKED] = IPI_FMT(10, 0, -1),
+	[MTKCAM_IPI_IMG_FMT_RGB_12B_3P_PACKED] = IPI_FMT(12, 0, -1),
+	[MTKCAM_IPI_IMG_FMT_FG_BAYER8_3P] =
+		IPI_FMT(8, MTK_CAM_IPI_FMT_FILL, 300),
+	[MTKCAM_IPI_IMG_FMT_FG_BAYER10_3P] = IPI_FMT(16, 0, -1),
+	[MTKCAM_IPI_IMG_FMT_FG_BAYER12_3P] = IPI_FMT(16, 0, -1),
+	[MTKCAM_IPI_IMG_FMT_FG_BAYER10_3P_PACKED] =
+		IPI_FMT(10, MTK_CAM_IPI_FMT_FILL, 300),
+	[MTKCAM_IPI_IMG_FMT_FG_BAYER12_3P_PACKED] =
+		IPI_FMT(12, MTK_CAM_IPI_FMT_FILL, 300),
+	[MTKCAM_IPI_IMG_FMT_UFBC_NV12] = IPI_FMT(8, MTK_CAM_IPI_FMT_FILL, 150),
+	[MTKCAM_IPI_IMG_FMT_UFBC_NV21] = IPI_FMT(8, MTK_CAM_IPI_FMT_FILL, 150),
+	[MTKCAM_IPI_IMG_FMT_UFBC_YUV_P010] =
+		IPI_FMT(10, MTK_CAM_IPI_FMT_FILL, 150),
+	[MTKCAM_IPI_IMG_FMT_UFBC_YVU_P010] =
+		IPI_FMT(10, MTK_CAM_IPI_FMT_FILL, 150),
+	[MTKCAM_IPI_IMG_FMT_UFBC_YUV_P012] =
+		IPI_FMT(12, MTK_CAM_IPI_FMT_FILL, 150),
+	[MTKCAM_IPI_IMG_FMT_UFBC_YVU_P012] =
+		IPI_FMT(12, MTK_CAM_IPI_FMT_FILL, 150),
+	[MTKCAM_IPI_IMG_FMT_UFBC_BAYER8] = IPI_FMT(8, MTK_CAM_IPI_FMT_FILL, 100),
+	[MTKCAM_IPI_IMG_FMT_UFBC_BAYER10] =
+		IPI_FMT(10, MTK_CAM_IPI_FMT_FILL, 100),
+	[MTKCAM_IPI_IMG_FMT_UFBC_BAYER12] =
+		IPI_FMT(12, MTK_CAM_IPI_FMT_FILL, 100),
+	[MTKCAM_IPI_IMG_FMT_UFBC_BAYER14] =
+		IPI_FMT(14, MTK_CAM_IPI_FMT_FILL, 100),
+	[MTKCAM_IPI_IMG_FMT_BAYER10_MIPI] =
+		IPI_FMT(10, MTK_CAM_IPI_FMT_DMAO, 100),
+};
+
+/* bayer and other dmao formats: no plane layout needed */
+#define FMT_RAW(f, ipi) \
+	{ .fourcc = f, .ipi_fmt = ipi }
+
+/* same layout as v4l2_format_info() */
+#define FMT_V4L2(f, ipi, cp, b0, b1, b2, h, v) \
+	{ .fourcc = f, .ipi_fmt = ipi, .flags = MTK_CAM_FMT_LAYOUT, \
+	  .info = { .format = f, .mem_planes = 1, .comp_planes = cp, \
+		    .bpp = { b0, b1, b2, 0 }, .hdiv = h, .vdiv = v, \
+		    .bit_r_num = 1, .bit_r_den = 1 } }
+
+#define FMT_MTK(f, ipi, fl, cp, b0, b1, h, v, num, den) \
+	{ .fourcc = f, .ipi_fmt = ipi, \
+	  .flags = MTK_CAM_FMT_MTK | MTK_CAM_FMT_LAYOUT | (fl), \
+	  .ufo_align = (fl) ? 64 : 0, \
+	  .ufo_hdr_size = (fl) ? sizeof(struct UfbcBufferHeader) : 0, \
+	  .info = { .format = f, .mem_planes = 1, .comp_planes = cp, \
+		    .bpp = { b0, b1, 0, 0 }, .hdiv = h, .vdiv = v, \
+		    .bit_r_num = num, .bit_r_den = den } }
+
+#define FMT_YUYV(f, ipi, num, den) \
+	FMT_MTK(f, ipi, 0, 1, 2, 0, 2, 1, num, den)
+#define FMT_NV(f, ipi, fl, v, num, den) \
+	FMT_MTK(f, ipi, fl, 2, 1, 2, 2, v, num, den)
+#define FMT_RAW_UFO(f, ipi, num, den) \
+	FMT_MTK(f, ipi, MTK_CAM_FMT_RAW_UFO, 1, 1, 0, 1, 1, num, den)
+
+static const struct mtk_cam_fmt_desc mtk_cam_fmt_descs[] = {
+	/* v4l2 yuv formats */
+	FMT_V4L2(V4L2_PIX_FMT_GREY, MTKCAM_IPI_IMG_FMT_Y8, 1, 1, 0, 0, 1, 1),
+	FMT_V4L2(V4L2_PIX_FMT_YUYV, MTKCAM_IPI_IMG_FMT_YUYV, 1, 2, 0, 0, 2, 1),
+	FMT_V4L2(V4L2_PIX_FMT_YVYU, MTKCAM_IPI_IMG_FMT_YVYU, 1, 2, 0, 0, 2, 1),
+	FMT_V4L2(V4L2_PIX_FMT_UYVY, MTKCAM_IPI_IMG_FMT_UYVY, 1, 2, 0, 0, 2, 1),
+	FMT_V4L2(V4L2_PIX_FMT_VYUY, MTKCAM_IPI_IMG_FMT_VYUY, 1, 2, 0, 0, 2, 1),
+	FMT_V4L2(V4L2_PIX_FMT_NV16, MTKCAM_IPI_IMG_FMT_YUV_422_2P,
+		 2, 1, 2, 0, 2, 1),
+	FMT_V4L2(V4L2_PIX_FMT_NV61, MTKCAM_IPI_IMG_FMT_YVU_422_2P,
+		 2, 1, 2, 0, 2, 1),
+	FMT_V4L2(V4L2_PIX_FMT_NV12, MTKCAM_IPI_IMG_FMT_YUV_420_2P,
+		 2, 1, 2, 0, 2, 2),
+	FMT_V4L2(V4L2_PIX_FMT_NV21, MTKCAM_IPI_IMG_FMT_YVU_420_2P,
+		 2, 1, 2, 0, 2, 2),
+	FMT_V4L2(V4L2_PIX_FMT_YUV422P, MTKCAM_IPI_IMG_FMT_YUV_422_3P,
+		 3, 1, 1, 1, 2, 1),
+	FMT_V4L2(V4L2_PIX_FMT_YUV420, MTKCAM_IPI_IMG_FMT_YUV_420_3P,
+		 3, 1, 1, 1, 2, 2),
+	FMT_V4L2(V4L2_PIX_FMT_YVU420, MTKCAM_IPI_IMG_FMT_YVU_420_3P,
+		 3, 1, 1, 1, 2, 2),
+	/* YUV planar formats */
+	FMT_NV(V4L2_PIX_FMT_NV12_10, MTKCAM_IPI_IMG_FMT_YUV_P010, 0, 2, 2, 1),
+	FMT_NV(V4L2_PIX_FMT_NV21_10, MTKCAM_IPI_IMG_FMT_YVU_P010, 0, 2, 2, 1),
+	FMT_NV(V4L2_PIX_FMT_NV16_10, MTKCAM_IPI_IMG_FMT_YUV_P210, 0, 1, 2, 1),
+	FMT_NV(V4L2_PIX_FMT_NV61_10, MTKCAM_IPI_IMG_FMT_YVU_P210, 0, 1, 2, 1),
+	FMT_YUYV(V4L2_PIX_FMT_YUYV10, MTKCAM_IPI_IMG_FMT_YUYV_Y210, 2, 1),
+	FMT_YUYV(V4L2_PIX_FMT_YVYU10, MTKCAM_IPI_IMG_FMT_YVYU_Y210, 2, 1),
+	FMT_YUYV(V4L2_PIX_FMT_UYVY10, MTKCAM_IPI_IMG_FMT_UYVY_Y210, 2, 1),
+	FMT_YUYV(V4L2_PIX_FMT_VYUY10, MTKCAM_IPI_IMG_FMT_VYUY_Y210, 2, 1),
+	FMT_NV(V4L2_PIX_FMT_NV12_12, MTKCAM_IPI_IMG_FMT_YUV_P012, 0, 2, 2, 1),
+	FMT_NV(V4L2_PIX_FMT_NV21_12, MTKCAM_IPI_IMG_FMT_YVU_P012, 0, 2, 2, 1),
+	FMT_NV(V4L2_PIX_FMT_NV16_12, MTKCAM_IPI_IMG_FMT_YUV_P212, 0, 1, 2, 1),
+	FMT_NV(V4L2_PIX_FMT_NV61_12, MTKCAM_IPI_IMG_FMT_YVU_P212, 0, 1, 2, 1),
+	/* no ipi format for the 12 bit yuyv family yet */
+	FMT_YUYV(V4L2_PIX_FMT_YUYV12, MTKCAM_IPI_IMG_FMT_UNKNOWN, 2, 1),
+	FMT_YUYV(V4L2_PIX_FMT_YVYU12, MTKCAM_IPI_IMG_FMT_UNKNOWN, 2, 1),
+	FMT_YUYV(V4L2_PIX_FMT_UYVY12, MTKCAM_IPI_IMG_FMT_UNKNOWN, 2, 1),
+	FMT_YUYV(V4L2_PIX_FMT_VYUY12, MTKCAM_IPI_IMG_FMT_UNKNOWN, 2, 1),
+	/* YUV packed formats */
+	FMT_YUYV(V4L2_PIX_FMT_MTISP_YUYV10P,
+		 MTKCAM_IPI_IMG_FMT_YUYV_Y210_PACKED, 5, 4),
+	FMT_YUYV(V4L2_PIX_FMT_MTISP_YVYU10P,
+		 MTKCAM_IPI_IMG_FMT_YVYU_Y210_PACKED, 5, 4),
+	FMT_YUYV(V4L2_PIX_FMT_MTISP_UYVY10P,
+		 MTKCAM_IPI_IMG_FMT_UYVY_Y210_PACKED, 5, 4),
+	FMT_YUYV(V4L2_PIX_FMT_MTISP_VYUY10P,
+		 MTKCAM_IPI_IMG_FMT_VYUY_Y210_PACKED, 5, 4),
+	FMT_NV(V4L2_PIX_FMT_MTISP_NV12_10P,
+	       MTKCAM_IPI_IMG_FMT_YUV_P010_PACKED, 0, 2, 5, 4),
+	FMT_NV(V4L2_PIX_FMT_MTISP_NV21_10P,
+	       MTKCAM_IPI_IMG_FMT_YVU_P010_PACKED, 0, 2, 5, 4),
+	FMT_NV(V4L2_PIX_FMT_MTISP_NV16_10P,
+	       MTKCAM_IPI_IMG_FMT_YUV_P210_PACKED, 0, 1, 5, 4),
+	FMT_NV(V4L2_PIX_FMT_MTISP_NV61_10P,
+	       MTKCAM_IPI_IMG_FMT_YVU_P210_PACKED, 0, 1, 5, 4),
+	FMT_YUYV(V4L2_PIX_FMT_MTISP_YUYV12P, MTKCAM_IPI_IMG_FMT_UNKNOWN, 3, 2),
+	FMT_YUYV(V4L2_PIX_FMT_MTISP_YVYU12P, MTKCAM_IPI_IMG_FMT_UNKNOWN, 3, 2),
+	FMT_YUYV(V4L2_PIX_FMT_MTISP_UYVY12P, MTKCAM_IPI_IMG_FMT_UNKNOWN, 3, 2),
+	FMT_YUYV(V4L2_PIX_FMT_MTISP_VYUY12P, MTKCAM_IPI_IMG_FMT_UNKNOWN, 3, 2),
+	FMT_NV(V4L2_PIX_FMT_MTISP_NV12_12P,
+	       MTKCAM_IPI_IMG_FMT_YUV_P012_PACKED, 0, 2, 3, 2),
+	FMT_NV(V4L2_PIX_FMT_MTISP_NV21_12P,
+	       MTKCAM_IPI_IMG_FMT_YVU_P012_PACKED, 0, 2, 3, 2),
+	FMT_NV(V4L2_PIX_FMT_MTISP_NV16_12P,
+	       MTKCAM_IPI_IMG_FMT_YUV_P212_PACKED, 0, 1, 3, 2),
+	FMT_NV(V4L2_PIX_FMT_MTISP_NV61_12P,
+	       MTKCAM_IPI_IMG_FMT_YVU_P212_PACKED, 0, 1, 3, 2),
+	/* YUV UFBC formats */
+	FMT_NV(V4L2_PIX_FMT_MTISP_NV12_UFBC, MTKCAM_IPI_IMG_FMT_UFBC_NV12,
+	       MTK_CAM_FMT_YUV_UFO, 2, 2, 1),
+	FMT_NV(V4L2_PIX_FMT_MTISP_NV21_UFBC, MTKCAM_IPI_IMG_FMT_UFBC_NV21,
+	       MTK_CAM_FMT_YUV_UFO, 2, 2, 1),
+	FMT_NV(V4L2_PIX_FMT_MTISP_NV12_10_UFBC, MTKCAM_IPI_IMG_FMT_UFBC_YUV_P010,
+	       MTK_CAM_FMT_YUV_UFO, 2, 5, 4),
+	FMT_NV(V4L2_PIX_FMT_MTISP_NV21_10_UFBC, MTKCAM_IPI_IMG_FMT_UFBC_YVU_P010,
+	       MTK_CAM_FMT_YUV_UFO, 2, 5, 4),
+	FMT_NV(V4L2_PIX_FMT_MTISP_NV12_12_UFBC, MTKCAM_IPI_IMG_FMT_UFBC_YUV_P012,
+	       MTK_CAM_FMT_YUV_UFO, 2, 3, 2),
+	FMT_NV(V4L2_PIX_FMT_MTISP_NV21_12_UFBC, MTKCAM_IPI_IMG_FMT_UFBC_YVU_P012,
+	       MTK_CAM_FMT_YUV_UFO, 2, 3, 2),
+	/* bayer UFBC formats */
+	FMT_RAW_UFO(V4L2_PIX_FMT_MTISP_BAYER8_UFBC,
+		    MTKCAM_IPI_IMG_FMT_UFBC_BAYER8, 1, 1),
+	FMT_RAW_UFO(V4L2_PIX_FMT_MTISP_BAYER10_UFBC,
+		    MTKCAM_IPI_IMG_FMT_UFBC_BAYER10, 5, 4),
+	FMT_RAW_UFO(V4L2_PIX_FMT_MTISP_BAYER12_UFBC,
+		    MTKCAM_IPI_IMG_FMT_UFBC_BAYER12, 3, 2),
+	FMT_RAW_UFO(V4L2_PIX_FMT_MTISP_BAYER14_UFBC,
+		    MTKCAM_IPI_IMG_FMT_UFBC_BAYER14, 7, 4),
+	/* bayer formats */
+	FMT_RAW(V4L2_PIX_FMT_SBGGR8, MTKCAM_IPI_IMG_FMT_BAYER8),
+	FMT_RAW(V4L2_PIX_FMT_SGBRG8, MTKCAM_IPI_IMG_FMT_BAYER8),
+	FMT_RAW(V4L2_PIX_FMT_SGRBG8, MTKCAM_IPI_IMG_FMT_BAYER8),
+	FMT_RAW(V4L2_PIX_FMT_SRGGB8, MTKCAM_IPI_IMG_FMT_BAYER8),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SBGGR8F, MTKCAM_IPI_IMG_FMT_FG_BAYER8),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SGBRG8F, MTKCAM_IPI_IMG_FMT_FG_BAYER8),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SGRBG8F, MTKCAM_IPI_IMG_FMT_FG_BAYER8),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SRGGB8F, MTKCAM_IPI_IMG_FMT_FG_BAYER8),
+	FMT_RAW(V4L2_PIX_FMT_SBGGR10, MTKCAM_IPI_IMG_FMT_BAYER10_UNPACKED),
+	FMT_RAW(V4L2_PIX_FMT_SGBRG10, MTKCAM_IPI_IMG_FMT_BAYER10_UNPACKED),
+	FMT_RAW(V4L2_PIX_FMT_SGRBG10, MTKCAM_IPI_IMG_FMT_BAYER10_UNPACKED),
+	FMT_RAW(V4L2_PIX_FMT_SRGGB10, MTKCAM_IPI_IMG_FMT_BAYER10_UNPACKED),
+	FMT_RAW(V4L2_PIX_FMT_SBGGR10P, MTKCAM_IPI_IMG_FMT_BAYER10_MIPI),
+	FMT_RAW(V4L2_PIX_FMT_SGBRG10P, MTKCAM_IPI_IMG_FMT_BAYER10_MIPI),
+	FMT_RAW(V4L2_PIX_FMT_SGRBG10P, MTKCAM_IPI_IMG_FMT_BAYER10_MIPI),
+	FMT_RAW(V4L2_PIX_FMT_SRGGB10P, MTKCAM_IPI_IMG_FMT_BAYER10_MIPI),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SBGGR10, MTKCAM_IPI_IMG_FMT_BAYER10),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SGBRG10, MTKCAM_IPI_IMG_FMT_BAYER10),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SGRBG10, MTKCAM_IPI_IMG_FMT_BAYER10),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SRGGB10, MTKCAM_IPI_IMG_FMT_BAYER10),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SBGGR10F, MTKCAM_IPI_IMG_FMT_FG_BAYER10),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SGBRG10F, MTKCAM_IPI_IMG_FMT_FG_BAYER10),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SGRBG10F, MTKCAM_IPI_IMG_FMT_FG_BAYER10),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SRGGB10F, MTKCAM_IPI_IMG_FMT_FG_BAYER10),
+	FMT_RAW(V4L2_PIX_FMT_SBGGR12, MTKCAM_IPI_IMG_FMT_BAYER12_UNPACKED),
+	FMT_RAW(V4L2_PIX_FMT_SGBRG12, MTKCAM_IPI_IMG_FMT_BAYER12_UNPACKED),
+	FMT_RAW(V4L2_PIX_FMT_SGRBG12, MTKCAM_IPI_IMG_FMT_BAYER12_UNPACKED),
+	FMT_RAW(V4L2_PIX_FMT_SRGGB12, MTKCAM_IPI_IMG_FMT_BAYER12_UNPACKED),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SBGGR12, MTKCAM_IPI_IMG_FMT_BAYER12),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SGBRG12, MTKCAM_IPI_IMG_FMT_BAYER12),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SGRBG12, MTKCAM_IPI_IMG_FMT_BAYER12),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SRGGB12, MTKCAM_IPI_IMG_FMT_BAYER12),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SBGGR12F, MTKCAM_IPI_IMG_FMT_FG_BAYER12),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SGBRG12F, MTKCAM_IPI_IMG_FMT_FG_BAYER12),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SGRBG12F, MTKCAM_IPI_IMG_FMT_FG_BAYER12),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SRGGB12F, MTKCAM_IPI_IMG_FMT_FG_BAYER12),
+	FMT_RAW(V4L2_PIX_FMT_SBGGR14, MTKCAM_IPI_IMG_FMT_BAYER14_UNPACKED),
+	FMT_RAW(V4L2_PIX_FMT_SGBRG14, MTKCAM_IPI_IMG_FMT_BAYER14_UNPACKED),
+	FMT_RAW(V4L2_PIX_FMT_SGRBG14, MTKCAM_IPI_IMG_FMT_BAYER14_UNPACKED),
+	FMT_RAW(V4L2_PIX_FMT_SRGGB14, MTKCAM_IPI_IMG_FMT_BAYER14_UNPACKED),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SBGGR14, MTKCAM_IPI_IMG_FMT_BAYER14),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SGBRG14, MTKCAM_IPI_IMG_FMT_BAYER14),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SGRBG14, MTKCAM_IPI_IMG_FMT_BAYER14),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SRGGB14, MTKCAM_IPI_IMG_FMT_BAYER14),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SBGGR14F, MTKCAM_IPI_IMG_FMT_FG_BAYER14),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SGBRG14F, MTKCAM_IPI_IMG_FMT_FG_BAYER14),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SGRBG14F, MTKCAM_IPI_IMG_FMT_FG_BAYER14),
+	FMT_RAW(V4L2_PIX_FMT_MTISP_SRGGB14F, MTKCAM_IPI_IMG_FMT_FG_BAYER14),
+	FMT_RAW(V4L2_PIX_FMT_SBGGR16, MTKCAM_IPI_IMG_FMT_BAYER16),
+	FMT_RAW(V4L2_PIX_FMT_SGBRG16, MTKCAM_IPI_IMG_FMT_BAYER16),
+	FMT_RAW(V4L2_PIX_FMT_SGRBG16, MTKCAM_IPI_IMG_FMT_BAYER16),
+	FMT_RAW(V4L2_PIX_FMT_SRGGB16, MTKCAM_IPI_IMG_FMT_BAYER16),
+	/* full-G 3 plane, no plane layout known */
+	{ .fourcc = V4L2_PIX_FMT_MTISP_SGRB8F,
+	  .ipi_fmt = MTKCAM_IPI_IMG_FMT_FG_BAYER8_3P,
+	  .flags = MTK_CAM_FMT_FULLG_RB },
+	{ .fourcc = V4L2_PIX_FMT_MTISP_SGRB10F,
+	  .ipi_fmt = MTKCAM_IPI_IMG_FMT_FG_BAYER10_3P_PACKED,
+	  .flags = MTK_CAM_FMT_FULLG_RB },
+	{ .fourcc = V4L2_PIX_FMT_MTISP_SGRB12F,
+	  .ipi_fmt = MTKCAM_IPI_IMG_FMT_FG_BAYER12_3P_PACKED,
+	  .flags = MTK_CAM_FMT_FULLG_RB },
+};
+
+/*
+ * fourcc -> descriptor, hash and displace: a key lands in bucket
+ * h(k, 0), every bucket carries a displacement d picked at init so that
+ * h(k, d + 1) of all its keys hit empty slots. Lookup is two hashes and
+ * one compare, whatever the fourcc values turn out to be.
+ */
+#define FMT_HASH_BUCKET_BITS	6
+#define FMT_HASH_BUCKETS	(1 << FMT_HASH_BUCKET_BITS)
+#define FMT_HASH_SLOTS		256
+#define FMT_HASH_BUCKET_MAX	16
+
+static u8 fmt_hash_disp[FMT_HASH_BUCKETS];
+/* descriptor index + 1, 0 is empty */
+static u8 fmt_hash_slot[FMT_HASH_SLOTS];
+static bool fmt_hash_ready;
+
+static inline u32 fmt_hash(u32 k, u32 seed)
+{
+	k ^= seed * 0x9e3779b9;
+	k ^= k >> 16;
+	k *= 0x85ebca6b;
+	k ^= k >> 13;
+	k *= 0xc2b2ae35;
+	k ^= k >> 16;
+
+	return k;
+}
+
+static inline u32 fmt_hash_bucket(u32 fourcc)
+{
+	return fmt_hash(fourcc, 0) >> (32 - FMT_HASH_BUCKET_BITS);
+}
+
+static inline u32 fmt_hash_pos(u32 fourcc, u32 disp)
+{
+	return fmt_hash(fourcc, disp + 1) & (FMT_HASH_SLOTS - 1);
+}
+
+static bool fmt_hash_place(const u8 *keys, int num)
+{
+	u32 b = fmt_hash_bucket(mtk_cam_fmt_descs[keys[0]].fourcc);
+	u32 pos[FMT_HASH_BUCKET_MAX];
+	u32 d;
+	int i, j;
+
+	for (d = 0; d < 256; d++) {
+		for (i = 0; i < num; i++) {
+			pos[i] = fmt_hash_pos(mtk_cam_fmt_descs[keys[i]].fourcc, d);
+			if (fmt_hash_slot[pos[i]])
+				break;
+			for (j = 0; j < i; j++)
+				if (pos[j] == pos[i])
+					break;
+			if (j < i)
+				break;
+		}
+		if (i < num)
+			continue;
+
+		fmt_hash_disp[b] = d;
+		for (i = 0; i < num; i++)
+			fmt_hash_slot[pos[i]] = keys[i] + 1;
+		return true;
+	}
+
+	return false;
+}
+
+int mtk_cam_fmt_desc_init(void)
+{
+	u8 cnt[FMT_HASH_BUCKETS] = {0};
+	u8 keys[FMT_HASH_BUCKET_MAX];
+	int i, b, n, size, max = 0;
+
+	BUILD_BUG_ON(ARRAY_SIZE(mtk_cam_fmt_descs) >= FMT_HASH_SLOTS);
+
+	fmt_hash_ready = false;
+	memset(fmt_hash_slot, 0, sizeof(fmt_hash_slot));
+
+	for (i = 0; i < ARRAY_SIZE(mtk_cam_fmt_descs); i++) {
+		b = fmt_hash_bucket(mtk_cam_fmt_descs[i].fourcc);
+		if (++cnt[b] > max)
+			max = cnt[b];
+	}
+	if (max > FMT_HASH_BUCKET_MAX)
+		goto fallback;
+
+	/* biggest buckets first, they are the hardest to place */
+	for (size = max; size > 0; size--) {
+		for (b = 0; b < FMT_HASH_BUCKETS; b++) {
+			if (cnt[b] != size)
+				continue;
+			for (i = 0, n = 0; i < ARRAY_SIZE(mtk_cam_fmt_descs); i++)
+				if (fmt_hash_bucket(mtk_cam_fmt_descs[i].fourcc) == b)
+					keys[n++] = i;
+			if (!fmt_hash_place(keys, n))
+				goto fallback;
+		}
+	}
+
+	fmt_hash_ready = true;
+	pr_debug("%s: %zu formats hashed, max bucket %d\n", __func__,
+		 ARRAY_SIZE(mtk_cam_fmt_descs), max);
+
+	return 0;
+
+fallback:
+	/* duplicated fourcc or unlucky values, lookups scan the table */
+	pr_info("%s: no perfect hash, fall back to linear lookup\n", __func__);
+
+	return -EINVAL;
+}
+
+const struct mtk_cam_fmt_desc *mtk_cam_fmt_desc_find(u32 fourcc)
+{
+	const struct mtk_cam_fmt_desc *desc;
+	unsigned int i;
+	u8 slot;
+
+	if (unlikely(!fmt_hash_ready)) {
+		for (i = 0; i < ARRAY_SIZE(mtk_cam_fmt_descs); i++)
+			if (mtk_cam_fmt_descs[i].fourcc == fourcc)
+				return &mtk_cam_fmt_descs[i];
+		return NULL;
+	}
+
+	slot = fmt_hash_slot[fmt_hash_pos(fourcc,
+					  fmt_hash_disp[fmt_hash_bucket(fourcc)])];
+	if (!slot)
+		return NULL;
+
+	desc = &mtk_cam_fmt_descs[slot - 1];
+
+	return desc->fourcc == fourcc ? desc : NULL;
+}
+
+/*
+ * Note
+ *	differt dma(fmt) would have different bus_size
+ *	align xsize(bytes per line) with [bus_size * pixel_mode]
+ */
+static int mtk_cam_fmt_dmao_xsize(int w, unsigned int ipi_fmt, int pixel_mode_shift)
+{
+	const struct mtk_cam_ipi_fmt_desc *ipi = mtk_cam_ipi_fmt_desc(ipi_fmt);
+	unsigned int bus_size;
+	int bpp, bytes;
+
+	if (!ipi || !ipi->pixel_bits)
+		return 0;
+
+	bpp = ipi->pixel_bits;
+	bus_size = ALIGN(bpp, 16) << pixel_mode_shift;
+	if (ipi->flags & MTK_CAM_IPI_FMT_FULLG) {
+		bytes = DIV_ROUND_UP(w * bpp * 3 / 2, 8);
+		bus_size <<= 1;
+	} else {
+		bytes = DIV_ROUND_UP(w * bpp, 8);
+	}
+
+	return ALIGN(bytes, (int)(bus_size / 8));
+}
+
+static int mtk_cam_fmt_fill_pixfmt_mp(const struct mtk_cam_fmt_desc *desc,
+				      struct v4l2_pix_format_mplane *pixfmt,
+				      u32 width, u32 height)
+{
+	const struct mtk_cam_ipi_fmt_desc *ipi =
+		mtk_cam_ipi_fmt_desc(desc->ipi_fmt);
+	const struct mtk_format_info *info = &desc->info;
+	struct v4l2_plane_pix_format *plane = &pixfmt->plane_fmt[0];
+	u32 stride, aligned_width, au_size;
+	u8 bus_size;
+	u8 i;
+
+	pixfmt->width = width;
+	pixfmt->height = height;
+	pixfmt->pixelformat = desc->fourcc;
+	plane->sizeimage = 0;
+
+	if (!(desc->flags & MTK_CAM_FMT_LAYOUT) || !ipi || !ipi->pixel_bits)
+		return -EINVAL;
+
+	pixfmt->num_planes = info->mem_planes;
+	if (info->mem_planes != 1) {
+		pr_debug("do not support non contiguous mplane\n");
+		return 0;
+	}
+
+	if (desc->flags & (MTK_CAM_FMT_YUV_UFO | MTK_CAM_FMT_RAW_UFO)) {
+		aligned_width = ALIGN(width, desc->ufo_align);
+		stride = aligned_width * info->bit_r_num / info->bit_r_den;
+		/* one length table byte per 64 pixel unit, padded to 8 */
+		au_size = ALIGN((aligned_width / 64), 8);
+
+		if (stride > plane->bytesperline)
+			plane->bytesperline = stride;
+		plane->sizeimage = stride * height + au_size * height +
+				   desc->ufo_hdr_size;
+		if (desc->flags & MTK_CAM_FMT_YUV_UFO)
+			plane->sizeimage += stride * height / 2 +
+					    au_size * height / 2;
+		goto out;
+	}
+
+	/* width should be bus_size align */
+	bus_size = ALIGN(ipi->pixel_bits, 32) / 8;
+	aligned_width = ALIGN(DIV_ROUND_UP(width * info->bit_r_num,
+					   info->bit_r_den), bus_size);
+	stride = aligned_width * info->bpp[0];
+
+	if (stride > plane->bytesperline)
+		plane->bytesperline = stride;
+
+	for (i = 0; i < info->comp_planes; i++) {
+		unsigned int hdiv = (i == 0) ? 1 : info->hdiv;
+		unsigned int vdiv = (i == 0) ? 1 : info->vdiv;
+
+		/* only mtk formats honour a wider user stride */
+		if ((desc->flags & MTK_CAM_FMT_MTK) &&
+		    plane->bytesperline > stride) {
+			if (desc->flags & MTK_CAM_FMT_FULLG_RB)
+				plane->sizeimage +=
+					DIV_ROUND_UP(plane->bytesperline, hdiv)
+					* DIV_ROUND_UP(height, vdiv);
+			else
+				plane->sizeimage += plane->bytesperline
+					* DIV_ROUND_UP(height, vdiv);
+		} else {
+			plane->sizeimage += info->bpp[i]
+				* DIV_ROUND_UP(aligned_width, hdiv)
+				* DIV_ROUND_UP(height, vdiv);
+		}
+	}
+
+out:
+	pr_debug("%s stride %d sizeimage %d\n", __func__,
+		 plane->bytesperline, plane->sizeimage);
+
+	return 0;
+}
+
+void mtk_cam_fmt_calc_pixfmt_mp(struct v4l2_pix_format_mplane *mp,
+				unsigned int pixel_mode_shift)
+{
+	const struct mtk_cam_fmt_desc *desc =
+		mtk_cam_fmt_desc_find(mp->pixelformat);
+	const struct mtk_cam_ipi_fmt_desc *ipi;
+	unsigned int stride, i;
+
+	if (!desc)
+		return;
+
+	pr_debug("fmt:0x%x ipi_fmt:%d\n", mp->pixelformat, desc->ipi_fmt);
+	ipi = mtk_cam_ipi_fmt_desc(desc->ipi_fmt);
+	if (!ipi)
+		return;
+
+	if (ipi->flags & MTK_CAM_IPI_FMT_DMAO) {
+		stride = mtk_cam_fmt_dmao_xsize(mp->width, desc->ipi_fmt,
+						pixel_mode_shift);
+		for (i = 0; i < mp->num_planes; i++) {
+			if (stride > mp->plane_fmt[i].bytesperline)
+				mp->plane_fmt[i].bytesperline = stride;
+			mp->plane_fmt[i].sizeimage =
+				mp->plane_fmt[i].bytesperline * mp->height;
+		}
+	} else if (ipi->flags & MTK_CAM_IPI_FMT_FILL) {
+		mtk_cam_fmt_fill_pixfmt_mp(desc, mp, mp->width, mp->height);
+	}
+}
@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Copyright (c) 2022 MediaTek Inc.
+ */
+
+#ifndef __MTK_CAM_FMT_DESC_H
+#define __MTK_CAM_FMT_DESC_H
+
+/*
+ * Precomputed format descriptors. Every fourcc camsys knows about has one
+ * entry holding its IPI format and plane layout; the per-IPI-format
+ * properties (pixel bits, mmqos factor, which stride rule applies) sit in
+ * a second table indexed by the dense mtkcam_ipi_fmt id. fourcc lookup is
+ * a perfect hash built once at init, so stride/size computation is a
+ * handful of arithmetic ops. Kept free of device state so it can be built
+ * on the host with -DFMT_DESC_UT.
+ */
+
+/* fmt-ut-test provides its own linux/types.h and linux/videodev2.h */
+#include <linux/types.h>
+#include <linux/videodev2.h>
+
+#include <common/mtk_cam-fmt.h>
+
+#define MTK_CAM_IPI_FMT_NUM		(MTKCAM_IPI_IMG_FMT_BAYER10_MIPI + 1)
+
+/* mtk_cam_fmt_desc.flags */
+#define MTK_CAM_FMT_MTK			(1 << 0) /* mtk_format_info layout */
+#define MTK_CAM_FMT_YUV_UFO		(1 << 1)
+#define MTK_CAM_FMT_RAW_UFO		(1 << 2)
+#define MTK_CAM_FMT_FULLG_RB		(1 << 3)
+#define MTK_CAM_FMT_LAYOUT		(1 << 4) /* info is valid */
+
+/* mtk_cam_ipi_fmt_desc.flags */
+#define MTK_CAM_IPI_FMT_FULLG		(1 << 0)
+#define MTK_CAM_IPI_FMT_DMAO		(1 << 1) /* stride from dmao xsize */
+#define MTK_CAM_IPI_FMT_FILL		(1 << 2) /* stride from plane layout */
+
+struct mtk_format_info {
+	u32 format;
+	u8 mem_planes;
+	u8 comp_planes;
+	u8 bpp[4];
+	u8 hdiv;
+	u8 vdiv;
+	/* numerator of bit ratio */
+	u8 bit_r_num;
+	/* denominator of bit ratio */
+	u8 bit_r_den;
+};
+
+struct mtk_cam_fmt_desc {
+	u32 fourcc;
+	s8 ipi_fmt;
+	u8 flags;
+	/* UFO: width alignment in pixels and UfbcBufferHeader size */
+	u8 ufo_align;
+	u16 ufo_hdr_size;
+	struct mtk_format_info info;
+};
+
+struct mtk_cam_ipi_fmt_desc {
+	u8 pixel_bits;	/* 0 if not supported */
+	u8 flags;
+	s16 size_factor; /* for mmqos and base is 100, -1 if unknown */
+};
+
+extern const struct mtk_cam_ipi_fmt_desc
+	mtk_cam_ipi_fmt_descs[MTK_CAM_IPI_FMT_NUM];
+
+int mtk_cam_fmt_desc_init(void);
+const struct mtk_cam_fmt_desc *mtk_cam_fmt_desc_find(u32 fourcc);
+
+static inline const struct mtk_cam_ipi_fmt_desc *
+mtk_cam_ipi_fmt_desc(unsigned int ipi_fmt)
+{
+	return ipi_fmt < MTK_CAM_IPI_FMT_NUM ?
+		&mtk_cam_ipi_fmt_descs[ipi_fmt] : NULL;
+}
+
+/* bytesperline and sizeimage of mp for its pixelformat, as try/s_fmt use */
+void mtk_cam_fmt_calc_pixfmt_mp(struct v4l2_pix_format_mplane *mp,
+				unsigned int pixel_mode_shift);
+
+#endif /*__MTK_CAM_FMT_DESC_H*/
@@ -0,0 +1,223 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Copyright (c) 2022 MediaTek Inc.
+ */
+
+#ifndef __MTK_CAM_IPI_TLV_H__
+#define __MTK_CAM_IPI_TLV_H__
+
+/*
+ * MTK_CAM_IPI_FRAME_FMT_TLV encoding of mtkcam_ipi_frame_param, see
+ * mtk_cam-ipi.h. A port is sent when any of its fields is set, so the
+ * decoded frame is the same as the full one. An image output only
+ * carries its subsample buffers up to the last one set.
+ *
+ * The decoder is for the composer side, it builds on the host as well.
+ */
+
+#ifdef __KERNEL__
+#include <linux/errno.h>
+#include <linux/string.h>
+#else
+#include <errno.h>
+#include <string.h>
+#endif
+
+#include "mtk_cam-ipi.h"
+
+/* the first byte is zero and all are equal, memcmp() is the fast one */
+static inline bool mtkcam_ipi_tlv_is_zero(const void *p, __u32 len)
+{
+	const __u8 *b = p;
+
+	return !len || (!b[0] && !memcmp(b, b + 1, len - 1));
+}
+
+/* add a record of @len bytes at @pos, NULL when it does not fit */
+static inline void *mtkcam_ipi_tlv_put(void *buf, __u32 size, __u32 *pos,
+				       __u8 type, __u8 idx, __u32 len)
+{
+	struct mtkcam_ipi_tlv *tlv = (struct mtkcam_ipi_tlv *)((__u8 *)buf + *pos);
+
+	if (*pos + sizeof(*tlv) + len > size)
+		return NULL;
+
+	tlv->type = type;
+	tlv->idx = idx;
+	tlv->len = len;
+	*pos += sizeof(*tlv) + len;
+
+	return tlv->value;
+}
+
+static inline __u32
+mtkcam_ipi_img_output_n_bufs(const struct mtkcam_ipi_img_output *out)
+{
+	__u32 n;
+
+	if (mtkcam_ipi_tlv_is_zero(out->buf, sizeof(out->buf)))
+		return 0;
+
+	for (n = CAM_MAX_SUBSAMPLE; n; n--)
+		if (!mtkcam_ipi_tlv_is_zero(out->buf[n - 1], sizeof(out->buf[0])))
+			break;
+
+	return n;
+}
+
+/* encode @fp into @buf, returns the frame size or 0 when over @size */
+static inline __u32
+mtkcam_ipi_frame_tlv_encode(void *buf, __u32 size,
+			    const struct mtkcam_ipi_frame_param *fp)
+{
+	struct mtkcam_ipi_frame_tlv_hdr *hdr = buf;
+	__u32 pos = sizeof(*hdr);
+	__u16 n_tlvs = 0;
+	void *v;
+	int i;
+
+	if (size < sizeof(*hdr))
+		return 0;
+
+	for (i = 0; i < CAM_MAX_IMAGE_INPUT; i++) {
+		const struct mtkcam_ipi_img_input *in = &fp->img_ins[i];
+
+		if (mtkcam_ipi_tlv_is_zero(in, sizeof(*in)))
+			continue;
+
+		v = mtkcam_ipi_tlv_put(buf, size, &pos, MTKCAM_IPI_TLV_IMG_IN,
+				       i, sizeof(*in));
+		if (!v)
+			return 0;
+		memcpy(v, in, sizeof(*in));
+		n_tlvs++;
+	}
+
+	for (i = 0; i < CAM_MAX_IMAGE_OUTPUT; i++) {
+		const struct mtkcam_ipi_img_output *out = &fp->img_outs[i];
+		struct mtkcam_ipi_img_output_tlv *t;
+		__u32 n_bufs = mtkcam_ipi_img_output_n_bufs(out);
+
+		if (!n_bufs && out->uid.id == 0 && out->uid.pipe_id == 0 &&
+		    mtkcam_ipi_tlv_is_zero(&out->fmt, sizeof(out->fmt)) &&
+		    mtkcam_ipi_tlv_is_zero(&out->crop, sizeof(out->crop)))
+			continue;
+
+		t = mtkcam_ipi_tlv_put(buf, size, &pos, MTKCAM_IPI_TLV_IMG_OUT,
+				       i, sizeof(*t) + n_bufs * sizeof(t->buf[0]));
+		if (!t)
+			return 0;
+		t->uid = out->uid;
+		t->fmt = out->fmt;
+		t->crop = out->crop;
+		t->n_bufs = n_bufs;
+		memcpy(t->buf, out->buf, n_bufs * sizeof(t->buf[0]));
+		n_tlvs++;
+	}
+
+	for (i = 0; i < CAM_MAX_PIPE_USED; i++) {
+		const struct mtkcam_ipi_meta_input *in = &fp->meta_inputs[i];
+
+		if (mtkcam_ipi_tlv_is_zero(in, sizeof(*in)))
+			continue;
+
+		v = mtkcam_ipi_tlv_put(buf, size, &pos, MTKCAM_IPI_TLV_META_IN,
+				       i, sizeof(*in));
+		if (!v)
+			return 0;
+		memcpy(v, in, sizeof(*in));
+		n_tlvs++;
+	}
+
+	for (i = 0; i < CAM_MAX_META_OUTPUT; i++) {
+		const struct mtkcam_ipi_meta_output *out = &fp->meta_outputs[i];
+
+		if (mtkcam_ipi_tlv_is_zero(out, sizeof(*out)))
+			continue;
+
+		v = mtkcam_ipi_tlv_put(buf, size, &pos, MTKCAM_IPI_TLV_META_OUT,
+				       i, sizeof(*out));
+		if (!v)
+			return 0;
+		memcpy(v, out, sizeof(*out));
+		n_tlvs++;
+	}
+
+	hdr->cur_workbuf_offset = fp->cur_workbuf_offset;
+	hdr->cur_workbuf_size = fp->cur_workbuf_size;
+	hdr->raw_param = fp->raw_param;
+	hdr->n_tlvs = n_tlvs;
+	hdr->size = pos;
+
+	return pos;
+}
+
+/* decode the frame in @buf of @size bytes into @fp */
+static inline int
+mtkcam_ipi_frame_tlv_decode(struct mtkcam_ipi_frame_param *fp,
+			    const void *buf, __u32 size)
+{
+	const struct mtkcam_ipi_frame_tlv_hdr *hdr = buf;
+	const struct mtkcam_ipi_tlv *tlv;
+	const struct mtkcam_ipi_img_output_tlv *t;
+	__u32 pos = sizeof(*hdr);
+	int i;
+
+	if (size < sizeof(*hdr) || hdr->size < sizeof(*hdr) ||
+	    hdr->size > size)
+		return -EINVAL;
+
+	memset(fp, 0, sizeof(*fp));
+	fp->cur_workbuf_offset = hdr->cur_workbuf_offset;
+	fp->cur_workbuf_size = hdr->cur_workbuf_size;
+	fp->raw_param = hdr->raw_param;
+
+	for (i = 0; i < hdr->n_tlvs; i++) {
+		tlv = (const struct mtkcam_ipi_tlv *)((const __u8 *)buf + pos);
+		if (pos + sizeof(*tlv) > hdr->size ||
+		    pos + sizeof(*tlv) + tlv->len > hdr->size)
+			return -EINVAL;
+		pos += sizeof(*tlv) + tlv->len;
+
+		switch (tlv->type) {
+		case MTKCAM_IPI_TLV_IMG_IN:
+			if (tlv->idx >= CAM_MAX_IMAGE_INPUT ||
+			    tlv->len != sizeof(fp->img_ins[0]))
+				return -EINVAL;
+			memcpy(&fp->img_ins[tlv->idx], tlv->value, tlv->len);
+			break;
+		case MTKCAM_IPI_TLV_IMG_OUT:
+			t = (const struct mtkcam_ipi_img_output_tlv *)tlv->value;
+			if (tlv->idx >= CAM_MAX_IMAGE_OUTPUT ||
+			    tlv->len < sizeof(*t) ||
+			    t->n_bufs > CAM_MAX_SUBSAMPLE ||
+			    tlv->len != sizeof(*t) + t->n_bufs * sizeof(t->buf[0]))
+				return -EINVAL;
+			fp->img_outs[tlv->idx].uid = t->uid;
+			fp->img_outs[tlv->idx].fmt = t->fmt;
+			fp->img_outs[tlv->idx].crop = t->crop;
+			memcpy(fp->img_outs[tlv->idx].buf, t->buf,
+			       t->n_bufs * sizeof(t->buf[0]));
+			break;
+		case MTKCAM_IPI_TLV_META_IN:
+			if (tlv->idx >= CAM_MAX_PIPE_USED ||
+			    tlv->len != sizeof(fp->meta_inputs[0]))
+				return -EINVAL;
+			memcpy(&fp->meta_inputs[tlv->idx], tlv->value, tlv->len);
+			break;
+		case MTKCAM_IPI_TLV_META_OUT:
+			if (tlv->idx >= CAM_MAX_META_OUTPUT ||
+			    tlv->len != sizeof(fp->meta_outputs[0]))
+				return -EINVAL;
+			memcpy(&fp->meta_outputs[tlv->idx], tlv->value, tlv->len);
+			break;
+		default:
+			/* unknown records are skipped */
+			break;
+		}
+	}
+
+	return 0;
+}
+
+#endif /* __MTK_CAM_IPI_TLV_H__ */
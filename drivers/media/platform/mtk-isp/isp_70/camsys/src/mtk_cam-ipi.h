@@ -189,9 +189,17 @@ struct mtkcam_ipi_session_cookie {
 	__u32 frame_no;
 } __attribute__ ((__packed__));
 
+/*
+ * Capabilities offered in mtkcam_ipi_session_param.caps. A composer
+ * supporting some of them acks CAM_CMD_CREATE_SESSION with the accepted
+ * ones in mtkcam_ipi_ack_info.caps, older ones do not ack it at all.
+ */
+#define MTK_CAM_IPI_CAP_FRAME_TLV	0x0001 /* MTK_CAM_IPI_FRAME_FMT_TLV */
+
 struct mtkcam_ipi_session_param {
 	struct mtkcam_ipi_sw_buffer workbuf;
 	struct mtkcam_ipi_sw_buffer msg_buf;
+	__u32 caps;
 } __attribute__ ((__packed__));
 
 struct mtkcam_ipi_hw_mapping {
@@ -233,9 +241,52 @@ struct mtkcam_ipi_frame_param {
 	struct mtkcam_ipi_meta_input meta_inputs[CAM_MAX_PIPE_USED];
 } __attribute__ ((__packed__));
 
+/*
+ * Compact frame, sent with MTK_CAM_IPI_FRAME_FMT_TLV once the composer
+ * accepted MTK_CAM_IPI_CAP_FRAME_TLV: the msg buffer holds a
+ * mtkcam_ipi_frame_tlv_hdr followed by n_tlvs records, one per port in
+ * use. The ports left out are zero in the mtkcam_ipi_frame_param of the
+ * frame.
+ */
+struct mtkcam_ipi_frame_tlv_hdr {
+	__u32 cur_workbuf_offset;
+	__u32 cur_workbuf_size;
+	struct mtkcam_ipi_raw_frame_param raw_param;
+	__u16 n_tlvs;
+	__u32 size; /* of the frame, header included */
+} __attribute__ ((__packed__));
+
+enum mtkcam_ipi_frame_tlv_type {
+	MTKCAM_IPI_TLV_IMG_IN = 1,	/* mtkcam_ipi_img_input */
+	MTKCAM_IPI_TLV_IMG_OUT,		/* mtkcam_ipi_img_output_tlv */
+	MTKCAM_IPI_TLV_META_IN,		/* mtkcam_ipi_meta_input */
+	MTKCAM_IPI_TLV_META_OUT,	/* mtkcam_ipi_meta_output */
+};
+
+struct mtkcam_ipi_tlv {
+	__u8 type;
+	__u8 idx; /* in the array of mtkcam_ipi_frame_param */
+	__u16 len; /* of value */
+	__u8 value[];
+} __attribute__ ((__packed__));
+
+/* mtkcam_ipi_img_output with the first n_bufs subsample buffers only */
+struct mtkcam_ipi_img_output_tlv {
+	struct mtkcam_ipi_uid		uid;
+	struct mtkcam_ipi_pix_fmt	fmt;
+	struct mtkcam_ipi_crop		crop;
+	__u8				n_bufs;
+	struct mtkcam_ipi_sw_buffer	buf[][CAM_MAX_PLANENUM];
+} __attribute__ ((__packed__));
+
+/* layout of the frame in the msg buffer */
+#define MTK_CAM_IPI_FRAME_FMT_FULL	0 /* mtkcam_ipi_frame_param */
+#define MTK_CAM_IPI_FRAME_FMT_TLV	1 /* mtkcam_ipi_frame_tlv_hdr */
+
 struct mtkcam_ipi_frame_info {
 	__u32	cur_msgbuf_offset;
 	__u32	cur_msgbuf_size;
+	__u8	fmt;
 } __attribute__ ((__packed__));
 
 struct mtkcam_ipi_frame_ack_result {
@@ -248,7 +299,11 @@ struct mtkcam_ipi_frame_ack_result {
 struct mtkcam_ipi_ack_info {
 	__u8 ack_cmd_id;
 	__s32 ret;
-	struct mtkcam_ipi_frame_ack_result frame_result;
+	union {
+		struct mtkcam_ipi_frame_ack_result frame_result;
+		/* accepted MTK_CAM_IPI_CAP_*, CAM_CMD_CREATE_SESSION */
+		__u32 caps;
+	};
 } __attribute__ ((__packed__));
 
 /*
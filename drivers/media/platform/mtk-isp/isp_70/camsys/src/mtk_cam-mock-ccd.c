@@ -0,0 +1,229 @@
+// SPDX-License-Identifier: GPL-2.0
+//
+// Copyright (c) 2022 MediaTek Inc.
+
+#include <linux/delay.h>
+#include <linux/kthread.h>
+#include <linux/module.h>
+#include <linux/platform_data/mtk_ccd.h>
+#include <linux/remoteproc.h>
+#include <linux/sched/signal.h>
+#include <linux/slab.h>
+#include <linux/mtk_ccd_controls.h>
+
+#include "mtk_cam.h"
+#include "mtk_cam-mock-ccd.h"
+
+static bool mock_ccd;
+module_param(mock_ccd, bool, 0644);
+MODULE_PARM_DESC(mock_ccd, "ack the composer IPI in the kernel, without the CCD daemon");
+
+static unsigned int mock_ccd_caps = MTK_CAM_IPI_CAP_FRAME_TLV;
+module_param(mock_ccd_caps, uint, 0644);
+MODULE_PARM_DESC(mock_ccd_caps, "MTK_CAM_IPI_CAP_* the mock composer accepts");
+
+static unsigned int mock_ccd_latency_us;
+module_param(mock_ccd_latency_us, uint, 0644);
+MODULE_PARM_DESC(mock_ccd_latency_us, "mock composer delay before each ack");
+
+static unsigned int mock_ccd_fail_every;
+module_param(mock_ccd_fail_every, uint, 0644);
+MODULE_PARM_DESC(mock_ccd_fail_every, "mock composer acks every n-th frame with an error, 0 never");
+
+static unsigned int mock_ccd_drop_every;
+module_param(mock_ccd_drop_every, uint, 0644);
+MODULE_PARM_DESC(mock_ccd_drop_every, "mock composer never acks every n-th frame, 0 never");
+
+/* wait for the endpoint of a worker to be created */
+#define MOCK_CCD_IDLE_MS	10
+
+struct mtk_cam_mock_ccd_dev;
+
+struct mtk_cam_mock_ccd_worker {
+	struct mtk_cam_mock_ccd_dev *mdev;
+	unsigned int src;
+	struct task_struct *task;
+	struct mtk_cam_mock_ccd m;
+	struct ccd_worker_item item;
+};
+
+struct mtk_cam_mock_ccd_dev {
+	struct mtk_cam_device *cam;
+	struct mtk_ccd *ccd;
+	struct task_struct *master;
+	unsigned int listened;
+	struct mtk_cam_mock_ccd_worker workers[MTK_CAM_MOCK_CCD_WORKERS];
+};
+
+/*
+ * The SIGKILL that ended the loop stays pending and would wake an
+ * interruptible sleep at once, so wait for kthread_stop() in TASK_IDLE.
+ */
+static void mtk_cam_mock_ccd_wait_stop(void)
+{
+	while (!kthread_should_stop())
+		schedule_timeout_idle(msecs_to_jiffies(MOCK_CCD_IDLE_MS));
+}
+
+/* consume the endpoint create and destroy, or they would block */
+static int mtk_cam_mock_ccd_master(void *data)
+{
+	struct mtk_cam_mock_ccd_dev *mdev = data;
+	struct ccd_master_listen_item listen;
+
+	allow_signal(SIGKILL);
+
+	while (!kthread_should_stop()) {
+		memset(&listen, 0, sizeof(listen));
+		ccd_master_listen(mdev->ccd, &listen);
+		if (signal_pending(current))
+			break;
+
+		dev_dbg(mdev->cam->dev, "%s: src:%u cmd:%u %s\n", __func__,
+			listen.src, listen.cmd, listen.name);
+		mdev->listened++;
+	}
+
+	mtk_cam_mock_ccd_wait_stop();
+
+	return 0;
+}
+
+static int mtk_cam_mock_ccd_work(void *data)
+{
+	struct mtk_cam_mock_ccd_worker *w = data;
+	struct mtk_cam_mock_ccd_dev *mdev = w->mdev;
+	struct ccd_worker_item *item = &w->item;
+	struct mtkcam_ipi_event ack;
+
+	allow_signal(SIGKILL);
+
+	while (!kthread_should_stop()) {
+		/* nothing is copied back when there is no message */
+		item->src = w->src;
+		item->len = 0;
+		ccd_worker_read(mdev->ccd, item);
+		if (signal_pending(current))
+			break;
+
+		if (!item->len) {
+			schedule_timeout_interruptible(msecs_to_jiffies(MOCK_CCD_IDLE_MS));
+			continue;
+		}
+
+		if (!mtk_cam_mock_ccd_reply(&w->m, item->sbuf, item->len, &ack))
+			continue;
+
+		if (w->m.cfg.latency_us)
+			usleep_range(w->m.cfg.latency_us, w->m.cfg.latency_us + 10);
+
+		memcpy(item->sbuf, &ack, sizeof(ack));
+		item->len = sizeof(ack);
+		ccd_worker_write(mdev->ccd, item);
+	}
+
+	mtk_cam_mock_ccd_wait_stop();
+
+	return 0;
+}
+
+static void mtk_cam_mock_ccd_kill(struct task_struct *task)
+{
+	if (!task)
+		return;
+
+	send_sig(SIGKILL, task, 1);
+	kthread_stop(task);
+}
+
+int mtk_cam_mock_ccd_start(struct mtk_cam_device *cam)
+{
+	struct mtk_cam_mock_ccd_dev *mdev;
+	struct mtk_cam_mock_ccd_cfg cfg;
+	int i, ret;
+
+	if (!READ_ONCE(mock_ccd) || cam->mock_ccd)
+		return 0;
+
+	mdev = kzalloc(sizeof(*mdev), GFP_KERNEL);
+	if (!mdev)
+		return -ENOMEM;
+
+	mdev->cam = cam;
+	mdev->ccd = cam->rproc_handle->priv;
+
+	cfg.caps = READ_ONCE(mock_ccd_caps);
+	cfg.latency_us = READ_ONCE(mock_ccd_latency_us);
+	cfg.fail_every = READ_ONCE(mock_ccd_fail_every);
+	cfg.drop_every = READ_ONCE(mock_ccd_drop_every);
+
+	mdev->master = kthread_run(mtk_cam_mock_ccd_master, mdev,
+				   "mtk_cam_mock_ccd");
+	if (IS_ERR(mdev->master)) {
+		ret = PTR_ERR(mdev->master);
+		mdev->master = NULL;
+		goto fail_stop;
+	}
+
+	for (i = 0; i < MTK_CAM_MOCK_CCD_WORKERS; i++) {
+		struct mtk_cam_mock_ccd_worker *w = &mdev->workers[i];
+
+		w->mdev = mdev;
+		w->src = CCD_IPI_ISP_MAIN + i;
+		w->m.cfg = cfg;
+		w->task = kthread_run(mtk_cam_mock_ccd_work, w,
+				      "mtk_cam_mock_ccd-%u", w->src);
+		if (IS_ERR(w->task)) {
+			ret = PTR_ERR(w->task);
+			w->task = NULL;
+			goto fail_stop;
+		}
+	}
+
+	cam->mock_ccd = mdev;
+
+	dev_info(cam->dev, "mock composer: caps 0x%x, latency %u us, fail every %u, drop every %u\n",
+		 cfg.caps, cfg.latency_us, cfg.fail_every, cfg.drop_every);
+
+	return 0;
+
+fail_stop:
+	for (i = 0; i < MTK_CAM_MOCK_CCD_WORKERS; i++)
+		mtk_cam_mock_ccd_kill(mdev->workers[i].task);
+	mtk_cam_mock_ccd_kill(mdev->master);
+	kfree(mdev);
+	dev_info(cam->dev, "failed to start mock composer:%d\n", ret);
+
+	return ret;
+}
+
+void mtk_cam_mock_ccd_stop(struct mtk_cam_device *cam)
+{
+	struct mtk_cam_mock_ccd_dev *mdev = cam->mock_ccd;
+	int i;
+
+	if (!mdev)
+		return;
+
+	for (i = 0; i < MTK_CAM_MOCK_CCD_WORKERS; i++) {
+		struct mtk_cam_mock_ccd_worker *w = &mdev->workers[i];
+		struct mtk_cam_mock_ccd_stats *s = &w->m.stats;
+
+		mtk_cam_mock_ccd_kill(w->task);
+		if (!s->sessions && !s->frames)
+			continue;
+
+		dev_info(cam->dev,
+			 "mock composer %u: session %u config %u frame %u (tlv %u failed %u dropped %u) destroy %u unknown %u\n",
+			 w->src, s->sessions, s->configs, s->frames,
+			 s->tlv_frames, s->failed, s->dropped, s->destroyed,
+			 s->unknown);
+	}
+	mtk_cam_mock_ccd_kill(mdev->master);
+
+	dev_dbg(cam->dev, "mock composer: %u endpoints listened\n",
+		mdev->listened);
+
+	cam->mock_ccd = NULL;
+	kfree(mdev);
+}
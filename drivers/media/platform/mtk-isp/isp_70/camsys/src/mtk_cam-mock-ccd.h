@@ -0,0 +1,149 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Copyright (c) 2022 MediaTek Inc.
+ */
+
+#ifndef __MTK_CAM_MOCK_CCD_H
+#define __MTK_CAM_MOCK_CCD_H
+
+/*
+ * Mock composer, answering the camsys IPI in place of the CCD daemon.
+ *
+ * The daemon side of the protocol is kept here: CAM_CMD_CREATE_SESSION
+ * is acked with the offered capabilities found in caps, if any,
+ * CAM_CMD_CONFIG is taken silently, CAM_CMD_FRAME and
+ * CAM_CMD_DESTROY_SESSION are acked. Nothing is composed, the frame acks
+ * carry an empty CQ. Faults are injected on frames: every fail_every-th
+ * one is acked with an error, every drop_every-th one is never acked.
+ * The transports apply latency_us before each ack.
+ *
+ * Two transports drive it over the mtk_ccd endpoints, the same way as the
+ * daemon: a master loop consuming the listen objects and a worker loop
+ * per composer ipi id reading the messages and writing the acks back.
+ *  - mtk_cam-mock-ccd.c runs them as kthreads with mock_ccd set, through
+ *    ccd_master_listen(), ccd_worker_read() and ccd_worker_write().
+ *  - mock-ccd/ is a userspace program doing the same through the
+ *    IOCTL_CCD_MASTER_LISTEN and IOCTL_CCD_WORKER_READ/WRITE ioctls.
+ * Only one of them, or the daemon, may serve the CCD at a time.
+ *
+ * The protocol part is built on the host with -DMOCK_CCD_HOST, see
+ * mock-ccd and mock-ccd-ut-test.
+ */
+
+#ifdef MOCK_CCD_HOST
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+#else
+#include <linux/errno.h>
+#include <linux/string.h>
+#endif
+
+#include "mtk_cam-ipi.h"
+
+/* composer ipi ids served, CCD_IPI_ISP_MAIN to CCD_IPI_ISP_TRICAM */
+#define MTK_CAM_MOCK_CCD_WORKERS	3
+
+struct mtk_cam_mock_ccd_cfg {
+	u32 caps;	/* MTK_CAM_IPI_CAP_* accepted */
+	u32 latency_us;
+	u32 fail_every;
+	u32 drop_every;
+};
+
+struct mtk_cam_mock_ccd_stats {
+	u32 sessions;
+	u32 configs;
+	u32 frames;
+	u32 tlv_frames;
+	u32 failed;
+	u32 dropped;
+	u32 destroyed;
+	u32 unknown;
+};
+
+/* one per ipi id, only touched by its worker */
+struct mtk_cam_mock_ccd {
+	struct mtk_cam_mock_ccd_cfg cfg;
+	struct mtk_cam_mock_ccd_stats stats;
+};
+
+static inline void
+mtk_cam_mock_ccd_ack(struct mtkcam_ipi_event *ack,
+		     const struct mtkcam_ipi_session_cookie *cookie,
+		     u8 ack_cmd_id, s32 ret)
+{
+	memset(ack, 0, sizeof(*ack));
+	ack->cmd_id = CAM_CMD_ACK;
+	ack->cookie = *cookie;
+	ack->ack_data.ack_cmd_id = ack_cmd_id;
+	ack->ack_data.ret = ret;
+}
+
+/*
+ * Handle the @len bytes message @buf. Returns true with @ack filled when
+ * it must be answered.
+ */
+static inline bool mtk_cam_mock_ccd_reply(struct mtk_cam_mock_ccd *m,
+					  const void *buf, u32 len,
+					  struct mtkcam_ipi_event *ack)
+{
+	struct mtkcam_ipi_event ev;
+	s32 ret = 0;
+
+	if (len < offsetof(struct mtkcam_ipi_event, cmd_id) + 1) {
+		m->stats.unknown++;
+		return false;
+	}
+
+	memset(&ev, 0, sizeof(ev));
+	memcpy(&ev, buf, len < sizeof(ev) ? len : sizeof(ev));
+
+	switch (ev.cmd_id) {
+	case CAM_CMD_CREATE_SESSION:
+		m->stats.sessions++;
+		if (!(ev.session_data.caps & m->cfg.caps))
+			return false;
+		mtk_cam_mock_ccd_ack(ack, &ev.cookie, CAM_CMD_CREATE_SESSION, 0);
+		ack->ack_data.caps = ev.session_data.caps & m->cfg.caps;
+		return true;
+	case CAM_CMD_CONFIG:
+		m->stats.configs++;
+		return false;
+	case CAM_CMD_FRAME:
+		m->stats.frames++;
+		if (ev.frame_data.fmt == MTK_CAM_IPI_FRAME_FMT_TLV)
+			m->stats.tlv_frames++;
+		if (m->cfg.drop_every &&
+		    !(m->stats.frames % m->cfg.drop_every)) {
+			m->stats.dropped++;
+			return false;
+		}
+		if (m->cfg.fail_every &&
+		    !(m->stats.frames % m->cfg.fail_every)) {
+			m->stats.failed++;
+			ret = -EIO;
+		}
+		mtk_cam_mock_ccd_ack(ack, &ev.cookie, CAM_CMD_FRAME, ret);
+		return true;
+	case CAM_CMD_DESTROY_SESSION:
+		m->stats.destroyed++;
+		mtk_cam_mock_ccd_ack(ack, &ev.cookie, CAM_CMD_DESTROY_SESSION, 0);
+		return true;
+	default:
+		m->stats.unknown++;
+		return false;
+	}
+}
+
+#ifndef MOCK_CCD_HOST
+struct mtk_cam_device;
+
+/* serve the CCD of @cam when mock_ccd is set, after rproc_boot() */
+int mtk_cam_mock_ccd_start(struct mtk_cam_device *cam);
+
+/* before rproc_shutdown() */
+void mtk_cam_mock_ccd_stop(struct mtk_cam_device *cam);
+#endif
+
+#endif /*__MTK_CAM_MOCK_CCD_H*/
@@ -10,10 +10,13 @@
 #include <linux/dma-mapping.h>
 #include <linux/dma-buf.h>
 #include <linux/mm.h>
+#include <linux/module.h>
 #include <linux/remoteproc.h>
 #include <linux/spinlock.h>
+#include <linux/timekeeping.h>
 
 #include "mtk_cam.h"
+#include "mtk_cam-feature.h"
 #include "mtk_cam-smem.h"
 #include "mtk_cam-pool.h"
 
@@ -24,6 +27,58 @@
 #include <uapi/linux/mtk_ccd_controls.h>
 #endif
 
+static unsigned int cq_buf_depth = MTK_CAM_MAX_RUNNING_JOBS + 1;
+module_param(cq_buf_depth, uint, 0644);
+MODULE_PARM_DESC(cq_buf_depth, "cq buffers of a single-exposure stream, scaled by the feature at stream-on, 0 all");
+
+static bool cq_buf_grow = true;
+module_param(cq_buf_grow, bool, 0644);
+MODULE_PARM_DESC(cq_buf_grow, "take cq buffers over the stream-on depth from the reserve");
+
+static void buf_pool_stats_reset(struct mtk_cam_buf_pool_stats *s, u32 size)
+{
+	u32 in_use = s->in_use;
+
+	memset(s, 0, sizeof(*s));
+	s->size = size;
+	s->in_use = in_use;
+	s->hwm = in_use;
+}
+
+/* the clock is only read when the pool runs empty and is refilled */
+static void buf_pool_stats_get(struct mtk_cam_buf_pool_stats *s, u32 free_cnt)
+{
+	if (++s->in_use > s->hwm)
+		s->hwm = s->in_use;
+	if (!free_cnt && !s->empty_ts)
+		s->empty_ts = ktime_get_ns();
+}
+
+static void buf_pool_stats_put(struct mtk_cam_buf_pool_stats *s)
+{
+	if (s->empty_ts) {
+		s->empty_ns += ktime_get_ns() - s->empty_ts;
+		s->empty_ts = 0;
+	}
+	if (s->in_use)
+		s->in_use--;
+}
+
+static int buf_pool_stats_show(char *buf, int size, const char *name,
+			       const struct mtk_cam_buf_pool_stats *s,
+			       u32 reserve_cnt)
+{
+	u64 empty_ns = s->empty_ns;
+
+	if (s->empty_ts)
+		empty_ns += ktime_get_ns() - s->empty_ts;
+
+	return scnprintf(buf, size,
+			 "%s: size %u in_use %u hwm %u reserve %u exhausted %u grown %u empty_us %llu\n",
+			 name, s->size, s->in_use, s->hwm, reserve_cnt,
+			 s->exhausted, s->grown, div_u64(empty_ns, 1000));
+}
+
 int mtk_cam_working_buf_pool_init(struct mtk_cam_ctx *ctx)
 {
 	int i;
@@ -35,8 +90,12 @@ int mtk_cam_working_buf_pool_init(struct mtk_cam_ctx *ctx)
 	const int msg_buf_size = round_up(IPI_FRAME_BUF_SIZE, PAGE_SIZE);
 
 	INIT_LIST_HEAD(&ctx->buf_pool.cam_freelist.list);
+	INIT_LIST_HEAD(&ctx->buf_pool.cam_freelist.reserve);
 	spin_lock_init(&ctx->buf_pool.cam_freelist.lock);
 	ctx->buf_pool.cam_freelist.cnt = 0;
+	ctx->buf_pool.cam_freelist.reserve_cnt = 0;
+	memset(&ctx->buf_pool.cam_freelist.stats, 0,
+	       sizeof(ctx->buf_pool.cam_freelist.stats));
 	ctx->buf_pool.working_buf_size = CAM_CQ_BUF_NUM * working_buf_size;
 	ctx->buf_pool.msg_buf_size = CAM_CQ_BUF_NUM * msg_buf_size;
 	ccd = (struct mtk_ccd *)ctx->cam->rproc_handle->priv;
@@ -96,6 +155,7 @@ int mtk_cam_working_buf_pool_init(struct mtk_cam_ctx *ctx)
 		list_add_tail(&buf->list_entry, &ctx->buf_pool.cam_freelist.list);
 		ctx->buf_pool.cam_freelist.cnt++;
 	}
+	ctx->buf_pool.cam_freelist.stats.size = CAM_CQ_BUF_NUM;
 
 	dev_info(ctx->cam->dev,
 		"%s: ctx(%d): cq buffers init, freebuf cnt(%d),fd(%d)\n",
@@ -168,6 +228,7 @@ mtk_cam_working_buf_put(struct mtk_cam_working_buf_entry *buf_entry)
 	list_add_tail(&buf_entry->list_entry,
 		      &ctx->buf_pool.cam_freelist.list);
 	cnt = ++ctx->buf_pool.cam_freelist.cnt;
+	buf_pool_stats_put(&ctx->buf_pool.cam_freelist.stats);
 
 	spin_unlock(&ctx->buf_pool.cam_freelist.lock);
 
@@ -178,27 +239,38 @@ mtk_cam_working_buf_put(struct mtk_cam_working_buf_entry *buf_entry)
 struct mtk_cam_working_buf_entry*
 mtk_cam_working_buf_get(struct mtk_cam_ctx *ctx)
 {
+	struct mtk_cam_working_buf_list *freelist = &ctx->buf_pool.cam_freelist;
 	struct mtk_cam_working_buf_entry *buf_entry;
 	int cnt;
 
 	/* get from free list */
-	spin_lock(&ctx->buf_pool.cam_freelist.lock);
-	if (list_empty(&ctx->buf_pool.cam_freelist.list)) {
-		spin_unlock(&ctx->buf_pool.cam_freelist.lock);
-
-		dev_info(ctx->cam->dev, "%s:ctx(%d):no free buf\n",
-			 __func__, ctx->stream_id);
-		return NULL;
+	spin_lock(&freelist->lock);
+	if (list_empty(&freelist->list)) {
+		/* the entry taken from the reserve stays in the pool */
+		if (!freelist->reserve_cnt || !READ_ONCE(cq_buf_grow)) {
+			freelist->stats.exhausted++;
+			spin_unlock(&freelist->lock);
+
+			dev_info(ctx->cam->dev, "%s:ctx(%d):no free buf\n",
+				 __func__, ctx->stream_id);
+			return NULL;
+		}
+		list_move_tail(freelist->reserve.next, &freelist->list);
+		freelist->reserve_cnt--;
+		freelist->cnt++;
+		freelist->stats.size++;
+		freelist->stats.grown++;
 	}
 
-	buf_entry = list_first_entry(&ctx->buf_pool.cam_freelist.list,
+	buf_entry = list_first_entry(&freelist->list,
 				     struct mtk_cam_working_buf_entry,
 				     list_entry);
 	list_del(&buf_entry->list_entry);
-	cnt = --ctx->buf_pool.cam_freelist.cnt;
+	cnt = --freelist->cnt;
 	buf_entry->ctx = ctx;
+	buf_pool_stats_get(&freelist->stats, cnt);
 
-	spin_unlock(&ctx->buf_pool.cam_freelist.lock);
+	spin_unlock(&freelist->lock);
 
 	dev_dbg(ctx->cam->dev, "%s:ctx(%d):iova(%pad), free cnt(%d)\n",
 		__func__, ctx->stream_id, &buf_entry->buffer.iova, cnt);
@@ -206,6 +278,63 @@ mtk_cam_working_buf_get(struct mtk_cam_ctx *ctx)
 	return buf_entry;
 }
 
+/* cq buffers in flight for the feature of the stream */
+static u32 mtk_cam_working_buf_depth(struct mtk_cam_ctx *ctx)
+{
+	u32 depth = READ_ONCE(cq_buf_depth);
+	int feature;
+
+	if (!depth || !ctx->pipe)
+		return CAM_CQ_BUF_NUM;
+
+	feature = ctx->pipe->feature_active;
+	/* a request is composed into one stream data per exposure */
+	if (mtk_cam_feature_is_mstream(feature) ||
+	    mtk_cam_feature_is_mstream_m2m(feature))
+		depth *= 2;
+	/* exposure switches are composed ahead of the frame */
+	if (ctx->pipe->dynamic_exposure_num_max > 1)
+		depth += ctx->pipe->dynamic_exposure_num_max - 1;
+	/* the next request is composed while the sub frames run */
+	if (mtk_cam_feature_is_subsample(feature))
+		depth += 2;
+
+	return min_t(u32, depth, CAM_CQ_BUF_NUM);
+}
+
+/*
+ * The cq buffers are shared with the composer at session creation, so
+ * the pool keeps all CAM_CQ_BUF_NUM of them. Only the depth of the
+ * stream is on the free list, the others wait in the reserve.
+ */
+void mtk_cam_working_buf_pool_config(struct mtk_cam_ctx *ctx)
+{
+	struct mtk_cam_working_buf_list *freelist = &ctx->buf_pool.cam_freelist;
+	u32 depth = mtk_cam_working_buf_depth(ctx);
+	u32 size;
+
+	spin_lock(&freelist->lock);
+	while (freelist->reserve_cnt &&
+	       freelist->cnt + freelist->stats.in_use < depth) {
+		list_move_tail(freelist->reserve.next, &freelist->list);
+		freelist->reserve_cnt--;
+		freelist->cnt++;
+	}
+	while (freelist->cnt &&
+	       freelist->cnt + freelist->stats.in_use > depth) {
+		list_move_tail(freelist->list.prev, &freelist->reserve);
+		freelist->reserve_cnt++;
+		freelist->cnt--;
+	}
+	size = freelist->cnt + freelist->stats.in_use;
+	buf_pool_stats_reset(&freelist->stats, size);
+	spin_unlock(&freelist->lock);
+
+	dev_info(ctx->cam->dev, "%s:ctx(%d):cq buffers %u, reserve %u%s\n",
+		 __func__, ctx->stream_id, size, freelist->reserve_cnt,
+		 READ_ONCE(cq_buf_grow) ? " (grow)" : "");
+}
+
 int mtk_cam_img_working_buf_pool_init(struct mtk_cam_ctx *ctx, int buf_num)
 {
 	int i;
@@ -227,8 +356,13 @@ int mtk_cam_img_working_buf_pool_init(struct mtk_cam_ctx *ctx, int buf_num)
 	vdev = &ctx->pipe->vdev_nodes[MTK_RAW_MAIN_STREAM_OUT - MTK_RAW_SINK_NUM];
 	working_buf_size = vdev->active_fmt.fmt.pix_mp.plane_fmt[0].sizeimage;
 	INIT_LIST_HEAD(&ctx->img_buf_pool.cam_freeimglist.list);
+	INIT_LIST_HEAD(&ctx->img_buf_pool.cam_freeimglist.reserve);
 	spin_lock_init(&ctx->img_buf_pool.cam_freeimglist.lock);
 	ctx->img_buf_pool.cam_freeimglist.cnt = 0;
+	ctx->img_buf_pool.cam_freeimglist.reserve_cnt = 0;
+	memset(&ctx->img_buf_pool.cam_freeimglist.stats, 0,
+	       sizeof(ctx->img_buf_pool.cam_freeimglist.stats));
+	ctx->img_buf_pool.cam_freeimglist.stats.size = buf_num;
 	ctx->img_buf_pool.working_img_buf_size = buf_num * working_buf_size;
 	smem.len = ctx->img_buf_pool.working_img_buf_size;
 	dev_info(ctx->cam->dev, "%s:ctx(%d) smem.len(%d)\n",
@@ -295,6 +429,7 @@ void mtk_cam_img_working_buf_put(struct mtk_cam_img_working_buf_entry *buf_entry
 	list_add_tail(&buf_entry->list_entry,
 		      &ctx->img_buf_pool.cam_freeimglist.list);
 	cnt = ++ctx->img_buf_pool.cam_freeimglist.cnt;
+	buf_pool_stats_put(&ctx->img_buf_pool.cam_freeimglist.stats);
 
 	spin_unlock(&ctx->img_buf_pool.cam_freeimglist.lock);
 
@@ -311,6 +446,7 @@ mtk_cam_img_working_buf_get(struct mtk_cam_ctx *ctx)
 	/* get from free list */
 	spin_lock(&ctx->img_buf_pool.cam_freeimglist.lock);
 	if (list_empty(&ctx->img_buf_pool.cam_freeimglist.list)) {
+		ctx->img_buf_pool.cam_freeimglist.stats.exhausted++;
 		spin_unlock(&ctx->img_buf_pool.cam_freeimglist.lock);
 
 		dev_info(ctx->cam->dev, "%s:ctx(%d):no free buf\n",
@@ -323,6 +459,7 @@ mtk_cam_img_working_buf_get(struct mtk_cam_ctx *ctx)
 				     list_entry);
 	list_del(&buf_entry->list_entry);
 	cnt = --ctx->img_buf_pool.cam_freeimglist.cnt;
+	buf_pool_stats_get(&ctx->img_buf_pool.cam_freeimglist.stats, cnt);
 
 	spin_unlock(&ctx->img_buf_pool.cam_freeimglist.lock);
 
@@ -339,6 +476,9 @@ int mtk_cam_sv_working_buf_pool_init(struct mtk_cam_ctx *ctx)
 	INIT_LIST_HEAD(&ctx->buf_pool.sv_freelist.list);
 	spin_lock_init(&ctx->buf_pool.sv_freelist.lock);
 	ctx->buf_pool.sv_freelist.cnt = 0;
+	memset(&ctx->buf_pool.sv_freelist.stats, 0,
+	       sizeof(ctx->buf_pool.sv_freelist.stats));
+	ctx->buf_pool.sv_freelist.stats.size = CAMSV_WORKING_BUF_NUM;
 
 	for (i = 0; i < CAMSV_WORKING_BUF_NUM; i++) {
 		struct mtk_camsv_working_buf_entry *buf = &ctx->buf_pool.sv_working_buf[i];
@@ -368,6 +508,7 @@ mtk_cam_sv_working_buf_put(struct mtk_camsv_working_buf_entry *buf_entry)
 	list_add_tail(&buf_entry->list_entry,
 		      &ctx->buf_pool.sv_freelist.list);
 	ctx->buf_pool.sv_freelist.cnt++;
+	buf_pool_stats_put(&ctx->buf_pool.sv_freelist.stats);
 	spin_unlock(&ctx->buf_pool.sv_freelist.lock);
 
 	dev_dbg(ctx->cam->dev, "%s:ctx(%d):e\n", __func__, ctx->stream_id);
@@ -382,6 +523,7 @@ mtk_cam_sv_working_buf_get(struct mtk_cam_ctx *ctx)
 
 	spin_lock(&ctx->buf_pool.sv_freelist.lock);
 	if (list_empty(&ctx->buf_pool.sv_freelist.list)) {
+		ctx->buf_pool.sv_freelist.stats.exhausted++;
 		spin_unlock(&ctx->buf_pool.sv_freelist.lock);
 		return NULL;
 	}
@@ -391,8 +533,39 @@ mtk_cam_sv_working_buf_get(struct mtk_cam_ctx *ctx)
 				     list_entry);
 	list_del(&buf_entry->list_entry);
 	ctx->buf_pool.sv_freelist.cnt--;
+	buf_pool_stats_get(&ctx->buf_pool.sv_freelist.stats,
+			   ctx->buf_pool.sv_freelist.cnt);
 	spin_unlock(&ctx->buf_pool.sv_freelist.lock);
 
 	dev_dbg(ctx->cam->dev, "%s:ctx(%d):e\n", __func__, ctx->stream_id);
 	return buf_entry;
 }
+
+int mtk_cam_working_buf_pools_show(struct mtk_cam_ctx *ctx, char *buf,
+				   int size)
+{
+	struct mtk_cam_buf_pool_stats s;
+	u32 reserve_cnt;
+	int len = 0;
+
+	spin_lock(&ctx->buf_pool.cam_freelist.lock);
+	s = ctx->buf_pool.cam_freelist.stats;
+	reserve_cnt = ctx->buf_pool.cam_freelist.reserve_cnt;
+	spin_unlock(&ctx->buf_pool.cam_freelist.lock);
+	len += buf_pool_stats_show(buf + len, size - len, "cq", &s,
+				   reserve_cnt);
+
+	if (ctx->img_buf_pool.working_img_buf_size > 0) {
+		spin_lock(&ctx->img_buf_pool.cam_freeimglist.lock);
+		s = ctx->img_buf_pool.cam_freeimglist.stats;
+		spin_unlock(&ctx->img_buf_pool.cam_freeimglist.lock);
+		len += buf_pool_stats_show(buf + len, size - len, "img", &s, 0);
+	}
+
+	spin_lock(&ctx->buf_pool.sv_freelist.lock);
+	s = ctx->buf_pool.sv_freelist.stats;
+	spin_unlock(&ctx->buf_pool.sv_freelist.lock);
+	len += buf_pool_stats_show(buf + len, size - len, "sv", &s, 0);
+
+	return len;
+}
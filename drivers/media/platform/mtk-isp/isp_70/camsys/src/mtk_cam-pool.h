@@ -14,6 +14,7 @@ void
 mtk_cam_working_buf_put(struct mtk_cam_working_buf_entry *buf_entry);
 struct mtk_cam_working_buf_entry*
 mtk_cam_working_buf_get(struct mtk_cam_ctx *ctx);
+void mtk_cam_working_buf_pool_config(struct mtk_cam_ctx *ctx);
 
 int mtk_cam_img_working_buf_pool_init(struct mtk_cam_ctx *ctx, int buf_num);
 void mtk_cam_img_working_buf_pool_release(struct mtk_cam_ctx *ctx);
@@ -28,4 +29,7 @@ mtk_cam_sv_working_buf_put(struct mtk_camsv_working_buf_entry *buf_entry);
 struct mtk_camsv_working_buf_entry*
 mtk_cam_sv_working_buf_get(struct mtk_cam_ctx *ctx);
 
+int mtk_cam_working_buf_pools_show(struct mtk_cam_ctx *ctx, char *buf,
+				   int size);
+
 #endif
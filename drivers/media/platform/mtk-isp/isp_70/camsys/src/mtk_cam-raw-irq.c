@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: GPL-2.0
+//
+// Copyright (c) 2022 MediaTek Inc.
+
+#ifdef RAW_IRQ_UT
+#include <stdio.h>
+#include <string.h>
+#define NSEC_PER_SEC	1000000000ULL
+#else
+#include <linux/kernel.h>
+#include <linux/string.h>
+#include <linux/time64.h>
+#endif
+
+#include "mtk_cam-raw-irq.h"
+
+#define MTK_CAM_IRQ_RING_MASK		(MTK_CAM_IRQ_RING_NUM - 1)
+
+#define MTK_CAM_IRQ_SOF_MASK \
+	(1 << CAMSYS_IRQ_FRAME_START | 1 << CAMSYS_IRQ_SUBSAMPLE_SENSOR_SET)
+
+static const char * const mtk_cam_irq_class_names[] = {
+	"sof", "done", "err",
+};
+
+enum mtk_cam_irq_class mtk_cam_irq_raw_class(u32 irq_type)
+{
+	if (irq_type & 1 << CAMSYS_IRQ_ERROR)
+		return MTK_CAM_IRQ_CLASS_ERR;
+	/* done bits read in the same irq as a SOF ride along with it */
+	if (irq_type & MTK_CAM_IRQ_SOF_MASK)
+		return MTK_CAM_IRQ_CLASS_SOF;
+
+	return MTK_CAM_IRQ_CLASS_DONE;
+}
+
+void mtk_cam_irq_queue_reset(struct mtk_cam_irq_queue *q)
+{
+	int i;
+
+	for (i = 0; i < MTK_CAM_IRQ_CLASS_NUM; i++)
+		q->ring[i].head = q->ring[i].tail = 0;
+}
+
+static bool mtk_cam_irq_mergeable(enum mtk_cam_irq_class cls,
+				  const struct mtk_camsys_irq_info *old,
+				  const struct mtk_camsys_irq_info *info)
+{
+	switch (cls) {
+	case MTK_CAM_IRQ_CLASS_SOF:
+		/* a repeated SOF, the state machine goes by frame numbers */
+		return old->irq_type == info->irq_type;
+	case MTK_CAM_IRQ_CLASS_DONE:
+		/* done handlers use the frame numbers, keep frames apart */
+		return !(old->irq_type & info->irq_type) &&
+			old->frame_idx == info->frame_idx &&
+			old->frame_idx_inner == info->frame_idx_inner;
+	default:
+		return true;
+	}
+}
+
+static void mtk_cam_irq_merge(enum mtk_cam_irq_class cls,
+			      struct mtk_cam_irq_msg *msg,
+			      const struct mtk_camsys_irq_info *info)
+{
+	int err_status = msg->info.e.err_status;
+	u32 irq_type = msg->info.irq_type | info->irq_type;
+
+	msg->info = *info;
+	msg->info.irq_type = irq_type;
+	if (cls == MTK_CAM_IRQ_CLASS_ERR)
+		msg->info.e.err_status |= err_status;
+	if (cls != MTK_CAM_IRQ_CLASS_DONE)
+		msg->first_frame_idx_inner = info->frame_idx_inner;
+	msg->count++;
+}
+
+/* a full ring, see mtk_cam_irq_msg_split() for a done of another frame */
+static void mtk_cam_irq_fold(enum mtk_cam_irq_class cls,
+			     struct mtk_cam_irq_msg *msg,
+			     const struct mtk_camsys_irq_info *info)
+{
+	/* the frame done bit now stands for the newest frame only */
+	if (cls == MTK_CAM_IRQ_CLASS_DONE &&
+	    msg->info.frame_idx_inner != info->frame_idx_inner)
+		msg->info.irq_type &= ~(1 << CAMSYS_IRQ_FRAME_DONE);
+
+	mtk_cam_irq_merge(cls, msg, info);
+}
+
+bool mtk_cam_irq_queue_push(struct mtk_cam_irq_queue *q,
+			    enum mtk_cam_irq_class cls,
+			    const struct mtk_camsys_irq_info *info)
+{
+	struct mtk_cam_irq_ring *r = &q->ring[cls];
+	struct mtk_cam_irq_msg *last = NULL;
+
+	if (r->tail != r->head)
+		last = &r->msg[(r->tail - 1) & MTK_CAM_IRQ_RING_MASK];
+
+	/* nothing of another class came in between */
+	if (last && last->seq == q->seq &&
+	    mtk_cam_irq_mergeable(cls, &last->info, info)) {
+		mtk_cam_irq_merge(cls, last, info);
+		r->coalesced++;
+		return true;
+	}
+
+	if (r->tail - r->head == MTK_CAM_IRQ_RING_NUM) {
+		/* fold into the newest, which now comes after the others */
+		mtk_cam_irq_fold(cls, last, info);
+		last->seq = ++q->seq;
+		r->lost++;
+		return false;
+	}
+
+	last = &r->msg[r->tail++ & MTK_CAM_IRQ_RING_MASK];
+	last->info = *info;
+	last->seq = ++q->seq;
+	last->count = 1;
+	last->first_frame_idx_inner = info->frame_idx_inner;
+	r->queued++;
+
+	return true;
+}
+
+bool mtk_cam_irq_queue_pop(struct mtk_cam_irq_queue *q,
+			   struct mtk_cam_irq_msg *msg)
+{
+	struct mtk_cam_irq_ring *r, *oldest = NULL;
+	u32 seq = 0;
+	int i;
+
+	for (i = 0; i < MTK_CAM_IRQ_CLASS_NUM; i++) {
+		r = &q->ring[i];
+		if (r->tail == r->head)
+			continue;
+		if (!oldest ||
+		    (s32)(r->msg[r->head & MTK_CAM_IRQ_RING_MASK].seq - seq) < 0) {
+			oldest = r;
+			seq = r->msg[r->head & MTK_CAM_IRQ_RING_MASK].seq;
+		}
+	}
+	if (!oldest)
+		return false;
+
+	*msg = oldest->msg[oldest->head++ & MTK_CAM_IRQ_RING_MASK];
+
+	return true;
+}
+
+bool mtk_cam_irq_msg_split(const struct mtk_cam_irq_msg *msg,
+			   struct mtk_camsys_irq_info *done)
+{
+	if (msg->first_frame_idx_inner == msg->info.frame_idx_inner)
+		return false;
+
+	/* done handlers complete all the frames up to the one given */
+	*done = msg->info;
+	done->irq_type = 1 << CAMSYS_IRQ_FRAME_DONE;
+	done->frame_idx = msg->info.frame_idx - 1;
+	done->frame_idx_inner = msg->info.frame_idx_inner - 1;
+
+	return true;
+}
+
+int mtk_cam_irq_queue_show(const struct mtk_cam_irq_queue *q,
+			   char *buf, int size)
+{
+	const struct mtk_cam_irq_ring *r;
+	int i, len = 0;
+
+	for (i = 0; i < MTK_CAM_IRQ_CLASS_NUM && len < size; i++) {
+		r = &q->ring[i];
+		len += snprintf(buf + len, size - len,
+				"%s: queued %u coalesced %u lost %u\n",
+				mtk_cam_irq_class_names[i],
+				r->queued, r->coalesced, r->lost);
+	}
+
+	return len < size ? len : size - 1;
+}
+
+void mtk_raw_irq_coal_reset(struct mtk_raw_irq_coal *c,
+			    u32 rate_thr, u32 budget, u64 flush_ns)
+{
+	memset(c, 0, sizeof(*c));
+	c->rate_thr = rate_thr;
+	c->budget = budget ? budget : 1;
+	c->flush_ns = flush_ns ? flush_ns : MTK_RAW_IRQ_FLUSH_NS;
+}
+
+static void mtk_raw_irq_coal_update(struct mtk_raw_irq_coal *c, u64 elapsed)
+{
+	/* events * 1s against thr * elapsed, no division in the top half */
+	u64 rate = (u64)c->win_events * NSEC_PER_SEC;
+	u64 thr = (u64)c->rate_thr * elapsed;
+
+	if (!c->rate_thr)
+		c->polling = false;
+	else if (!c->polling && rate >= thr) {
+		c->polling = true;
+		c->poll_enter++;
+	} else if (c->polling && 2 * rate < thr)
+		c->polling = false;
+}
+
+bool mtk_raw_irq_coal_event(struct mtk_raw_irq_coal *c, bool urgent,
+			    u64 ts_ns)
+{
+	u64 elapsed = ts_ns - c->win_start_ns;
+
+	c->events++;
+	c->win_events++;
+
+	if (elapsed >= MTK_RAW_IRQ_WIN_NS) {
+		bool was_polling = c->polling;
+
+		mtk_raw_irq_coal_update(c, elapsed);
+		c->win_start_ns = ts_ns;
+		c->win_events = 0;
+
+		/* hand over whatever polling held back */
+		if (was_polling && !c->polling)
+			urgent = true;
+	}
+
+	/* held past the deadline, in case the flush timer is late */
+	if (c->pending && ts_ns - c->held_ns >= c->flush_ns)
+		urgent = true;
+
+	c->pending++;
+	if (c->polling && !urgent && c->pending < c->budget) {
+		if (c->pending == 1)
+			c->held_ns = ts_ns;
+		c->coalesced++;
+		return false;
+	}
+
+	c->pending = 0;
+	c->wakeups++;
+
+	return true;
+}
+
+bool mtk_raw_irq_coal_flush(struct mtk_raw_irq_coal *c)
+{
+	if (!c->pending)
+		return false;
+
+	c->pending = 0;
+	c->flushes++;
+
+	return true;
+}
@@ -0,0 +1,165 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Copyright (c) 2022 MediaTek Inc.
+ */
+
+#ifndef __MTK_CAM_RAW_IRQ_H
+#define __MTK_CAM_RAW_IRQ_H
+
+/*
+ * Irq messages from the raw and camsv top halves to their irq threads.
+ *
+ * Messages are queued in a small ring per event class (SOF, done, error)
+ * and popped in arrival order across the rings. A message that repeats
+ * the newest one of its class is merged into it: the latest frame number
+ * wins and the count goes up. Done events are only merged within a frame.
+ * A full ring folds the event into its newest message and counts it as
+ * lost: a folded SOF or error only keeps the latest frame number. A done
+ * message folded across frames remembers the first inner frame it holds,
+ * the frame done completing the older ones is then given by
+ * mtk_cam_irq_msg_split() since they all left the HW.
+ *
+ * Raw irq coalescing. Below rate_thr events/s every event wakes the irq
+ * thread. Above it the raw enters polling: done events are only queued,
+ * and the thread is woken by the next urgent event (SOF, error, subsample
+ * sensor setting) or once budget events are pending, then drains them in
+ * one pass. An event is never held longer than flush_ns: the first one
+ * held starts a flush deadline, kept by a timer of the caller, and an
+ * event coming in past it wakes the thread as well. Otherwise the last
+ * done events would be left queued once the sensor stops sending SOF.
+ * Polling is left when the rate falls under half the threshold.
+ *
+ * Both are kept free of device state so they can be built on the host
+ * with -DRAW_IRQ_UT.
+ */
+
+/* irq-ut-test provides its own linux/types.h */
+#include <linux/types.h>
+
+#define MTK_RAW_IRQ_WIN_NS		100000000ULL /* rate sampling window */
+#define MTK_RAW_IRQ_FLUSH_NS		4000000ULL /* default flush deadline */
+#define MTK_CAM_IRQ_RING_NUM		4 /* messages per class, power of 2 */
+
+enum MTK_CAMSYS_IRQ_EVENT {
+	/* with normal_data */
+	CAMSYS_IRQ_SETTING_DONE = 0,
+	CAMSYS_IRQ_FRAME_START,
+	CAMSYS_IRQ_AFO_DONE,
+	CAMSYS_IRQ_FRAME_DONE,
+	CAMSYS_IRQ_SUBSAMPLE_SENSOR_SET,
+	CAMSYS_IRQ_FRAME_DROP,
+
+	/* with error_data */
+	CAMSYS_IRQ_ERROR,
+};
+
+struct mtk_camsys_irq_normal_data {
+};
+
+struct mtk_camsys_irq_error_data {
+	int err_status;
+};
+
+struct mtk_camsys_irq_info {
+	enum MTK_CAMSYS_IRQ_EVENT irq_type;
+	u64 ts_ns;
+	int frame_idx;
+	int frame_idx_inner;
+	bool slave_engine;
+	int write_cnt;
+	int fbc_cnt;
+	union {
+		struct mtk_camsys_irq_normal_data	n;
+		struct mtk_camsys_irq_error_data	e;
+	};
+};
+
+enum mtk_cam_irq_class {
+	MTK_CAM_IRQ_CLASS_SOF,
+	MTK_CAM_IRQ_CLASS_DONE,
+	MTK_CAM_IRQ_CLASS_ERR,
+	MTK_CAM_IRQ_CLASS_NUM,
+};
+
+struct mtk_cam_irq_msg {
+	struct mtk_camsys_irq_info info;
+	u32 seq;	/* arrival order across the classes */
+	u32 count;	/* events merged into this message */
+	int first_frame_idx_inner;	/* oldest frame folded into a done */
+};
+
+struct mtk_cam_irq_ring {
+	struct mtk_cam_irq_msg msg[MTK_CAM_IRQ_RING_NUM];
+	u32 head;
+	u32 tail;
+
+	/* kept across mtk_cam_irq_queue_reset */
+	u32 queued;
+	u32 coalesced;
+	u32 lost;
+};
+
+struct mtk_cam_irq_queue {
+	struct mtk_cam_irq_ring ring[MTK_CAM_IRQ_CLASS_NUM];
+	u32 seq;
+};
+
+struct mtk_raw_irq_coal {
+	u32 rate_thr;	/* events/s to start polling, 0 disables */
+	u32 budget;	/* max events per thread wakeup while polling */
+	u64 flush_ns;	/* max time an event is held while polling */
+
+	u64 win_start_ns;
+	u32 win_events;
+	u32 pending;	/* queued but not signalled to the thread yet */
+	u64 held_ns;	/* arrival of the first pending event */
+	bool polling;
+
+	/* stats since the last reset */
+	u64 events;
+	u64 wakeups;
+	u64 coalesced;
+	u64 flushes;
+	u32 poll_enter;
+};
+
+/* class of a raw message, camsv errors do not use the bit layout */
+enum mtk_cam_irq_class mtk_cam_irq_raw_class(u32 irq_type);
+
+void mtk_cam_irq_queue_reset(struct mtk_cam_irq_queue *q);
+
+/* returns false if the ring was full and the event got folded */
+bool mtk_cam_irq_queue_push(struct mtk_cam_irq_queue *q,
+			    enum mtk_cam_irq_class cls,
+			    const struct mtk_camsys_irq_info *info);
+
+/* oldest message of all classes, false if the queue is empty */
+bool mtk_cam_irq_queue_pop(struct mtk_cam_irq_queue *q,
+			   struct mtk_cam_irq_msg *msg);
+
+int mtk_cam_irq_queue_show(const struct mtk_cam_irq_queue *q,
+			   char *buf, int size);
+
+/*
+ * A done message folded across frames, returns true with the frame done
+ * of the frames before its newest one, to be handled ahead of it.
+ */
+bool mtk_cam_irq_msg_split(const struct mtk_cam_irq_msg *msg,
+			   struct mtk_camsys_irq_info *done);
+
+/* flush_ns 0 takes MTK_RAW_IRQ_FLUSH_NS */
+void mtk_raw_irq_coal_reset(struct mtk_raw_irq_coal *c,
+			    u32 rate_thr, u32 budget, u64 flush_ns);
+
+/*
+ * Account one queued event, returns true if the thread must be woken.
+ * When it returns false with pending 1, the event is the first one held
+ * and the caller arms its flush timer flush_ns from now.
+ */
+bool mtk_raw_irq_coal_event(struct mtk_raw_irq_coal *c, bool urgent,
+			    u64 ts_ns);
+
+/* flush timer expired, returns true if held events must be handed over */
+bool mtk_raw_irq_coal_flush(struct mtk_raw_irq_coal *c);
+
+#endif /*__MTK_CAM_RAW_IRQ_H*/
@@ -0,0 +1,407 @@
+// SPDX-License-Identifier: GPL-2.0
+//
+// Copyright (c) 2022 MediaTek Inc.
+
+#ifdef RAW_RES_UT
+#include <string.h>
+#else
+#include <linux/string.h>
+#endif
+
+#include "mtk_cam-defs.h"
+#include "mtk_cam-raw-res.h"
+
+#define MTK_CAMSYS_RES_IDXMASK		0xF0
+#define MTK_CAMSYS_RES_BIN_TAG		0x10
+#define MTK_CAMSYS_RES_FRZ_TAG		0x20
+#define MTK_CAMSYS_RES_HWN_TAG		0x30
+#define MTK_CAMSYS_RES_CLK_TAG		0x40
+
+#define TGO_MAX_PXLMODE		8
+#define FRZ_PXLMODE_THRES		71
+#define MHz		1000000
+#define MTK_CAMSYS_PROC_DEFAULT_PIXELMODE 2
+
+enum MTK_CAMSYS_RES_STEP {
+	E_RES_BASIC,
+	E_RES_BIN_S = MTK_CAMSYS_RES_BIN_TAG,
+	E_RES_BIN0 = E_RES_BIN_S,
+	E_RES_BIN1,
+	E_RES_BIN_E,
+	E_RES_FRZ_S = MTK_CAMSYS_RES_FRZ_TAG,
+	E_RES_FRZ0 = E_RES_FRZ_S,
+	E_RES_FRZ1,
+	E_RES_FRZ_E,
+	E_RES_HWN_S = MTK_CAMSYS_RES_HWN_TAG,
+	E_RES_HWN0 = E_RES_HWN_S,
+	E_RES_HWN1,
+	E_RES_HWN2,
+	E_RES_HWN_E,
+	E_RES_CLK_S = MTK_CAMSYS_RES_CLK_TAG,
+	E_RES_CLK0 = E_RES_CLK_S,
+	E_RES_CLK1,
+	E_RES_CLK2,
+	E_RES_CLK3,
+	E_RES_CLK_E,
+};
+
+enum MTK_CAMSYS_MAXLB_CHECK_RESULT {
+	LB_CHECK_OK = 0,
+	LB_CHECK_CBN,
+	LB_CHECK_QBN,
+	LB_CHECK_BIN,
+	LB_CHECK_FRZ,
+	LB_CHECK_TWIN,
+	LB_CHECK_RAW,
+};
+
+#define CAM_RAW_PROCESS_MAX_LINE_BUFFER		(6632)
+#define CAM_RAW_FRZ_MAX_LINE_BUFFER		(6632)
+#define CAM_RAW_BIN_MAX_LINE_BUFFER		(12000)
+#define CAM_RAW_QBND_MAX_LINE_BUFFER		(16000)
+#define CAM_RAW_CBN_MAX_LINE_BUFFER		(18472)
+#define CAM_TWIN_PROCESS_MAX_LINE_BUFFER	(12400)
+
+struct cam_resource_plan {
+	int cam_resource[MTK_CAMSYS_RES_STEP_NUM];
+};
+
+static const struct cam_resource_plan raw_resource_strategy_plan[] = {
+	[RESOURCE_STRATEGY_QPR] = {
+		.cam_resource = {
+			E_RES_BASIC, E_RES_HWN1, E_RES_CLK1, E_RES_CLK2,
+			E_RES_CLK3, E_RES_FRZ1, E_RES_BIN1, E_RES_HWN2} },
+	[RESOURCE_STRATEGY_PQR] = {
+		.cam_resource = {
+			E_RES_BASIC, E_RES_HWN1, E_RES_HWN2, E_RES_FRZ1,
+			E_RES_BIN1, E_RES_CLK1, E_RES_CLK2, E_RES_CLK3} },
+	[RESOURCE_STRATEGY_RPQ] = {
+		.cam_resource = {
+			E_RES_BASIC, E_RES_FRZ1, E_RES_BIN1, E_RES_CLK1,
+			E_RES_CLK2, E_RES_CLK3, E_RES_HWN1, E_RES_HWN2} },
+	[RESOURCE_STRATEGY_QRP] = {
+		.cam_resource = {
+			E_RES_BASIC, E_RES_CLK1, E_RES_CLK2, E_RES_CLK3,
+			E_RES_HWN1, E_RES_HWN2, E_RES_FRZ1, E_RES_BIN1} },
+};
+
+static int mtk_raw_linebuf_chk(bool b_twin, bool b_bin, bool b_frz, bool b_qbn,
+			       bool b_cbn, int tg_x, int *frz_ratio)
+{
+	int input_x = tg_x;
+	/* max line buffer check for frontal binning and resizer */
+	if (b_twin) {
+		if (input_x > CAM_TWIN_PROCESS_MAX_LINE_BUFFER)
+			return LB_CHECK_TWIN;
+		input_x = input_x >> 1;
+	}
+	if (b_cbn) {
+		if (input_x > CAM_RAW_CBN_MAX_LINE_BUFFER)
+			return LB_CHECK_CBN;
+		input_x = input_x >> 1;
+	}
+	if (b_qbn) {
+		if (input_x > CAM_RAW_QBND_MAX_LINE_BUFFER)
+			return LB_CHECK_QBN;
+		input_x = input_x >> 1;
+	}
+	if (b_bin) {
+		if (input_x > CAM_RAW_BIN_MAX_LINE_BUFFER)
+			return LB_CHECK_BIN;
+		input_x = input_x >> 1;
+	}
+	if (input_x <= CAM_RAW_PROCESS_MAX_LINE_BUFFER) {
+		return LB_CHECK_OK;
+	} else if (b_frz) {
+		if (input_x > CAM_RAW_FRZ_MAX_LINE_BUFFER)
+			return LB_CHECK_FRZ;
+
+		*frz_ratio = input_x * 100 /
+			CAM_RAW_PROCESS_MAX_LINE_BUFFER;
+		return LB_CHECK_OK;
+	} else {
+		return LB_CHECK_RAW;
+	}
+}
+
+static int mtk_raw_pixelmode_calc(int rawpxl, int b_twin, bool b_bin,
+				  bool b_frz, int min_ratio)
+{
+	int pixelmode = rawpxl;
+
+	pixelmode = (b_twin == 2) ? pixelmode << 2 : pixelmode;
+	pixelmode = (b_twin == 1) ? pixelmode << 1 : pixelmode;
+	pixelmode = b_bin ? pixelmode << 1 : pixelmode;
+	pixelmode = (b_frz && (min_ratio < FRZ_PXLMODE_THRES))
+			? pixelmode << 1 : pixelmode;
+	pixelmode = (pixelmode > TGO_MAX_PXLMODE) ?
+		TGO_MAX_PXLMODE : pixelmode;
+
+	return pixelmode;
+}
+
+static bool is_cbn_en(int bin_flag)
+{
+	switch (bin_flag) {
+	case CBN_2X2_ON:
+	case CBN_3X3_ON:
+	case CBN_4X4_ON:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static u32 mtk_raw_pixelmode_log2(int pixelmode)
+{
+	switch (pixelmode) {
+	case 2:
+		return 1;
+	case 4:
+		return 2;
+	case 8:
+		return 3;
+	default:
+		return 0;
+	}
+}
+
+/*
+ * Walk the clock levels up to @max_idx and return the lowest one that
+ * still sustains the pixel rate with the given resources, trying the
+ * smaller pixel mode first on each level.
+ */
+static int mtk_raw_lowest_clk(const struct mtk_raw_res_in *in, s64 pixel_rate,
+			      int max_idx, int twin_en, int bin_en, int frz_en,
+			      int frz_ratio, int *pixelmode)
+{
+	u64 eq_throughput;
+	int lv, p, pxl;
+
+	for (lv = 0; lv <= max_idx && lv < (int)in->clklv_num; lv++) {
+		for (p = 1; p <= MTK_CAMSYS_PROC_DEFAULT_PIXELMODE; p++) {
+			pxl = mtk_raw_pixelmode_calc(p, twin_en, bin_en,
+						     frz_en, frz_ratio);
+			eq_throughput = ((u64)pxl) * in->clklv[lv];
+			if (eq_throughput > pixel_rate) {
+				*pixelmode = pxl;
+				return lv;
+			}
+		}
+	}
+
+	return -1;
+}
+
+bool mtk_raw_res_plan(const struct mtk_raw_res_in *in,
+		      struct mtk_raw_res_out *out)
+{
+	const unsigned int *clklv = in->clklv;
+	u64 eq_throughput = clklv[0];
+	s64 pixel_rate = in->pixel_rate;
+	int res_step_type = 0;
+	int tgo_pxl_mode = 1;
+	int pixel_mode[MTK_CAMSYS_RES_STEP_NUM] = {0};
+	int bin_temp = 0, frz_temp = 0, hwn_temp = 0;
+	int bin_en = 0, frz_en = 0, twin_en = 0, clk_cur = 0;
+	int idx = 0, clk_res = 0, idx_res = 0;
+	int lb_chk_res = -1;
+	int frz_ratio = 100;
+	int step_frz_ratio;
+	int lowest;
+	int p;
+
+	memset(out, 0, sizeof(*out));
+	out->raw_num_used = 1;
+	out->frz_ratio = frz_ratio;
+	out->step_idx = -1;
+	if (in->res_plan >= RESOURCE_STRATEGY_NUMBER)
+		return false;
+
+	/* test pattern */
+	if (pixel_rate == 0)
+		pixel_rate = 450 * MHz;
+
+	memcpy(out->res_strategy, raw_resource_strategy_plan + in->res_plan,
+	       MTK_CAMSYS_RES_STEP_NUM * sizeof(int));
+
+	step_frz_ratio = out->frz_ratio;
+	for (idx = 0; idx < MTK_CAMSYS_RES_STEP_NUM ; idx++) {
+		res_step_type = out->res_strategy[idx] & MTK_CAMSYS_RES_IDXMASK;
+		switch (res_step_type) {
+		case MTK_CAMSYS_RES_BIN_TAG:
+			bin_temp = out->res_strategy[idx] - E_RES_BIN_S;
+			if (bin_temp <= in->bin_limit)
+				bin_en = bin_temp;
+			if (bin_en && frz_en)
+				frz_en = 0;
+			break;
+		case MTK_CAMSYS_RES_FRZ_TAG:
+			frz_temp = out->res_strategy[idx] - E_RES_FRZ_S;
+			if (in->frz_limit < 100)
+				frz_en = frz_temp;
+			break;
+		case MTK_CAMSYS_RES_HWN_TAG:
+			hwn_temp = out->res_strategy[idx] - E_RES_HWN_S;
+			if (hwn_temp + 1 <= in->hwn_limit_max)
+				twin_en = hwn_temp;
+			break;
+		case MTK_CAMSYS_RES_CLK_TAG:
+			clk_cur = out->res_strategy[idx] - E_RES_CLK_S;
+			break;
+		default:
+			break;
+		}
+
+		/* 1 for force bin on */
+		if (in->bin_limit >= 1)
+			bin_en = 1;
+
+		if (in->hwn_limit_min > 1)
+			twin_en = 1;
+
+		/* max line buffer check*/
+		lb_chk_res = mtk_raw_linebuf_chk(twin_en, in->bin_limit & BIN_ON,
+						 frz_en, in->bin_limit & QBND_ON,
+						 is_cbn_en(in->bin_limit),
+						 in->in_w, &frz_ratio);
+		/* frz ratio*/
+		if (res_step_type == MTK_CAMSYS_RES_FRZ_TAG) {
+			if (eq_throughput > pixel_rate &&
+			    lb_chk_res == LB_CHECK_OK)
+				step_frz_ratio = frz_ratio;
+			else
+				step_frz_ratio =
+					in->frz_limit < FRZ_PXLMODE_THRES
+					? in->frz_limit : FRZ_PXLMODE_THRES;
+		}
+		if (in->timeshare) {
+			tgo_pxl_mode = mtk_raw_pixelmode_calc(MTK_CAMSYS_PROC_DEFAULT_PIXELMODE,
+					twin_en, bin_en, frz_en, step_frz_ratio);
+			pixel_mode[idx] = tgo_pxl_mode;
+			if (lb_chk_res == LB_CHECK_OK) {
+				out->bin_enable = bin_en;
+				out->frz_enable = frz_en;
+				out->frz_ratio = step_frz_ratio;
+				out->raw_num_used = twin_en + 1;
+				clk_res = clk_cur;
+				idx_res = idx;
+				out->found = true;
+			}
+		} else {
+			/*try 1-pixel mode first*/
+			for (p = 1; p <= MTK_CAMSYS_PROC_DEFAULT_PIXELMODE; p++) {
+				tgo_pxl_mode = mtk_raw_pixelmode_calc(p, twin_en, bin_en, frz_en,
+								      step_frz_ratio);
+				/**
+				 * isp throughput along resource strategy
+				 * (compared with pixel rate)
+				 */
+				pixel_mode[idx] = tgo_pxl_mode;
+				eq_throughput = ((u64)tgo_pxl_mode) * clklv[clk_cur];
+				if ((eq_throughput > pixel_rate) &&
+					(lb_chk_res == LB_CHECK_OK)) {
+					if (!out->found) {
+						out->bin_enable = bin_en;
+						out->frz_enable = frz_en;
+						out->frz_ratio = step_frz_ratio;
+						out->raw_num_used = twin_en + 1;
+						clk_res = clk_cur;
+						idx_res = idx;
+						out->found = true;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	out->step_clk_idx = out->found ? clk_res : clk_cur;
+
+	/* clock steps may go past a short opp table, stay on its last level */
+	if (in->clklv_num && clk_cur >= (int)in->clklv_num)
+		clk_cur = in->clklv_num - 1;
+	if (in->clklv_num && clk_res >= (int)in->clklv_num)
+		clk_res = in->clklv_num - 1;
+
+	if (!out->found) {
+		out->clk_idx = clk_cur;
+		out->clk_target = clklv[clk_cur];
+		out->tgo_pxl_mode = mtk_raw_pixelmode_log2(pixel_mode[0]);
+		return false;
+	}
+
+	tgo_pxl_mode = pixel_mode[idx_res];
+
+	/*
+	 * The strategy walk only tells which resources to spend. Steps placed
+	 * after a clock step inherit its level, so a step that adds bin or
+	 * twin may well run at a lower clock than the one it was found at.
+	 */
+	if (!in->timeshare) {
+		lowest = mtk_raw_lowest_clk(in, pixel_rate, clk_res,
+					    out->raw_num_used - 1,
+					    out->bin_enable, out->frz_enable,
+					    out->frz_ratio, &p);
+		if (lowest >= 0 && lowest < clk_res) {
+			clk_res = lowest;
+			tgo_pxl_mode = p;
+		}
+	}
+
+	out->step_idx = idx_res;
+	out->clk_idx = clk_res;
+	out->clk_target = clklv[clk_res];
+	out->tgo_pxl_mode = mtk_raw_pixelmode_log2(tgo_pxl_mode);
+
+	return true;
+}
+
+static bool mtk_raw_res_in_equal(const struct mtk_raw_res_in *a,
+				 const struct mtk_raw_res_in *b)
+{
+	return a->in_w == b->in_w &&
+	       a->in_h == b->in_h &&
+	       a->pixel_rate == b->pixel_rate &&
+	       a->res_plan == b->res_plan &&
+	       a->bin_limit == b->bin_limit &&
+	       a->frz_limit == b->frz_limit &&
+	       a->hwn_limit_max == b->hwn_limit_max &&
+	       a->hwn_limit_min == b->hwn_limit_min &&
+	       a->timeshare == b->timeshare &&
+	       a->clklv == b->clklv &&
+	       a->clklv_num == b->clklv_num;
+}
+
+bool mtk_raw_res_plan_cached(struct mtk_raw_res_cache *cache,
+			     const struct mtk_raw_res_in *in,
+			     struct mtk_raw_res_out *out)
+{
+	struct mtk_raw_res_cache_entry *e;
+	int i;
+
+	for (i = 0; i < MTK_RAW_RES_CACHE_NUM; i++) {
+		e = &cache->entry[i];
+		if (e->valid && mtk_raw_res_in_equal(&e->in, in)) {
+			cache->hit++;
+			*out = e->out;
+			return out->found;
+		}
+	}
+
+	cache->miss++;
+	mtk_raw_res_plan(in, out);
+
+	e = &cache->entry[cache->next];
+	cache->next = (cache->next + 1) % MTK_RAW_RES_CACHE_NUM;
+	e->in = *in;
+	e->out = *out;
+	e->valid = true;
+
+	return out->found;
+}
+
+void mtk_raw_res_cache_reset(struct mtk_raw_res_cache *cache)
+{
+	memset(cache, 0, sizeof(*cache));
+}
@@ -0,0 +1,80 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Copyright (c) 2022 MediaTek Inc.
+ */
+
+#ifndef __MTK_CAM_RAW_RES_H
+#define __MTK_CAM_RAW_RES_H
+
+/*
+ * Raw resource planner: picks bin/frz/twin/clock/pixel mode for a given
+ * sensor input. It only depends on its inputs, so it is kept free of
+ * device state and can be built on the host with -DRAW_RES_UT.
+ */
+
+/* res-ut-test provides its own linux/types.h */
+#include <linux/types.h>
+
+#define MTK_CAMSYS_RES_STEP_NUM	8
+#define MTK_RAW_RES_CACHE_NUM	8
+
+enum resource_strategy_id {
+	RESOURCE_STRATEGY_QPR = 0,
+	RESOURCE_STRATEGY_PQR,
+	RESOURCE_STRATEGY_RPQ,
+	RESOURCE_STRATEGY_QRP,
+	RESOURCE_STRATEGY_NUMBER
+};
+
+struct mtk_raw_res_in {
+	int in_w;
+	int in_h;
+	s64 pixel_rate;
+	u32 res_plan;
+	u32 bin_limit;
+	u32 frz_limit;
+	u32 hwn_limit_max;
+	u32 hwn_limit_min;
+	bool timeshare;
+	/* clock levels in ascending order, fixed once the device is probed */
+	const unsigned int *clklv;
+	unsigned int clklv_num;
+};
+
+struct mtk_raw_res_out {
+	bool found;
+	u32 res_strategy[MTK_CAMSYS_RES_STEP_NUM];
+	u32 bin_enable;
+	u32 frz_enable;
+	u32 frz_ratio;
+	u32 raw_num_used;
+	u32 tgo_pxl_mode;	/* log2 */
+	u32 clk_target;
+	int clk_idx;
+	int step_idx;
+	/* clock index the strategy step itself asked for */
+	int step_clk_idx;
+};
+
+struct mtk_raw_res_cache_entry {
+	bool valid;
+	struct mtk_raw_res_in in;
+	struct mtk_raw_res_out out;
+};
+
+/* caller serialises access */
+struct mtk_raw_res_cache {
+	struct mtk_raw_res_cache_entry entry[MTK_RAW_RES_CACHE_NUM];
+	unsigned int next;
+	unsigned int hit;
+	unsigned int miss;
+};
+
+bool mtk_raw_res_plan(const struct mtk_raw_res_in *in,
+		      struct mtk_raw_res_out *out);
+bool mtk_raw_res_plan_cached(struct mtk_raw_res_cache *cache,
+			     const struct mtk_raw_res_in *in,
+			     struct mtk_raw_res_out *out);
+void mtk_raw_res_cache_reset(struct mtk_raw_res_cache *cache);
+
+#endif /*__MTK_CAM_RAW_RES_H*/
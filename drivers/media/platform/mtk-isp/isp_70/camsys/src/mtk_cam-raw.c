@@ -62,95 +62,29 @@ static int debug_dump_fbc;
 module_param(debug_dump_fbc, int, 0644);
 MODULE_PARM_DESC(debug_dump_fbc, "debug: dump fbc");
 
-#define MTK_RAW_STOP_HW_TIMEOUT			(33)
+static unsigned int raw_irq_poll_rate = 800;
+module_param(raw_irq_poll_rate, uint, 0644);
+MODULE_PARM_DESC(raw_irq_poll_rate,
+		 "raw irq events/s to coalesce done irqs, 0 to disable");
+
+static unsigned int raw_irq_poll_budget = 4;
+module_param(raw_irq_poll_budget, uint, 0644);
+MODULE_PARM_DESC(raw_irq_poll_budget,
+		 "max raw irq events per thread wakeup while coalescing");
 
-#define MTK_CAMSYS_RES_IDXMASK		0xF0
-#define MTK_CAMSYS_RES_BIN_TAG		0x10
-#define MTK_CAMSYS_RES_FRZ_TAG		0x20
-#define MTK_CAMSYS_RES_HWN_TAG		0x30
-#define MTK_CAMSYS_RES_CLK_TAG		0x40
+static unsigned int raw_irq_poll_flush_us = 4000;
+module_param(raw_irq_poll_flush_us, uint, 0644);
+MODULE_PARM_DESC(raw_irq_poll_flush_us,
+		 "max time a coalesced raw irq event is held, in us");
+
+#define MTK_RAW_STOP_HW_TIMEOUT			(33)
 
 #define MTK_CAMSYS_RES_PLAN_NUM		10
-#define TGO_MAX_PXLMODE		8
-#define FRZ_PXLMODE_THRES		71
 #define MHz		1000000
-#define MTK_CAMSYS_PROC_DEFAULT_PIXELMODE 2
 
 #define sizeof_u32(__struct__) ((sizeof(__struct__) + sizeof(u32) - 1)/ \
 				sizeof(u32))
 
-enum MTK_CAMSYS_RES_STEP {
-	E_RES_BASIC,
-	E_RES_BIN_S = MTK_CAMSYS_RES_BIN_TAG,
-	E_RES_BIN0 = E_RES_BIN_S,
-	E_RES_BIN1,
-	E_RES_BIN_E,
-	E_RES_FRZ_S = MTK_CAMSYS_RES_FRZ_TAG,
-	E_RES_FRZ0 = E_RES_FRZ_S,
-	E_RES_FRZ1,
-	E_RES_FRZ_E,
-	E_RES_HWN_S = MTK_CAMSYS_RES_HWN_TAG,
-	E_RES_HWN0 = E_RES_HWN_S,
-	E_RES_HWN1,
-	E_RES_HWN2,
-	E_RES_HWN_E,
-	E_RES_CLK_S = MTK_CAMSYS_RES_CLK_TAG,
-	E_RES_CLK0 = E_RES_CLK_S,
-	E_RES_CLK1,
-	E_RES_CLK2,
-	E_RES_CLK3,
-	E_RES_CLK_E,
-};
-
-enum MTK_CAMSYS_MAXLB_CHECK_RESULT {
-	LB_CHECK_OK = 0,
-	LB_CHECK_CBN,
-	LB_CHECK_QBN,
-	LB_CHECK_BIN,
-	LB_CHECK_FRZ,
-	LB_CHECK_TWIN,
-	LB_CHECK_RAW,
-};
-
-
-#define CAM_RAW_PROCESS_MAX_LINE_BUFFER		(6632)
-#define CAM_RAW_FRZ_MAX_LINE_BUFFER		(6632)
-#define CAM_RAW_BIN_MAX_LINE_BUFFER		(12000)
-#define CAM_RAW_QBND_MAX_LINE_BUFFER		(16000)
-#define CAM_RAW_CBN_MAX_LINE_BUFFER		(18472)
-#define CAM_TWIN_PROCESS_MAX_LINE_BUFFER	(12400)
-
-struct cam_resource_plan {
-	int cam_resource[MTK_CAMSYS_RES_STEP_NUM];
-};
-
-enum resource_strategy_id {
-	RESOURCE_STRATEGY_QPR = 0,
-	RESOURCE_STRATEGY_PQR,
-	RESOURCE_STRATEGY_RPQ,
-	RESOURCE_STRATEGY_QRP,
-	RESOURCE_STRATEGY_NUMBER
-};
-
-static const struct cam_resource_plan raw_resource_strategy_plan[] = {
-	[RESOURCE_STRATEGY_QPR] = {
-		.cam_resource = {
-			E_RES_BASIC, E_RES_HWN1, E_RES_CLK1, E_RES_CLK2,
-			E_RES_CLK3, E_RES_FRZ1, E_RES_BIN1, E_RES_HWN2} },
-	[RESOURCE_STRATEGY_PQR] = {
-		.cam_resource = {
-			E_RES_BASIC, E_RES_HWN1, E_RES_HWN2, E_RES_FRZ1,
-			E_RES_BIN1, E_RES_CLK1, E_RES_CLK2, E_RES_CLK3} },
-	[RESOURCE_STRATEGY_RPQ] = {
-		.cam_resource = {
-			E_RES_BASIC, E_RES_FRZ1, E_RES_BIN1, E_RES_CLK1,
-			E_RES_CLK2, E_RES_CLK3, E_RES_HWN1, E_RES_HWN2} },
-	[RESOURCE_STRATEGY_QRP] = {
-		.cam_resource = {
-			E_RES_BASIC, E_RES_CLK1, E_RES_CLK2, E_RES_CLK3,
-			E_RES_HWN1, E_RES_HWN2, E_RES_FRZ1, E_RES_BIN1} },
-};
-
 #ifdef ISP7_1
 /* stagger raw select and mode decision preference */
 #define STAGGER_MAX_STREAM_NUM 4
@@ -1165,6 +1099,12 @@ void apply_cq(struct mtk_raw_device *dev,
 	int trigger = USINGSCQ || initial;
 	dma_addr_t main, sub;
 
+	/* nothing to load, the virtual sensor reports the CQ done */
+	if (dev->virt) {
+		mtk_cam_virt_apply_cq(dev->virt);
+		return;
+	}
+
 #ifdef ISP7_1
 	dev_dbg(dev->dev,
 		"apply raw%d cq - addr:0x%llx ,size:%d/%d,offset:%d\n",
@@ -1454,26 +1394,89 @@ void dump_aa_info(struct mtk_cam_ctx *ctx,
 	}
 }
 
-static int reset_msgfifo(struct mtk_raw_device *dev)
+static void reset_msgfifo(struct mtk_raw_device *dev)
 {
+	/* a budget of done events fits the done ring */
+	unsigned int budget = min_t(unsigned int, raw_irq_poll_budget,
+				    MTK_CAM_IRQ_RING_NUM);
+	unsigned long flags;
+
+	spin_lock_irqsave(&dev->msg_lock, flags);
+	mtk_raw_irq_coal_reset(&dev->irq_coal, raw_irq_poll_rate, budget,
+			       (u64)raw_irq_poll_flush_us * 1000);
+	mtk_cam_irq_queue_reset(&dev->msg_q);
 	atomic_set(&dev->is_fifo_overflow, 0);
-	return kfifo_init(&dev->msg_fifo, dev->msg_buffer, dev->fifo_size);
+	spin_unlock_irqrestore(&dev->msg_lock, flags);
 }
 
-static int push_msgfifo(struct mtk_raw_device *dev,
-			struct mtk_camsys_irq_info *info)
+/* called with msg_lock held, returns true if the irq thread must run */
+static bool queue_msgfifo(struct mtk_raw_device *dev,
+			  struct mtk_camsys_irq_info *info)
 {
-	int len;
+	enum mtk_cam_irq_class cls = mtk_cam_irq_raw_class(info->irq_type);
+	bool wake;
+
+	wake = mtk_raw_irq_coal_event(&dev->irq_coal,
+				      cls != MTK_CAM_IRQ_CLASS_DONE,
+				      info->ts_ns);
+
+	/* the first event held starts the flush deadline */
+	if (!wake && dev->irq_coal.pending == 1)
+		hrtimer_start(&dev->irq_flush_timer,
+			      ns_to_ktime(dev->irq_coal.flush_ns),
+			      HRTIMER_MODE_REL);
 
-	if (unlikely(kfifo_avail(&dev->msg_fifo) < sizeof(*info))) {
+	/* folded into a full ring, the thread reports it and must catch up */
+	if (unlikely(!mtk_cam_irq_queue_push(&dev->msg_q, cls, info))) {
 		atomic_set(&dev->is_fifo_overflow, 1);
-		return -1;
+		wake = true;
 	}
 
-	len = kfifo_in(&dev->msg_fifo, info, sizeof(*info));
-	WARN_ON(len != sizeof(*info));
+	return wake;
+}
 
-	return 0;
+static bool pop_msgfifo(struct mtk_raw_device *dev,
+			struct mtk_cam_irq_msg *msg)
+{
+	unsigned long flags;
+	bool ret;
+
+	spin_lock_irqsave(&dev->msg_lock, flags);
+	ret = mtk_cam_irq_queue_pop(&dev->msg_q, msg);
+	spin_unlock_irqrestore(&dev->msg_lock, flags);
+
+	return ret;
+}
+
+/* no urgent event came to hand the held ones over, e.g. the sensor stopped */
+static enum hrtimer_restart mtk_raw_irq_flush(struct hrtimer *t)
+{
+	struct mtk_raw_device *dev =
+		container_of(t, struct mtk_raw_device, irq_flush_timer);
+	unsigned long flags;
+	bool wake;
+
+	spin_lock_irqsave(&dev->msg_lock, flags);
+	wake = mtk_raw_irq_coal_flush(&dev->irq_coal);
+	spin_unlock_irqrestore(&dev->msg_lock, flags);
+
+	if (wake)
+		irq_wake_thread(dev->irq, dev);
+
+	return HRTIMER_NORESTART;
+}
+
+static void dump_irq_coal(struct mtk_raw_device *dev)
+{
+	struct mtk_raw_irq_coal *c = &dev->irq_coal;
+
+	if (!c->events)
+		return;
+
+	dev_dbg(dev->dev,
+		"irq events:%llu wakeups:%llu coalesced:%llu flushes:%llu poll_enter:%u\n",
+		c->events, c->wakeups, c->coalesced, c->flushes,
+		c->poll_enter);
 }
 
 #define FIFO_THRESHOLD(FIFO_SIZE, HEIGHT_RATIO, LOW_RATIO) \
@@ -1893,6 +1896,13 @@ void stream_on(struct mtk_raw_device *dev, int on)
 	pipe = dev->pipeline;
 	feature = pipe->feature_active;
 
+	/* the TG stays off, frames are timed by the virtual sensor */
+	if (on && dev->virt) {
+		atomic_set(&dev->vf_en, 1);
+		mtk_cam_virt_vf_on(dev->virt);
+		return;
+	}
+
 	if (on) {
 		if (!pipe->res_config.enable_hsf_raw) {
 #if USINGSCQ
@@ -1975,61 +1985,6 @@ void stream_on(struct mtk_raw_device *dev, int on)
 	}
 }
 
-static int mtk_raw_linebuf_chk(bool b_twin, bool b_bin, bool b_frz, bool b_qbn,
-			       bool b_cbn, int tg_x, int *frz_ratio)
-{
-	int input_x = tg_x;
-	/* max line buffer check for frontal binning and resizer */
-	if (b_twin) {
-		if (input_x > CAM_TWIN_PROCESS_MAX_LINE_BUFFER)
-			return LB_CHECK_TWIN;
-		input_x = input_x >> 1;
-	}
-	if (b_cbn) {
-		if (input_x > CAM_RAW_CBN_MAX_LINE_BUFFER)
-			return LB_CHECK_CBN;
-		input_x = input_x >> 1;
-	}
-	if (b_qbn) {
-		if (input_x > CAM_RAW_QBND_MAX_LINE_BUFFER)
-			return LB_CHECK_QBN;
-		input_x = input_x >> 1;
-	}
-	if (b_bin) {
-		if (input_x > CAM_RAW_BIN_MAX_LINE_BUFFER)
-			return LB_CHECK_BIN;
-		input_x = input_x >> 1;
-	}
-	if (input_x <= CAM_RAW_PROCESS_MAX_LINE_BUFFER) {
-		return LB_CHECK_OK;
-	} else if (b_frz) {
-		if (input_x > CAM_RAW_FRZ_MAX_LINE_BUFFER)
-			return LB_CHECK_FRZ;
-
-		*frz_ratio = input_x * 100 /
-			CAM_RAW_PROCESS_MAX_LINE_BUFFER;
-		return LB_CHECK_OK;
-	} else {
-		return LB_CHECK_RAW;
-	}
-}
-
-static int mtk_raw_pixelmode_calc(int rawpxl, int b_twin, bool b_bin,
-				  bool b_frz, int min_ratio)
-{
-	int pixelmode = rawpxl;
-
-	pixelmode = (b_twin == 2) ? pixelmode << 2 : pixelmode;
-	pixelmode = (b_twin == 1) ? pixelmode << 1 : pixelmode;
-	pixelmode = b_bin ? pixelmode << 1 : pixelmode;
-	pixelmode = (b_frz && (min_ratio < FRZ_PXLMODE_THRES))
-			? pixelmode << 1 : pixelmode;
-	pixelmode = (pixelmode > TGO_MAX_PXLMODE) ?
-		TGO_MAX_PXLMODE : pixelmode;
-
-	return pixelmode;
-}
-
 static void mtk_raw_update_debug_param(struct mtk_cam_device *cam,
 				       struct mtk_cam_resource_config *res,
 				       int *clk_idx)
@@ -2071,35 +2026,18 @@ static void mtk_raw_update_debug_param(struct mtk_cam_device *cam,
 
 }
 
-static bool is_cbn_en(int bin_flag)
-{
-	switch (bin_flag) {
-	case CBN_2X2_ON:
-	case CBN_3X3_ON:
-	case CBN_4X4_ON:
-		return true;
-	default:
-		return false;
-	}
-}
-
 static bool mtk_raw_resource_calc(struct mtk_cam_device *cam,
 				  struct mtk_cam_resource_config *res,
 				  s64 pixel_rate, int res_plan,
 				  int in_w, int in_h, int *out_w, int *out_h)
 {
 	struct mtk_camsys_dvfs *clk = &cam->camsys_ctrl.dvfs_info;
-	u64 eq_throughput = clk->clklv[0];
-	int res_step_type = 0;
-	int tgo_pxl_mode = 1;
-	int pixel_mode[MTK_CAMSYS_RES_STEP_NUM] = {0};
-	int bin_temp = 0, frz_temp = 0, hwn_temp = 0;
-	int bin_en = 0, frz_en = 0, twin_en = 0, clk_cur = 0;
-	int idx = 0, clk_res = 0, idx_res = 0;
-	bool res_found = false;
-	int lb_chk_res = -1;
-	int frz_ratio = 100;
-	int p;
+	struct mtk_raw *raw = &cam->raw;
+	struct mtk_raw_res_in in;
+	struct mtk_raw_res_out plan;
+	u64 eq_throughput;
+	int clk_res;
+	bool res_found;
 
 	res->res_plan = res_plan;
 	res->pixel_rate = pixel_rate;
@@ -2112,136 +2050,47 @@ static bool mtk_raw_resource_calc(struct mtk_cam_device *cam,
 		"[Res] PR = %lld, w/h=%d/%d HWN(%d)/BIN(%d)/FRZ(%d),Plan:%d\n",
 		res->pixel_rate, in_w, in_h,
 		res->hwn_limit_max, res->bin_limit, res->frz_limit, res->res_plan);
-	memcpy(res->res_strategy, raw_resource_strategy_plan + res->res_plan,
-	       MTK_CAMSYS_RES_STEP_NUM * sizeof(int));
-	res->bin_enable = 0;
-	res->raw_num_used = 1;
-	res->frz_enable = 0;
-	res->frz_ratio = frz_ratio;
-	for (idx = 0; idx < MTK_CAMSYS_RES_STEP_NUM ; idx++) {
-		res_step_type = res->res_strategy[idx] & MTK_CAMSYS_RES_IDXMASK;
-		switch (res_step_type) {
-		case MTK_CAMSYS_RES_BIN_TAG:
-			bin_temp = res->res_strategy[idx] - E_RES_BIN_S;
-			if (bin_temp <= res->bin_limit)
-				bin_en = bin_temp;
-			if (bin_en && frz_en)
-				frz_en = 0;
-			break;
-		case MTK_CAMSYS_RES_FRZ_TAG:
-			frz_temp = res->res_strategy[idx] - E_RES_FRZ_S;
-			if (res->frz_limit < 100)
-				frz_en = frz_temp;
-			break;
-		case MTK_CAMSYS_RES_HWN_TAG:
-			hwn_temp = res->res_strategy[idx] - E_RES_HWN_S;
-			if (hwn_temp + 1 <= res->hwn_limit_max)
-				twin_en = hwn_temp;
-			break;
-		case MTK_CAMSYS_RES_CLK_TAG:
-			clk_cur = res->res_strategy[idx] - E_RES_CLK_S;
-			break;
-		default:
-			break;
-		}
 
-		/* 1 for force bin on */
-		if (res->bin_limit >= 1)
-			bin_en = 1;
-
-		if (res->hwn_limit_min > 1)
-			twin_en = 1;
-
-		/* max line buffer check*/
-		lb_chk_res = mtk_raw_linebuf_chk(twin_en, res->bin_limit & BIN_ON,
-						 frz_en, res->bin_limit & QBND_ON,
-						 is_cbn_en(res->bin_limit),
-						 in_w, &frz_ratio);
-		/* frz ratio*/
-		if (res_step_type == MTK_CAMSYS_RES_FRZ_TAG) {
-			if (eq_throughput > res->pixel_rate &&
-			    lb_chk_res == LB_CHECK_OK)
-				res->frz_ratio = frz_ratio;
-			else
-				res->frz_ratio =
-					res->frz_limit < FRZ_PXLMODE_THRES
-					? res->frz_limit : FRZ_PXLMODE_THRES;
-		}
-		if (res->raw_feature & MTK_CAM_FEATURE_TIMESHARE_MASK) {
-			tgo_pxl_mode = mtk_raw_pixelmode_calc(MTK_CAMSYS_PROC_DEFAULT_PIXELMODE,
-					twin_en, bin_en, frz_en, res->frz_ratio);
-			pixel_mode[idx] = tgo_pxl_mode;
-			if (lb_chk_res == LB_CHECK_OK) {
-				res->bin_enable = bin_en;
-				res->frz_enable = frz_en;
-				res->raw_num_used = twin_en + 1;
-				clk_res = clk_cur;
-				idx_res = idx;
-				res->clk_target = clk->clklv[clk_res];
-				res_found = true;
-			}
-		} else {
-			/*try 1-pixel mode first*/
-			for (p = 1; p <= MTK_CAMSYS_PROC_DEFAULT_PIXELMODE; p++) {
-				tgo_pxl_mode = mtk_raw_pixelmode_calc(p, twin_en, bin_en, frz_en,
-									res->frz_ratio);
-				/**
-				 * isp throughput along resource strategy
-				 * (compared with pixel rate)
-				 */
-				pixel_mode[idx] = tgo_pxl_mode;
-				eq_throughput = ((u64)tgo_pxl_mode) * clk->clklv[clk_cur];
-				if ((eq_throughput > res->pixel_rate) &&
-					(lb_chk_res == LB_CHECK_OK)) {
-					if (!res_found) {
-						res->bin_enable = bin_en;
-						res->frz_enable = frz_en;
-						res->raw_num_used = twin_en + 1;
-						clk_res = clk_cur;
-						idx_res = idx;
-						res->clk_target = clk->clklv[clk_res];
-						res_found = true;
-						break;
-					}
-				}
-			}
-		}
-		dev_dbg(cam->dev, "Res-%d B/F/H/C=%d/%d/%d/%d -> %d/%d/%d/%d (%d)(%d):%10llu\n",
-			idx, bin_temp, frz_temp, hwn_temp, clk_cur, bin_en,
-			frz_en, twin_en, clk_cur, lb_chk_res, pixel_mode[idx],
-			eq_throughput);
-	}
-
-	tgo_pxl_mode = pixel_mode[idx_res];
-	switch (tgo_pxl_mode) {
-	case 1:
-		res->tgo_pxl_mode = 0;
-		break;
-	case 2:
-		res->tgo_pxl_mode = 1;
-		break;
-	case 4:
-		res->tgo_pxl_mode = 2;
-		break;
-	case 8:
-		res->tgo_pxl_mode = 3;
-		break;
-	default:
-		break;
-	}
+	memset(&in, 0, sizeof(in));
+	in.in_w = in_w;
+	in.in_h = in_h;
+	in.pixel_rate = res->pixel_rate;
+	in.res_plan = res->res_plan;
+	in.bin_limit = res->bin_limit;
+	in.frz_limit = res->frz_limit;
+	in.hwn_limit_max = res->hwn_limit_max;
+	in.hwn_limit_min = res->hwn_limit_min;
+	in.timeshare = !!(res->raw_feature & MTK_CAM_FEATURE_TIMESHARE_MASK);
+	in.clklv = clk->clklv;
+	in.clklv_num = clk->clklv_num;
+
+	mutex_lock(&raw->res_cache_lock);
+	res_found = mtk_raw_res_plan_cached(&raw->res_cache, &in, &plan);
+	dev_dbg(cam->dev, "[Res] cache hit/miss=%u/%u\n",
+		raw->res_cache.hit, raw->res_cache.miss);
+	mutex_unlock(&raw->res_cache_lock);
+
+	memcpy(res->res_strategy, plan.res_strategy, sizeof(res->res_strategy));
+	res->bin_enable = plan.bin_enable;
+	res->frz_enable = plan.frz_enable;
+	res->frz_ratio = plan.frz_ratio;
+	res->raw_num_used = plan.raw_num_used;
+	res->tgo_pxl_mode = plan.tgo_pxl_mode;
+	res->clk_target = plan.clk_target;
+	clk_res = plan.clk_idx;
 
 	mtk_raw_update_debug_param(cam, res, &clk_res);
 
 	eq_throughput = ((u64)(1 << res->tgo_pxl_mode)) * res->clk_target;
 	if (res_found) {
-		dev_info(cam->dev, "Res-end:%d BIN/FRZ/HWN/CLK/pxl=%d/%d(%d)/%d/%d/%d:%10llu, clk:%d\n",
-			idx_res, res->bin_enable, res->frz_enable, res->frz_ratio,
-			res->raw_num_used, clk_res, res->tgo_pxl_mode, eq_throughput,
-			res->clk_target);
+		dev_info(cam->dev, "Res-end:%d BIN/FRZ/HWN/CLK/pxl=%d/%d(%d)/%d/%d(%d)/%d:%10llu, clk:%d\n",
+			plan.step_idx, res->bin_enable, res->frz_enable, res->frz_ratio,
+			res->raw_num_used, clk_res, plan.step_clk_idx,
+			res->tgo_pxl_mode, eq_throughput, res->clk_target);
 	} else {
 		dev_dbg(cam->dev, "[%s] Error resource result; use %dMhz\n",
-			__func__, clk->clklv[clk_cur]);
-		res->clk_target = clk->clklv[clk_cur];
+			__func__, clk->clklv[plan.clk_idx]);
+		res->clk_target = clk->clklv[plan.clk_idx];
 	}
 	if (res->bin_enable) {
 		*out_w = in_w >> 1;
@@ -2351,6 +2200,10 @@ static irqreturn_t mtk_irq_raw(int irq, void *data)
 		goto ctx_not_found;
 	}
 
+	/* the virtual sensor feeds the thread on its own */
+	if (unlikely(raw_dev->virt))
+		goto ctx_not_found;
+
 	irq_info.irq_type = 0;
 	irq_info.ts_ns = ktime_get_boottime_ns();
 	irq_info.frame_idx = frame_idx;
@@ -2391,8 +2244,10 @@ static irqreturn_t mtk_irq_raw(int irq, void *data)
 		++raw_dev->cur_vsync_idx;
 	}
 
+	spin_lock(&raw_dev->msg_lock);
+
 	if (irq_info.irq_type && !raw_dev->is_slave) {
-		if (push_msgfifo(raw_dev, &irq_info) == 0)
+		if (queue_msgfifo(raw_dev, &irq_info))
 			wake_thread = 1;
 	}
 
@@ -2406,10 +2261,12 @@ static irqreturn_t mtk_irq_raw(int irq, void *data)
 		err_info.frame_idx_inner = irq_info.frame_idx_inner;
 		err_info.e.err_status = err_status;
 
-		if (push_msgfifo(raw_dev, &err_info) == 0)
+		if (queue_msgfifo(raw_dev, &err_info))
 			wake_thread = 1;
 	}
 
+	spin_unlock(&raw_dev->msg_lock);
+
 	/* enable to debug fbc related */
 	if (debug_raw && debug_dump_fbc && (irq_status & SOF_INT_ST))
 		mtk_cam_raw_dump_fbc(raw_dev->dev, raw_dev->base, raw_dev->yuv_base);
@@ -2423,20 +2280,25 @@ static irqreturn_t mtk_thread_irq_raw(int irq, void *data)
 {
 	struct mtk_raw_device *raw_dev = (struct mtk_raw_device *)data;
 	struct mtk_camsys_irq_info irq_info;
+	struct mtk_cam_irq_msg msg;
 
 	if (unlikely(atomic_cmpxchg(&raw_dev->is_fifo_overflow, 1, 0)))
-		dev_info(raw_dev->dev, "msg fifo overflow\n");
+		dev_info(raw_dev->dev, "msg fifo overflow, events folded\n");
 
-	while (kfifo_len(&raw_dev->msg_fifo) >= sizeof(irq_info)) {
-		int len = kfifo_out(&raw_dev->msg_fifo, &irq_info, sizeof(irq_info));
+	while (pop_msgfifo(raw_dev, &msg)) {
+		/* the older frames of a done folded on overflow */
+		if (unlikely(mtk_cam_irq_msg_split(&msg, &irq_info)))
+			mtk_camsys_isr_event(raw_dev->cam,
+					     CAMSYS_ENGINE_RAW, raw_dev->id,
+					     &irq_info);
 
-		WARN_ON(len != sizeof(irq_info));
+		irq_info = msg.info;
 
-		dev_dbg(raw_dev->dev, "ts=%llu irq_type %d, req:%d/%d\n",
+		dev_dbg(raw_dev->dev, "ts=%llu irq_type %d, req:%d/%d cnt:%u\n",
 			irq_info.ts_ns / 1000,
 			irq_info.irq_type,
 			irq_info.frame_idx_inner,
-			irq_info.frame_idx);
+			irq_info.frame_idx, msg.count);
 
 		/* error case */
 		if (unlikely(irq_info.irq_type == (1 << CAMSYS_IRQ_ERROR))) {
@@ -2455,6 +2317,45 @@ static irqreturn_t mtk_thread_irq_raw(int irq, void *data)
 	return IRQ_HANDLED;
 }
 
+int mtk_raw_inject_irq(struct mtk_raw_device *dev,
+		       struct mtk_camsys_irq_info *info)
+{
+	unsigned long flags;
+	bool wake;
+
+	if (!dev->pipeline || !dev->pipeline->enabled_raw)
+		return -ENODEV;
+
+	if (!info->ts_ns)
+		info->ts_ns = ktime_get_boottime_ns();
+
+	spin_lock_irqsave(&dev->msg_lock, flags);
+	wake = queue_msgfifo(dev, info);
+	spin_unlock_irqrestore(&dev->msg_lock, flags);
+
+	if (wake)
+		irq_wake_thread(dev->irq, dev);
+
+	return 0;
+}
+
+static ssize_t irq_stats_show(struct device *dev,
+			      struct device_attribute *attr, char *buf)
+{
+	struct mtk_raw_device *raw_dev = dev_get_drvdata(dev);
+	struct mtk_raw_irq_coal *c = &raw_dev->irq_coal;
+	int len;
+
+	len = mtk_cam_irq_queue_show(&raw_dev->msg_q, buf, PAGE_SIZE);
+	len += snprintf(buf + len, PAGE_SIZE - len,
+			"polling: %d wakeups %llu coalesced %llu flushes %llu\n",
+			c->polling, c->wakeups, c->coalesced, c->flushes);
+
+	return len;
+}
+
+static DEVICE_ATTR_RO(irq_stats);
+
 void raw_irq_handle_tg_grab_err(struct mtk_raw_device *raw_dev,
 					int dequeued_frame_seq_no)
 {
@@ -3823,6 +3724,11 @@ static int mtk_raw_set_fmt(struct v4l2_subdev *sd,
 		return -EINVAL;
 	}
 
+	if (mtk_cam_req_s_data_alloc(cam_req, pipe->id)) {
+		media_request_put(req);
+		return -ENOMEM;
+	}
+
 	stream_data = mtk_cam_req_get_s_data_no_chk(cam_req, pipe->id, 0);
 	stream_data->pad_fmt_update |= (1 << fmt->pad);
 	stream_data->pad_fmt[fmt->pad] = *fmt;
@@ -5836,6 +5742,9 @@ int mtk_raw_register_entities(struct mtk_raw *raw, struct v4l2_device *v4l2_dev)
 	unsigned int i;
 	int ret;
 
+	mutex_init(&raw->res_cache_lock);
+	mtk_raw_res_cache_reset(&raw->res_cache);
+
 	for (i = 0; i < cam_dev->num_raw_drivers; i++) {
 		struct mtk_raw_pipeline *pipe = raw->pipelines + i;
 
@@ -5858,6 +5767,8 @@ void mtk_raw_unregister_entities(struct mtk_raw *raw)
 
 	for (i = 0; i < cam_dev->num_raw_drivers; i++)
 		mtk_raw_pipeline_unregister(raw->pipelines + i);
+
+	mutex_destroy(&raw->res_cache_lock);
 }
 
 static int mtk_raw_component_bind(struct device *dev, struct device *master,
@@ -5914,11 +5825,14 @@ static int mtk_raw_probe(struct platform_device *pdev)
 	if (ret)
 		return ret;
 
-	raw_dev->fifo_size =
-		roundup_pow_of_two(8 * sizeof(struct mtk_camsys_irq_info));
-	raw_dev->msg_buffer = devm_kzalloc(dev, raw_dev->fifo_size, GFP_KERNEL);
-	if (!raw_dev->msg_buffer)
-		return -ENOMEM;
+	spin_lock_init(&raw_dev->msg_lock);
+	hrtimer_init(&raw_dev->irq_flush_timer, CLOCK_MONOTONIC,
+		     HRTIMER_MODE_REL);
+	raw_dev->irq_flush_timer.function = mtk_raw_irq_flush;
+
+	ret = device_create_file(dev, &dev_attr_irq_stats);
+	if (ret)
+		dev_info(dev, "failed to create irq_stats:%d\n", ret);
 
 	pm_runtime_enable(dev);
 
@@ -5934,8 +5848,10 @@ static int mtk_raw_remove(struct platform_device *pdev)
 	dev_info(dev, "%s\n", __func__);
 
 	unregister_pm_notifier(&raw_dev->pm_notifier);
+	device_remove_file(dev, &dev_attr_irq_stats);
 
 	pm_runtime_disable(dev);
+	hrtimer_cancel(&raw_dev->irq_flush_timer);
 	component_del(dev, &mtk_raw_component_ops);
 
 	for (i = 0; i < raw_dev->num_clks; i++)
@@ -5952,6 +5868,8 @@ static int mtk_raw_runtime_suspend(struct device *dev)
 	dev_dbg(dev, "%s:disable clock\n", __func__);
 
 	disable_irq(drvdata->irq);
+	hrtimer_cancel(&drvdata->irq_flush_timer);
+	dump_irq_coal(drvdata);
 
 	reset(drvdata);
 
@@ -5967,9 +5885,7 @@ static int mtk_raw_runtime_resume(struct device *dev)
 	int i, ret;
 
 	/* reset_msgfifo before enable_irq */
-	ret = reset_msgfifo(drvdata);
-	if (ret)
-		return ret;
+	reset_msgfifo(drvdata);
 
 	enable_irq(drvdata->irq);
 
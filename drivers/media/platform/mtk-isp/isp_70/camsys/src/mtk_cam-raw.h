@@ -6,12 +6,16 @@
 #ifndef __MTK_CAM_RAW_H
 #define __MTK_CAM_RAW_H
 
-#include <linux/kfifo.h>
+#include <linux/hrtimer.h>
 #include <media/v4l2-subdev.h>
 #include "mtk_cam-video.h"
 #include "mtk_camera-v4l2-controls.h"
+#include "mtk_cam-raw-res.h"
+#include "mtk_cam-raw-irq.h"
 
 struct mtk_cam_request_stream_data;
+struct mtk_camsys_irq_info;
+struct mtk_cam_virt;
 
 #ifdef ISP7_1
 #define RAW_PIPELINE_NUM 3
@@ -21,7 +25,6 @@ struct mtk_cam_request_stream_data;
 #define SCQ_DEADLINE_MS  15 // ~1/2 frame length
 #define SCQ_DEFAULT_CLK_RATE 208 // default 208MHz
 #define USINGSCQ 1
-#define MTK_CAMSYS_RES_STEP_NUM	8
 
 /* FIXME: dynamic config image max/min w/h */
 #ifdef ISP7_1
@@ -284,10 +287,13 @@ struct mtk_raw_device {
 	struct notifier_block pm_notifier;
 #endif
 
-	int		fifo_size;
-	void		*msg_buffer;
-	struct kfifo	msg_fifo;
+	/* top half and mtk_raw_inject_irq to the irq thread */
+	spinlock_t	msg_lock;
+	struct mtk_cam_irq_queue msg_q;
 	atomic_t	is_fifo_overflow;
+	struct mtk_raw_irq_coal irq_coal;
+	/* hands the coalesced events over once flush_ns passed */
+	struct hrtimer irq_flush_timer;
 
 	struct mtk_raw_pipeline *pipeline;
 	bool is_slave;
@@ -305,6 +311,9 @@ struct mtk_raw_device {
 	atomic_t vf_en;
 	u32 stagger_en;
 	int overrun_debug_dump_cnt;
+
+	/* set while the frames run on a virtual sensor */
+	struct mtk_cam_virt *virt;
 };
 
 struct mtk_yuv_device {
@@ -338,6 +347,9 @@ struct mtk_raw {
 	struct device *devs[RAW_PIPELINE_NUM];
 	struct device *yuvs[RAW_PIPELINE_NUM];
 	struct mtk_raw_pipeline pipelines[RAW_PIPELINE_NUM];
+	/* memoised mtk_raw_resource_calc results, shared by all pipelines */
+	struct mutex res_cache_lock;
+	struct mtk_raw_res_cache res_cache;
 };
 
 struct mtk_raw_stagger_select {
@@ -388,6 +400,10 @@ void trigger_rawi(struct mtk_raw_device *dev, struct mtk_cam_ctx *ctx,
 
 void reset(struct mtk_raw_device *dev);
 
+/* feed a synthetic event through the top half queue, see mtk_cam-virt.h */
+int mtk_raw_inject_irq(struct mtk_raw_device *dev,
+		       struct mtk_camsys_irq_info *info);
+
 void dump_aa_info(struct mtk_cam_ctx *ctx,
 				 struct mtk_ae_debug_data *ae_info);
 
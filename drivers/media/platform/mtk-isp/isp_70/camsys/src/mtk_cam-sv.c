@@ -396,6 +396,11 @@ static int mtk_camsv_set_fmt(struct v4l2_subdev *sd,
 		return -EINVAL;
 	}
 
+	if (mtk_cam_req_s_data_alloc(cam_req, pipe->id)) {
+		media_request_put(req);
+		return -ENOMEM;
+	}
+
 	stream_data = mtk_cam_req_get_s_data_no_chk(cam_req, pipe->id, 0);
 	stream_data->pad_fmt_update |= (1 << fmt->pad);
 	stream_data->pad_fmt[fmt->pad] = *fmt;
@@ -695,28 +700,49 @@ static const char *sv_capture_queue_names[CAMSV_PIPELINE_NUM][MTK_CAMSV_TOTAL_CA
 #endif
 };
 
-static int reset_msgfifo(struct mtk_camsv_device *dev)
+static void reset_msgfifo(struct mtk_camsv_device *dev)
 {
+	unsigned long flags;
+
+	spin_lock_irqsave(&dev->msg_lock, flags);
+	mtk_cam_irq_queue_reset(&dev->msg_q);
 	atomic_set(&dev->is_fifo_overflow, 0);
-	return kfifo_init(&dev->msg_fifo, dev->msg_buffer, dev->fifo_size);
+	spin_unlock_irqrestore(&dev->msg_lock, flags);
 }
 
-static int push_msgfifo(struct mtk_camsv_device *dev,
-			struct mtk_camsys_irq_info *info)
+static void push_msgfifo(struct mtk_camsv_device *dev,
+			 enum mtk_cam_irq_class cls,
+			 struct mtk_camsys_irq_info *info)
 {
-	int len;
-
-	if (unlikely(kfifo_avail(&dev->msg_fifo) < sizeof(*info))) {
+	spin_lock(&dev->msg_lock);
+	if (unlikely(!mtk_cam_irq_queue_push(&dev->msg_q, cls, info)))
 		atomic_set(&dev->is_fifo_overflow, 1);
-		return -1;
-	}
+	spin_unlock(&dev->msg_lock);
+}
 
-	len = kfifo_in(&dev->msg_fifo, info, sizeof(*info));
-	WARN_ON(len != sizeof(*info));
+static bool pop_msgfifo(struct mtk_camsv_device *dev,
+			struct mtk_cam_irq_msg *msg)
+{
+	unsigned long flags;
+	bool ret;
 
-	return 0;
+	spin_lock_irqsave(&dev->msg_lock, flags);
+	ret = mtk_cam_irq_queue_pop(&dev->msg_q, msg);
+	spin_unlock_irqrestore(&dev->msg_lock, flags);
+
+	return ret;
 }
 
+static ssize_t irq_stats_show(struct device *dev,
+			      struct device_attribute *attr, char *buf)
+{
+	struct mtk_camsv_device *camsv_dev = dev_get_drvdata(dev);
+
+	return mtk_cam_irq_queue_show(&camsv_dev->msg_q, buf, PAGE_SIZE);
+}
+
+static DEVICE_ATTR_RO(irq_stats);
+
 void sv_reset(struct mtk_camsv_device *dev)
 {
 #ifdef ISP7_1
@@ -2513,8 +2539,13 @@ static irqreturn_t mtk_irq_camsv(int irq, void *data)
 		camsv_dev->sof_count++;
 	}
 
-	if (irq_info.irq_type && push_msgfifo(camsv_dev, &irq_info) == 0)
+	if (irq_info.irq_type) {
+		push_msgfifo(camsv_dev, (irq_info.irq_type &
+			     (1 << CAMSYS_IRQ_FRAME_START)) ?
+			     MTK_CAM_IRQ_CLASS_SOF : MTK_CAM_IRQ_CLASS_DONE,
+			     &irq_info);
 		wake_thread = 1;
+	}
 
 	/* Check ISP error status */
 	if (err_status) {
@@ -2526,8 +2557,8 @@ static irqreturn_t mtk_irq_camsv(int irq, void *data)
 		err_info.frame_idx_inner = irq_info.frame_idx_inner;
 		err_info.e.err_status = err_status;
 
-		if (push_msgfifo(camsv_dev, &err_info) == 0)
-			wake_thread = 1;
+		push_msgfifo(camsv_dev, MTK_CAM_IRQ_CLASS_ERR, &err_info);
+		wake_thread = 1;
 	}
 
 	return wake_thread ? IRQ_WAKE_THREAD : IRQ_HANDLED;
@@ -2537,14 +2568,19 @@ static irqreturn_t mtk_thread_irq_camsv(int irq, void *data)
 {
 	struct mtk_camsv_device *camsv_dev = (struct mtk_camsv_device *)data;
 	struct mtk_camsys_irq_info irq_info;
+	struct mtk_cam_irq_msg msg;
 
 	if (unlikely(atomic_cmpxchg(&camsv_dev->is_fifo_overflow, 1, 0)))
-		dev_info(camsv_dev->dev, "msg fifo overflow\n");
+		dev_info(camsv_dev->dev, "msg fifo overflow, events folded\n");
 
-	while (kfifo_len(&camsv_dev->msg_fifo) >= sizeof(irq_info)) {
-		int len = kfifo_out(&camsv_dev->msg_fifo, &irq_info, sizeof(irq_info));
+	while (pop_msgfifo(camsv_dev, &msg)) {
+		/* the older frames of a done folded on overflow */
+		if (unlikely(mtk_cam_irq_msg_split(&msg, &irq_info)))
+			mtk_camsys_isr_event(camsv_dev->cam,
+					     CAMSYS_ENGINE_CAMSV, camsv_dev->id,
+					     &irq_info);
 
-		WARN_ON(len != sizeof(irq_info));
+		irq_info = msg.info;
 
 		/* error case */
 		if (unlikely(irq_info.irq_type == CAMSYS_IRQ_ERROR)) {
@@ -2900,12 +2936,11 @@ static int mtk_camsv_probe(struct platform_device *pdev)
 	pm_runtime_use_autosuspend(dev);
 #endif
 
-	camsv_dev->fifo_size =
-		roundup_pow_of_two(8 * sizeof(struct mtk_camsys_irq_info));
-	camsv_dev->msg_buffer = devm_kzalloc(dev, camsv_dev->fifo_size,
-					     GFP_KERNEL);
-	if (!camsv_dev->msg_buffer)
-		return -ENOMEM;
+	spin_lock_init(&camsv_dev->msg_lock);
+
+	ret = device_create_file(dev, &dev_attr_irq_stats);
+	if (ret)
+		dev_info(dev, "failed to create irq_stats:%d\n", ret);
 
 	pm_runtime_enable(dev);
 
@@ -2918,6 +2953,7 @@ static int mtk_camsv_remove(struct platform_device *pdev)
 
 	dev_info(dev, "%s\n", __func__);
 
+	device_remove_file(dev, &dev_attr_irq_stats);
 	pm_runtime_disable(dev);
 
 	component_del(dev, &mtk_camsv_component_ops);
@@ -2945,9 +2981,7 @@ static int mtk_camsv_runtime_resume(struct device *dev)
 	int i, ret;
 
 	/* reset_msgfifo before enable_irq */
-	ret = reset_msgfifo(camsv_dev);
-	if (ret)
-		return ret;
+	reset_msgfifo(camsv_dev);
 
 	enable_irq(camsv_dev->irq);
 
@@ -6,9 +6,9 @@
 #ifndef __MTK_CAM_SV_H
 #define __MTK_CAM_SV_H
 
-#include <linux/kfifo.h>
 #include <linux/suspend.h>
 
+#include "mtk_cam-raw-irq.h"
 #include "mtk_cam-video.h"
 
 #define PDAF_READY 0
@@ -208,9 +208,8 @@ struct mtk_camsv_device {
 	unsigned int hw_cap;
 	unsigned int cammux_id;
 
-	int fifo_size;
-	void *msg_buffer;
-	struct kfifo msg_fifo;
+	spinlock_t msg_lock;
+	struct mtk_cam_irq_queue msg_q;
 	atomic_t is_fifo_overflow;
 
 	unsigned int sof_count;
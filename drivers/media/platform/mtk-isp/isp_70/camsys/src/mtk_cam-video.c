@@ -11,7 +11,6 @@
 #include "mtk_cam-feature.h"
 #include "mtk_cam-video.h"
 #include "mtk_camera-v4l2-controls.h"
-#include "mtk_cam-ufbc-def.h"
 
 #include "mtk_cam_vb2-dma-contig.h"
 
@@ -19,49 +18,6 @@
 #include <linux/platform_data/mtk_ccd.h>
 static struct mtk_ccd *g_ccd;
 
-/*
- * Note
- *	differt dma(fmt) would have different bus_size
- *	align xsize(bytes per line) with [bus_size * pixel_mode]
- */
-static inline
-int mtk_cam_is_fullg(unsigned int ipi_fmt)
-{
-	return (ipi_fmt == MTKCAM_IPI_IMG_FMT_FG_BAYER8)
-		|| (ipi_fmt == MTKCAM_IPI_IMG_FMT_FG_BAYER10)
-		|| (ipi_fmt == MTKCAM_IPI_IMG_FMT_FG_BAYER12);
-}
-
-static inline
-int mtk_cam_dma_bus_size(int bpp, int pixel_mode_shift, int is_fg)
-{
-	unsigned int bus_size = ALIGN(bpp, 16) << pixel_mode_shift;
-
-	if (is_fg)
-		bus_size <<= 1;
-	return bus_size / 8; /* in bytes */
-}
-
-static inline
-int mtk_cam_yuv_dma_bus_size(int bpp, int pixel_mode_shift)
-{
-	unsigned int bus_size = ALIGN(bpp, 32);
-
-	return bus_size / 8; /* in bytes */
-}
-
-static inline
-int mtk_cam_dmao_xsize(int w, unsigned int ipi_fmt, int pixel_mode_shift)
-{
-	const int is_fg		= mtk_cam_is_fullg(ipi_fmt);
-	const int bpp		= mtk_cam_get_pixel_bits(ipi_fmt);
-	const int bytes		= is_fg ?
-		DIV_ROUND_UP(w * bpp * 3 / 2, 8) : DIV_ROUND_UP(w * bpp, 8);
-	const int bus_size	= mtk_cam_dma_bus_size(bpp, pixel_mode_shift, is_fg);
-
-	return ALIGN(bytes, bus_size);
-}
-
 static int mtk_cam_vb2_queue_setup(struct vb2_queue *vq,
 				   unsigned int *num_buffers,
 				   unsigned int *num_planes,
@@ -366,237 +322,37 @@ static void mtk_cam_vb2_stop_streaming(struct vb2_queue *vq)
 
 int is_mtk_format(u32 pixelformat)
 {
-	switch (pixelformat) {
-	case V4L2_PIX_FMT_YUYV10:
-	case V4L2_PIX_FMT_YVYU10:
-	case V4L2_PIX_FMT_UYVY10:
-	case V4L2_PIX_FMT_VYUY10:
-	case V4L2_PIX_FMT_YUYV12:
-	case V4L2_PIX_FMT_YVYU12:
-	case V4L2_PIX_FMT_UYVY12:
-	case V4L2_PIX_FMT_VYUY12:
-	case V4L2_PIX_FMT_MTISP_YUYV10P:
-	case V4L2_PIX_FMT_MTISP_YVYU10P:
-	case V4L2_PIX_FMT_MTISP_UYVY10P:
-	case V4L2_PIX_FMT_MTISP_VYUY10P:
-	case V4L2_PIX_FMT_MTISP_YUYV12P:
-	case V4L2_PIX_FMT_MTISP_YVYU12P:
-	case V4L2_PIX_FMT_MTISP_UYVY12P:
-	case V4L2_PIX_FMT_MTISP_VYUY12P:
-	case V4L2_PIX_FMT_NV12_10:
-	case V4L2_PIX_FMT_NV21_10:
-	case V4L2_PIX_FMT_NV16_10:
-	case V4L2_PIX_FMT_NV61_10:
-	case V4L2_PIX_FMT_NV12_12:
-	case V4L2_PIX_FMT_NV21_12:
-	case V4L2_PIX_FMT_NV16_12:
-	case V4L2_PIX_FMT_NV61_12:
-	case V4L2_PIX_FMT_MTISP_NV12_10P:
-	case V4L2_PIX_FMT_MTISP_NV21_10P:
-	case V4L2_PIX_FMT_MTISP_NV16_10P:
-	case V4L2_PIX_FMT_MTISP_NV61_10P:
-	case V4L2_PIX_FMT_MTISP_NV12_12P:
-	case V4L2_PIX_FMT_MTISP_NV21_12P:
-	case V4L2_PIX_FMT_MTISP_NV16_12P:
-	case V4L2_PIX_FMT_MTISP_NV61_12P:
-	case V4L2_PIX_FMT_MTISP_NV12_UFBC:
-	case V4L2_PIX_FMT_MTISP_NV21_UFBC:
-	case V4L2_PIX_FMT_MTISP_NV12_10_UFBC:
-	case V4L2_PIX_FMT_MTISP_NV21_10_UFBC:
-	case V4L2_PIX_FMT_MTISP_NV12_12_UFBC:
-	case V4L2_PIX_FMT_MTISP_NV21_12_UFBC:
-	case V4L2_PIX_FMT_MTISP_BAYER8_UFBC:
-	case V4L2_PIX_FMT_MTISP_BAYER10_UFBC:
-	case V4L2_PIX_FMT_MTISP_BAYER12_UFBC:
-	case V4L2_PIX_FMT_MTISP_BAYER14_UFBC:
-		return 1;
-	break;
-	default:
-		return 0;
-	break;
-	}
+	const struct mtk_cam_fmt_desc *desc = mtk_cam_fmt_desc_find(pixelformat);
+
+	return desc && (desc->flags & MTK_CAM_FMT_MTK);
 }
 
 int is_yuv_ufo(u32 pixelformat)
 {
-	switch (pixelformat) {
-	case V4L2_PIX_FMT_MTISP_NV12_UFBC:
-	case V4L2_PIX_FMT_MTISP_NV21_UFBC:
-	case V4L2_PIX_FMT_MTISP_NV12_10_UFBC:
-	case V4L2_PIX_FMT_MTISP_NV21_10_UFBC:
-	case V4L2_PIX_FMT_MTISP_NV12_12_UFBC:
-	case V4L2_PIX_FMT_MTISP_NV21_12_UFBC:
-		return 1;
-	default:
-		return 0;
-	}
+	const struct mtk_cam_fmt_desc *desc = mtk_cam_fmt_desc_find(pixelformat);
+
+	return desc && (desc->flags & MTK_CAM_FMT_YUV_UFO);
 }
 
 int is_raw_ufo(u32 pixelformat)
 {
-	switch (pixelformat) {
-	case V4L2_PIX_FMT_MTISP_BAYER8_UFBC:
-	case V4L2_PIX_FMT_MTISP_BAYER10_UFBC:
-	case V4L2_PIX_FMT_MTISP_BAYER12_UFBC:
-	case V4L2_PIX_FMT_MTISP_BAYER14_UFBC:
-		return 1;
-	default:
-		return 0;
-	}
+	const struct mtk_cam_fmt_desc *desc = mtk_cam_fmt_desc_find(pixelformat);
+
+	return desc && (desc->flags & MTK_CAM_FMT_RAW_UFO);
 }
 
 int is_fullg_rb(u32 pixelformat)
 {
-	switch (pixelformat) {
-	case V4L2_PIX_FMT_MTISP_SGRB8F:
-	case V4L2_PIX_FMT_MTISP_SGRB10F:
-	case V4L2_PIX_FMT_MTISP_SGRB12F:
-		return 1;
-	default:
-		return 0;
-	}
+	const struct mtk_cam_fmt_desc *desc = mtk_cam_fmt_desc_find(pixelformat);
+
+	return desc && (desc->flags & MTK_CAM_FMT_FULLG_RB);
 }
 
 const struct mtk_format_info *mtk_format_info(u32 format)
 {
-	static const struct mtk_format_info formats[] = {
-		/* YUV planar formats */
-		{ .format = V4L2_PIX_FMT_NV12_10,  .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 2,
-			.bit_r_num = 2, .bit_r_den = 1 },
-		{ .format = V4L2_PIX_FMT_NV21_10,  .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 2,
-			.bit_r_num = 2, .bit_r_den = 1 },
-		{ .format = V4L2_PIX_FMT_NV16_10,  .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 2, .bit_r_den = 1 },
-		{ .format = V4L2_PIX_FMT_NV61_10,  .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 2, .bit_r_den = 1 },
-		{ .format = V4L2_PIX_FMT_YUYV10,	  .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 2, 0, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 2, .bit_r_den = 1 },
-		{ .format = V4L2_PIX_FMT_YVYU10,	  .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 2, 0, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 2, .bit_r_den = 1 },
-		{ .format = V4L2_PIX_FMT_UYVY10,	  .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 2, 0, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 2, .bit_r_den = 1 },
-		{ .format = V4L2_PIX_FMT_VYUY10,	  .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 2, 0, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 2, .bit_r_den = 1 },
-		{ .format = V4L2_PIX_FMT_NV12_12,  .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 2,
-			.bit_r_num = 2, .bit_r_den = 1 },
-		{ .format = V4L2_PIX_FMT_NV21_12,  .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 2,
-			.bit_r_num = 2, .bit_r_den = 1 },
-		{ .format = V4L2_PIX_FMT_NV16_12,  .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 2, .bit_r_den = 1 },
-		{ .format = V4L2_PIX_FMT_NV61_12,  .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 2, .bit_r_den = 1 },
-		{ .format = V4L2_PIX_FMT_YUYV12,	  .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 2, 0, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 2, .bit_r_den = 1 },
-		{ .format = V4L2_PIX_FMT_YVYU12,	  .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 2, 0, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 2, .bit_r_den = 1 },
-		{ .format = V4L2_PIX_FMT_UYVY12,	  .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 2, 0, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 2, .bit_r_den = 1 },
-		{ .format = V4L2_PIX_FMT_VYUY12,	  .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 2, 0, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 2, .bit_r_den = 1 },
-		/* YUV packed formats */
-		{ .format = V4L2_PIX_FMT_MTISP_YUYV10P,	  .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 2, 0, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 5, .bit_r_den = 4 },
-		{ .format = V4L2_PIX_FMT_MTISP_YVYU10P,	  .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 2, 0, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 5, .bit_r_den = 4 },
-		{ .format = V4L2_PIX_FMT_MTISP_UYVY10P,	  .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 2, 0, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 5, .bit_r_den = 4 },
-		{ .format = V4L2_PIX_FMT_MTISP_VYUY10P,	  .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 2, 0, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 5, .bit_r_den = 4 },
-		{ .format = V4L2_PIX_FMT_MTISP_NV12_10P, .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 2,
-			.bit_r_num = 5, .bit_r_den = 4 },
-		{ .format = V4L2_PIX_FMT_MTISP_NV21_10P, .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 2,
-			.bit_r_num = 5, .bit_r_den = 4 },
-		{ .format = V4L2_PIX_FMT_MTISP_NV16_10P, .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 5, .bit_r_den = 4 },
-		{ .format = V4L2_PIX_FMT_MTISP_NV61_10P, .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 5, .bit_r_den = 4 },
-		{ .format = V4L2_PIX_FMT_MTISP_YUYV12P,	  .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 2, 0, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 3, .bit_r_den = 2 },
-		{ .format = V4L2_PIX_FMT_MTISP_YVYU12P,	  .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 2, 0, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 3, .bit_r_den = 2 },
-		{ .format = V4L2_PIX_FMT_MTISP_UYVY12P,	  .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 2, 0, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 3, .bit_r_den = 2 },
-		{ .format = V4L2_PIX_FMT_MTISP_VYUY12P,	  .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 2, 0, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 3, .bit_r_den = 2 },
-		{ .format = V4L2_PIX_FMT_MTISP_NV12_12P, .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 2,
-			.bit_r_num = 3, .bit_r_den = 2 },
-		{ .format = V4L2_PIX_FMT_MTISP_NV21_12P, .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 2,
-			.bit_r_num = 3, .bit_r_den = 2 },
-		{ .format = V4L2_PIX_FMT_MTISP_NV16_12P, .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 3, .bit_r_den = 2 },
-		{ .format = V4L2_PIX_FMT_MTISP_NV61_12P, .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 1,
-			.bit_r_num = 3, .bit_r_den = 2 },
-		/* YUV UFBC formats */
-		{ .format = V4L2_PIX_FMT_MTISP_NV12_UFBC, .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 2,
-			.bit_r_num = 2, .bit_r_den = 1 },
-		{ .format = V4L2_PIX_FMT_MTISP_NV21_UFBC, .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 2,
-			.bit_r_num = 2, .bit_r_den = 1 },
-		{ .format = V4L2_PIX_FMT_MTISP_NV12_10_UFBC, .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 2,
-			.bit_r_num = 5, .bit_r_den = 4 },
-		{ .format = V4L2_PIX_FMT_MTISP_NV21_10_UFBC, .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 2,
-			.bit_r_num = 5, .bit_r_den = 4 },
-		{ .format = V4L2_PIX_FMT_MTISP_NV12_12_UFBC, .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 2,
-			.bit_r_num = 3, .bit_r_den = 2 },
-		{ .format = V4L2_PIX_FMT_MTISP_NV21_12_UFBC, .mem_planes = 1, .comp_planes = 2,
-			.bpp = { 1, 2, 0, 0 }, .hdiv = 2, .vdiv = 2,
-			.bit_r_num = 3, .bit_r_den = 2 },
-		{ .format = V4L2_PIX_FMT_MTISP_BAYER8_UFBC, .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 1, 0, 0, 0 }, .hdiv = 1, .vdiv = 1,
-			.bit_r_num = 1, .bit_r_den = 1 },
-		{ .format = V4L2_PIX_FMT_MTISP_BAYER10_UFBC, .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 1, 0, 0, 0 }, .hdiv = 1, .vdiv = 1,
-			.bit_r_num = 5, .bit_r_den = 4 },
-		{ .format = V4L2_PIX_FMT_MTISP_BAYER12_UFBC, .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 1, 0, 0, 0 }, .hdiv = 1, .vdiv = 1,
-			.bit_r_num = 3, .bit_r_den = 2 },
-		{ .format = V4L2_PIX_FMT_MTISP_BAYER14_UFBC, .mem_planes = 1, .comp_planes = 1,
-			.bpp = { 1, 0, 0, 0 }, .hdiv = 1, .vdiv = 1,
-			.bit_r_num = 7, .bit_r_den = 4 },
-
-	};
-	unsigned int i;
+	const struct mtk_cam_fmt_desc *desc = mtk_cam_fmt_desc_find(format);
 
-	for (i = 0; i < ARRAY_SIZE(formats); ++i)
-		if (formats[i].format == format)
-			return &formats[i];
-	return NULL;
+	return desc && (desc->flags & MTK_CAM_FMT_MTK) ? &desc->info : NULL;
 }
 
 static void mtk_cam_vb2_buf_queue(struct vb2_buffer *vb)
@@ -806,95 +562,11 @@ unsigned int mtk_cam_get_sensor_fmt(unsigned int fmt)
 
 unsigned int mtk_cam_get_pixel_bits(unsigned int ipi_fmt)
 {
-	switch (ipi_fmt) {
-	case MTKCAM_IPI_IMG_FMT_BAYER8:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER8:
-		return 8;
-	case MTKCAM_IPI_IMG_FMT_BAYER10:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER10:
-	case MTKCAM_IPI_IMG_FMT_BAYER10_MIPI:
-		return 10;
-	case MTKCAM_IPI_IMG_FMT_BAYER12:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER12:
-		return 12;
-	case MTKCAM_IPI_IMG_FMT_BAYER14:
-	case MTKCAM_IPI_IMG_FMT_UFBC_BAYER14:
-		return 14;
-	case MTKCAM_IPI_IMG_FMT_BAYER10_UNPACKED:
-	case MTKCAM_IPI_IMG_FMT_BAYER12_UNPACKED:
-	case MTKCAM_IPI_IMG_FMT_BAYER14_UNPACKED:
-	case MTKCAM_IPI_IMG_FMT_BAYER16:
-	case MTKCAM_IPI_IMG_FMT_YUYV:
-	case MTKCAM_IPI_IMG_FMT_YVYU:
-	case MTKCAM_IPI_IMG_FMT_UYVY:
-	case MTKCAM_IPI_IMG_FMT_VYUY:
-		return 16;
-	case MTKCAM_IPI_IMG_FMT_Y8:
-	case MTKCAM_IPI_IMG_FMT_YUV_422_2P:
-	case MTKCAM_IPI_IMG_FMT_YVU_422_2P:
-	case MTKCAM_IPI_IMG_FMT_YUV_422_3P:
-	case MTKCAM_IPI_IMG_FMT_YVU_422_3P:
-	case MTKCAM_IPI_IMG_FMT_YUV_420_2P:
-	case MTKCAM_IPI_IMG_FMT_YVU_420_2P:
-	case MTKCAM_IPI_IMG_FMT_YUV_420_3P:
-	case MTKCAM_IPI_IMG_FMT_YVU_420_3P:
-		return 8;
-	case MTKCAM_IPI_IMG_FMT_YUYV_Y210:
-	case MTKCAM_IPI_IMG_FMT_YVYU_Y210:
-	case MTKCAM_IPI_IMG_FMT_UYVY_Y210:
-	case MTKCAM_IPI_IMG_FMT_VYUY_Y210:
-		return 32;
-	case MTKCAM_IPI_IMG_FMT_YUV_P210:
-	case MTKCAM_IPI_IMG_FMT_YVU_P210:
-	case MTKCAM_IPI_IMG_FMT_YUV_P010:
-	case MTKCAM_IPI_IMG_FMT_YVU_P010:
-	case MTKCAM_IPI_IMG_FMT_YUV_P212:
-	case MTKCAM_IPI_IMG_FMT_YVU_P212:
-	case MTKCAM_IPI_IMG_FMT_YUV_P012:
-	case MTKCAM_IPI_IMG_FMT_YVU_P012:
-		return 16;
-	case MTKCAM_IPI_IMG_FMT_YUYV_Y210_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YVYU_Y210_PACKED:
-	case MTKCAM_IPI_IMG_FMT_UYVY_Y210_PACKED:
-	case MTKCAM_IPI_IMG_FMT_VYUY_Y210_PACKED:
-		return 20;
-	case MTKCAM_IPI_IMG_FMT_YUV_P210_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YVU_P210_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YUV_P010_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YVU_P010_PACKED:
-		return 10;
-	case MTKCAM_IPI_IMG_FMT_YUV_P212_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YVU_P212_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YUV_P012_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YVU_P012_PACKED:
-		return 12;
-	case MTKCAM_IPI_IMG_FMT_RGB_8B_3P:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER8_3P:
-	case MTKCAM_IPI_IMG_FMT_UFBC_NV12:
-	case MTKCAM_IPI_IMG_FMT_UFBC_NV21:
-	case MTKCAM_IPI_IMG_FMT_UFBC_BAYER8:
-		return 8;
-	case MTKCAM_IPI_IMG_FMT_RGB_10B_3P_PACKED:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER10_3P_PACKED:
-	case MTKCAM_IPI_IMG_FMT_UFBC_YUV_P010:
-	case MTKCAM_IPI_IMG_FMT_UFBC_YVU_P010:
-	case MTKCAM_IPI_IMG_FMT_UFBC_BAYER10:
-		return 10;
-	case MTKCAM_IPI_IMG_FMT_RGB_12B_3P_PACKED:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER12_3P_PACKED:
-	case MTKCAM_IPI_IMG_FMT_UFBC_YUV_P012:
-	case MTKCAM_IPI_IMG_FMT_UFBC_YVU_P012:
-	case MTKCAM_IPI_IMG_FMT_UFBC_BAYER12:
-		return 12;
-	case MTKCAM_IPI_IMG_FMT_RGB_10B_3P:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER10_3P:
-	case MTKCAM_IPI_IMG_FMT_RGB_12B_3P:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER12_3P:
-		return 16;
+	const struct mtk_cam_ipi_fmt_desc *ipi = mtk_cam_ipi_fmt_desc(ipi_fmt);
+
+	if (ipi && ipi->pixel_bits)
+		return ipi->pixel_bits;
 
-	default:
-		break;
-	}
 	pr_debug("not supported ipi-fmt 0x%08x", ipi_fmt);
 
 	return -1;
@@ -902,452 +574,24 @@ unsigned int mtk_cam_get_pixel_bits(unsigned int ipi_fmt)
 
 unsigned int mtk_cam_get_img_fmt(unsigned int fourcc)
 {
-	switch (fourcc) {
-	case V4L2_PIX_FMT_GREY:
-		return MTKCAM_IPI_IMG_FMT_Y8;
-	case V4L2_PIX_FMT_YUYV:
-		return MTKCAM_IPI_IMG_FMT_YUYV;
-	case V4L2_PIX_FMT_YVYU:
-		return MTKCAM_IPI_IMG_FMT_YVYU;
-	case V4L2_PIX_FMT_UYVY:
-		return MTKCAM_IPI_IMG_FMT_UYVY;
-	case V4L2_PIX_FMT_VYUY:
-		return MTKCAM_IPI_IMG_FMT_VYUY;
-	case V4L2_PIX_FMT_NV16:
-		return MTKCAM_IPI_IMG_FMT_YUV_422_2P;
-	case V4L2_PIX_FMT_NV61:
-		return MTKCAM_IPI_IMG_FMT_YVU_422_2P;
-	case V4L2_PIX_FMT_NV12:
-		return MTKCAM_IPI_IMG_FMT_YUV_420_2P;
-	case V4L2_PIX_FMT_NV21:
-		return MTKCAM_IPI_IMG_FMT_YVU_420_2P;
-	case V4L2_PIX_FMT_YUV422P:
-		return MTKCAM_IPI_IMG_FMT_YUV_422_3P;
-	case V4L2_PIX_FMT_YUV420:
-		return MTKCAM_IPI_IMG_FMT_YUV_420_3P;
-	case V4L2_PIX_FMT_YVU420:
-		return MTKCAM_IPI_IMG_FMT_YVU_420_3P;
-	case V4L2_PIX_FMT_NV12_10:
-		return MTKCAM_IPI_IMG_FMT_YUV_P010;
-	case V4L2_PIX_FMT_NV21_10:
-		return MTKCAM_IPI_IMG_FMT_YVU_P010;
-	case V4L2_PIX_FMT_NV16_10:
-		return MTKCAM_IPI_IMG_FMT_YUV_P210;
-	case V4L2_PIX_FMT_NV61_10:
-		return MTKCAM_IPI_IMG_FMT_YVU_P210;
-	case V4L2_PIX_FMT_MTISP_NV12_10P:
-		return MTKCAM_IPI_IMG_FMT_YUV_P010_PACKED;
-	case V4L2_PIX_FMT_MTISP_NV21_10P:
-		return MTKCAM_IPI_IMG_FMT_YVU_P010_PACKED;
-	case V4L2_PIX_FMT_MTISP_NV16_10P:
-		return MTKCAM_IPI_IMG_FMT_YUV_P210_PACKED;
-	case V4L2_PIX_FMT_MTISP_NV61_10P:
-		return MTKCAM_IPI_IMG_FMT_YVU_P210_PACKED;
-	case V4L2_PIX_FMT_YUYV10:
-		return MTKCAM_IPI_IMG_FMT_YUYV_Y210;
-	case V4L2_PIX_FMT_YVYU10:
-		return MTKCAM_IPI_IMG_FMT_YVYU_Y210;
-	case V4L2_PIX_FMT_UYVY10:
-		return MTKCAM_IPI_IMG_FMT_UYVY_Y210;
-	case V4L2_PIX_FMT_VYUY10:
-		return MTKCAM_IPI_IMG_FMT_VYUY_Y210;
-	case V4L2_PIX_FMT_MTISP_YUYV10P:
-		return MTKCAM_IPI_IMG_FMT_YUYV_Y210_PACKED;
-	case V4L2_PIX_FMT_MTISP_YVYU10P:
-		return MTKCAM_IPI_IMG_FMT_YVYU_Y210_PACKED;
-	case V4L2_PIX_FMT_MTISP_UYVY10P:
-		return MTKCAM_IPI_IMG_FMT_UYVY_Y210_PACKED;
-	case V4L2_PIX_FMT_MTISP_VYUY10P:
-		return MTKCAM_IPI_IMG_FMT_VYUY_Y210_PACKED;
-	case V4L2_PIX_FMT_NV12_12:
-		return MTKCAM_IPI_IMG_FMT_YUV_P012;
-	case V4L2_PIX_FMT_NV21_12:
-		return MTKCAM_IPI_IMG_FMT_YVU_P012;
-	case V4L2_PIX_FMT_NV16_12:
-		return MTKCAM_IPI_IMG_FMT_YUV_P212;
-	case V4L2_PIX_FMT_NV61_12:
-		return MTKCAM_IPI_IMG_FMT_YVU_P212;
-	case V4L2_PIX_FMT_MTISP_NV12_12P:
-		return MTKCAM_IPI_IMG_FMT_YUV_P012_PACKED;
-	case V4L2_PIX_FMT_MTISP_NV21_12P:
-		return MTKCAM_IPI_IMG_FMT_YVU_P012_PACKED;
-	case V4L2_PIX_FMT_MTISP_NV16_12P:
-		return MTKCAM_IPI_IMG_FMT_YUV_P212_PACKED;
-	case V4L2_PIX_FMT_MTISP_NV61_12P:
-		return MTKCAM_IPI_IMG_FMT_YVU_P212_PACKED;
-	case V4L2_PIX_FMT_SBGGR8:
-	case V4L2_PIX_FMT_SGBRG8:
-	case V4L2_PIX_FMT_SGRBG8:
-	case V4L2_PIX_FMT_SRGGB8:
-		return MTKCAM_IPI_IMG_FMT_BAYER8;
-	case V4L2_PIX_FMT_MTISP_SBGGR8F:
-	case V4L2_PIX_FMT_MTISP_SGBRG8F:
-	case V4L2_PIX_FMT_MTISP_SGRBG8F:
-	case V4L2_PIX_FMT_MTISP_SRGGB8F:
-		return MTKCAM_IPI_IMG_FMT_FG_BAYER8;
-	case V4L2_PIX_FMT_SBGGR10:
-	case V4L2_PIX_FMT_SGBRG10:
-	case V4L2_PIX_FMT_SGRBG10:
-	case V4L2_PIX_FMT_SRGGB10:
-		return MTKCAM_IPI_IMG_FMT_BAYER10_UNPACKED;
-	case V4L2_PIX_FMT_SBGGR10P:
-	case V4L2_PIX_FMT_SGBRG10P:
-	case V4L2_PIX_FMT_SGRBG10P:
-	case V4L2_PIX_FMT_SRGGB10P:
-		return MTKCAM_IPI_IMG_FMT_BAYER10_MIPI;
-	case V4L2_PIX_FMT_MTISP_SBGGR10:
-	case V4L2_PIX_FMT_MTISP_SGBRG10:
-	case V4L2_PIX_FMT_MTISP_SGRBG10:
-	case V4L2_PIX_FMT_MTISP_SRGGB10:
-		return MTKCAM_IPI_IMG_FMT_BAYER10;
-	case V4L2_PIX_FMT_MTISP_SBGGR10F:
-	case V4L2_PIX_FMT_MTISP_SGBRG10F:
-	case V4L2_PIX_FMT_MTISP_SGRBG10F:
-	case V4L2_PIX_FMT_MTISP_SRGGB10F:
-		return MTKCAM_IPI_IMG_FMT_FG_BAYER10;
-	case V4L2_PIX_FMT_SBGGR12:
-	case V4L2_PIX_FMT_SGBRG12:
-	case V4L2_PIX_FMT_SGRBG12:
-	case V4L2_PIX_FMT_SRGGB12:
-		return MTKCAM_IPI_IMG_FMT_BAYER12_UNPACKED;
-	case V4L2_PIX_FMT_MTISP_SBGGR12:
-	case V4L2_PIX_FMT_MTISP_SGBRG12:
-	case V4L2_PIX_FMT_MTISP_SGRBG12:
-	case V4L2_PIX_FMT_MTISP_SRGGB12:
-		return MTKCAM_IPI_IMG_FMT_BAYER12;
-	case V4L2_PIX_FMT_MTISP_SBGGR12F:
-	case V4L2_PIX_FMT_MTISP_SGBRG12F:
-	case V4L2_PIX_FMT_MTISP_SGRBG12F:
-	case V4L2_PIX_FMT_MTISP_SRGGB12F:
-		return MTKCAM_IPI_IMG_FMT_FG_BAYER12;
-	case V4L2_PIX_FMT_SBGGR14:
-	case V4L2_PIX_FMT_SGBRG14:
-	case V4L2_PIX_FMT_SGRBG14:
-	case V4L2_PIX_FMT_SRGGB14:
-		return MTKCAM_IPI_IMG_FMT_BAYER14_UNPACKED;
-	case V4L2_PIX_FMT_MTISP_SBGGR14:
-	case V4L2_PIX_FMT_MTISP_SGBRG14:
-	case V4L2_PIX_FMT_MTISP_SGRBG14:
-	case V4L2_PIX_FMT_MTISP_SRGGB14:
-		return MTKCAM_IPI_IMG_FMT_BAYER14;
-	case V4L2_PIX_FMT_MTISP_SBGGR14F:
-	case V4L2_PIX_FMT_MTISP_SGBRG14F:
-	case V4L2_PIX_FMT_MTISP_SGRBG14F:
-	case V4L2_PIX_FMT_MTISP_SRGGB14F:
-		return MTKCAM_IPI_IMG_FMT_FG_BAYER14;
-	case V4L2_PIX_FMT_SBGGR16:
-	case V4L2_PIX_FMT_SGBRG16:
-	case V4L2_PIX_FMT_SGRBG16:
-	case V4L2_PIX_FMT_SRGGB16:
-		return MTKCAM_IPI_IMG_FMT_BAYER16;
-	case V4L2_PIX_FMT_MTISP_NV12_UFBC:
-		return MTKCAM_IPI_IMG_FMT_UFBC_NV12;
-	case V4L2_PIX_FMT_MTISP_NV21_UFBC:
-		return MTKCAM_IPI_IMG_FMT_UFBC_NV21;
-	case V4L2_PIX_FMT_MTISP_NV12_10_UFBC:
-		return MTKCAM_IPI_IMG_FMT_UFBC_YUV_P010;
-	case V4L2_PIX_FMT_MTISP_NV21_10_UFBC:
-		return MTKCAM_IPI_IMG_FMT_UFBC_YVU_P010;
-	case V4L2_PIX_FMT_MTISP_NV12_12_UFBC:
-		return MTKCAM_IPI_IMG_FMT_UFBC_YUV_P012;
-	case V4L2_PIX_FMT_MTISP_NV21_12_UFBC:
-		return MTKCAM_IPI_IMG_FMT_UFBC_YVU_P012;
-	case V4L2_PIX_FMT_MTISP_BAYER8_UFBC:
-		return MTKCAM_IPI_IMG_FMT_UFBC_BAYER8;
-	case V4L2_PIX_FMT_MTISP_BAYER10_UFBC:
-		return MTKCAM_IPI_IMG_FMT_UFBC_BAYER10;
-	case V4L2_PIX_FMT_MTISP_BAYER12_UFBC:
-		return MTKCAM_IPI_IMG_FMT_UFBC_BAYER12;
-	case V4L2_PIX_FMT_MTISP_BAYER14_UFBC:
-		return MTKCAM_IPI_IMG_FMT_UFBC_BAYER14;
-	case V4L2_PIX_FMT_MTISP_SGRB8F:
-		return MTKCAM_IPI_IMG_FMT_FG_BAYER8_3P;
-	case V4L2_PIX_FMT_MTISP_SGRB10F:
-		return MTKCAM_IPI_IMG_FMT_FG_BAYER10_3P_PACKED;
-	case V4L2_PIX_FMT_MTISP_SGRB12F:
-		return MTKCAM_IPI_IMG_FMT_FG_BAYER12_3P_PACKED;
-	default:
-		return MTKCAM_IPI_IMG_FMT_UNKNOWN;
-	}
+	const struct mtk_cam_fmt_desc *desc = mtk_cam_fmt_desc_find(fourcc);
+
+	return desc ? desc->ipi_fmt : MTKCAM_IPI_IMG_FMT_UNKNOWN;
 }
+
 /* for mmqos and base is 100 */
 int mtk_cam_get_fmt_size_factor(unsigned int ipi_fmt)
 {
-	switch (ipi_fmt) {
-	case MTKCAM_IPI_IMG_FMT_BAYER8:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER8:
-	case MTKCAM_IPI_IMG_FMT_BAYER10:
-	case MTKCAM_IPI_IMG_FMT_BAYER10_MIPI:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER10:
-	case MTKCAM_IPI_IMG_FMT_BAYER12:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER12:
-	case MTKCAM_IPI_IMG_FMT_BAYER14:
-	case MTKCAM_IPI_IMG_FMT_YUYV:
-	case MTKCAM_IPI_IMG_FMT_YVYU:
-	case MTKCAM_IPI_IMG_FMT_UYVY:
-	case MTKCAM_IPI_IMG_FMT_VYUY:
-	case MTKCAM_IPI_IMG_FMT_Y8:
-	case MTKCAM_IPI_IMG_FMT_YUYV_Y210:
-	case MTKCAM_IPI_IMG_FMT_YVYU_Y210:
-	case MTKCAM_IPI_IMG_FMT_UYVY_Y210:
-	case MTKCAM_IPI_IMG_FMT_VYUY_Y210:
-	case MTKCAM_IPI_IMG_FMT_YUYV_Y210_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YVYU_Y210_PACKED:
-	case MTKCAM_IPI_IMG_FMT_UYVY_Y210_PACKED:
-	case MTKCAM_IPI_IMG_FMT_VYUY_Y210_PACKED:
-		return 100;
-	case MTKCAM_IPI_IMG_FMT_YUV_420_2P:
-	case MTKCAM_IPI_IMG_FMT_YVU_420_2P:
-	case MTKCAM_IPI_IMG_FMT_YUV_420_3P:
-	case MTKCAM_IPI_IMG_FMT_YVU_420_3P:
-	case MTKCAM_IPI_IMG_FMT_YUV_P010_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YVU_P010_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YUV_P012_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YVU_P012_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YUV_P010:
-	case MTKCAM_IPI_IMG_FMT_YVU_P010:
-	case MTKCAM_IPI_IMG_FMT_YUV_P012:
-	case MTKCAM_IPI_IMG_FMT_YVU_P012:
-	case MTKCAM_IPI_IMG_FMT_UFBC_YUV_P010:
-	case MTKCAM_IPI_IMG_FMT_UFBC_YVU_P010:
-	case MTKCAM_IPI_IMG_FMT_UFBC_NV12:
-	case MTKCAM_IPI_IMG_FMT_UFBC_NV21:
-	case MTKCAM_IPI_IMG_FMT_UFBC_YUV_P012:
-	case MTKCAM_IPI_IMG_FMT_UFBC_YVU_P012:
-		return 150;
-	case MTKCAM_IPI_IMG_FMT_YUV_422_2P:
-	case MTKCAM_IPI_IMG_FMT_YVU_422_2P:
-	case MTKCAM_IPI_IMG_FMT_YUV_422_3P:
-	case MTKCAM_IPI_IMG_FMT_YVU_422_3P:
-	case MTKCAM_IPI_IMG_FMT_YUV_P210:
-	case MTKCAM_IPI_IMG_FMT_YVU_P210:
-	case MTKCAM_IPI_IMG_FMT_YUV_P212:
-	case MTKCAM_IPI_IMG_FMT_YVU_P212:
-	case MTKCAM_IPI_IMG_FMT_YUV_P210_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YVU_P210_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YUV_P212_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YVU_P212_PACKED:
-		return 200;
-	case V4L2_PIX_FMT_MTISP_BAYER8_UFBC:
-	case V4L2_PIX_FMT_MTISP_BAYER10_UFBC:
-	case V4L2_PIX_FMT_MTISP_BAYER12_UFBC:
-	case V4L2_PIX_FMT_MTISP_BAYER14_UFBC:
-		return 100;
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER8_3P:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER10_3P_PACKED:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER12_3P_PACKED:
-		return 300;
-	default:
-		break;
-	}
-	return -1;
-}
-
-static int mtk_cam_fill_pixfmt_mp(struct v4l2_pix_format_mplane *pixfmt,
-			u32 pixelformat, u32 width, u32 height)
-{
-	struct v4l2_plane_pix_format *plane;
-	unsigned int ipi_fmt = mtk_cam_get_img_fmt(pixelformat);
-	u8 pixel_bits = mtk_cam_get_pixel_bits(ipi_fmt);
-	u32 stride;
-	u32 aligned_width;
-	u8 pixel_mode_shift = 0; /* todo: should set by resMgr */
-	u8 bus_size;
-	u8 i;
-
-	pixfmt->width = width;
-	pixfmt->height = height;
-	pixfmt->pixelformat = pixelformat;
-	plane = &pixfmt->plane_fmt[0];
-	bus_size = mtk_cam_yuv_dma_bus_size(pixel_bits, pixel_mode_shift);
-	plane->sizeimage = 0;
-
-	if (is_mtk_format(pixelformat)) {
-		const struct mtk_format_info *info;
-
-		info = mtk_format_info(pixelformat);
-		pixfmt->num_planes = info->mem_planes;
-
-		if (!info)
-			return -EINVAL;
-
-		if (info->mem_planes == 1) {
-			if (is_yuv_ufo(pixelformat)) {
-				/* UFO format width should align 64 pixel */
-				aligned_width = ALIGN(width, 64);
-				stride = aligned_width * info->bit_r_num / info->bit_r_den;
-
-				if (stride > plane->bytesperline)
-					plane->bytesperline = stride;
-				plane->sizeimage = stride * height;
-				plane->sizeimage += stride * height / 2;
-				plane->sizeimage += ALIGN((aligned_width / 64), 8) * height;
-				plane->sizeimage += ALIGN((aligned_width / 64), 8) * height / 2;
-				plane->sizeimage += sizeof(struct UfbcBufferHeader);
-			} else if (is_raw_ufo(pixelformat)) {
-				/* UFO format width should align 64 pixel */
-				aligned_width = ALIGN(width, 64);
-				stride = aligned_width * info->bit_r_num / info->bit_r_den;
-
-				if (stride > plane->bytesperline)
-					plane->bytesperline = stride;
-				plane->sizeimage = stride * height;
-				plane->sizeimage += ALIGN((aligned_width / 64), 8) * height;
-				plane->sizeimage += sizeof(struct UfbcBufferHeader);
-			} else {
-				/* width should be bus_size align */
-				aligned_width = ALIGN(DIV_ROUND_UP(width
-					* info->bit_r_num, info->bit_r_den), bus_size);
-				stride = aligned_width * info->bpp[0];
-
-				if (stride > plane->bytesperline)
-					plane->bytesperline = stride;
-
-				for (i = 0; i < info->comp_planes; i++) {
-					unsigned int hdiv = (i == 0) ? 1 : info->hdiv;
-					unsigned int vdiv = (i == 0) ? 1 : info->vdiv;
-
-					if (plane->bytesperline > stride) {
-						if (is_fullg_rb(pixelformat)) {
-							plane->sizeimage +=
-							DIV_ROUND_UP(plane->bytesperline, hdiv)
-							* DIV_ROUND_UP(height, vdiv);
-						} else {
-							plane->sizeimage += plane->bytesperline
-							* DIV_ROUND_UP(height, vdiv);
-						}
-					} else {
-						plane->sizeimage += info->bpp[i]
-							* DIV_ROUND_UP(aligned_width, hdiv)
-							* DIV_ROUND_UP(height, vdiv);
-					}
-				}
-			}
-			pr_debug("%s stride %d sizeimage %d\n", __func__,
-				plane->bytesperline, plane->sizeimage);
-		} else {
-			pr_debug("do not support non contiguous mplane\n");
-		}
-	} else {
-		const struct v4l2_format_info *info;
+	const struct mtk_cam_ipi_fmt_desc *ipi = mtk_cam_ipi_fmt_desc(ipi_fmt);
 
-		pr_debug("pixelformat:0x%x sizeimage:%d\n", pixelformat, plane->sizeimage);
-		info = v4l2_format_info(pixelformat);
-		pixfmt->num_planes = info->mem_planes;
-
-		if (!info)
-			return -EINVAL;
-
-		if (info->mem_planes == 1) {
-
-			aligned_width = ALIGN(width, bus_size);
-			stride = aligned_width * info->bpp[0];
-			if (stride > plane->bytesperline)
-				plane->bytesperline = stride;
-
-			for (i = 0; i < info->comp_planes; i++) {
-				unsigned int hdiv = (i == 0) ? 1 : info->hdiv;
-				unsigned int vdiv = (i == 0) ? 1 : info->vdiv;
-
-				plane->sizeimage += info->bpp[i]
-					* DIV_ROUND_UP(aligned_width, hdiv)
-					* DIV_ROUND_UP(height, vdiv);
-			}
-			pr_debug("%s stride %d sizeimage %d\n", __func__,
-				plane->bytesperline, plane->sizeimage);
-		} else {
-			pr_debug("do not support non contiguous mplane\n");
-		}
-	}
-
-	return 0;
+	return ipi ? ipi->size_factor : -1;
 }
 
 static void cal_image_pix_mp(unsigned int node_id,
 			     struct v4l2_pix_format_mplane *mp,
 			     unsigned int pixel_mode)
 {
-	unsigned int ipi_fmt = mtk_cam_get_img_fmt(mp->pixelformat);
-	unsigned int width = mp->width;
-	unsigned int height = mp->height;
-	unsigned int stride, i;
-
-	pr_debug("fmt:0x%x ipi_fmt:%d\n", mp->pixelformat, ipi_fmt);
-	switch (ipi_fmt) {
-	case MTKCAM_IPI_IMG_FMT_BAYER8:
-	case MTKCAM_IPI_IMG_FMT_BAYER10:
-	case MTKCAM_IPI_IMG_FMT_BAYER12:
-	case MTKCAM_IPI_IMG_FMT_BAYER14:
-	case MTKCAM_IPI_IMG_FMT_BAYER16:
-	case MTKCAM_IPI_IMG_FMT_BAYER10_MIPI:
-	case MTKCAM_IPI_IMG_FMT_BAYER10_UNPACKED:
-	case MTKCAM_IPI_IMG_FMT_BAYER12_UNPACKED:
-	case MTKCAM_IPI_IMG_FMT_BAYER14_UNPACKED:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER8:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER10:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER12:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER14:
-		stride = mtk_cam_dmao_xsize(width, ipi_fmt, pixel_mode);
-		for (i = 0; i < mp->num_planes; i++) {
-			if (stride > mp->plane_fmt[i].bytesperline)
-				mp->plane_fmt[i].bytesperline = stride;
-			mp->plane_fmt[i].sizeimage = mp->plane_fmt[i].bytesperline * height;
-		}
-	break;
-	case MTKCAM_IPI_IMG_FMT_YUYV:
-	case MTKCAM_IPI_IMG_FMT_YVYU:
-	case MTKCAM_IPI_IMG_FMT_UYVY:
-	case MTKCAM_IPI_IMG_FMT_VYUY:
-	case MTKCAM_IPI_IMG_FMT_YUV_422_2P:
-	case MTKCAM_IPI_IMG_FMT_YVU_422_2P:
-	case MTKCAM_IPI_IMG_FMT_YUV_422_3P:
-	case MTKCAM_IPI_IMG_FMT_YVU_422_3P:
-	case MTKCAM_IPI_IMG_FMT_YUV_420_2P:
-	case MTKCAM_IPI_IMG_FMT_YVU_420_2P:
-	case MTKCAM_IPI_IMG_FMT_YUV_420_3P:
-	case MTKCAM_IPI_IMG_FMT_YVU_420_3P:
-	case MTKCAM_IPI_IMG_FMT_Y8:
-	case MTKCAM_IPI_IMG_FMT_YUYV_Y210:
-	case MTKCAM_IPI_IMG_FMT_YVYU_Y210:
-	case MTKCAM_IPI_IMG_FMT_UYVY_Y210:
-	case MTKCAM_IPI_IMG_FMT_VYUY_Y210:
-	case MTKCAM_IPI_IMG_FMT_YUYV_Y210_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YVYU_Y210_PACKED:
-	case MTKCAM_IPI_IMG_FMT_UYVY_Y210_PACKED:
-	case MTKCAM_IPI_IMG_FMT_VYUY_Y210_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YUV_P210:
-	case MTKCAM_IPI_IMG_FMT_YVU_P210:
-	case MTKCAM_IPI_IMG_FMT_YUV_P010:
-	case MTKCAM_IPI_IMG_FMT_YVU_P010:
-	case MTKCAM_IPI_IMG_FMT_YUV_P210_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YVU_P210_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YUV_P010_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YVU_P010_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YUV_P212:
-	case MTKCAM_IPI_IMG_FMT_YVU_P212:
-	case MTKCAM_IPI_IMG_FMT_YUV_P012:
-	case MTKCAM_IPI_IMG_FMT_YVU_P012:
-	case MTKCAM_IPI_IMG_FMT_YUV_P212_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YVU_P212_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YUV_P012_PACKED:
-	case MTKCAM_IPI_IMG_FMT_YVU_P012_PACKED:
-	case MTKCAM_IPI_IMG_FMT_UFBC_NV12:
-	case MTKCAM_IPI_IMG_FMT_UFBC_NV21:
-	case MTKCAM_IPI_IMG_FMT_UFBC_YUV_P010:
-	case MTKCAM_IPI_IMG_FMT_UFBC_YVU_P010:
-	case MTKCAM_IPI_IMG_FMT_UFBC_YUV_P012:
-	case MTKCAM_IPI_IMG_FMT_UFBC_YVU_P012:
-	case MTKCAM_IPI_IMG_FMT_UFBC_BAYER8:
-	case MTKCAM_IPI_IMG_FMT_UFBC_BAYER10:
-	case MTKCAM_IPI_IMG_FMT_UFBC_BAYER12:
-	case MTKCAM_IPI_IMG_FMT_UFBC_BAYER14:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER8_3P:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER10_3P_PACKED:
-	case MTKCAM_IPI_IMG_FMT_FG_BAYER12_3P_PACKED:
-		mtk_cam_fill_pixfmt_mp(mp, mp->pixelformat, width, height);
-	default:
-		break;
-	}
+	mtk_cam_fmt_calc_pixfmt_mp(mp, pixel_mode);
 }
 
 static int mtk_video_init_format(struct mtk_cam_video_device *video)
@@ -1661,6 +905,11 @@ int mtk_cam_vidioc_s_fmt(struct file *file, void *fh,
 		__func__, cam_req->req.debug_str, node->uid.pipe_id, node->desc.name,
 		f->fmt.pix_mp.pixelformat,  f->fmt.pix_mp.width, f->fmt.pix_mp.height);
 
+	if (mtk_cam_req_s_data_alloc(cam_req, node->uid.pipe_id)) {
+		media_request_put(req);
+		return -ENOMEM;
+	}
+
 	stream_data = mtk_cam_req_get_s_data_no_chk(cam_req, node->uid.pipe_id, 0);
 	stream_data->vdev_fmt_update |= (1 << node->desc.id);
 	vfmt = mtk_cam_s_data_get_vfmt(stream_data, node->desc.id);
@@ -1906,6 +1155,11 @@ int mtk_cam_vidioc_s_selection(struct file *file, void *fh,
 	}
 
 	cam_req = to_mtk_cam_req(req);
+	if (mtk_cam_req_s_data_alloc(cam_req, node->uid.pipe_id)) {
+		media_request_put(req);
+		return -ENOMEM;
+	}
+
 	stream_data = mtk_cam_req_get_s_data_no_chk(cam_req, node->uid.pipe_id, 0);
 	stream_data->vdev_selection_update |= (1 << node->desc.id);
 	vsel = mtk_cam_s_data_get_vsel(stream_data, node->desc.id);
@@ -14,6 +14,7 @@
 #include <media/videobuf2-core.h>
 #include <media/videobuf2-v4l2.h>
 
+#include "mtk_cam-fmt-desc.h"
 #include "mtk_cam-ipi.h"
 
 #define MAX_PLANE_NUM 3
@@ -133,19 +134,6 @@ struct mtk_cam_video_device {
 	struct mtk_cam_ctx *ctx;
 };
 
-struct mtk_format_info {
-	u32 format;
-	u8 mem_planes;
-	u8 comp_planes;
-	u8 bpp[4];
-	u8 hdiv;
-	u8 vdiv;
-	/* numerator of bit ratio */
-	u8 bit_r_num;
-	/* denominator of bit ratio */
-	u8 bit_r_den;
-};
-
 int mtk_cam_video_register(struct mtk_cam_video_device *video,
 			   struct v4l2_device *v4l2_dev);
 void mtk_cam_video_unregister(struct mtk_cam_video_device *video);
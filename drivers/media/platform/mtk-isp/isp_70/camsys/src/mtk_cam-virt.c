@@ -0,0 +1,248 @@
+// SPDX-License-Identifier: GPL-2.0
+//
+// Copyright (c) 2022 MediaTek Inc.
+
+#include <linux/atomic.h>
+#include <linux/kernel_stat.h>
+#include <linux/module.h>
+
+#include "mtk_cam.h"
+#include "mtk_cam-feature.h"
+#include "mtk_cam-virt.h"
+
+static unsigned int virt_sensor_fps;
+module_param(virt_sensor_fps, uint, 0644);
+MODULE_PARM_DESC(virt_sensor_fps,
+		 "run raw contexts on a software sensor at this fps, 0 to disable");
+
+/* frames done by all the virtual contexts, for the busy time per frame */
+static atomic64_t virt_all_frames = ATOMIC64_INIT(0);
+
+static const char * const mtk_cam_virt_stage_names[] = {
+	[MTK_CAM_VIRT_ENQUEUE] = "total",
+	[MTK_CAM_VIRT_TX] = "enq-tx",
+	[MTK_CAM_VIRT_ACK] = "tx-ack",
+	[MTK_CAM_VIRT_SOF] = "ack-sof",
+	[MTK_CAM_VIRT_DONE] = "sof-done",
+};
+
+/* time spent out of idle on all cpus */
+static u64 mtk_cam_virt_busy_ns(void)
+{
+	struct kernel_cpustat kcs;
+	u64 busy = 0;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		kcpustat_cpu_fetch(&kcs, cpu);
+		busy += kcs.cpustat[CPUTIME_USER] + kcs.cpustat[CPUTIME_NICE] +
+			kcs.cpustat[CPUTIME_SYSTEM] + kcs.cpustat[CPUTIME_IRQ] +
+			kcs.cpustat[CPUTIME_SOFTIRQ];
+	}
+
+	return busy;
+}
+
+static bool mtk_cam_virt_supported(struct mtk_cam_ctx *ctx)
+{
+	return ctx->used_raw_num && !ctx->used_sv_num &&
+	       ctx->pipe->res_config.raw_num_used == 1 &&
+	       ctx->pipe->dynamic_exposure_num_max <= 1 &&
+	       !mtk_cam_is_m2m(ctx) && !mtk_cam_is_time_shared(ctx) &&
+	       !mtk_cam_is_stagger(ctx) && !mtk_cam_is_mstream(ctx) &&
+	       !mtk_cam_is_subsample(ctx) && !mtk_cam_is_hsf(ctx) &&
+	       !mtk_cam_is_with_w_channel(ctx);
+}
+
+static enum hrtimer_restart mtk_cam_virt_tick(struct hrtimer *timer)
+{
+	struct mtk_cam_virt *virt =
+		container_of(timer, struct mtk_cam_virt, timer);
+	struct mtk_raw_device *raw_dev = virt->raw_dev;
+	struct mtk_camsys_irq_info irq_info;
+	unsigned long flags;
+
+	hrtimer_forward_now(timer, virt->period);
+
+	if (!atomic_read(&raw_dev->vf_en))
+		return HRTIMER_RESTART;
+
+	memset(&irq_info, 0, sizeof(irq_info));
+	irq_info.irq_type = 1 << CAMSYS_IRQ_FRAME_START;
+
+	spin_lock_irqsave(&virt->lock, flags);
+	/* the running frame is written out, then the latched CQ runs */
+	if (virt->inner > virt->done) {
+		irq_info.irq_type |= 1 << CAMSYS_IRQ_FRAME_DONE;
+		virt->done = virt->inner;
+	}
+	virt->inner = virt->outer;
+	irq_info.frame_idx = virt->outer;
+	irq_info.frame_idx_inner = virt->inner;
+	irq_info.write_cnt = virt->done & 0xff;
+	spin_unlock_irqrestore(&virt->lock, flags);
+
+	raw_dev->cur_vsync_idx = 0;
+	raw_dev->sof_count++;
+	mtk_raw_inject_irq(raw_dev, &irq_info);
+
+	return HRTIMER_RESTART;
+}
+
+void mtk_cam_virt_vf_on(struct mtk_cam_virt *virt)
+{
+	hrtimer_start(&virt->timer, virt->period, HRTIMER_MODE_REL);
+}
+
+void mtk_cam_virt_apply_cq(struct mtk_cam_virt *virt)
+{
+	struct mtk_camsys_irq_info irq_info;
+	unsigned long flags;
+
+	memset(&irq_info, 0, sizeof(irq_info));
+	irq_info.irq_type = 1 << CAMSYS_IRQ_SETTING_DONE;
+
+	/* frames are composed and applied in order */
+	spin_lock_irqsave(&virt->lock, flags);
+	irq_info.frame_idx = ++virt->outer;
+	irq_info.frame_idx_inner = virt->inner;
+	spin_unlock_irqrestore(&virt->lock, flags);
+
+	mtk_raw_inject_irq(virt->raw_dev, &irq_info);
+}
+
+void mtk_cam_virt_stamp(struct mtk_cam_virt *virt, int frame_seq_no,
+			enum mtk_cam_virt_stage stage)
+{
+	u64 now = ktime_get_boottime_ns();
+	u64 *ts, prev;
+	unsigned long flags;
+	int i;
+
+	if (!virt->enabled || frame_seq_no <= 0)
+		return;
+
+	ts = virt->ts[frame_seq_no & (MTK_CAM_VIRT_FRAMES - 1)];
+
+	spin_lock_irqsave(&virt->lock, flags);
+	if (stage == MTK_CAM_VIRT_ENQUEUE)
+		memset(ts, 0, sizeof(virt->ts[0]));
+	ts[stage] = now;
+
+	if (stage == MTK_CAM_VIRT_DONE) {
+		/* a stage missed by the frame is skipped */
+		for (i = 0, prev = 0; i < MTK_CAM_VIRT_STAGE_NUM; i++) {
+			struct mtk_cam_virt_lat *lat;
+			u64 d;
+
+			if (!ts[i])
+				continue;
+
+			if (prev) {
+				lat = &virt->lat[i];
+				d = ts[i] - prev;
+				lat->sum_ns += d;
+				lat->max_ns = max(lat->max_ns, d);
+				lat->cnt++;
+			}
+			prev = ts[i];
+		}
+
+		if (ts[MTK_CAM_VIRT_ENQUEUE]) {
+			struct mtk_cam_virt_lat *lat =
+				&virt->lat[MTK_CAM_VIRT_ENQUEUE];
+			u64 d = now - ts[MTK_CAM_VIRT_ENQUEUE];
+
+			lat->sum_ns += d;
+			lat->max_ns = max(lat->max_ns, d);
+			lat->cnt++;
+		}
+
+		memset(ts, 0, sizeof(virt->ts[0]));
+		virt->frames++;
+		atomic64_inc(&virt_all_frames);
+	}
+	spin_unlock_irqrestore(&virt->lock, flags);
+}
+
+void mtk_cam_virt_start(struct mtk_cam_ctx *ctx,
+			struct mtk_raw_device *raw_dev)
+{
+	struct mtk_cam_virt *virt = &ctx->virt;
+	unsigned int fps = READ_ONCE(virt_sensor_fps);
+
+	virt->enabled = false;
+	raw_dev->virt = NULL;
+
+	if (!fps)
+		return;
+
+	if (!mtk_cam_virt_supported(ctx)) {
+		dev_info(ctx->cam->dev,
+			 "ctx:%d: virtual sensor not supported, run on raw%d\n",
+			 ctx->stream_id, raw_dev->id);
+		return;
+	}
+
+	spin_lock_init(&virt->lock);
+	virt->outer = 0;
+	virt->inner = 0;
+	virt->done = 0;
+	memset(virt->ts, 0, sizeof(virt->ts));
+	memset(virt->lat, 0, sizeof(virt->lat));
+	virt->frames = 0;
+
+	virt->fps = fps;
+	virt->period = ns_to_ktime(div_u64(NSEC_PER_SEC, fps));
+	virt->raw_dev = raw_dev;
+	hrtimer_init(&virt->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	virt->timer.function = mtk_cam_virt_tick;
+
+	virt->start_ns = ktime_get_boottime_ns();
+	virt->cpu_start_ns = mtk_cam_virt_busy_ns();
+	virt->all_frames_start = atomic64_read(&virt_all_frames);
+
+	virt->enabled = true;
+	raw_dev->virt = virt;
+
+	dev_info(ctx->cam->dev, "ctx:%d: raw%d on virtual sensor, %u fps\n",
+		 ctx->stream_id, raw_dev->id, fps);
+}
+
+void mtk_cam_virt_stop(struct mtk_cam_ctx *ctx)
+{
+	struct mtk_cam_virt *virt = &ctx->virt;
+	struct device *dev = ctx->cam->dev;
+	u64 elapsed, busy, all_frames;
+	int i;
+
+	if (!virt->enabled)
+		return;
+
+	hrtimer_cancel(&virt->timer);
+	virt->raw_dev->virt = NULL;
+	virt->enabled = false;
+
+	elapsed = ktime_get_boottime_ns() - virt->start_ns;
+	busy = mtk_cam_virt_busy_ns() - virt->cpu_start_ns;
+	all_frames = atomic64_read(&virt_all_frames) - virt->all_frames_start;
+
+	dev_info(dev,
+		 "ctx:%d: virtual sensor %u fps: %u frames in %llu ms, busy %llu us/frame (%llu frames of all ctxs)\n",
+		 ctx->stream_id, virt->fps, virt->frames,
+		 div_u64(elapsed, NSEC_PER_MSEC),
+		 all_frames ? div64_u64(busy, all_frames) / NSEC_PER_USEC : 0,
+		 all_frames);
+
+	for (i = 0; i < MTK_CAM_VIRT_STAGE_NUM; i++) {
+		struct mtk_cam_virt_lat *lat = &virt->lat[i];
+
+		if (!lat->cnt)
+			continue;
+
+		dev_info(dev, "ctx:%d: %-8s avg %llu us, max %llu us (%u)\n",
+			 ctx->stream_id, mtk_cam_virt_stage_names[i],
+			 div_u64(lat->sum_ns, lat->cnt) / NSEC_PER_USEC,
+			 lat->max_ns / NSEC_PER_USEC, lat->cnt);
+	}
+}
@@ -0,0 +1,91 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Copyright (c) 2022 MediaTek Inc.
+ */
+
+#ifndef __MTK_CAM_VIRT_H
+#define __MTK_CAM_VIRT_H
+
+#include <linux/hrtimer.h>
+#include <linux/spinlock.h>
+#include <linux/types.h>
+
+/*
+ * Software virtual sensor, to measure the driver overhead apart from the
+ * ISP and the composer.
+ *
+ * With virt_sensor_fps set at stream on, a single raw context runs its
+ * frames on an hrtimer instead of the raw hardware. Each tick feeds the
+ * frame done of the running frame and the SOF of the next one to the raw
+ * irq thread through mtk_raw_inject_irq(). apply_cq() only latches the
+ * frame number and queues its CQ done, stream_on() leaves the TG off and
+ * the hardware irqs of the raw are ignored. The frames are acked in the
+ * kernel instead of by the CCD composer, so requests complete through the
+ * normal enqueue, composer ack, SOF and frame done paths.
+ *
+ * The latency between the stages of each frame and the system busy time
+ * per frame are reported at stream off.
+ */
+
+struct mtk_cam_ctx;
+struct mtk_raw_device;
+
+enum mtk_cam_virt_stage {
+	MTK_CAM_VIRT_ENQUEUE,	/* frame number given to the request */
+	MTK_CAM_VIRT_TX,	/* isp_tx_frame_worker() */
+	MTK_CAM_VIRT_ACK,	/* composer ack handled */
+	MTK_CAM_VIRT_SOF,	/* SOF of the frame handled */
+	MTK_CAM_VIRT_DONE,	/* frame done handled */
+	MTK_CAM_VIRT_STAGE_NUM,
+};
+
+/* frames in flight, power of 2 */
+#define MTK_CAM_VIRT_FRAMES	16
+
+struct mtk_cam_virt_lat {
+	u64 sum_ns;
+	u64 max_ns;
+	u32 cnt;
+};
+
+struct mtk_cam_virt {
+	bool enabled;
+	u32 fps;
+	struct hrtimer timer;
+	ktime_t period;
+	struct mtk_raw_device *raw_dev;
+
+	spinlock_t lock; /* protect the fields below */
+	int outer;	/* frame of the latched CQ */
+	int inner;	/* frame running since the last SOF */
+	int done;	/* last frame done */
+	u64 ts[MTK_CAM_VIRT_FRAMES][MTK_CAM_VIRT_STAGE_NUM];
+	/* from the previous stage, lat[0] is enqueue to done */
+	struct mtk_cam_virt_lat lat[MTK_CAM_VIRT_STAGE_NUM];
+	u32 frames;
+	u64 start_ns;
+	u64 cpu_start_ns;
+	u64 all_frames_start;
+};
+
+static inline bool mtk_cam_virt_enabled(struct mtk_cam_virt *virt)
+{
+	return virt->enabled;
+}
+
+/* decide at stream on, after the raw is initialized */
+void mtk_cam_virt_start(struct mtk_cam_ctx *ctx,
+			struct mtk_raw_device *raw_dev);
+
+/* stop the timer and report, before the raw is streamed off */
+void mtk_cam_virt_stop(struct mtk_cam_ctx *ctx);
+
+/* stream_on() and apply_cq() of a virtual raw */
+void mtk_cam_virt_vf_on(struct mtk_cam_virt *virt);
+
+void mtk_cam_virt_apply_cq(struct mtk_cam_virt *virt);
+
+void mtk_cam_virt_stamp(struct mtk_cam_virt *virt, int frame_seq_no,
+			enum mtk_cam_virt_stage stage);
+
+#endif /*__MTK_CAM_VIRT_H*/
@@ -4,6 +4,7 @@
 
 #include <linux/component.h>
 #include <linux/iopoll.h>
+#include <linux/mm.h>
 #include <linux/module.h>
 #include <linux/of_platform.h>
 #include <linux/platform_device.h>
@@ -12,6 +13,7 @@
 #include <linux/pm_runtime.h>
 #include <linux/remoteproc.h>
 #include <linux/rpmsg/mtk_ccd_rpmsg.h>
+#include <linux/slab.h>
 #include <linux/mtk_ccd_controls.h>
 
 #include <linux/types.h>
@@ -36,6 +38,7 @@
 #include "mtk_cam-tg-flash.h"
 #include "mtk_camera-v4l2-controls.h"
 #include "mtk_cam-hsf.h"
+#include "mtk_cam-ipi-tlv.h"
 #include "mtk_cam-ufbc-def.h"
 #if IS_ENABLED(CONFIG_MTK_AEE_FEATURE)
 #include <aee.h>
@@ -50,6 +53,12 @@ static unsigned int debug_ae;
 module_param(debug_ae, uint, 0644);
 MODULE_PARM_DESC(debug_ae, "activates debug ae info");
 
+static bool ipi_frame_tlv = true;
+module_param(ipi_frame_tlv, bool, 0644);
+MODULE_PARM_DESC(ipi_frame_tlv, "offer the compact frame format to the composer at session creation");
+
+static struct kmem_cache *mtk_cam_req_cache;
+
 /* FIXME for CIO pad id */
 #define MTK_CAM_CIO_PAD_SRC		PAD_SRC_RAW0
 #define MTK_CAM_CIO_PAD_SINK		MTK_RAW_SINK
@@ -3311,6 +3320,50 @@ static void mtk_cam_req_s_data_init(struct mtk_cam_request *req,
 
 }
 
+/*
+ * The sv pipes are enqueued along with their ctx, see
+ * mtk_cam_sv_req_enqueue(), but may not have been linked when the request
+ * was validated.
+ */
+static int mtk_cam_req_s_data_alloc_sv(struct mtk_cam_device *cam,
+				       struct mtk_cam_request *req)
+{
+	struct mtk_cam_ctx *ctx;
+	int i, j, ret;
+
+	for (i = 0; i < cam->max_stream_num; i++) {
+		ctx = &cam->ctxs[i];
+		if (!(req->pipe_used & 1 << i) || !ctx->streaming)
+			continue;
+
+		for (j = 0; j < ctx->used_sv_num; j++) {
+			ret = mtk_cam_req_s_data_alloc(req, ctx->sv_pipe[j]->id);
+			if (ret)
+				return ret;
+		}
+	}
+
+	return 0;
+}
+
+/* return the buffers of a request taken off the pending list */
+static void mtk_cam_req_fail_pending(struct mtk_cam_request *req)
+{
+	struct mtk_cam_request_stream_data *s_data;
+	unsigned int pipe_used = req->pipe_used;
+	int i;
+
+	for (i = 0; i < MTKCAM_SUBDEV_MAX; i++) {
+		if (!(pipe_used & 1 << i))
+			continue;
+
+		s_data = mtk_cam_req_get_s_data(req, i, 0);
+		if (mtk_cam_s_data_set_buf_state(s_data, VB2_BUF_STATE_ERROR) &&
+		    mtk_cam_req_put(req, i))
+			break; /* DO NOT touch req after here */
+	}
+}
+
 void mtk_cam_dev_req_try_queue(struct mtk_cam_device *cam)
 {
 	struct mtk_cam_ctx *ctx, *stream_ctx;
@@ -3318,7 +3371,7 @@ void mtk_cam_dev_req_try_queue(struct mtk_cam_device *cam)
 	struct mtk_cam_request_stream_data *s_data;
 	int i, s_data_flags;
 	int feature_change, previous_feature;
-	int enqueue_req_cnt, job_count, s_data_cnt;
+	int enqueue_req_cnt, job_count, s_data_cnt, ret;
 	struct list_head equeue_list;
 	struct v4l2_ctrl_handler *hdl;
 	struct media_request_object *sensor_hdl_obj, *raw_hdl_obj, *obj;
@@ -3360,6 +3413,15 @@ void mtk_cam_dev_req_try_queue(struct mtk_cam_device *cam)
 		return;
 
 	list_for_each_entry_safe(req, req_prev, &equeue_list, list) {
+		ret = mtk_cam_req_s_data_alloc_sv(cam, req);
+		if (ret) {
+			dev_info(cam->dev, "%s:req(%s): failed to alloc sv stream data:%d\n",
+				 __func__, req->req.debug_str, ret);
+			list_del(&req->list);
+			mtk_cam_req_fail_pending(req);
+			continue;
+		}
+
 		for (i = 0; i < cam->max_stream_num; i++) {
 			if (!(req->pipe_used & 1 << i))
 				continue;
@@ -3373,6 +3435,8 @@ void mtk_cam_dev_req_try_queue(struct mtk_cam_device *cam)
 			/* Update frame_seq_no */
 			s_data = mtk_cam_req_get_s_data(req, i, 0);
 			s_data->frame_seq_no = atomic_inc_return(&ctx->enqueued_frame_seq_no);
+			mtk_cam_virt_stamp(&ctx->virt, s_data->frame_seq_no,
+					   MTK_CAM_VIRT_ENQUEUE);
 			mtk_cam_req_update_seq(ctx, req,
 					       ++(ctx->enqueued_request_cnt));
 			if (is_camsv_subdev(i)) {
@@ -3528,13 +3592,113 @@ void mtk_cam_dev_req_try_queue(struct mtk_cam_device *cam)
 	}
 }
 
-static struct media_request *mtk_cam_req_alloc(struct media_device *mdev)
+/* the locks and list heads stay initialized in the cached requests */
+static void mtk_cam_req_ctor(void *obj)
 {
-	struct mtk_cam_request *cam_req;
+	struct mtk_cam_request *cam_req = obj;
 
-	cam_req = vzalloc(sizeof(*cam_req));
+	memset(cam_req, 0, sizeof(*cam_req));
 	spin_lock_init(&cam_req->done_status_lock);
 	mutex_init(&cam_req->fs.op_lock);
+	INIT_LIST_HEAD(&cam_req->list);
+	INIT_LIST_HEAD(&cam_req->cleanup_list);
+}
+
+int mtk_cam_req_s_data_alloc(struct mtk_cam_request *req, int pipe_id)
+{
+	struct mtk_cam_request_stream_data *s_data;
+	int i;
+
+	if (pipe_id < 0 || pipe_id >= MTKCAM_SUBDEV_MAX)
+		return -EINVAL;
+
+	if (READ_ONCE(req->p_data[pipe_id].s_data))
+		return 0;
+
+	/* too large for a slab, the frame fields are reset at enqueue */
+	s_data = kvzalloc(sizeof(*s_data) * MTK_CAM_REQ_MAX_S_DATA, GFP_KERNEL);
+	if (!s_data)
+		return -ENOMEM;
+
+	for (i = 0; i < MTK_CAM_REQ_MAX_S_DATA; i++) {
+		atomic_set(&s_data[i].buf_state, -1);
+		INIT_LIST_HEAD(&s_data[i].deque_list_node);
+		INIT_LIST_HEAD(&s_data[i].cleanup_list_node);
+	}
+
+	/* a pending set fmt and a link change may race on the same pipe */
+	if (cmpxchg(&req->p_data[pipe_id].s_data, NULL, s_data))
+		kvfree(s_data);
+
+	return 0;
+}
+
+static int mtk_cam_req_s_data_alloc_pipes(struct mtk_cam_request *req,
+					  unsigned int pipes)
+{
+	int i, ret;
+
+	for (i = 0; i < MTKCAM_SUBDEV_MAX; i++) {
+		if (!(pipes & (1 << i)))
+			continue;
+
+		ret = mtk_cam_req_s_data_alloc(req, i);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/* the streaming pipes and the camsv pipes their contexts enqueue to */
+static unsigned int mtk_cam_req_linked_pipes(struct mtk_cam_device *cam)
+{
+	unsigned int pipes = cam->streaming_pipe;
+	int i, j;
+
+	for (i = 0; i < cam->max_stream_num; i++) {
+		struct mtk_cam_ctx *ctx = &cam->ctxs[i];
+
+		if (!ctx->streaming_pipe)
+			continue;
+
+		for (j = 0; j < ctx->used_sv_num; j++)
+			pipes |= 1 << ctx->sv_pipe[j]->id;
+	}
+
+	return pipes;
+}
+
+static struct media_request *mtk_cam_req_alloc(struct media_device *mdev)
+{
+	struct mtk_cam_device *cam =
+		container_of(mdev, struct mtk_cam_device, media_dev);
+	struct mtk_cam_request *cam_req;
+
+	cam_req = kmem_cache_alloc(mtk_cam_req_cache, GFP_KERNEL);
+	if (!cam_req)
+		return NULL;
+
+	/**
+	 * A cached request is handled as a reinit one, only the members
+	 * used before the next queue are reset, see mtk_cam_req_clean().
+	 * The media core initializes the embedded media request.
+	 */
+	memset(&cam_req->req, 0, sizeof(cam_req->req));
+	cam_req->pipe_used = 0;
+	cam_req->ctx_used = 0;
+	cam_req->flags = 0;
+	cam_req->done_status = 0;
+	atomic_set(&cam_req->state, MTK_CAM_REQ_STATE_PENDING);
+	atomic_set(&cam_req->ref_cnt, 0);
+	mtk_cam_fs_reset(&cam_req->fs);
+	mtk_cam_req_clean(cam_req);
+
+	/* the other pipes are allocated when the request is validated */
+	if (mtk_cam_req_s_data_alloc_pipes(cam_req,
+					   mtk_cam_req_linked_pipes(cam)))
+		dev_dbg(cam->dev, "%s: stream data deferred to queue\n",
+			__func__);
 
 	return &cam_req->req;
 }
@@ -3542,8 +3706,49 @@ static struct media_request *mtk_cam_req_alloc(struct media_device *mdev)
 static void mtk_cam_req_free(struct media_request *req)
 {
 	struct mtk_cam_request *cam_req = to_mtk_cam_req(req);
+	int i;
+
+	for (i = 0; i < MTKCAM_SUBDEV_MAX; i++) {
+		if (!cam_req->p_data[i].s_data)
+			continue;
+
+		kvfree(cam_req->p_data[i].s_data);
+		cam_req->p_data[i].s_data = NULL;
+		cam_req->p_data[i].s_data_num = 0;
+	}
+
+	kmem_cache_free(mtk_cam_req_cache, cam_req);
+}
+
+static int mtk_cam_req_validate(struct media_request *req)
+{
+	struct mtk_cam_request *cam_req = to_mtk_cam_req(req);
+	struct mtk_cam_device *cam =
+		container_of(req->mdev, struct mtk_cam_device, media_dev);
+	struct media_request_object *obj;
+	unsigned int pipes;
+	int ret;
+
+	pipes = mtk_cam_req_linked_pipes(cam);
+	list_for_each_entry(obj, &req->objects, list) {
+		struct vb2_buffer *vb;
+		struct mtk_cam_video_device *node;
 
-	vfree(cam_req);
+		if (!vb2_request_object_is_buffer(obj))
+			continue;
+		vb = container_of(obj, struct vb2_buffer, req_obj);
+		node = mtk_cam_vbq_to_vdev(vb->vb2_queue);
+		pipes |= 1 << node->uid.pipe_id;
+	}
+
+	ret = mtk_cam_req_s_data_alloc_pipes(cam_req, pipes);
+	if (ret) {
+		dev_info(cam->dev, "%s:req(%s): failed to alloc stream data:%d\n",
+			 __func__, req->debug_str, ret);
+		return ret;
+	}
+
+	return vb2_request_validate(req);
 }
 
 static int mtk_cam_req_chk_job_list(struct mtk_cam_device *cam,
@@ -3725,6 +3930,11 @@ static int mtk_cam_link_notify(struct media_link *link, u32 flags,
 	}
 
 	cam_req = to_mtk_cam_req(req);
+	if (mtk_cam_req_s_data_alloc(cam_req, ctx->stream_id)) {
+		media_request_put(req);
+		return -ENOMEM;
+	}
+
 	stream_data = mtk_cam_req_get_s_data_no_chk(cam_req, ctx->stream_id, 0);
 	stream_data->seninf_old = ctx->seninf;
 	stream_data->seninf_new = media_entity_to_v4l2_subdev(source);
@@ -3744,7 +3954,7 @@ static const struct media_device_ops mtk_cam_dev_ops = {
 	.link_notify = mtk_cam_link_notify,
 	.req_alloc = mtk_cam_req_alloc,
 	.req_free = mtk_cam_req_free,
-	.req_validate = vb2_request_validate,
+	.req_validate = mtk_cam_req_validate,
 	.req_queue = mtk_cam_req_queue,
 };
 
@@ -4171,6 +4381,9 @@ static int isp_composer_handle_ack(struct mtk_cam_device *cam,
 		return -EINVAL;
 	}
 
+	mtk_cam_virt_stamp(&ctx->virt, s_data->frame_seq_no,
+			   MTK_CAM_VIRT_ACK);
+
 	req = mtk_cam_s_data_get_req(s_data);
 	if (req->flags & MTK_CAM_REQ_FLAG_SENINF_IMMEDIATE_UPDATE &&
 			(req->ctx_link_update & (1 << s_data->pipe_id))) {
@@ -4317,6 +4530,7 @@ static int isp_composer_handler(struct rpmsg_device *rpdev, void *data,
 
 	if (ipi_msg->cmd_id != CAM_CMD_ACK ||
 	    (ipi_msg->ack_data.ack_cmd_id != CAM_CMD_FRAME &&
+	     ipi_msg->ack_data.ack_cmd_id != CAM_CMD_CREATE_SESSION &&
 	     ipi_msg->ack_data.ack_cmd_id != CAM_CMD_DESTROY_SESSION))
 		return -EINVAL;
 
@@ -4327,6 +4541,16 @@ static int isp_composer_handler(struct rpmsg_device *rpdev, void *data,
 
 		return ret;
 
+	} else if (ipi_msg->ack_data.ack_cmd_id == CAM_CMD_CREATE_SESSION) {
+		if (ipi_msg->cookie.session_id >= cam->max_stream_num)
+			return -EINVAL;
+
+		/* frames composed before this still go in the full format */
+		ctx = &cam->ctxs[ipi_msg->cookie.session_id];
+		WRITE_ONCE(ctx->ipi_caps,
+			   ipi_msg->ack_data.caps & MTK_CAM_IPI_CAP_FRAME_TLV);
+		dev_info(dev, "%s:ctx(%d): composer caps:0x%x",
+			 __func__, ctx->stream_id, ctx->ipi_caps);
 	} else if (ipi_msg->ack_data.ack_cmd_id == CAM_CMD_DESTROY_SESSION) {
 		if (ipi_msg->cookie.session_id >= cam->max_stream_num)
 			return -EINVAL;
@@ -4340,6 +4564,16 @@ static int isp_composer_handler(struct rpmsg_device *rpdev, void *data,
 	return 0;
 }
 
+/* ack a frame in place of the CCD, nothing is composed into the CQ */
+static void isp_composer_loopback(struct mtk_cam_ctx *ctx,
+				  struct mtkcam_ipi_event *frame)
+{
+	struct mtkcam_ipi_event ack;
+
+	mtk_cam_mock_ccd_ack(&ack, &frame->cookie, CAM_CMD_FRAME, 0);
+	isp_composer_handle_ack(ctx->cam, &ack);
+}
+
 #endif
 
 static void isp_tx_frame_worker(struct work_struct *work)
@@ -4396,6 +4630,9 @@ static void isp_tx_frame_worker(struct work_struct *work)
 	}
 	spin_unlock(&ctx->streaming_lock);
 
+	mtk_cam_virt_stamp(&ctx->virt, req_stream_data->frame_seq_no,
+			   MTK_CAM_VIRT_TX);
+
 	s_raw_pipe_data = mtk_cam_s_data_get_raw_pipe_data(req_stream_data);
 
 	/* Send CAM_CMD_CONFIG if the sink pad fmt is changed */
@@ -4493,23 +4730,37 @@ static void isp_tx_frame_worker(struct work_struct *work)
 		}
 	}
 
-	memcpy(frame_data, &req_stream_data->frame_params,
-	       sizeof(req_stream_data->frame_params));
-	frame_data->cur_workbuf_offset =
+	frame_param = &req_stream_data->frame_params;
+	frame_param->cur_workbuf_offset =
 		buf_entry->buffer.iova -
 		cam->ctxs[session->session_id].buf_pool.working_buf_iova;
-	frame_data->cur_workbuf_size = buf_entry->buffer.size;
+	frame_param->cur_workbuf_size = buf_entry->buffer.size;
 
 	res_user = mtk_cam_s_data_get_res(req_stream_data);
 	if (res_user && res_user->raw_res.bin) {
-		frame_data->raw_param.bin_flag = res_user->raw_res.bin;
+		frame_param->raw_param.bin_flag = res_user->raw_res.bin;
 	} else {
 		if (ctx->pipe->res_config.bin_limit == BIN_AUTO)
-			frame_data->raw_param.bin_flag = ctx->pipe->res_config.bin_enable;
+			frame_param->raw_param.bin_flag = ctx->pipe->res_config.bin_enable;
 		else
-			frame_data->raw_param.bin_flag = ctx->pipe->res_config.bin_limit;
+			frame_param->raw_param.bin_flag = ctx->pipe->res_config.bin_limit;
 	}
 
+	/* only the ports in use, the full frame if it does not fit */
+	if (READ_ONCE(ctx->ipi_caps) & MTK_CAM_IPI_CAP_FRAME_TLV &&
+	    mtkcam_ipi_frame_tlv_encode(frame_data, buf_entry->msg_buffer.size,
+					frame_param))
+		frame_info->fmt = MTK_CAM_IPI_FRAME_FMT_TLV;
+	else
+		memcpy(frame_data, frame_param, sizeof(*frame_param));
+
+#if CCD_READY
+	if (mtk_cam_virt_enabled(&ctx->virt)) {
+		isp_composer_loopback(ctx, &event);
+		return;
+	}
+#endif
+
 	if (ctx->rpmsg_dev) {
 		rpmsg_send(ctx->rpmsg_dev->rpdev.ept, &event, sizeof(event));
 
@@ -4517,7 +4768,7 @@ static void isp_tx_frame_worker(struct work_struct *work)
 			 "%s: rpmsg_send id: %d, ctx:%d, seq:%d, bin:(0x%x)\n",
 			 req->req.debug_str, event.cmd_id, session->session_id,
 			 req_stream_data->frame_seq_no,
-			 frame_data->raw_param.bin_flag);
+			 frame_param->raw_param.bin_flag);
 	} else {
 		dev_dbg(cam->dev, "%s: rpmsg_dev not exist: %d, ctx:%d, req:%d\n",
 			__func__, event.cmd_id, session->session_id,
@@ -4540,6 +4791,11 @@ static bool mtk_cam_sv_req_enqueue(struct mtk_cam_ctx *ctx,
 	ctx_stream_data = mtk_cam_req_get_s_data(req, ctx->stream_id, idx);
 	for (i = 0 ; i < ctx->used_sv_num ; i++) {
 		pipe_id = ctx->sv_pipe[i]->id;
+		/* allocated by mtk_cam_req_s_data_alloc_sv() */
+		if (WARN_ON(!req->p_data[pipe_id].s_data)) {
+			ret = false;
+			continue;
+		}
 		buf_entry = mtk_cam_sv_working_buf_get(ctx);
 		req->p_data[pipe_id].s_data_num = req->p_data[ctx->stream_id].s_data_num;
 		pipe_stream_data = mtk_cam_req_get_s_data(req, pipe_id, idx);
@@ -4909,6 +5165,10 @@ int isp_composer_create_session(struct mtk_cam_ctx *ctx)
 	session_data->workbuf.size = ctx->buf_pool.working_buf_size;
 	session_data->msg_buf.ccd_fd = ctx->buf_pool.msg_buf_fd;
 	session_data->msg_buf.size = ctx->buf_pool.msg_buf_size;
+	if (READ_ONCE(ipi_frame_tlv))
+		session_data->caps = MTK_CAM_IPI_CAP_FRAME_TLV;
+	/* until the composer acks the session with the ones it takes */
+	ctx->ipi_caps = 0;
 
 	ret = rpmsg_send(ctx->rpmsg_dev->rpdev.ept, &event, sizeof(event));
 	dev_dbg(cam->dev,
@@ -5623,6 +5883,10 @@ struct mtk_cam_ctx *mtk_cam_start_ctx(struct mtk_cam_device *cam,
 			goto fail_rproc_put;
 		}
 
+		ret = mtk_cam_mock_ccd_start(cam);
+		if (ret)
+			goto fail_shutdown;
+
 		/* To catch camsys exception and trigger dump */
 		if (cam->debug_fs)
 			cam->debug_fs->ops->exp_reinit(cam->debug_fs);
@@ -5759,6 +6023,7 @@ fail_shutdown:
 	if (is_first_ctx) {
 		pm_runtime_mark_last_busy(cam->dev);
 		pm_runtime_put_sync_autosuspend(cam->dev);
+		mtk_cam_mock_ccd_stop(cam);
 		rproc_shutdown(cam->rproc_handle);
 	}
 fail_rproc_put:
@@ -5887,6 +6152,7 @@ void mtk_cam_stop_ctx(struct mtk_cam_ctx *ctx, struct media_entity *entity)
 		pm_runtime_mark_last_busy(cam->dev);
 		pm_runtime_put_sync_autosuspend(cam->dev);
 #if CCD_READY
+		mtk_cam_mock_ccd_stop(cam);
 		rproc_shutdown(cam->rproc_handle);
 		rproc_put(cam->rproc_handle);
 		cam->rproc_handle = NULL;
@@ -5959,6 +6225,7 @@ int mtk_cam_ctx_stream_on(struct mtk_cam_ctx *ctx)
 		feature_active = ctx->pipe->feature_active;
 		feature_first_req = ctx->pipe->feature_pending;
 	}
+	mtk_cam_working_buf_pool_config(ctx);
 	if (ctx->used_raw_num) {
 		tgo_pxl_mode = ctx->pipe->res_config.tgo_pxl_mode;
 		/**
@@ -6212,6 +6479,7 @@ int mtk_cam_ctx_stream_on(struct mtk_cam_ctx *ctx)
 				}
 			}
 		}
+		mtk_cam_virt_start(ctx, raw_dev);
 	}
 	/* TODO */
 	spin_lock(&ctx->streaming_lock);
@@ -6277,6 +6545,7 @@ fail_streaming_off:
 	ctx->streaming = false;
 	cam->streaming_ctx &= ~(1 << ctx->stream_id);
 	spin_unlock(&ctx->streaming_lock);
+	mtk_cam_virt_stop(ctx);
 	/* reset dvfs/qos */
 	if (!mtk_cam_is_m2m(ctx))
 		v4l2_subdev_call(ctx->seninf, video, s_stream, 0);
@@ -6330,6 +6599,7 @@ int mtk_cam_ctx_stream_off(struct mtk_cam_ctx *ctx)
 	unsigned int i, enabled_sv = 0;
 	int ret;
 	int feature = 0;
+	char pools[384];
 
 	if (!ctx->streaming) {
 		dev_info(cam->dev, "ctx-%d is already streaming off\n",
@@ -6346,11 +6616,16 @@ int mtk_cam_ctx_stream_off(struct mtk_cam_ctx *ctx)
 	dev_info(cam->dev, "%s: ctx-%d:  composer_cnt:%d, streaming_pipe:0x%x\n",
 		__func__, ctx->stream_id, cam->composer_cnt, ctx->streaming_pipe);
 
+	mtk_cam_working_buf_pools_show(ctx, pools, sizeof(pools));
+	dev_info(cam->dev, "ctx-%d buffer pools:\n%s", ctx->stream_id, pools);
+
 	spin_lock(&ctx->streaming_lock);
 	ctx->streaming = false;
 	cam->streaming_ctx &= ~(1 << ctx->stream_id);
 	spin_unlock(&ctx->streaming_lock);
 
+	mtk_cam_virt_stop(ctx);
+
 	if (ctx->synced) {
 		/* after streaming being off, no one can do V4L2_CID_FRAME_SYNC */
 		struct v4l2_ctrl *ctrl;
@@ -7216,6 +7491,28 @@ REGISTER_LARB_FAIL:
 	return ret;
 }
 
+static ssize_t buf_pools_show(struct device *dev,
+			      struct device_attribute *attr, char *buf)
+{
+	struct mtk_cam_device *cam = dev_get_drvdata(dev);
+	int i, len = 0;
+
+	for (i = 0; i < cam->max_stream_num; i++) {
+		struct mtk_cam_ctx *ctx = &cam->ctxs[i];
+
+		if (!(cam->streaming_ctx & (1 << i)))
+			continue;
+
+		len += scnprintf(buf + len, PAGE_SIZE - len, "ctx-%d\n", i);
+		len += mtk_cam_working_buf_pools_show(ctx, buf + len,
+						      PAGE_SIZE - len);
+	}
+
+	return len;
+}
+
+static DEVICE_ATTR_RO(buf_pools);
+
 static int mtk_cam_probe(struct platform_device *pdev)
 {
 	struct mtk_cam_device *cam_dev;
@@ -7308,6 +7605,10 @@ static int mtk_cam_probe(struct platform_device *pdev)
 	if (ret < 0)
 		goto fail_uninit_link_change_wq;
 
+	ret = device_create_file(dev, &dev_attr_buf_pools);
+	if (ret)
+		dev_info(dev, "failed to create buf_pools:%d\n", ret);
+
 	return 0;
 
 fail_uninit_link_change_wq:
@@ -7327,6 +7628,7 @@ static int mtk_cam_remove(struct platform_device *pdev)
 	struct device *dev = &pdev->dev;
 	struct mtk_cam_device *cam_dev = dev_get_drvdata(dev);
 
+	device_remove_file(dev, &dev_attr_buf_pools);
 	pm_runtime_disable(dev);
 
 	component_master_del(dev, &mtk_cam_master_ops);
@@ -7362,12 +7664,28 @@ static struct platform_driver mtk_cam_driver = {
 
 static int __init mtk_cam_init(void)
 {
-	return platform_driver_register(&mtk_cam_driver);
+	int ret;
+
+	/* a failed hash build only costs a linear lookup */
+	mtk_cam_fmt_desc_init();
+
+	mtk_cam_req_cache = kmem_cache_create("mtk_cam_req",
+					      sizeof(struct mtk_cam_request),
+					      0, 0, mtk_cam_req_ctor);
+	if (!mtk_cam_req_cache)
+		return -ENOMEM;
+
+	ret = platform_driver_register(&mtk_cam_driver);
+	if (ret)
+		kmem_cache_destroy(mtk_cam_req_cache);
+
+	return ret;
 }
 
 static void __exit mtk_cam_exit(void)
 {
 	platform_driver_unregister(&mtk_cam_driver);
+	kmem_cache_destroy(mtk_cam_req_cache);
 }
 
 module_init(mtk_cam_init);
@@ -26,6 +26,8 @@
 #include "mtk_cam-debug.h"
 #include "mtk_cam-hsf-def.h"
 #include "mtk_cam-plat-util.h"
+#include "mtk_cam-virt.h"
+#include "mtk_cam-mock-ccd.h"
 
 #define MTK_CAM_REQ_MAX_S_DATA	2
 /* for cq working buffers */
@@ -117,10 +119,25 @@ struct mtk_cam_img_working_buf_entry {
 	struct list_head list_entry;
 };
 
+/* occupancy of a working buffer pool, under the lock of its list */
+struct mtk_cam_buf_pool_stats {
+	u32 size;
+	u32 in_use;
+	u32 hwm;
+	u32 exhausted;
+	u32 grown;
+	u64 empty_ts;
+	u64 empty_ns;
+};
+
 struct mtk_cam_working_buf_list {
 	struct list_head list;
 	u32 cnt;
 	spinlock_t lock; /* protect the list and cnt */
+	/* entries over the stream-on depth, taken when the list runs out */
+	struct list_head reserve;
+	u32 reserve_cnt;
+	struct mtk_cam_buf_pool_stats stats;
 };
 
 struct mtk_camsv_working_buf_entry {
@@ -135,6 +152,7 @@ struct mtk_camsv_working_buf_list {
 	struct list_head list;
 	u32 cnt;
 	spinlock_t lock; /* protect the list and cnt */
+	struct mtk_cam_buf_pool_stats stats;
 };
 
 struct mtk_cam_req_work {
@@ -222,10 +240,14 @@ struct mtk_cam_request_stream_data {
 	atomic_t first_setting_check;
 };
 
+/*
+ * @s_data: MTK_CAM_REQ_MAX_S_DATA stream data, only allocated for the
+ * pipes the request is used with, see mtk_cam_req_s_data_alloc().
+ */
 struct mtk_cam_req_pipe {
 	int s_data_num;
 	int req_seq;
-	struct mtk_cam_request_stream_data s_data[MTK_CAM_REQ_MAX_S_DATA];
+	struct mtk_cam_request_stream_data *s_data;
 };
 
 enum mtk_cam_request_state {
@@ -402,7 +424,11 @@ struct mtk_cam_ctx {
 
 	/* To support debug dump */
 	struct mtkcam_ipi_config_param config_params;
+	/* MTK_CAM_IPI_CAP_* accepted by the composer for the session */
+	u32 ipi_caps;
 
+	/* software sensor instead of the raw hardware, see mtk_cam-virt.h */
+	struct mtk_cam_virt virt;
 };
 
 struct mtk_cam_device {
@@ -417,6 +443,8 @@ struct mtk_cam_device {
 	//struct platform_device *scp_pdev; /* only for scp case? */
 	phandle rproc_phandle;
 	struct rproc *rproc_handle;
+	/* composer acked in the kernel, see mtk_cam-mock-ccd.h */
+	struct mtk_cam_mock_ccd_dev *mock_ccd;
 
 	struct workqueue_struct *link_change_wq;
 	unsigned int composer_cnt;
@@ -477,6 +505,7 @@ mtk_cam_req_get_num_s_data(struct mtk_cam_request *req, int pipe_id)
 /**
  * Be used operation between request reinit and enqueue.
  * For example, request-based set fmt and selection.
+ * The caller allocates the stream data with mtk_cam_req_s_data_alloc().
  */
 static inline struct mtk_cam_request_stream_data*
 mtk_cam_req_get_s_data_no_chk(struct mtk_cam_request *req, int pipe_id, int idx)
@@ -490,7 +519,8 @@ mtk_cam_req_get_s_data(struct mtk_cam_request *req, int pipe_id, int idx)
 	if (!req || pipe_id < 0 || pipe_id >= MTKCAM_SUBDEV_MAX)
 		return NULL;
 
-	if (idx < 0 || idx >= req->p_data[pipe_id].s_data_num)
+	if (idx < 0 || idx >= req->p_data[pipe_id].s_data_num ||
+	    !req->p_data[pipe_id].s_data)
 		return NULL;
 
 	return mtk_cam_req_get_s_data_no_chk(req, pipe_id, idx);
@@ -763,6 +793,7 @@ void mtk_cam_dev_req_clean_pending(struct mtk_cam_device *cam, int pipe_id,
 
 void mtk_cam_req_get(struct mtk_cam_request *req, int pipe_id);
 bool mtk_cam_req_put(struct mtk_cam_request *req, int pipe_id);
+int mtk_cam_req_s_data_alloc(struct mtk_cam_request *req, int pipe_id);
 
 void mtk_cam_dev_req_try_queue(struct mtk_cam_device *cam);
 
@@ -0,0 +1,17 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Copyright (c) 2022 MediaTek Inc.
+ */
+
+#ifndef __RES_UT_LINUX_TYPES_H
+#define __RES_UT_LINUX_TYPES_H
+
+/* host stand-in for the kernel header, RAW_RES_UT only */
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef uint32_t u32;
+typedef int64_t s64;
+typedef uint64_t u64;
+
+#endif
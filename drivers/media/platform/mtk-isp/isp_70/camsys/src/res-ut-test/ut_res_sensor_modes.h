@@ -0,0 +1,65 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Copyright (c) 2022 MediaTek Inc.
+ */
+
+#ifndef __UT_RES_SENSOR_MODES_H
+#define __UT_RES_SENSOR_MODES_H
+
+/*
+ * Sensor modes of the imgsensor drivers in this tree, copied from their
+ * imgsensor_info tables (drivers/misc/mediatek/imgsensor/src-v4l2/common).
+ * Keep in sync when a mode is added or changed there.
+ */
+struct ut_res_sensor_mode {
+	const char *sensor;
+	const char *mode;
+	int width;
+	int height;
+	int linelength;
+	int framelength;
+	long long mipi_pixel_rate;
+	int max_framerate;	/* fps * 10 */
+};
+
+static const struct ut_res_sensor_mode ut_res_sensor_modes[] = {
+	{ "ar0430ap1302", "pre", 2316, 1746, 4800, 3180, 468000000LL, 300 },
+	{ "ar0430ap1302", "cap", 2316, 1746, 4800, 3180, 468000000LL, 300 },
+	{ "ar0430ap1302", "cap1", 2316, 1746, 4800, 3180, 484000000LL, 300 },
+	{ "ar0430ap1302", "normal_video", 2316, 1746, 4800, 3180, 475000000LL, 300 },
+	{ "ar0430ap1302", "hs_video", 2316, 1746, 4800, 3180, 320000000LL, 600 },
+	{ "ar0430ap1302", "slim_video", 2316, 1746, 4800, 3180, 160000000LL, 300 },
+	{ "ar0830ap1302", "pre", 2560, 1440, 4800, 3180, 610000000LL, 300 },
+	{ "ar0830ap1302", "cap", 3840, 2160, 4800, 3180, 610000000LL, 250 },
+	{ "ar0830ap1302", "cap1", 1920, 1080, 4800, 3180, 484000000LL, 300 },
+	{ "ar0830ap1302", "normal_video", 1920, 1080, 4800, 3180, 610000000LL, 300 },
+	{ "ar0830ap1302", "hs_video", 1920, 1080, 4800, 3180, 320000000LL, 600 },
+	{ "ar0830ap1302", "slim_video", 1920, 1080, 4800, 3180, 160000000LL, 300 },
+	{ "ar0830ap1302d2l", "pre", 2560, 1440, 4800, 3180, 610000000LL, 300 },
+	{ "ar0830ap1302d2l", "cap", 3840, 2160, 4800, 3180, 610000000LL, 125 },
+	{ "ar0830ap1302d2l", "cap1", 1920, 1080, 4800, 3180, 484000000LL, 300 },
+	{ "ar0830ap1302d2l", "normal_video", 1920, 1080, 4800, 3180, 610000000LL, 300 },
+	{ "ar0830ap1302d2l", "hs_video", 1920, 1080, 4800, 3180, 320000000LL, 600 },
+	{ "ar0830ap1302d2l", "slim_video", 1920, 1080, 4800, 3180, 160000000LL, 300 },
+	{ "imx214", "pre", 2104, 1560, 5008, 2110, 317000000LL, 300 },
+	{ "imx214", "cap", 4208, 3120, 5008, 3160, 484000000LL, 300 },
+	{ "imx214", "cap1", 4208, 3120, 5008, 3220, 484000000LL, 240 },
+	{ "imx214", "cap2", 4208, 3120, 5008, 3220, 484000000LL, 150 },
+	{ "imx214", "normal_video", 4208, 3120, 5008, 3160, 475000000LL, 300 },
+	{ "imx214", "hs_video", 2104, 1184, 5008, 1288, 320000000LL, 600 },
+	{ "imx214", "slim_video", 2104, 1184, 5008, 1288, 160000000LL, 300 },
+	{ "imx214d2l", "pre", 2104, 1560, 5008, 1600, 260000000LL, 300 },
+	{ "imx214d2l", "cap", 4208, 3120, 5008, 3160, 260000000LL, 150 },
+	{ "imx214d2l", "cap1", 4208, 3120, 5008, 3160, 260000000LL, 150 },
+	{ "imx214d2l", "cap2", 4208, 3120, 5008, 3160, 260000000LL, 150 },
+	{ "imx214d2l", "normal_video", 4208, 3120, 5008, 3160, 260000000LL, 150 },
+	{ "imx214d2l", "hs_video", 4208, 3120, 5008, 3160, 260000000LL, 150 },
+	{ "imx214d2l", "slim_video", 4208, 3120, 5008, 3160, 260000000LL, 150 },
+	{ "imx219d2l", "pre", 1920, 1080, 1920, 1600, 260000000LL, 300 },
+	{ "imx219d2l", "cap", 1920, 1080, 1920, 1080, 260000000LL, 300 },
+	{ "imx219d2l", "normal_video", 1920, 1080, 1920, 1080, 260000000LL, 300 },
+	{ "imx219d2l", "hs_video", 1920, 1080, 1920, 1080, 9120000000LL, 300 },
+	{ "imx219d2l", "slim_video", 1920, 1080, 1920, 1080, 260000000LL, 300 },
+};
+
+#endif
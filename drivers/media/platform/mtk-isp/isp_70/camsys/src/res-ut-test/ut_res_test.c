@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright (c) 2022 MediaTek Inc.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* built in, so the checks can reuse the planner's static helpers */
+#include "../mtk_cam-raw-res.c"
+
+#include "ut_res_sensor_modes.h"
+
+#define NONE           "\033[m"
+#define RED            "\033[0;32;31m"
+#define GREEN          "\033[0;32;32m"
+
+/* mirrors ISP_CLK_LEVEL_CNT, the planner may index up to clk step 3 */
+#define UT_CLK_LEVEL_CNT 10
+
+/* from mtk_cam-seninf-def.h, ISP7_1 */
+#define UT_HW_BUF_EFFECT 10
+#define UT_ISP_CLK_LOW 273000000
+
+struct ut_clk_table {
+	const char *name;
+	unsigned int num;
+	unsigned int clklv[UT_CLK_LEVEL_CNT];
+};
+
+static const struct ut_clk_table ut_clk_tables[] = {
+	/* opp_default_table in mtk_cam-dvfs_qos.c */
+	{ "default", 1, { 546000000 } },
+	{ "4-level", 4, { 312000000, 416000000, 546000000, 624000000 } },
+};
+
+static int ut_fail;
+static int ut_cnt;
+static int ut_lowered;
+
+#define UT_CHECK(cond, fmt, args...)					\
+do {									\
+	ut_cnt++;							\
+	if (!(cond)) {							\
+		ut_fail++;						\
+		printf(RED "[FAIL] %s:%d " fmt NONE "\n",		\
+		       __func__, __LINE__, ##args);			\
+	}								\
+} while (0)
+
+/* same as calc_buffered_pixel_rate() in mtk_cam-seninf-drv.c */
+static s64 ut_buffered_pixel_rate(const struct ut_res_sensor_mode *m)
+{
+	s64 hblank = m->linelength - m->width;
+	s64 k = UT_HW_BUF_EFFECT * m->mipi_pixel_rate / UT_ISP_CLK_LOW;
+
+	if (hblank < 1)
+		hblank = 1;
+
+	return m->mipi_pixel_rate * m->width / (m->width + hblank - k);
+}
+
+static void ut_check_plan(const struct ut_res_sensor_mode *m,
+			  const struct mtk_raw_res_in *in,
+			  const struct mtk_raw_res_out *out)
+{
+	u64 eq_throughput;
+	int frz_ratio = 100;
+	int lb, lv, p, pxl;
+
+	if (!out->found)
+		return;
+
+	UT_CHECK(out->clk_idx <= out->step_clk_idx,
+		 "%s/%s: clk %d above step clk %d", m->sensor, m->mode,
+		 out->clk_idx, out->step_clk_idx);
+	UT_CHECK(out->clk_idx < (int)in->clklv_num,
+		 "%s/%s: clk idx %d out of table", m->sensor, m->mode,
+		 out->clk_idx);
+	UT_CHECK(out->raw_num_used >= 1 &&
+		 out->raw_num_used <= in->hwn_limit_max +
+		 (in->hwn_limit_min > 1),
+		 "%s/%s: raw num %u", m->sensor, m->mode, out->raw_num_used);
+
+	lb = mtk_raw_linebuf_chk(out->raw_num_used - 1,
+				 in->bin_limit & BIN_ON, out->frz_enable,
+				 in->bin_limit & QBND_ON,
+				 is_cbn_en(in->bin_limit), in->in_w, &frz_ratio);
+	UT_CHECK(lb == LB_CHECK_OK, "%s/%s: line buffer check %d",
+		 m->sensor, m->mode, lb);
+
+	if (in->timeshare)
+		return;
+
+	eq_throughput = ((u64)1 << out->tgo_pxl_mode) * out->clk_target;
+	UT_CHECK(eq_throughput > in->pixel_rate,
+		 "%s/%s: throughput %llu <= pixel rate %lld", m->sensor,
+		 m->mode, (unsigned long long)eq_throughput,
+		 (long long)in->pixel_rate);
+
+	/* nothing below the chosen level may sustain the same resources */
+	for (lv = 0; lv < out->clk_idx; lv++) {
+		for (p = 1; p <= MTK_CAMSYS_PROC_DEFAULT_PIXELMODE; p++) {
+			pxl = mtk_raw_pixelmode_calc(p, out->raw_num_used - 1,
+						     out->bin_enable,
+						     out->frz_enable,
+						     out->frz_ratio);
+			eq_throughput = ((u64)pxl) * in->clklv[lv];
+			UT_CHECK(eq_throughput <= in->pixel_rate,
+				 "%s/%s: clk %d not lowest, %d suffices",
+				 m->sensor, m->mode, out->clk_idx, lv);
+		}
+	}
+
+	if (out->clk_idx < out->step_clk_idx)
+		ut_lowered++;
+}
+
+static void ut_check_cache(const struct mtk_raw_res_in *in,
+			   const struct mtk_raw_res_out *ref)
+{
+	static struct mtk_raw_res_cache cache;
+	struct mtk_raw_res_out out;
+	unsigned int hit;
+
+	mtk_raw_res_plan_cached(&cache, in, &out);
+	UT_CHECK(!memcmp(&out, ref, sizeof(out)), "cached plan differs");
+
+	hit = cache.hit;
+	mtk_raw_res_plan_cached(&cache, in, &out);
+	UT_CHECK(cache.hit == hit + 1, "second lookup missed");
+	UT_CHECK(!memcmp(&out, ref, sizeof(out)), "cache hit differs");
+}
+
+static void ut_run_mode(const struct ut_res_sensor_mode *m,
+			const struct ut_clk_table *tbl)
+{
+	static const int prate_mul[] = { 1, 2, 3 }; /* stagger worst case */
+	struct mtk_raw_res_in in;
+	struct mtk_raw_res_out out;
+	unsigned int plan, hwn, bin, ts, i;
+	int found = 0, total = 0;
+
+	for (i = 0; i < sizeof(prate_mul) / sizeof(prate_mul[0]); i++)
+	for (plan = 0; plan < RESOURCE_STRATEGY_NUMBER; plan++)
+	for (hwn = 1; hwn <= 2; hwn++)
+	for (bin = 0; bin <= 1; bin++)
+	for (ts = 0; ts <= 1; ts++) {
+		memset(&in, 0, sizeof(in));
+		in.in_w = m->width;
+		in.in_h = m->height;
+		in.pixel_rate = ut_buffered_pixel_rate(m) * prate_mul[i];
+		in.res_plan = plan;
+		in.bin_limit = bin;
+		in.hwn_limit_max = ts ? 1 : hwn;
+		in.hwn_limit_min = 1;
+		in.timeshare = ts;
+		in.clklv = tbl->clklv;
+		in.clklv_num = tbl->num;
+
+		mtk_raw_res_plan(&in, &out);
+		ut_check_plan(m, &in, &out);
+		ut_check_cache(&in, &out);
+		total++;
+		found += out.found;
+	}
+
+	printf("%-16s %-13s %5dx%-5d %-8s found %3d/%3d\n", m->sensor,
+	       m->mode, m->width, m->height, tbl->name, found, total);
+}
+
+static void ut_check_defaults(void)
+{
+	const struct ut_clk_table *tbl = &ut_clk_tables[1];
+	const struct ut_res_sensor_mode *m;
+	struct mtk_raw_res_in in;
+	struct mtk_raw_res_out out;
+	unsigned int i;
+
+	/* driver defaults (QRP, up to 2 raws) must fit every mode */
+	for (i = 0; i < sizeof(ut_res_sensor_modes) /
+	     sizeof(ut_res_sensor_modes[0]); i++) {
+		m = &ut_res_sensor_modes[i];
+		if (ut_buffered_pixel_rate(m) >= 2LL * 8 * tbl->clklv[3])
+			continue; /* beyond the hardware, e.g. imx219d2l hs */
+		memset(&in, 0, sizeof(in));
+		in.in_w = m->width;
+		in.in_h = m->height;
+		in.pixel_rate = ut_buffered_pixel_rate(m);
+		in.res_plan = RESOURCE_STRATEGY_QRP;
+		in.hwn_limit_max = 2;
+		in.hwn_limit_min = 1;
+		in.clklv = tbl->clklv;
+		in.clklv_num = tbl->num;
+		mtk_raw_res_plan(&in, &out);
+		UT_CHECK(out.found, "%s/%s: no plan with defaults",
+			 m->sensor, m->mode);
+	}
+}
+
+static void ut_check_eviction(void)
+{
+	const struct ut_clk_table *tbl = &ut_clk_tables[1];
+	static struct mtk_raw_res_cache cache;
+	struct mtk_raw_res_in in;
+	struct mtk_raw_res_out out;
+	int i;
+
+	mtk_raw_res_cache_reset(&cache);
+	memset(&in, 0, sizeof(in));
+	in.in_w = 1920;
+	in.in_h = 1080;
+	in.hwn_limit_max = 2;
+	in.hwn_limit_min = 1;
+	in.clklv = tbl->clklv;
+	in.clklv_num = tbl->num;
+
+	for (i = 0; i <= MTK_RAW_RES_CACHE_NUM; i++) {
+		in.pixel_rate = 100000000LL + i;
+		mtk_raw_res_plan_cached(&cache, &in, &out);
+	}
+	UT_CHECK(cache.miss == MTK_RAW_RES_CACHE_NUM + 1, "miss %u",
+		 cache.miss);
+
+	/* the first entry was recycled by the last insert */
+	in.pixel_rate = 100000000LL;
+	mtk_raw_res_plan_cached(&cache, &in, &out);
+	UT_CHECK(cache.hit == 0, "stale entry hit");
+
+	in.pixel_rate = 100000000LL + MTK_RAW_RES_CACHE_NUM;
+	mtk_raw_res_plan_cached(&cache, &in, &out);
+	UT_CHECK(cache.hit == 1, "recent entry missed");
+}
+
+int main(void)
+{
+	unsigned int i, t;
+
+	for (t = 0; t < sizeof(ut_clk_tables) / sizeof(ut_clk_tables[0]); t++)
+		for (i = 0; i < sizeof(ut_res_sensor_modes) /
+		     sizeof(ut_res_sensor_modes[0]); i++)
+			ut_run_mode(&ut_res_sensor_modes[i], &ut_clk_tables[t]);
+
+	ut_check_defaults();
+	ut_check_eviction();
+
+	printf("plans with clock below the strategy step: %d\n", ut_lowered);
+	if (ut_fail) {
+		printf(RED "%d/%d checks failed\n" NONE, ut_fail, ut_cnt);
+		return EXIT_FAILURE;
+	}
+	printf(GREEN "all %d checks passed\n" NONE, ut_cnt);
+
+	return EXIT_SUCCESS;
+}
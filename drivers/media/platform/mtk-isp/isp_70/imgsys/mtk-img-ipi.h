@@ -328,6 +328,33 @@ struct img_ipi_param {
 #endif
 } __attribute__ ((__packed__));
 
+/*
+ * Several IMG_IPI_FRAME params in one HCP_IMGSYS_FRAME_BATCH_ID message,
+ * and the replies of several frames in one HCP_IMGSYS_FRAME_BATCH_DONE_ID.
+ * Only used once the daemon has set IMG_IPI_CAP_FRAME_BATCH in its
+ * HCP_IMGSYS_INIT_ID ack; older daemons keep the one-per-frame messages.
+ */
+#define IMG_IPI_FRAME_BATCH_MAX	8
+
+struct img_ipi_frame_batch {
+	u32	num;
+	struct img_ipi_param frames[IMG_IPI_FRAME_BATCH_MAX];
+} __attribute__ ((__packed__));
+
+struct img_sw_buffer_batch {
+	u32	num;
+	struct img_sw_buffer bufs[IMG_IPI_FRAME_BATCH_MAX];
+} __attribute__ ((__packed__));
+
+/* optional payload of the HCP_IMGSYS_INIT_ID ack */
+#define IMG_IPI_CAPS_MAGIC	0x53504143 /* "CAPS" */
+#define IMG_IPI_CAP_FRAME_BATCH	BIT(0)
+
+struct img_ipi_caps {
+	u32	magic;
+	u32	caps;
+} __attribute__ ((__packed__));
+
 #ifdef __KERNEL__
 struct img_frameparam {
 	struct list_head	list_entry;
@@ -6,7 +6,10 @@
  *
  */
 
+#include <linux/debugfs.h>
+#include <linux/log2.h>
 #include <linux/platform_device.h>
+#include <linux/seq_file.h>
 #include <linux/soc/mediatek/mtk-cmdq.h>
 #include <linux/pm_opp.h>
 #include <linux/pm_runtime.h>
@@ -47,12 +50,314 @@ module_param(imgsys_qos_blank_int, int, 0644);
 int imgsys_qos_factor;
 module_param(imgsys_qos_factor, int, 0644);
 
+/* share one high address load among writes to the same 64KB window */
+int imgsys_cmdq_wburst_en = 1;
+module_param(imgsys_cmdq_wburst_en, int, 0644);
+
+/* timestamp every gce task into prof_ring, see mtk_imgsys_gce_prof */
+int imgsys_cmdq_prof_en;
+module_param(imgsys_cmdq_prof_en, int, 0644);
+
 struct workqueue_struct *imgsys_cmdq_wq;
 static u32 is_stream_off;
 #if IMGSYS_SECURE_ENABLE
 static u32 is_sec_task_create;
 #endif
 static struct imgsys_event_history event_hist[IMGSYS_CMDQ_SYNC_POOL_NUM];
+/*
+ * Packets go back to the pool of their gce thread once their callback
+ * is done instead of being destroyed, so steady streaming allocates and
+ * maps no command buffer per frame. New packets are sized from the
+ * largest command stream the thread has produced.
+ */
+static struct imgsys_cmdq_pkt_pool pkt_pool[IMGSYS_ENG_MAX];
+/* [0] one write per command, [1] burst */
+static struct imgsys_cmdq_wr_stat wr_stat[2];
+
+/*
+ * Low cost gce profiling: two GCE timer writes per task into a ring
+ * allocated once per thread, folded into per hw_comb histograms by the
+ * callback work. No allocation or printing per frame. Without
+ * CMDQ_EXT_TS the flush to callback time is used instead.
+ */
+#ifdef CMDQ_EXT_TS
+static struct imgsys_cmdq_prof_ring prof_ring[IMGSYS_ENG_MAX];
+#endif
+static struct imgsys_cmdq_prof_hist prof_hist[IMGSYS_CMDQ_PROF_COMB_NUM];
+static DEFINE_SPINLOCK(prof_lock);
+static struct dentry *prof_debugfs;
+
+/* returns the start slot, or -1 if the task is not profiled */
+static s32 imgsys_cmdq_prof_begin(struct cmdq_pkt *pkt, u32 thd_idx)
+{
+#ifdef CMDQ_EXT_TS
+	struct imgsys_cmdq_prof_ring *ring = &prof_ring[thd_idx];
+	u32 slot;
+
+	if (!imgsys_cmdq_prof_en || !ring->va)
+		return -1;
+
+	slot = (atomic_add_return(2, &ring->head) - 2) %
+		IMGSYS_CMDQ_PROF_SLOT_NUM;
+	cmdq_pkt_write_indriect(pkt, NULL, ring->pa + 4 * slot,
+		CMDQ_TPR_ID, ~0);
+
+	return slot;
+#else
+	return imgsys_cmdq_prof_en ? 0 : -1;
+#endif
+}
+
+static void imgsys_cmdq_prof_end(struct cmdq_pkt *pkt, u32 thd_idx,
+				 s32 slot)
+{
+#ifdef CMDQ_EXT_TS
+	if (slot < 0)
+		return;
+
+	cmdq_pkt_write_indriect(pkt, NULL, prof_ring[thd_idx].pa + 4 * (slot + 1),
+		CMDQ_TPR_ID, ~0);
+#endif
+}
+
+static void imgsys_cmdq_prof_add(struct mtk_imgsys_cb_param *cb_param,
+				 u32 hw_comb)
+{
+	struct imgsys_cmdq_prof_hist *hist = NULL;
+#ifdef CMDQ_EXT_TS
+	u32 *ts = prof_ring[cb_param->thd_idx].va;
+#endif
+	u32 us, i;
+
+	/* failed or timed out packets would skew the latency */
+	if (cb_param->prof_slot < 0 || cb_param->err)
+		return;
+
+#ifdef CMDQ_EXT_TS
+	if (!ts)
+		return;
+	us = ts[cb_param->prof_slot + 1] - ts[cb_param->prof_slot];
+	CMDQ_TICK_TO_US(us);
+#else
+	us = cb_param->cmdqTs.tsCmdqCbStart - cb_param->cmdqTs.tsFlushStart;
+#endif
+
+	spin_lock(&prof_lock);
+	for (i = 0; i < IMGSYS_CMDQ_PROF_COMB_NUM; i++) {
+		if (prof_hist[i].hw_comb == hw_comb || !prof_hist[i].cnt) {
+			hist = &prof_hist[i];
+			break;
+		}
+	}
+	if (hist) {
+		hist->hw_comb = hw_comb;
+		hist->cnt++;
+		hist->total_us += us;
+		hist->max_us = max(hist->max_us, us);
+		hist->bucket[min_t(u32, fls(us),
+				   IMGSYS_CMDQ_PROF_BUCKET_NUM - 1)]++;
+	}
+	spin_unlock(&prof_lock);
+}
+
+static int imgsys_cmdq_prof_show(struct seq_file *s, void *unused)
+{
+	struct imgsys_cmdq_prof_hist hist;
+	u32 i, b;
+
+	seq_puts(s, "hw_comb    count    avg_us   max_us  buckets(<1,<2,<4..us)\n");
+	for (i = 0; i < IMGSYS_CMDQ_PROF_COMB_NUM; i++) {
+		spin_lock(&prof_lock);
+		hist = prof_hist[i];
+		spin_unlock(&prof_lock);
+		if (!hist.cnt)
+			break;
+		seq_printf(s, "0x%06x %8llu %8llu %8u ", hist.hw_comb, hist.cnt,
+			   div64_u64(hist.total_us, hist.cnt), hist.max_us);
+		for (b = 0; b < IMGSYS_CMDQ_PROF_BUCKET_NUM; b++)
+			seq_printf(s, " %llu", hist.bucket[b]);
+		seq_putc(s, '\n');
+	}
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(imgsys_cmdq_prof);
+
+static void imgsys_cmdq_prof_init(struct mtk_imgsys_dev *imgsys_dev)
+{
+#ifdef CMDQ_EXT_TS
+	u32 idx;
+
+	for (idx = 0; idx < IMGSYS_ENG_MAX; idx++) {
+		if (!imgsys_clt[idx])
+			continue;
+		prof_ring[idx].va = cmdq_mbox_buf_alloc(imgsys_clt[idx],
+							&prof_ring[idx].pa);
+		atomic_set(&prof_ring[idx].head, 0);
+	}
+#endif
+	prof_debugfs = debugfs_create_file("gce_prof", 0444,
+					   imgsys_dev->debugfs_root, NULL,
+					   &imgsys_cmdq_prof_fops);
+}
+
+static void imgsys_cmdq_prof_release(void)
+{
+#ifdef CMDQ_EXT_TS
+	u32 idx;
+#endif
+
+	debugfs_remove(prof_debugfs);
+	prof_debugfs = NULL;
+#ifdef CMDQ_EXT_TS
+	for (idx = 0; idx < IMGSYS_ENG_MAX; idx++) {
+		if (!prof_ring[idx].va)
+			continue;
+		cmdq_mbox_buf_free(imgsys_clt[idx], prof_ring[idx].va,
+				   prof_ring[idx].pa);
+		prof_ring[idx].va = NULL;
+	}
+#endif
+}
+
+static void imgsys_cmdq_wr_stat_reset(void)
+{
+	u32 i;
+
+	for (i = 0; i < ARRAY_SIZE(wr_stat); i++) {
+		atomic64_set(&wr_stat[i].writes, 0);
+		atomic64_set(&wr_stat[i].insts, 0);
+		atomic64_set(&wr_stat[i].tasks, 0);
+		atomic64_set(&wr_stat[i].exec_us, 0);
+	}
+}
+
+static void imgsys_cmdq_wr_stat_dump(struct mtk_imgsys_dev *imgsys_dev)
+{
+	static const char * const name[] = { "single", "burst" };
+	s64 writes, insts, tasks, exec_us;
+	u32 i;
+
+	for (i = 0; i < ARRAY_SIZE(wr_stat); i++) {
+		writes = atomic64_read(&wr_stat[i].writes);
+		tasks = atomic64_read(&wr_stat[i].tasks);
+		if (!writes || !tasks)
+			continue;
+		insts = atomic64_read(&wr_stat[i].insts);
+		exec_us = atomic64_read(&wr_stat[i].exec_us);
+		dev_info(imgsys_dev->dev,
+			"%s: %s write(%lld) inst(%lld, %lld.%02lld/write) task(%lld) exec(%lldus/task)\n",
+			__func__, name[i], writes, insts,
+			div64_s64(insts, writes),
+			div64_s64((insts % writes) * 100, writes),
+			tasks, div64_s64(exec_us, tasks));
+	}
+}
+
+static struct cmdq_pkt *imgsys_cmdq_pkt_get(u32 thd_idx,
+					    struct cmdq_client *clt)
+{
+	struct imgsys_cmdq_pkt_pool *pool = &pkt_pool[thd_idx];
+	struct cmdq_pkt *pkt = NULL;
+	size_t sz;
+
+	spin_lock(&pool->lock);
+	if (pool->num) {
+		pkt = pool->pkts[--pool->num];
+		pool->hit++;
+	} else {
+		pool->miss++;
+	}
+	sz = pool->pkt_sz;
+	spin_unlock(&pool->lock);
+
+	if (pkt) {
+		pkt->cmd_buf_size = 0;
+		return pkt;
+	}
+
+	pkt = cmdq_pkt_create(clt, sz);
+
+	return IS_ERR(pkt) ? NULL : pkt;
+}
+
+static void imgsys_cmdq_pkt_put(u32 thd_idx, struct cmdq_pkt *pkt)
+{
+	struct imgsys_cmdq_pkt_pool *pool = &pkt_pool[thd_idx];
+	size_t used = pkt->cmd_buf_size;
+	bool keep = false;
+
+	spin_lock(&pool->lock);
+	if (used > pool->peak) {
+		pool->peak = used;
+		/* a quarter of headroom over the largest stream so far */
+		pool->pkt_sz = clamp_t(size_t,
+				       roundup_pow_of_two(used + used / 4),
+				       IMGSYS_CMDQ_PKT_SZ_MIN,
+				       IMGSYS_CMDQ_PKT_SZ_MAX);
+	}
+	if (pkt->buf_size >= pool->pkt_sz &&
+	    pool->num < IMGSYS_CMDQ_PKT_POOL_NUM) {
+		pool->pkts[pool->num++] = pkt;
+		keep = true;
+	} else {
+		pool->drop++;
+	}
+	spin_unlock(&pool->lock);
+
+	if (!keep)
+		cmdq_pkt_destroy(pkt);
+}
+
+static void imgsys_cmdq_pkt_pool_fill(void)
+{
+	struct imgsys_cmdq_pkt_pool *pool;
+	struct cmdq_pkt *pkt;
+	u32 idx, i;
+
+	for (idx = 0; idx < IMGSYS_ENG_MAX; idx++) {
+		pool = &pkt_pool[idx];
+		pool->peak = 0;
+		pool->hit = 0;
+		pool->miss = 0;
+		pool->drop = 0;
+		if (!imgsys_clt[idx])
+			continue;
+		for (i = pool->num; i < IMGSYS_CMDQ_PKT_POOL_PREFILL; i++) {
+			pkt = cmdq_pkt_create(imgsys_clt[idx], pool->pkt_sz);
+			if (IS_ERR(pkt))
+				break;
+			spin_lock(&pool->lock);
+			pool->pkts[pool->num++] = pkt;
+			spin_unlock(&pool->lock);
+		}
+	}
+}
+
+static void imgsys_cmdq_pkt_pool_drain(struct mtk_imgsys_dev *imgsys_dev)
+{
+	struct imgsys_cmdq_pkt_pool *pool;
+	struct cmdq_pkt *pkts[IMGSYS_CMDQ_PKT_POOL_NUM];
+	u32 idx, i, num;
+
+	for (idx = 0; idx < IMGSYS_ENG_MAX; idx++) {
+		pool = &pkt_pool[idx];
+		spin_lock(&pool->lock);
+		num = pool->num;
+		memcpy(pkts, pool->pkts, num * sizeof(pkts[0]));
+		pool->num = 0;
+		spin_unlock(&pool->lock);
+
+		for (i = 0; i < num; i++)
+			cmdq_pkt_destroy(pkts[i]);
+
+		if (pool->hit || pool->miss)
+			dev_info(imgsys_dev->dev,
+				"%s: thd(%d) pkt hit(%llu) miss(%llu) drop(%llu) peak(0x%zx) sz(0x%zx)\n",
+				__func__, idx, pool->hit, pool->miss,
+				pool->drop, pool->peak, pool->pkt_sz);
+	}
+}
 
 void imgsys_cmdq_init(struct mtk_imgsys_dev *imgsys_dev, const int nr_imgsys_dev)
 {
@@ -78,6 +383,9 @@ void imgsys_cmdq_init(struct mtk_imgsys_dev *imgsys_dev, const int nr_imgsys_dev
 		for (idx = 0; idx < IMGSYS_ENG_MAX; idx++) {
 			imgsys_clt[idx] = cmdq_mbox_create(dev, idx);
 			pr_info("%s: cmdq_mbox_create(%d, %p)\n", __func__, idx, imgsys_clt[idx]);
+			spin_lock_init(&pkt_pool[idx].lock);
+			pkt_pool[idx].num = 0;
+			pkt_pool[idx].pkt_sz = IMGSYS_CMDQ_PKT_SZ_MIN;
 		}
 		#if IMGSYS_SECURE_ENABLE
 		/* request for imgsys secure gce thread */
@@ -88,6 +396,7 @@ void imgsys_cmdq_init(struct mtk_imgsys_dev *imgsys_dev, const int nr_imgsys_dev
 				__func__, idx, imgsys_sec_clt[idx-IMGSYS_ENG_MAX]);
 		}
 		#endif
+		imgsys_cmdq_prof_init(imgsys_dev);
 		/* parse hardware event */
 		for (idx = 0; idx < IMGSYS_CMDQ_EVENT_MAX; idx++) {
 			of_property_read_u16(dev->of_node,
@@ -112,6 +421,11 @@ void imgsys_cmdq_release(struct mtk_imgsys_dev *imgsys_dev)
 	u32 idx = 0;
 	pr_info("%s: +\n", __func__);
 
+	/* packets that completed after stream off */
+	flush_workqueue(imgsys_cmdq_wq);
+	imgsys_cmdq_pkt_pool_drain(imgsys_dev);
+	imgsys_cmdq_prof_release();
+
 	/* Destroy cmdq client */
 	for (idx = 0; idx < IMGSYS_ENG_MAX; idx++) {
 		cmdq_mbox_destroy(imgsys_clt[idx]);
@@ -149,6 +463,8 @@ void imgsys_cmdq_streamon(struct mtk_imgsys_dev *imgsys_dev)
 
 	memset((void *)event_hist, 0x0,
 		sizeof(struct imgsys_event_history)*IMGSYS_CMDQ_SYNC_POOL_NUM);
+	imgsys_cmdq_pkt_pool_fill();
+	imgsys_cmdq_wr_stat_reset();
 #if DVFS_QOS_READY
 	mtk_imgsys_mmqos_reset(imgsys_dev);
 #endif
@@ -183,6 +499,9 @@ void imgsys_cmdq_streamoff(struct mtk_imgsys_dev *imgsys_dev)
 	cmdq_mbox_disable(imgsys_clt[0]->chan);
 #endif
 
+	imgsys_cmdq_pkt_pool_drain(imgsys_dev);
+	imgsys_cmdq_wr_stat_dump(imgsys_dev);
+
 	#if DVFS_QOS_READY
 	mtk_imgsys_mmqos_reset(imgsys_dev);
 	#endif
@@ -289,6 +608,10 @@ static void imgsys_cmdq_cb_work(struct work_struct *work)
 	cb_param->cmdqTs.tsCmdqCbWorkStart = ktime_get_boottime_ns()/1000;
 	imgsys_dev = cb_param->imgsys_dev;
 
+	atomic64_inc(&wr_stat[cb_param->wburst].tasks);
+	atomic64_add(cb_param->cmdqTs.tsCmdqCbStart - cb_param->cmdqTs.tsFlushStart,
+		     &wr_stat[cb_param->wburst].exec_us);
+
 	dev_dbg(imgsys_dev->dev,
 		"%s: cb(%p) gid(%d) in block(%d/%d) for frm(%d/%d) lst(%d/%d/%d) task(%d/%d/%d) ofst(%lx/%lx/%lx/%lx/%lx)\n",
 		__func__, cb_param, cb_param->group_id,
@@ -379,6 +702,7 @@ static void imgsys_cmdq_cb_work(struct work_struct *work)
 		cb_param->frm_idx, cb_param->frm_num);
 
 	hw_comb = cb_param->frm_info->user_info[cb_param->frm_idx].hw_comb;
+	imgsys_cmdq_prof_add(cb_param, hw_comb);
 	req_fd = cb_param->frm_info->request_fd;
 	req_no = cb_param->frm_info->request_no;
 	frm_no = cb_param->frm_info->frame_no;
@@ -503,7 +827,7 @@ static void imgsys_cmdq_cb_work(struct work_struct *work)
 #if CMDQ_EXT
 	cmdq_pkt_wait_complete(cb_param->pkt);
 #endif
-	cmdq_pkt_destroy(cb_param->pkt);
+	imgsys_cmdq_pkt_put(cb_param->thd_idx, cb_param->pkt);
 	cb_param->cmdqTs.tsReqEnd = ktime_get_boottime_ns()/1000;
 	IMGSYS_SYSTRACE_END();
 
@@ -706,6 +1030,8 @@ int imgsys_cmdq_sendtask(struct mtk_imgsys_dev *imgsys_dev,
 	u32 task_num = 0;
 	u32 task_cnt = 0;
 	size_t pkt_ofst[MAX_FRAME_IN_TASK] = {0};
+	bool wburst = !!imgsys_cmdq_wburst_en;
+	s32 prof_slot = -1;
 
 	/* PMQOS API */
 	tsDvfsQosStart = ktime_get_boottime_ns()/1000;
@@ -850,8 +1176,8 @@ int imgsys_cmdq_sendtask(struct mtk_imgsys_dev *imgsys_dev,
 		for (blk_idx = 0; blk_idx < cmd_buf->frame_block; blk_idx++) {
 			tsReqStart = ktime_get_boottime_ns()/1000;
 			if (isPack == 0) {
-				/* create pkt and hook clt as pkt's private data */
-				pkt = cmdq_pkt_create(clt, 0x00004000);
+				/* pooled pkt, or a new one with clt as private data */
+				pkt = imgsys_cmdq_pkt_get(thd_idx, clt);
 				if (pkt == NULL) {
 					pr_info(
 						"%s: [ERROR] cmdq_pkt_create fail in block(%d)!\n",
@@ -863,6 +1189,7 @@ int imgsys_cmdq_sendtask(struct mtk_imgsys_dev *imgsys_dev,
 					__func__, pkt, blk_idx, frm_idx, frm_num);
 				/* Reset pkt timestamp num */
 				pkt_ts_num = 0;
+				prof_slot = imgsys_cmdq_prof_begin(pkt, thd_idx);
 #if CMDQ_EXT
 				/* Assign task priority according to is_time_shared */
 				if (frm_info->user_info[frm_idx].is_time_shared)
@@ -885,13 +1212,14 @@ int imgsys_cmdq_sendtask(struct mtk_imgsys_dev *imgsys_dev,
 			#endif
 
 			ret = imgsys_cmdq_parser(frm_info, pkt, &cmd[cmd_idx], hw_comb, cmd_num,
-				(pkt_ts_pa + 4 * pkt_ts_ofst), &pkt_ts_num, thd_idx);
+				(pkt_ts_pa + 4 * pkt_ts_ofst), &pkt_ts_num, thd_idx,
+				wburst);
 			if (ret < 0) {
 				pr_info(
 					"%s: [ERROR] parsing idx(%d) with cmd(%d) in block(%d) for frm(%d/%d) fail\n",
 					__func__, cmd_idx, cmd[cmd_idx].opcode,
 					blk_idx, frm_idx, frm_num);
-				cmdq_pkt_destroy(pkt);
+				imgsys_cmdq_pkt_put(thd_idx, pkt);
 				goto sendtask_done;
 			}
 			cmd_idx += ret;
@@ -918,7 +1246,7 @@ int imgsys_cmdq_sendtask(struct mtk_imgsys_dev *imgsys_dev,
 				cb_param =
 					vzalloc(sizeof(struct mtk_imgsys_cb_param));
 				if (cb_param == NULL) {
-					cmdq_pkt_destroy(pkt);
+					imgsys_cmdq_pkt_put(thd_idx, pkt);
 					return -1;
 				}
 				dev_dbg(imgsys_dev->dev,
@@ -950,6 +1278,8 @@ int imgsys_cmdq_sendtask(struct mtk_imgsys_dev *imgsys_dev,
 				cb_param->imgsys_dev = imgsys_dev;
 				cb_param->thd_idx = thd_idx;
 				cb_param->clt = clt;
+				cb_param->wburst = wburst;
+				cb_param->prof_slot = prof_slot;
 				cb_param->task_cnt = task_cnt;
 				for (task_idx = 0; task_idx < task_cnt; task_idx++)
 					cb_param->pkt_ofst[task_idx] = pkt_ofst[task_idx];
@@ -998,6 +1328,7 @@ int imgsys_cmdq_sendtask(struct mtk_imgsys_dev *imgsys_dev,
 					frm_info->frm_owner, cb_param, frm_idx, frm_num,
 					blk_idx, cmd_buf->frame_block);
 
+				imgsys_cmdq_prof_end(pkt, thd_idx, prof_slot);
 				cmdq_pkt_finalize(pkt);
 				ret_flush = cmdq_pkt_flush_async(pkt, imgsys_cmdq_task_cb,
 								(void *)cb_param);
@@ -1023,12 +1354,17 @@ sendtask_done:
 
 int imgsys_cmdq_parser(struct swfrm_info_t *frm_info, struct cmdq_pkt *pkt,
 						struct Command *cmd, u32 hw_comb, u32 cmd_num,
-						dma_addr_t dma_pa, uint32_t *num, u32 thd_idx)
+						dma_addr_t dma_pa, uint32_t *num, u32 thd_idx,
+						bool wburst)
 {
 	bool stop = 0;
 	int count = 0;
 	int req_fd = 0, req_no = 0, frm_no = 0;
 	u32 event = 0;
+	/* high address held in CMDQ_SPR_FOR_TEMP, valid while writes run */
+	bool spr_valid = false;
+	u32 spr_high = 0, high;
+	size_t inst_ofst;
 
 	req_fd = frm_info->request_fd;
 	req_no = frm_info->request_no;
@@ -1037,6 +1373,10 @@ int imgsys_cmdq_parser(struct swfrm_info_t *frm_info, struct cmdq_pkt *pkt,
 	pr_debug("%s: +, cmd(%d)\n", __func__, cmd->opcode);
 
 	do {
+		/* anything but a write may use the temp SPR */
+		if (cmd->opcode != IMGSYS_CMD_WRITE)
+			spr_valid = false;
+
 		switch (cmd->opcode) {
 		case IMGSYS_CMD_READ:
 			if ((cmd->u.address < IMGSYS_REG_START) ||
@@ -1069,8 +1409,30 @@ int imgsys_cmdq_parser(struct swfrm_info_t *frm_info, struct cmdq_pkt *pkt,
 			pr_debug(
 				"%s: WRITE with addr(0x%08llx) value(0x%08x) mask(0x%08x)\n",
 				__func__, cmd->u.address, cmd->u.value, cmd->u.mask);
-			cmdq_pkt_write_value_addr(pkt, (dma_addr_t)cmd->u.address,
+			inst_ofst = pkt->cmd_buf_size;
+			if (wburst) {
+				/*
+				 * Same sequence cmdq_pkt_write_value_addr()
+				 * emits, minus the high address load when
+				 * the previous write already did it.
+				 */
+				high = CMDQ_GET_ADDR_HIGH((dma_addr_t)cmd->u.address);
+				if (!spr_valid || high != spr_high) {
+					cmdq_pkt_assign_command(pkt,
+						CMDQ_SPR_FOR_TEMP, high);
+					spr_high = high;
+					spr_valid = true;
+				}
+				cmdq_pkt_store_value(pkt, CMDQ_SPR_FOR_TEMP,
+					CMDQ_GET_ADDR_LOW((dma_addr_t)cmd->u.address),
 					cmd->u.value, cmd->u.mask);
+			} else {
+				cmdq_pkt_write_value_addr(pkt, (dma_addr_t)cmd->u.address,
+						cmd->u.value, cmd->u.mask);
+			}
+			atomic64_inc(&wr_stat[wburst].writes);
+			atomic64_add((pkt->cmd_buf_size - inst_ofst) / CMDQ_INST_SIZE,
+				     &wr_stat[wburst].insts);
 			break;
 		case IMGSYS_CMD_POLL:
 			if ((cmd->u.address < IMGSYS_REG_START) ||
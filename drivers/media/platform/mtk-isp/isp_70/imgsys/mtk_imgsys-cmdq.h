@@ -21,6 +21,18 @@
 
 #define MAX_FRAME_IN_TASK		64
 
+/* finished packets kept per gce thread, and their size bounds */
+#define IMGSYS_CMDQ_PKT_POOL_NUM	8
+#define IMGSYS_CMDQ_PKT_POOL_PREFILL	2
+#define IMGSYS_CMDQ_PKT_SZ_MIN		0x4000
+#define IMGSYS_CMDQ_PKT_SZ_MAX		0x40000
+
+/* gce timestamp ring per thread, a start and an end slot per task */
+#define IMGSYS_CMDQ_PROF_SLOT_NUM	(PAGE_SIZE / sizeof(u32))
+/* execution time histogram, bucket n counts [2^(n-1), 2^n) us */
+#define IMGSYS_CMDQ_PROF_BUCKET_NUM	16
+#define IMGSYS_CMDQ_PROF_COMB_NUM	32
+
 struct task_timestamp {
 	dma_addr_t dma_pa;
 	uint32_t *dma_va;
@@ -66,6 +78,42 @@ struct mtk_imgsys_cb_param {
 	bool isBlkLast;
 	bool isFrmLast;
 	bool isTaskLast;
+	bool wburst;
+	s32 prof_slot;	/* start slot in prof_ring, -1 if not profiled */
+};
+
+struct imgsys_cmdq_prof_ring {
+	u32 *va;
+	dma_addr_t pa;
+	atomic_t head;
+};
+
+/* gce execution time of the tasks of one engine combination */
+struct imgsys_cmdq_prof_hist {
+	u32 hw_comb;
+	u32 max_us;
+	u64 cnt;
+	u64 total_us;
+	u64 bucket[IMGSYS_CMDQ_PROF_BUCKET_NUM];
+};
+
+/* IMGSYS_CMD_WRITE cost, per write mode */
+struct imgsys_cmdq_wr_stat {
+	atomic64_t writes;	/* IMGSYS_CMD_WRITE parsed */
+	atomic64_t insts;	/* gce instructions they became */
+	atomic64_t tasks;
+	atomic64_t exec_us;	/* flush to callback */
+};
+
+struct imgsys_cmdq_pkt_pool {
+	spinlock_t lock;
+	struct cmdq_pkt *pkts[IMGSYS_CMDQ_PKT_POOL_NUM];
+	u32 num;
+	size_t pkt_sz;	/* size new packets are created with */
+	size_t peak;	/* largest command stream seen this stream */
+	u64 hit;
+	u64 miss;
+	u64 drop;	/* returned too small or to a full pool */
 };
 
 enum mtk_imgsys_cmd {
@@ -152,7 +200,8 @@ int imgsys_cmdq_sendtask(struct mtk_imgsys_dev *imgsys_dev,
 					uint32_t fail_uinfo_idx, bool isHWhang));
 int imgsys_cmdq_parser(struct swfrm_info_t *frm_info, struct cmdq_pkt *pkt,
 				struct Command *cmd, u32 hw_comb, u32 cmd_num,
-				dma_addr_t dma_pa, uint32_t *num, u32 thd_idx);
+				dma_addr_t dma_pa, uint32_t *num, u32 thd_idx,
+				bool wburst);
 int imgsys_cmdq_sec_sendtask(struct mtk_imgsys_dev *imgsys_dev);
 void imgsys_cmdq_sec_cmd(struct cmdq_pkt *pkt);
 void imgsys_cmdq_clearevent(int event_id);
@@ -0,0 +1,268 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright (c) 2021 MediaTek Inc.
+ *
+ */
+
+#include <linux/anon_inodes.h>
+#include <linux/file.h>
+#include <linux/fs.h>
+#include <linux/mm.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+
+#include "mtk_imgsys-cmpl.h"
+#include "mtk_imgsys-dev.h"
+
+static void cmpl_ring_release(struct kref *kref)
+{
+	struct mtk_imgsys_cmpl_ring *cr =
+		container_of(kref, struct mtk_imgsys_cmpl_ring, kref);
+
+	if (cr->evfd)
+		eventfd_ctx_put(cr->evfd);
+	vfree(cr->ring);
+	kfree(cr);
+}
+
+static int cmpl_ring_fop_mmap(struct file *filp, struct vm_area_struct *vma)
+{
+	struct mtk_imgsys_cmpl_ring *cr = filp->private_data;
+
+	if (vma->vm_end - vma->vm_start > cr->size)
+		return -EINVAL;
+
+	return remap_vmalloc_range(vma, cr->ring, vma->vm_pgoff);
+}
+
+static int cmpl_ring_fop_release(struct inode *inode, struct file *filp)
+{
+	struct mtk_imgsys_cmpl_ring *cr = filp->private_data;
+
+	kref_put(&cr->kref, cmpl_ring_release);
+
+	return 0;
+}
+
+static const struct file_operations cmpl_ring_fops = {
+	.owner = THIS_MODULE,
+	.mmap = cmpl_ring_fop_mmap,
+	.release = cmpl_ring_fop_release,
+};
+
+static struct mtk_imgsys_cmpl_ring *
+cmpl_ring_swap(struct mtk_imgsys_pipe *pipe, struct mtk_imgsys_cmpl_ring *cr)
+{
+	struct mtk_imgsys_cmpl_ring *old;
+	unsigned long flags;
+
+	spin_lock_irqsave(&pipe->cmpl_lock, flags);
+	old = pipe->cmpl_ring;
+	pipe->cmpl_ring = cr;
+	spin_unlock_irqrestore(&pipe->cmpl_lock, flags);
+
+	return old;
+}
+
+void mtk_imgsys_cmpl_ring_detach(struct mtk_imgsys_pipe *pipe)
+{
+	struct mtk_imgsys_cmpl_ring *old = cmpl_ring_swap(pipe, NULL);
+
+	if (old)
+		kref_put(&old->kref, cmpl_ring_release);
+}
+
+/* the user armed the ring and goes away */
+void mtk_imgsys_cmpl_ring_detach_user(struct mtk_imgsys_pipe *pipe, u16 owner)
+{
+	struct mtk_imgsys_cmpl_ring *old = NULL;
+	unsigned long flags;
+
+	spin_lock_irqsave(&pipe->cmpl_lock, flags);
+	if (pipe->cmpl_ring && pipe->cmpl_ring->owner == owner) {
+		old = pipe->cmpl_ring;
+		pipe->cmpl_ring = NULL;
+	}
+	spin_unlock_irqrestore(&pipe->cmpl_lock, flags);
+
+	if (old)
+		kref_put(&old->kref, cmpl_ring_release);
+}
+
+int mtk_imgsys_cmpl_ring_setup(struct mtk_imgsys_pipe *pipe,
+			       struct cmpl_ring_info *info, u16 owner)
+{
+	struct mtk_imgsys_cmpl_ring *cr, *old;
+	struct file *filp;
+	int fd, ret;
+
+	if (!info->num_entries) {
+		if (owner)
+			mtk_imgsys_cmpl_ring_detach_user(pipe, owner);
+		else
+			mtk_imgsys_cmpl_ring_detach(pipe);
+		info->ring_fd = -1;
+		info->ring_size = 0;
+		return 0;
+	}
+
+	if (!is_power_of_2(info->num_entries) ||
+	    info->num_entries > MTKDIP_CMPL_RING_MAX_ENTRIES)
+		return -EINVAL;
+
+	cr = kzalloc(sizeof(*cr), GFP_KERNEL);
+	if (!cr)
+		return -ENOMEM;
+
+	kref_init(&cr->kref);
+	cr->owner = owner;
+	cr->mask = info->num_entries - 1;
+	cr->size = PAGE_ALIGN(struct_size(cr->ring, entries, info->num_entries));
+	cr->ring = vmalloc_user(cr->size);
+	if (!cr->ring) {
+		ret = -ENOMEM;
+		goto err_free;
+	}
+	cr->ring->num_entries = info->num_entries;
+	cr->ring->entry_size = sizeof(struct mtkdip_cmpl_entry);
+
+	if (info->event_fd >= 0) {
+		cr->evfd = eventfd_ctx_fdget(info->event_fd);
+		if (IS_ERR(cr->evfd)) {
+			ret = PTR_ERR(cr->evfd);
+			cr->evfd = NULL;
+			goto err_free;
+		}
+	}
+
+	fd = get_unused_fd_flags(O_RDWR | O_CLOEXEC);
+	if (fd < 0) {
+		ret = fd;
+		goto err_free;
+	}
+
+	filp = anon_inode_getfile("mtkdip-cmpl", &cmpl_ring_fops, cr, O_RDWR);
+	if (IS_ERR(filp)) {
+		put_unused_fd(fd);
+		ret = PTR_ERR(filp);
+		goto err_free;
+	}
+
+	/* one reference for the file, one for the pipe */
+	kref_get(&cr->kref);
+	old = cmpl_ring_swap(pipe, cr);
+	if (old)
+		kref_put(&old->kref, cmpl_ring_release);
+
+	fd_install(fd, filp);
+	info->ring_fd = fd;
+	info->ring_size = cr->size;
+
+	dev_info(pipe->imgsys_dev->dev,
+		"%s: entries(%d) size(%zu) evfd(%d) owner(%d)\n",
+		__func__, info->num_entries, cr->size, info->event_fd, owner);
+
+	return 0;
+
+err_free:
+	kref_put(&cr->kref, cmpl_ring_release);
+	return ret;
+}
+
+static void cmpl_ring_fill(struct mtkdip_cmpl_entry *e,
+			   struct mtk_imgsys_pipe *pipe,
+			   struct mtk_imgsys_request *req, u32 status)
+{
+	struct mtk_imgsys_time_state *ts = &req->tstate;
+	u32 i;
+
+	e->req_fd = ts->req_fd;
+	e->status = status;
+	e->job_id = req->id;
+	e->num_bufs = 0;
+	e->user_seq_num = 0;
+	e->cookie = 0;
+	memset(e->buf_idx, MTKDIP_CMPL_BUF_UNUSED, sizeof(e->buf_idx));
+
+#ifdef BATCH_MODE_V3
+	if (is_batch_mode(req) && req->done_pack) {
+		e->user_seq_num = req->done_pack->pack.seq_num;
+		e->cookie = (u64)(uintptr_t)req->done_pack->pack.cookie;
+	}
+#endif
+	if (req->buf_map) {
+		for (i = 0; i < pipe->desc->total_queues &&
+		     i < MTKDIP_CMPL_MAX_BUFS; i++) {
+			if (!req->buf_map[i])
+				continue;
+			e->buf_idx[i] = req->buf_map[i]->vbb.vb2_buf.index;
+			e->num_bufs++;
+		}
+	}
+
+	e->time_qbuf = ts->time_qbuf;
+	e->time_composing_start = ts->time_composingStart;
+	e->time_ipisend_start = ts->time_ipisendStart;
+	e->time_send2cmq = ts->time_send2cmq;
+	e->time_mdpcb_start = ts->time_mdpcbStart;
+	e->time_notify_start = ts->time_notifyStart;
+}
+
+/*
+ * Called from the notify paths before the vb2 buffers are returned, so
+ * buf_map is still valid. Returns false if no ring is armed on the pipe,
+ * if the request is a batch pack of another user than the ring owner, or
+ * if the ring is full: a batch pack then goes to its done_list instead.
+ */
+bool mtk_imgsys_cmpl_ring_post(struct mtk_imgsys_pipe *pipe,
+			       struct mtk_imgsys_request *req,
+			       u32 status)
+{
+	struct mtk_imgsys_cmpl_ring *cr;
+	struct mtkdip_cmpl_entry *e;
+	struct eventfd_ctx *evfd = NULL;
+	unsigned long flags;
+	u32 tail;
+
+	spin_lock_irqsave(&pipe->cmpl_lock, flags);
+	cr = pipe->cmpl_ring;
+	if (!cr) {
+		spin_unlock_irqrestore(&pipe->cmpl_lock, flags);
+		return false;
+	}
+#ifdef BATCH_MODE_V3
+	/* the pack goes to the done_list of its user */
+	if (is_batch_mode(req) &&
+	    cr->owner != mtk_imgsys_pipe_get_pipe_from_job_id(req->id)) {
+		spin_unlock_irqrestore(&pipe->cmpl_lock, flags);
+		return false;
+	}
+#endif
+
+	tail = smp_load_acquire(&cr->ring->tail);
+	if (cr->head - tail > cr->mask) {
+		cr->ring->dropped++;
+		spin_unlock_irqrestore(&pipe->cmpl_lock, flags);
+		return false;
+	}
+
+	e = &cr->ring->entries[cr->head & cr->mask];
+	cmpl_ring_fill(e, pipe, req, status);
+	e->seq = cr->seq++;
+	cr->head++;
+	/* entry must be visible before head moves */
+	smp_store_release(&cr->ring->head, cr->head);
+
+	if (cr->evfd) {
+		evfd = cr->evfd;
+		kref_get(&cr->kref);
+	}
+	spin_unlock_irqrestore(&pipe->cmpl_lock, flags);
+
+	if (evfd) {
+		eventfd_signal(evfd, 1);
+		kref_put(&cr->kref, cmpl_ring_release);
+	}
+
+	return true;
+}
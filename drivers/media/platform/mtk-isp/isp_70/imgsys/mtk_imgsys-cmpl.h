@@ -0,0 +1,40 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Copyright (c) 2021 MediaTek Inc.
+ *
+ */
+
+#ifndef _MTK_IMGSYS_CMPL_H_
+#define _MTK_IMGSYS_CMPL_H_
+
+#include <linux/eventfd.h>
+#include <linux/kref.h>
+#include <linux/spinlock.h>
+#include "mtkdip.h"
+
+struct mtk_imgsys_pipe;
+struct mtk_imgsys_request;
+
+/* mmap'd completion ring, shared with userspace through an anon fd */
+struct mtk_imgsys_cmpl_ring {
+	struct mtkdip_cmpl_ring *ring;	/* vmalloc_user, mmap'd */
+	/* user id whose batch packs are posted, 0 when armed on the subdev */
+	u16 owner;
+	size_t size;
+	u32 mask;
+	/* private copy, the shared head is never read back */
+	u32 head;
+	u64 seq;
+	struct eventfd_ctx *evfd;
+	struct kref kref;
+};
+
+int mtk_imgsys_cmpl_ring_setup(struct mtk_imgsys_pipe *pipe,
+			       struct cmpl_ring_info *info, u16 owner);
+void mtk_imgsys_cmpl_ring_detach(struct mtk_imgsys_pipe *pipe);
+void mtk_imgsys_cmpl_ring_detach_user(struct mtk_imgsys_pipe *pipe, u16 owner);
+bool mtk_imgsys_cmpl_ring_post(struct mtk_imgsys_pipe *pipe,
+			       struct mtk_imgsys_request *req,
+			       u32 status);
+
+#endif
@@ -9,7 +9,10 @@
 #include <linux/dma-buf.h>
 #include <linux/dma-direction.h>
 #include <linux/dma-mapping.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
 #include <linux/platform_device.h>
+#include <linux/slab.h>
 #include <media/videobuf2-dma-contig.h>
 #include <media/v4l2-event.h>
 #include "mtk_imgsys-dev.h"
@@ -47,6 +50,8 @@ int mtk_imgsys_pipe_init(struct mtk_imgsys_dev *imgsys_dev,
 	//mutex_init(&pipe->job_lock);
 	spin_lock_init(&pipe->pending_job_lock);
 	spin_lock_init(&pipe->running_job_lock);
+	spin_lock_init(&pipe->cmpl_lock);
+	pipe->cmpl_ring = NULL;
 	mutex_init(&pipe->lock);
 
 	nodes_num = pipe->desc->total_queues;
@@ -96,6 +101,7 @@ err_destroy_pipe_lock:
 int mtk_imgsys_pipe_release(struct mtk_imgsys_pipe *pipe)
 {
 	mtk_imgsys_pipe_v4l2_unregister(pipe);
+	mtk_imgsys_cmpl_ring_detach(pipe);
 	mutex_destroy(&pipe->lock);
 
 	return 0;
@@ -202,7 +208,132 @@ bool is_batch_mode(struct mtk_imgsys_request *req)
 	return req->is_batch_mode;
 }
 
-void mtk_imgsys_frame_done(struct mtk_imgsys_request *req)
+static void mtk_imgsys_alloc_stat_add(struct mtk_imgsys_alloc_stat *st,
+				      u64 start, bool ok)
+{
+	s64 ns = ktime_get_ns() - start;
+	s64 max = atomic64_read(&st->max_ns);
+	s64 old;
+
+	atomic64_inc(&st->cnt);
+	if (!ok)
+		atomic64_inc(&st->fail);
+	atomic64_add(ns, &st->total_ns);
+	while (ns > max) {
+		old = atomic64_cmpxchg(&st->max_ns, max, ns);
+		if (old == max)
+			break;
+		max = old;
+	}
+}
+
+int mtk_imgsys_batch_cache_init(struct mtk_imgsys_dev *imgsys_dev)
+{
+	imgsys_dev->req_cache = KMEM_CACHE(mtk_imgsys_request,
+					   SLAB_HWCACHE_ALIGN);
+	if (!imgsys_dev->req_cache)
+		return -ENOMEM;
+
+	imgsys_dev->done_pack_cache = KMEM_CACHE(done_frame_pack, 0);
+	if (!imgsys_dev->done_pack_cache) {
+		kmem_cache_destroy(imgsys_dev->req_cache);
+		imgsys_dev->req_cache = NULL;
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+void mtk_imgsys_batch_cache_release(struct mtk_imgsys_dev *imgsys_dev)
+{
+	mtk_imgsys_batch_alloc_stat_dump(imgsys_dev);
+	kmem_cache_destroy(imgsys_dev->done_pack_cache);
+	kmem_cache_destroy(imgsys_dev->req_cache);
+	imgsys_dev->done_pack_cache = NULL;
+	imgsys_dev->req_cache = NULL;
+}
+
+struct mtk_imgsys_request *
+mtk_imgsys_batch_req_alloc(struct mtk_imgsys_dev *imgsys_dev)
+{
+	struct mtk_imgsys_request *req;
+	u64 start = ktime_get_ns();
+
+	req = kmem_cache_zalloc(imgsys_dev->req_cache, GFP_KERNEL);
+	mtk_imgsys_alloc_stat_add(&imgsys_dev->req_alloc_stat, start, !!req);
+
+	return req;
+}
+
+void mtk_imgsys_batch_req_free(struct mtk_imgsys_dev *imgsys_dev,
+			       struct mtk_imgsys_request *req)
+{
+	kmem_cache_free(imgsys_dev->req_cache, req);
+}
+
+struct done_frame_pack *
+mtk_imgsys_done_pack_alloc(struct mtk_imgsys_dev *imgsys_dev)
+{
+	struct done_frame_pack *dp;
+	u64 start = ktime_get_ns();
+
+	dp = kmem_cache_zalloc(imgsys_dev->done_pack_cache, GFP_KERNEL);
+	mtk_imgsys_alloc_stat_add(&imgsys_dev->pack_alloc_stat, start, !!dp);
+
+	return dp;
+}
+
+void mtk_imgsys_done_pack_free(struct mtk_imgsys_dev *imgsys_dev,
+			       struct done_frame_pack *dp)
+{
+	kmem_cache_free(imgsys_dev->done_pack_cache, dp);
+}
+
+void mtk_imgsys_batch_alloc_stat_dump(struct mtk_imgsys_dev *imgsys_dev)
+{
+	struct mtk_imgsys_alloc_stat *st[] = {
+		&imgsys_dev->req_alloc_stat,
+		&imgsys_dev->pack_alloc_stat,
+	};
+	static const char * const name[] = { "req", "done_pack" };
+	unsigned int i;
+	s64 cnt;
+
+	for (i = 0; i < ARRAY_SIZE(st); i++) {
+		cnt = atomic64_read(&st[i]->cnt);
+		if (!cnt)
+			continue;
+		dev_info(imgsys_dev->dev,
+			"%s: %s alloc cnt(%lld) fail(%lld) avg(%lldns) max(%lldns)\n",
+			__func__, name[i], cnt, atomic64_read(&st[i]->fail),
+			div64_s64(atomic64_read(&st[i]->total_ns), cnt),
+			atomic64_read(&st[i]->max_ns));
+	}
+}
+
+/*
+ * Drop the quota of a pack that ends without mtk_imgsys_frame_done(),
+ * e.g. one left in flight by an aborted flush.
+ */
+void mtk_imgsys_batch_req_release_quota(struct mtk_imgsys_request *req)
+{
+	const int user_id = mtk_imgsys_pipe_get_pipe_from_job_id(req->id);
+	struct mtk_imgsys_dev *imgsys_dev = req->imgsys_pipe->imgsys_dev;
+	struct mtk_imgsys_user *user, *owner = NULL;
+
+	mutex_lock(&imgsys_dev->imgsys_users.user_lock);
+	list_for_each_entry(user, &imgsys_dev->imgsys_users.list, entry) {
+		if (user->id == user_id) {
+			owner = user;
+			break;
+		}
+	}
+	mtk_imgsys_hw_working_buf_release_quota(imgsys_dev, owner, req);
+	mutex_unlock(&imgsys_dev->imgsys_users.user_lock);
+}
+
+void mtk_imgsys_frame_done(struct mtk_imgsys_request *req,
+			   enum vb2_buffer_state vbf_state)
 {
 	bool found = false;
 	const int user_id = mtk_imgsys_pipe_get_pipe_from_job_id(req->id);
@@ -220,8 +351,20 @@ void mtk_imgsys_frame_done(struct mtk_imgsys_request *req)
 			break;
 		}
 	}
+	/* under user_lock so the user's quota can't go away meanwhile */
+	mtk_imgsys_hw_working_buf_release_quota(imgsys_dev,
+						found ? user : NULL, req);
 	mutex_unlock(&imgsys_dev->imgsys_users.user_lock);
 
+	/* completion ring armed by the user: no DQBUF will come for this pack */
+	if (!found || mtk_imgsys_cmpl_ring_post(req->imgsys_pipe, req,
+			(vbf_state == VB2_BUF_STATE_DONE) ?
+			MTKDIP_CMPL_DONE : MTKDIP_CMPL_ERROR)) {
+		mtk_imgsys_done_pack_free(imgsys_dev, req->done_pack);
+		mtk_imgsys_batch_req_free(imgsys_dev, req);
+		return;
+	}
+
 	// add into user's done_list and wake it up
 	if (found) {
 		spin_lock_irqsave(&user->lock, flags);
@@ -231,16 +374,15 @@ void mtk_imgsys_frame_done(struct mtk_imgsys_request *req)
 		user->dqdonestate = true;
 
 
-		pr_info("%s: user id(%x) req(%p) add done_pack\n", __func__,
+		pr_debug("%s: user id(%x) req(%p) add done_pack\n", __func__,
 			user->id, req);
 
 		wake_up(&user->done_wq);
-		wake_up(&user->enque_wq);
 		spin_unlock_irqrestore(&user->lock, flags);
 
 		if (!IS_ERR(req)) {
-			pr_info("%s free req(%p)\n", __func__, req);
-			vfree(req);
+			pr_debug("%s free req(%p)\n", __func__, req);
+			mtk_imgsys_batch_req_free(imgsys_dev, req);
 		}
 	}
 }
@@ -258,10 +400,14 @@ void mtk_imgsys_pipe_job_finish(struct mtk_imgsys_request *req,
 #ifdef BATCH_MODE_V3
 	// batch mode
 	if (is_batch_mode(req)) {
-		mtk_imgsys_frame_done(req);
+		mtk_imgsys_frame_done(req, vbf_state);
 		return;
 	}
 #endif
+	/* flushed jobs, mtk_imgsys_notify() posts the others */
+	if (vbf_state != VB2_BUF_STATE_DONE)
+		mtk_imgsys_cmpl_ring_post(pipe, req, MTKDIP_CMPL_ERROR);
+
 	if (req->req.state != MEDIA_REQUEST_STATE_QUEUED) {
 		dev_info(pipe->imgsys_dev->dev, "%s: req %d flushed", __func__,
 					req->tstate.req_fd);
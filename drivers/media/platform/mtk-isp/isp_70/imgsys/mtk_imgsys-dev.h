@@ -29,6 +29,7 @@
 #include "mtkdip.h"
 //#include "mtk-interconnect.h"
 #include "mtk_imgsys-worker.h"
+#include "mtk_imgsys-cmpl.h"
 
 #define MTK_IMGSYS_PIPE_ID_PREVIEW				0
 #define MTK_IMGSYS_PIPE_ID_CAPTURE				1
@@ -212,6 +213,9 @@ struct mtk_imgsys_pipe {
 	const struct mtk_imgsys_pipe_desc *desc;
 	struct mtk_imgsys_dma_buf_iova_list iova_cache;
 	struct init_info init_info;
+	/* opt-in completion ring, protected by cmpl_lock */
+	struct mtk_imgsys_cmpl_ring *cmpl_ring;
+	spinlock_t cmpl_lock;
 };
 
 struct imgsys_event_status {
@@ -279,6 +283,33 @@ typedef void (*debug_dump)(struct mtk_imgsys_dev *imgsys_dev, 		\
 	const struct module_ops *imgsys_modules, int imgsys_module_num,	\
 	unsigned int hw_comb);
 
+#ifdef BATCH_MODE_V3
+/* working buffer admission class, lower value is served first */
+enum mtk_imgsys_wbuf_prio {
+	MTK_IMGSYS_WBUF_PRIO_PREVIEW = 0,
+	MTK_IMGSYS_WBUF_PRIO_CAPTURE,
+	MTK_IMGSYS_WBUF_PRIO_NUM,
+};
+
+/* a QBUF waiting for all working buffers of its pack */
+struct mtk_imgsys_wbuf_waiter {
+	struct list_head entry;
+	struct mtk_imgsys_user *user;
+	unsigned int num;
+	enum mtk_imgsys_wbuf_prio prio;
+	bool granted;
+	struct list_head bufs;
+};
+
+/* allocation latency of the per-frame batch-mode objects */
+struct mtk_imgsys_alloc_stat {
+	atomic64_t cnt;
+	atomic64_t fail;
+	atomic64_t total_ns;
+	atomic64_t max_ns;
+};
+#endif
+
 struct mtk_imgsys_dev {
 	struct device *dev;
 	struct device *dev_Me;
@@ -332,6 +363,32 @@ struct mtk_imgsys_dev {
 	debug_dump dump;
 	atomic_t imgsys_user_cnt;
 	struct kref init_kref;
+	/*
+	 * Frames composed back to back are sent to the daemon in one
+	 * message, see imgsys_ipi_batch_flush(). Protected by hw_op_lock.
+	 */
+	struct img_ipi_frame_batch ipi_batch;
+	struct mtk_imgsys_request *ipi_batch_req[IMG_IPI_FRAME_BATCH_MAX];
+	/* requests queued to enqueue_wq and not yet composed */
+	atomic_t ipi_pending;
+	u32 ipi_caps;
+	u64 ipi_batch_sent;
+	u64 ipi_batch_frames;
+	u64 ipi_ack_batch;
+	u64 ipi_ack_frames;
+	/* mtk_imgsys debugfs directory, NULL or an error if unavailable */
+	struct dentry *debugfs_root;
+#ifdef BATCH_MODE_V3
+	/* MTKDIP_IOC_QBUF requests and the packs they hand back on DQBUF */
+	struct kmem_cache *req_cache;
+	struct kmem_cache *done_pack_cache;
+	struct mtk_imgsys_alloc_stat req_alloc_stat;
+	struct mtk_imgsys_alloc_stat pack_alloc_stat;
+	/* protected by imgsys_freebufferlist.lock */
+	struct list_head wbuf_waiters[MTK_IMGSYS_WBUF_PRIO_NUM];
+	unsigned int wbuf_held[MTK_IMGSYS_WBUF_PRIO_NUM];
+	wait_queue_head_t wbuf_wq;
+#endif
 };
 
 /* contained in struct mtk_imgsys_user's done_list */
@@ -351,6 +408,8 @@ struct mtk_imgsys_user {
 	struct list_head done_list;  /* contains struct done_frame_pack */
 	bool dqdonestate; /*batchmode use to check dqdonestate*/
 	wait_queue_head_t done_wq;
+	/* working buffers reserved by packs not done yet */
+	unsigned int wbuf_held;
 
 	// ToDo: should also sync with standard mode
 	enum imgsys_user_state state;
@@ -449,6 +508,9 @@ struct mtk_imgsys_request {
 	struct mtk_imgsys_hw_working_buf_list runner_done_list;
 	struct mtk_imgsys_hw_working_buf_list mdp_done_list;
 	bool is_batch_mode;
+	/* working buffers reserved for this pack, see wbuf_held */
+	unsigned int wbuf_num;
+	enum mtk_imgsys_wbuf_prio wbuf_prio;
 	// } V3 added
 #endif
 };
@@ -649,6 +711,8 @@ int mtk_imgsys_hw_working_buf_pool_init(struct mtk_imgsys_dev *imgsys_dev);
 void mtk_imgsys_hw_working_buf_pool_release(struct mtk_imgsys_dev *imgsys_dev);
 struct mtk_imgsys_hw_subframe*
 imgsys_working_buf_alloc_helper(struct mtk_imgsys_dev *imgsys_dev);
+void mtk_imgsys_hw_working_buf_mark_dirty(struct mtk_imgsys_hw_subframe *buf);
+void mtk_imgsys_hw_working_buf_clear(struct mtk_imgsys_hw_subframe *buf);
 
 int mtk_imgsys_can_enqueue(struct mtk_imgsys_dev *imgsys_dev,
 			int unprocessedcnt);
@@ -657,6 +721,30 @@ void mtk_imgsys_sd_desc_map_iova(struct mtk_imgsys_request *req);
 
 #ifdef BATCH_MODE_V3
 bool is_batch_mode(struct mtk_imgsys_request *req);
+
+int mtk_imgsys_batch_cache_init(struct mtk_imgsys_dev *imgsys_dev);
+void mtk_imgsys_batch_cache_release(struct mtk_imgsys_dev *imgsys_dev);
+struct mtk_imgsys_request *
+mtk_imgsys_batch_req_alloc(struct mtk_imgsys_dev *imgsys_dev);
+void mtk_imgsys_batch_req_free(struct mtk_imgsys_dev *imgsys_dev,
+			       struct mtk_imgsys_request *req);
+struct done_frame_pack *
+mtk_imgsys_done_pack_alloc(struct mtk_imgsys_dev *imgsys_dev);
+void mtk_imgsys_done_pack_free(struct mtk_imgsys_dev *imgsys_dev,
+			       struct done_frame_pack *dp);
+void mtk_imgsys_batch_alloc_stat_dump(struct mtk_imgsys_dev *imgsys_dev);
+
+enum mtk_imgsys_wbuf_prio mtk_imgsys_user_wbuf_prio(struct mtk_imgsys_user *user);
+int mtk_imgsys_hw_working_buf_reserve(struct mtk_imgsys_dev *imgsys_dev,
+				      struct mtk_imgsys_user *user,
+				      unsigned int num, bool nonblock,
+				      struct list_head *bufs);
+void mtk_imgsys_hw_working_buf_use(struct mtk_imgsys_dev *imgsys_dev,
+				   struct mtk_imgsys_hw_subframe *buf);
+void mtk_imgsys_hw_working_buf_release_quota(struct mtk_imgsys_dev *imgsys_dev,
+					     struct mtk_imgsys_user *user,
+					     struct mtk_imgsys_request *req);
+void mtk_imgsys_batch_req_release_quota(struct mtk_imgsys_request *req);
 #endif
 
 void mtk_imgsys_put_dma_buf(struct dma_buf *dma_buf,
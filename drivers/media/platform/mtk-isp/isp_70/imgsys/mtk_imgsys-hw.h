@@ -161,6 +161,10 @@ struct mtk_imgsys_hw_subframe {
 	struct mtk_imgsys_hw_working_buf tuning_buf;
 	struct mtk_imgsys_hw_working_buf frameparam;
 	struct list_head list_entry;
+	/* areas which may be non-zero, the clear is skipped for the others */
+	bool sub_frm_dirty;
+	bool tuning_dirty;
+	bool comp_dirty;
 };
 
 struct mtk_imgsys_hw_working_buf_list {
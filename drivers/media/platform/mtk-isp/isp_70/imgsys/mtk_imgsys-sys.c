@@ -31,6 +31,20 @@
 int imgsys_quick_onoff_en;
 module_param(imgsys_quick_onoff_en, int, 0644);
 
+/* send frames composed back to back in one IPI if the daemon can take it */
+int imgsys_ipi_batch_en = 1;
+module_param(imgsys_ipi_batch_en, int, 0644);
+
+#ifdef BATCH_MODE_V3
+/* working buffers capture class users leave for preview */
+int imgsys_wbuf_preview_reserve = 4;
+module_param(imgsys_wbuf_preview_reserve, int, 0644);
+
+/* working buffers one user may hold across its packs in flight */
+int imgsys_wbuf_user_quota = DIP_SUB_FRM_DATA_NUM;
+module_param(imgsys_wbuf_user_quota, int, 0644);
+#endif
+
 
 static struct gce_timeout_work imgsys_timeout_winfo[VIDEO_MAX_FRAME];
 static int imgsys_timeout_idx;
@@ -74,7 +88,14 @@ static int imgsys_send(struct platform_device *pdev, enum hcp_id id,
 
 static void imgsys_init_handler(void *data, unsigned int len, void *priv)
 {
-	pr_info("imgsys_init_handler");
+	struct mtk_imgsys_dev *imgsys_dev = (struct mtk_imgsys_dev *)priv;
+	struct img_ipi_caps *caps = (struct img_ipi_caps *)data;
+
+	/* older daemons ack without caps */
+	if (data && len == sizeof(*caps) && caps->magic == IMG_IPI_CAPS_MAGIC)
+		imgsys_dev->ipi_caps = caps->caps;
+
+	pr_info("imgsys_init_handler caps(0x%x)", imgsys_dev->ipi_caps);
 }
 
 static int mtk_imgsys_hw_working_buf_pool_reinit(struct mtk_imgsys_dev *imgsys_dev)
@@ -123,6 +144,14 @@ int mtk_imgsys_hw_working_buf_pool_init(struct mtk_imgsys_dev *imgsys_dev)
 	spin_lock_init(&imgsys_dev->imgsys_usedbufferlist.lock);
 	imgsys_dev->imgsys_usedbufferlist.cnt = 0;
 
+#ifdef BATCH_MODE_V3
+	for (i = 0; i < MTK_IMGSYS_WBUF_PRIO_NUM; i++) {
+		INIT_LIST_HEAD(&imgsys_dev->wbuf_waiters[i]);
+		imgsys_dev->wbuf_held[i] = 0;
+	}
+	init_waitqueue_head(&imgsys_dev->wbuf_wq);
+#endif
+
 #if MTK_CM4_SUPPORT
 	scp_workingbuf_offset = DIP_SCP_WORKINGBUF_OFFSET;
 	imgsys_dev->working_buf_mem_size = DIP_SUB_FRM_DATA_NUM *
@@ -256,6 +285,9 @@ int mtk_imgsys_hw_working_buf_pool_init(struct mtk_imgsys_dev *imgsys_dev)
 			__func__, i, &buf->frameparam.scp_daddr,
 			buf->frameparam.vaddr);
 
+		/* content of the reserved memory is unknown */
+		mtk_imgsys_hw_working_buf_mark_dirty(buf);
+
 		list_add_tail(&buf->list_entry,
 			      &imgsys_dev->imgsys_freebufferlist.list);
 		imgsys_dev->imgsys_freebufferlist.cnt++;
@@ -264,6 +296,34 @@ int mtk_imgsys_hw_working_buf_pool_init(struct mtk_imgsys_dev *imgsys_dev)
 	return 0;
 }
 
+/* handed to the daemon/HW, which may write any of it */
+void mtk_imgsys_hw_working_buf_mark_dirty(struct mtk_imgsys_hw_subframe *buf)
+{
+	buf->sub_frm_dirty = true;
+	buf->tuning_dirty = true;
+	buf->comp_dirty = true;
+}
+
+static void mtk_imgsys_hw_clear_area(void *vaddr, size_t size, bool *dirty)
+{
+	if (!*dirty)
+		return;
+
+	memset(vaddr, 0, size);
+	*dirty = false;
+}
+
+/* skip the areas already zeroed since they were last handed out */
+void mtk_imgsys_hw_working_buf_clear(struct mtk_imgsys_hw_subframe *buf)
+{
+	mtk_imgsys_hw_clear_area(buf->buffer.vaddr, DIP_SUB_FRM_SZ,
+				 &buf->sub_frm_dirty);
+	mtk_imgsys_hw_clear_area(buf->tuning_buf.vaddr, DIP_TUNING_SZ,
+				 &buf->tuning_dirty);
+	mtk_imgsys_hw_clear_area(buf->config_data.vaddr, DIP_COMP_SZ,
+				 &buf->comp_dirty);
+}
+
 void mtk_imgsys_hw_working_buf_pool_release(struct mtk_imgsys_dev *imgsys_dev)
 {
 	/* All the buffer should be in the freebufferlist when release */
@@ -290,10 +350,213 @@ void mtk_imgsys_hw_working_buf_pool_release(struct mtk_imgsys_dev *imgsys_dev)
 #endif
 }
 
+#ifdef BATCH_MODE_V3
+enum mtk_imgsys_wbuf_prio mtk_imgsys_user_wbuf_prio(struct mtk_imgsys_user *user)
+{
+	return user->user_enum == DIP_STREAMING ?
+		MTK_IMGSYS_WBUF_PRIO_PREVIEW : MTK_IMGSYS_WBUF_PRIO_CAPTURE;
+}
+
+static unsigned int mtk_imgsys_wbuf_class_limit(enum mtk_imgsys_wbuf_prio prio)
+{
+	if (prio == MTK_IMGSYS_WBUF_PRIO_PREVIEW)
+		return DIP_SUB_FRM_DATA_NUM;
+
+	return DIP_SUB_FRM_DATA_NUM -
+		clamp(imgsys_wbuf_preview_reserve, 0, DIP_SUB_FRM_DATA_NUM - 1);
+}
+
+static unsigned int mtk_imgsys_wbuf_user_limit(void)
+{
+	return clamp(imgsys_wbuf_user_quota, 1, DIP_SUB_FRM_DATA_NUM);
+}
+
+/*
+ * -EDQUOT if only w's own user quota is in the way, -EBUSY if its class
+ * limit or the free pool is. Called with imgsys_freebufferlist.lock held.
+ */
+static int mtk_imgsys_wbuf_check_locked(struct mtk_imgsys_dev *imgsys_dev,
+					struct mtk_imgsys_wbuf_waiter *w)
+{
+	if (w->user->wbuf_held + w->num > mtk_imgsys_wbuf_user_limit())
+		return -EDQUOT;
+
+	if (imgsys_dev->wbuf_held[w->prio] + w->num >
+	    mtk_imgsys_wbuf_class_limit(w->prio) ||
+	    imgsys_dev->imgsys_freebufferlist.cnt < w->num)
+		return -EBUSY;
+
+	return 0;
+}
+
+/*
+ * Hand out whole packs: strict priority between classes, arrival order
+ * inside a class. A waiter stopped by its own user quota does not hold
+ * back the others; one stopped by the pool holds back everything behind
+ * it so large packs are not starved by small ones. Returns true if any
+ * waiter was granted. Called with imgsys_freebufferlist.lock held.
+ */
+static bool mtk_imgsys_wbuf_grant_locked(struct mtk_imgsys_dev *imgsys_dev)
+{
+	struct mtk_imgsys_hw_working_buf_list *free_list =
+					&imgsys_dev->imgsys_freebufferlist;
+	struct mtk_imgsys_wbuf_waiter *w, *tmp;
+	struct mtk_imgsys_hw_subframe *buf;
+	bool granted = false;
+	unsigned int i;
+	int prio, ret;
+
+	for (prio = 0; prio < MTK_IMGSYS_WBUF_PRIO_NUM; prio++) {
+		list_for_each_entry_safe(w, tmp, &imgsys_dev->wbuf_waiters[prio],
+					 entry) {
+			ret = mtk_imgsys_wbuf_check_locked(imgsys_dev, w);
+			if (ret == -EDQUOT)
+				continue;
+			if (ret)
+				return granted;
+
+			for (i = 0; i < w->num; i++) {
+				buf = list_first_entry(&free_list->list,
+						struct mtk_imgsys_hw_subframe,
+						list_entry);
+				list_move_tail(&buf->list_entry, &w->bufs);
+			}
+			free_list->cnt -= w->num;
+			imgsys_dev->wbuf_held[w->prio] += w->num;
+			w->user->wbuf_held += w->num;
+
+			list_del_init(&w->entry);
+			/* pairs with smp_load_acquire() in the waiter */
+			smp_store_release(&w->granted, true);
+			granted = true;
+		}
+	}
+
+	return granted;
+}
+
+static void mtk_imgsys_wbuf_put_locked(struct mtk_imgsys_dev *imgsys_dev,
+				       struct mtk_imgsys_user *user,
+				       enum mtk_imgsys_wbuf_prio prio,
+				       struct list_head *bufs,
+				       unsigned int num)
+{
+	if (bufs) {
+		list_splice_tail_init(bufs,
+				      &imgsys_dev->imgsys_freebufferlist.list);
+		imgsys_dev->imgsys_freebufferlist.cnt += num;
+	}
+	imgsys_dev->wbuf_held[prio] -= num;
+	if (user)
+		user->wbuf_held -= num;
+}
+
+/*
+ * Reserve num working buffers for one pack, all or nothing. Sleeps until
+ * the pack is admitted unless nonblock. On success the buffers are on
+ * bufs, owned by the caller and on neither pool list.
+ */
+int mtk_imgsys_hw_working_buf_reserve(struct mtk_imgsys_dev *imgsys_dev,
+				      struct mtk_imgsys_user *user,
+				      unsigned int num, bool nonblock,
+				      struct list_head *bufs)
+{
+	struct mtk_imgsys_wbuf_waiter w = {
+		.user = user,
+		.num = num,
+		.prio = mtk_imgsys_user_wbuf_prio(user),
+	};
+	bool woken;
+	int ret = 0;
+
+	/* could never be admitted */
+	if (!num || num > mtk_imgsys_wbuf_user_limit() ||
+	    num > mtk_imgsys_wbuf_class_limit(w.prio))
+		return -EINVAL;
+
+	INIT_LIST_HEAD(&w.bufs);
+
+	spin_lock(&imgsys_dev->imgsys_freebufferlist.lock);
+	list_add_tail(&w.entry, &imgsys_dev->wbuf_waiters[w.prio]);
+	woken = mtk_imgsys_wbuf_grant_locked(imgsys_dev);
+	if (!w.granted && nonblock) {
+		list_del(&w.entry);
+		ret = -EAGAIN;
+	}
+	spin_unlock(&imgsys_dev->imgsys_freebufferlist.lock);
+
+	if (woken)
+		wake_up_all(&imgsys_dev->wbuf_wq);
+	if (ret)
+		return ret;
+
+	ret = wait_event_interruptible(imgsys_dev->wbuf_wq,
+				       smp_load_acquire(&w.granted));
+	if (ret) {
+		spin_lock(&imgsys_dev->imgsys_freebufferlist.lock);
+		if (w.granted)
+			mtk_imgsys_wbuf_put_locked(imgsys_dev, user, w.prio,
+						   &w.bufs, num);
+		else
+			list_del(&w.entry);
+		woken = mtk_imgsys_wbuf_grant_locked(imgsys_dev);
+		spin_unlock(&imgsys_dev->imgsys_freebufferlist.lock);
+
+		if (woken)
+			wake_up_all(&imgsys_dev->wbuf_wq);
+		return ret;
+	}
+
+	list_splice_tail(&w.bufs, bufs);
+
+	return 0;
+}
+
+/* account a reserved buffer as used, so it is freed the usual way */
+void mtk_imgsys_hw_working_buf_use(struct mtk_imgsys_dev *imgsys_dev,
+				   struct mtk_imgsys_hw_subframe *buf)
+{
+	spin_lock(&imgsys_dev->imgsys_usedbufferlist.lock);
+	list_add_tail(&buf->list_entry,
+		      &imgsys_dev->imgsys_usedbufferlist.list);
+	imgsys_dev->imgsys_usedbufferlist.cnt++;
+	spin_unlock(&imgsys_dev->imgsys_usedbufferlist.lock);
+}
+
+/*
+ * The pack is done, drop its reservation from the quotas. Its buffers
+ * went back to the pool one by one as frames completed. user is NULL if
+ * it has already gone.
+ */
+void mtk_imgsys_hw_working_buf_release_quota(struct mtk_imgsys_dev *imgsys_dev,
+					     struct mtk_imgsys_user *user,
+					     struct mtk_imgsys_request *req)
+{
+	bool woken;
+
+	if (!req->wbuf_num)
+		return;
+
+	spin_lock(&imgsys_dev->imgsys_freebufferlist.lock);
+	mtk_imgsys_wbuf_put_locked(imgsys_dev, user, req->wbuf_prio, NULL,
+				   req->wbuf_num);
+	req->wbuf_num = 0;
+	woken = mtk_imgsys_wbuf_grant_locked(imgsys_dev);
+	spin_unlock(&imgsys_dev->imgsys_freebufferlist.lock);
+
+	if (woken)
+		wake_up_all(&imgsys_dev->wbuf_wq);
+}
+#endif
+
 static void mtk_imgsys_hw_working_buf_free(struct mtk_imgsys_dev *imgsys_dev,
 				struct mtk_imgsys_hw_subframe *working_buf,
 					bool error_free)
 {
+#ifdef BATCH_MODE_V3
+	bool woken;
+#endif
+
 	if (!working_buf)
 		return;
 
@@ -309,8 +572,15 @@ static void mtk_imgsys_hw_working_buf_free(struct mtk_imgsys_dev *imgsys_dev,
 	list_add_tail(&working_buf->list_entry,
 		      &imgsys_dev->imgsys_freebufferlist.list);
 	imgsys_dev->imgsys_freebufferlist.cnt++;
+#ifdef BATCH_MODE_V3
+	woken = mtk_imgsys_wbuf_grant_locked(imgsys_dev);
+#endif
 	spin_unlock(&imgsys_dev->imgsys_freebufferlist.lock);
 
+#ifdef BATCH_MODE_V3
+	if (woken)
+		wake_up_all(&imgsys_dev->wbuf_wq);
+#endif
 }
 
 static struct mtk_imgsys_hw_subframe*
@@ -408,6 +678,7 @@ static void mtk_imgsys_notify_batch(struct mtk_imgsys_request *req)
 {
 	struct mtk_imgsys_dev *imgsys_dev = req->imgsys_pipe->imgsys_dev;
 	struct mtk_imgsys_hw_subframe *working_buf;
+	enum vb2_buffer_state vbf_state;
 
 	if (!is_batch_mode(req)) {
 		dev_info(imgsys_dev->dev, "%s:batch mode not batch mode\n",
@@ -441,6 +712,9 @@ static void mtk_imgsys_notify_batch(struct mtk_imgsys_request *req)
 	req->mdp_done_list.cnt--;
 	spin_unlock(&req->mdp_done_list.lock);
 
+	/* zero it here rather than on the next QBUF */
+	mtk_imgsys_hw_working_buf_clear(working_buf);
+
 	spin_lock(&imgsys_dev->imgsys_usedbufferlist.lock);
 	list_add_tail(&working_buf->list_entry,
 			  &imgsys_dev->imgsys_usedbufferlist.list);
@@ -453,6 +727,10 @@ static void mtk_imgsys_notify_batch(struct mtk_imgsys_request *req)
 	if (--req->unprocessed_count != 0)
 		return;
 
+	/* the pack's own buffer, reserved along with its subframes */
+	mtk_imgsys_hw_working_buf_free(imgsys_dev, req->working_buf, false);
+	req->working_buf = NULL;
+
 	/** Here means the complete of the request job,
 	 *  so we can suspend the HW.
 	 */
@@ -464,8 +742,12 @@ static void mtk_imgsys_notify_batch(struct mtk_imgsys_request *req)
 	 * it by id here.
 	 */
 	if (mtk_imgsys_pipe_get_running_job(req->imgsys_pipe, req->id)) {
+		/* a frame of the pack timed out, the ring gets ERROR as well */
+		vbf_state = (req->img_fparam.frameparam.state ==
+			     FRAME_STATE_HW_TIMEOUT) ?
+			    VB2_BUF_STATE_ERROR : VB2_BUF_STATE_DONE;
 		mtk_imgsys_pipe_remove_job(req);
-		mtk_imgsys_pipe_job_finish(req, VB2_BUF_STATE_DONE);
+		mtk_imgsys_pipe_job_finish(req, vbf_state);
 		wake_up(&imgsys_dev->flushing_waitq);
 	}
 }
@@ -533,6 +815,9 @@ static void mtk_imgsys_notify(struct mtk_imgsys_request *req, uint64_t frm_owner
 	mtk_imgsys_hw_working_buf_free(imgsys_dev, req->working_buf,
 								false);
 	req->working_buf = NULL;
+	mtk_imgsys_cmpl_ring_post(pipe, req,
+		(vbf_state == VB2_BUF_STATE_DONE) ?
+		MTKDIP_CMPL_DONE : MTKDIP_CMPL_ERROR);
 	/*  vb2 bufer done in below function  */
 	if (vbf_state == VB2_BUF_STATE_DONE)
 		mtk_imgsys_pipe_job_finish(req, vbf_state);
@@ -1608,6 +1893,34 @@ static void imgsys_scp_handler(void *data, unsigned int len, void *priv)
 
 }
 
+/* the daemon's replies to several frames at once */
+static void imgsys_scp_batch_handler(void *data, unsigned int len, void *priv)
+{
+	struct mtk_imgsys_dev *imgsys_dev = (struct mtk_imgsys_dev *)priv;
+	struct img_sw_buffer_batch *batch = (struct img_sw_buffer_batch *)data;
+	u32 i;
+
+	if (!data) {
+		WARN_ONCE(!data, "%s: failed due to NULL data\n", __func__);
+		return;
+	}
+
+	if (WARN_ONCE(len < sizeof(batch->num) ||
+		      batch->num > IMG_IPI_FRAME_BATCH_MAX ||
+		      len != offsetof(struct img_sw_buffer_batch,
+				      bufs[batch->num]),
+		      "%s: len(%d) not match img_sw_buffer_batch\n",
+		      __func__, len))
+		return;
+
+	imgsys_dev->ipi_ack_batch++;
+	imgsys_dev->ipi_ack_frames += batch->num;
+
+	for (i = 0; i < batch->num; i++)
+		imgsys_scp_handler(&batch->bufs[i], sizeof(batch->bufs[i]),
+				   priv);
+}
+
 static void imgsys_cleartoken_handler(void *data, unsigned int len, void *priv)
 {
 	struct mtk_imgsys_dev *imgsys_dev = (struct mtk_imgsys_dev *)priv;
@@ -1689,12 +2002,95 @@ static void imgsys_sd_share_buffer(struct mtk_imgsys_request *req,
 	ipi_param->frm_param.offset = buf_in->dataofst;
 }
 
+static void imgsys_composer_fail(struct mtk_imgsys_dev *imgsys_dev,
+				 struct mtk_imgsys_request *req, int ret)
+{
+#ifdef BATCH_MODE_V3
+	struct mtk_imgsys_hw_subframe *buf, *tmp;
+#endif
+
+	dev_info(imgsys_dev->dev,
+		"%s: frame_no(%d) send SCP_IPI_DIP_FRAME failed %d\n",
+		__func__, req->img_fparam.frameparam.frame_no, ret);
+	/* no ack will come for it, or the next flush would wait in vain */
+	atomic_dec(&imgsys_dev->num_composing);
+	if (is_singledev_mode(req))
+		mtk_imgsys_iova_map_tbl_unmap_sd(req);
+	else if (is_desc_mode(req))
+		mtk_imgsys_iova_map_tbl_unmap(req);
+	mtk_imgsys_pipe_remove_job(req);
+#ifdef BATCH_MODE_V3
+	/* the subframes reserved at QBUF, none reached the daemon */
+	if (is_batch_mode(req)) {
+		list_for_each_entry_safe(buf, tmp, &req->working_buf_list.list,
+					 list_entry) {
+			list_del(&buf->list_entry);
+			mtk_imgsys_hw_working_buf_use(imgsys_dev, buf);
+			mtk_imgsys_hw_working_buf_free(imgsys_dev, buf, true);
+		}
+		req->working_buf_list.cnt = 0;
+	}
+#endif
+	mtk_imgsys_hw_working_buf_free(imgsys_dev,
+					req->working_buf, true);
+	req->working_buf = NULL;
+	/* a batch pack is ended by mtk_imgsys_frame_done(), quota included */
+	mtk_imgsys_pipe_job_finish(req, VB2_BUF_STATE_ERROR);
+	wake_up(&imgsys_dev->flushing_waitq);
+}
+
+static bool imgsys_ipi_batch_enabled(struct mtk_imgsys_dev *imgsys_dev)
+{
+	return imgsys_ipi_batch_en &&
+	       (imgsys_dev->ipi_caps & IMG_IPI_CAP_FRAME_BATCH);
+}
+
+/*
+ * Send the frames held in ipi_batch. A lone frame goes out as a plain
+ * HCP_DIP_FRAME_ID message, so the daemon sees no difference when there
+ * is nothing to batch. Called with hw_op_lock held.
+ */
+static void imgsys_ipi_batch_flush(struct mtk_imgsys_dev *imgsys_dev)
+{
+	struct img_ipi_frame_batch *batch = &imgsys_dev->ipi_batch;
+	u32 i, num = batch->num;
+	int ret;
+
+	BUILD_BUG_ON(sizeof(*batch) > HCP_SHARE_BUF_SIZE);
+
+	if (!num)
+		return;
+
+	if (num == 1)
+		ret = imgsys_send(imgsys_dev->scp_pdev, HCP_DIP_FRAME_ID,
+			&batch->frames[0], sizeof(batch->frames[0]),
+			imgsys_dev->ipi_batch_req[0]->tstate.req_fd, 0);
+	else
+		ret = imgsys_send(imgsys_dev->scp_pdev,
+			HCP_IMGSYS_FRAME_BATCH_ID, batch,
+			offsetof(struct img_ipi_frame_batch, frames[num]),
+			imgsys_dev->ipi_batch_req[0]->tstate.req_fd, 0);
+	batch->num = 0;
+
+	if (ret) {
+		for (i = 0; i < num; i++)
+			imgsys_composer_fail(imgsys_dev,
+					     imgsys_dev->ipi_batch_req[i], ret);
+		return;
+	}
+
+	imgsys_dev->ipi_batch_sent++;
+	imgsys_dev->ipi_batch_frames += num;
+	dev_dbg(imgsys_dev->dev, "%s: sent %u frame(s)\n", __func__, num);
+}
+
 static void imgsys_composer_workfunc(struct work_struct *work)
 {
 	struct mtk_imgsys_request *req = mtk_imgsys_hw_fw_work_to_req(work);
 	struct mtk_imgsys_dev *imgsys_dev = req->imgsys_pipe->imgsys_dev;
 	struct img_ipi_param ipi_param;
 	struct mtk_imgsys_hw_subframe *buf;
+	bool more;
 	int ret;
 	// u32 index, frame_no;
 
@@ -1707,7 +2103,15 @@ static void imgsys_composer_workfunc(struct work_struct *work)
 		__func__, req->tstate.req_fd,
 		req->img_fparam.frameparam.frame_no);
 	media_request_get(&req->req);
-	down(&imgsys_dev->sem);
+	/* another request is already queued behind this one */
+	more = !atomic_dec_and_test(&imgsys_dev->ipi_pending);
+	if (down_trylock(&imgsys_dev->sem)) {
+		/* the frames held back may be what the semaphore waits for */
+		mutex_lock(&imgsys_dev->hw_op_lock);
+		imgsys_ipi_batch_flush(imgsys_dev);
+		mutex_unlock(&imgsys_dev->hw_op_lock);
+		down(&imgsys_dev->sem);
+	}
 #if MTK_CM4_SUPPORT == 0
 
 	#ifdef BATCH_MODE_V3
@@ -1725,16 +2129,16 @@ static void imgsys_composer_workfunc(struct work_struct *work)
 
 		mutex_lock(&imgsys_dev->hw_op_lock);
 		atomic_inc(&imgsys_dev->num_composing);
+		/* keep the order with frames still held back */
+		imgsys_ipi_batch_flush(imgsys_dev);
 
 		ret = imgsys_send(imgsys_dev->scp_pdev, HCP_DIP_FRAME_ID,
 			&ipi_param, sizeof(ipi_param),
 			req->tstate.req_fd, 0);
 
+		/* fail the pack so its buffers and quota are returned */
 		if (ret)
-			dev_info(imgsys_dev->dev,
-			"%s: frame_no(%d) send SCP_IPI_DIP_FRAME failed %d\n",
-				__func__,
-				req->img_fparam.frameparam.frame_no, ret);
+			imgsys_composer_fail(imgsys_dev, req, ret);
 		mutex_unlock(&imgsys_dev->hw_op_lock);
 		return;
 	}
@@ -1795,6 +2199,20 @@ static void imgsys_composer_workfunc(struct work_struct *work)
 
 	req->tstate.time_ipisendStart = ktime_get_boottime_ns()/1000;
 
+	if (imgsys_ipi_batch_enabled(imgsys_dev)) {
+		struct img_ipi_frame_batch *batch = &imgsys_dev->ipi_batch;
+
+		imgsys_dev->ipi_batch_req[batch->num] = req;
+		batch->frames[batch->num++] = ipi_param;
+		/* let the requests right behind join the same message */
+		if (!more || batch->num == IMG_IPI_FRAME_BATCH_MAX)
+			imgsys_ipi_batch_flush(imgsys_dev);
+		mutex_unlock(&imgsys_dev->hw_op_lock);
+
+		IMGSYS_SYSTRACE_END();
+		return;
+	}
+
 	ret = imgsys_send(imgsys_dev->scp_pdev, HCP_DIP_FRAME_ID,
 		&ipi_param, sizeof(ipi_param),
 		req->tstate.req_fd, 0);
@@ -1802,21 +2220,8 @@ static void imgsys_composer_workfunc(struct work_struct *work)
 	// index = req->img_fparam.frameparam.index;
 	// frame_no = req->img_fparam.frameparam.frame_no;
 
-	if (ret) {
-		dev_info(imgsys_dev->dev,
-			"%s: frame_no(%d) send SCP_IPI_DIP_FRAME failed %d\n",
-			__func__, req->img_fparam.frameparam.frame_no, ret);
-		if (is_singledev_mode(req))
-			mtk_imgsys_iova_map_tbl_unmap_sd(req);
-		else if (is_desc_mode(req))
-			mtk_imgsys_iova_map_tbl_unmap(req);
-		mtk_imgsys_pipe_remove_job(req);
-		mtk_imgsys_hw_working_buf_free(imgsys_dev,
-						req->working_buf, true);
-		req->working_buf = NULL;
-		mtk_imgsys_pipe_job_finish(req, VB2_BUF_STATE_ERROR);
-		wake_up(&imgsys_dev->flushing_waitq);
-	}
+	if (ret)
+		imgsys_composer_fail(imgsys_dev, req, ret);
 	mutex_unlock(&imgsys_dev->hw_op_lock);
 
 	dev_dbg(imgsys_dev->dev, "%s:(reqfd-%d) sent\n", __func__,
@@ -1849,6 +2254,12 @@ static int mtk_imgsys_hw_flush_pipe_jobs(struct mtk_imgsys_pipe *pipe)
 		dev_info(pipe->imgsys_dev->dev,
 			"%s: flushing is aborted, num(%d)\n",
 			__func__, num);
+#ifdef BATCH_MODE_V3
+		/* still in flight, but no frame done will end them now */
+		list_for_each_entry(req, &job_list, list)
+			if (is_batch_mode(req))
+				mtk_imgsys_batch_req_release_quota(req);
+#endif
 		return -EINVAL;
 	}
 
@@ -2012,6 +2423,11 @@ static int mtk_imgsys_hw_connect(struct mtk_imgsys_dev *imgsys_dev)
 		info.full_wd = imgsys_dev->imgsys_pipe[0].init_info.sensor.full_wd;
 		info.full_ht = imgsys_dev->imgsys_pipe[0].init_info.sensor.full_ht;
 		info.smvr_mode = imgsys_dev->imgsys_pipe[0].init_info.is_smvr;
+		/* the ack may carry the daemon's img_ipi_caps */
+		imgsys_dev->ipi_caps = 0;
+		imgsys_dev->ipi_batch.num = 0;
+		mtk_hcp_register(imgsys_dev->scp_pdev, HCP_IMGSYS_INIT_ID,
+			imgsys_init_handler, "imgsys_init_handler", imgsys_dev);
 		ret = imgsys_send(imgsys_dev->scp_pdev, HCP_IMGSYS_INIT_ID,
 			(void *)&info, sizeof(info), 0, 1);
 	}
@@ -2036,10 +2452,10 @@ static int mtk_imgsys_hw_connect(struct mtk_imgsys_dev *imgsys_dev)
 	imgsys_queue_init(&imgsys_dev->runnerque, imgsys_dev->dev, "imgsys-cmdq");
 	imgsys_queue_enable(&imgsys_dev->runnerque);
 
-	mtk_hcp_register(imgsys_dev->scp_pdev, HCP_IMGSYS_INIT_ID,
-		imgsys_init_handler, "imgsys_init_handler", imgsys_dev);
 	mtk_hcp_register(imgsys_dev->scp_pdev, HCP_IMGSYS_FRAME_ID,
 		imgsys_scp_handler, "imgsys_scp_handler", imgsys_dev);
+	mtk_hcp_register(imgsys_dev->scp_pdev, HCP_IMGSYS_FRAME_BATCH_DONE_ID,
+		imgsys_scp_batch_handler, "imgsys_scp_batch_handler", imgsys_dev);
 	mtk_hcp_register(imgsys_dev->scp_pdev, HCP_IMGSYS_CLEAR_HWTOKEN_ID,
 		imgsys_cleartoken_handler, "imgsys_cleartoken_handler", imgsys_dev);
 
@@ -2071,6 +2487,13 @@ static void mtk_imgsys_hw_disconnect(struct mtk_imgsys_dev *imgsys_dev)
 
 	mtk_hcp_unregister(imgsys_dev->scp_pdev, HCP_DIP_INIT_ID);
 	mtk_hcp_unregister(imgsys_dev->scp_pdev, HCP_DIP_FRAME_ID);
+	mtk_hcp_unregister(imgsys_dev->scp_pdev, HCP_IMGSYS_FRAME_BATCH_DONE_ID);
+
+	dev_info(imgsys_dev->dev,
+		"%s: caps(0x%x) batch sent(%llu/%llu frames) acked(%llu/%llu frames)\n",
+		__func__, imgsys_dev->ipi_caps,
+		imgsys_dev->ipi_batch_sent, imgsys_dev->ipi_batch_frames,
+		imgsys_dev->ipi_ack_batch, imgsys_dev->ipi_ack_frames);
 
 	imgsys_queue_disable(&imgsys_dev->runnerque);
 
@@ -2260,7 +2683,9 @@ void mtk_imgsys_hw_enqueue(struct mtk_imgsys_dev *imgsys_dev,
 
 	req->tstate.time_composingStart = ktime_get_boottime_ns()/1000;
 	/* TODO: use user fd + offset */
-	buf = mtk_imgsys_hw_working_buf_alloc(req->imgsys_pipe->imgsys_dev);
+	buf = req->working_buf; /* batch mode reserves it up front */
+	if (!buf)
+		buf = mtk_imgsys_hw_working_buf_alloc(req->imgsys_pipe->imgsys_dev);
 	if (!buf) {
 		dev_dbg(req->imgsys_pipe->imgsys_dev->dev,
 			"%s:%s:req(%p): no free working buffer available\n",
@@ -2268,6 +2693,7 @@ void mtk_imgsys_hw_enqueue(struct mtk_imgsys_dev *imgsys_dev,
 		return;
 	}
 	req->working_buf = buf;
+	mtk_imgsys_hw_working_buf_mark_dirty(buf);
 #ifndef USE_KERNEL_ION_BUFFER
 	buf->frameparam.vaddr = 0;
 #endif
@@ -2292,6 +2718,7 @@ void mtk_imgsys_hw_enqueue(struct mtk_imgsys_dev *imgsys_dev,
 	req->tstate.time_composingEnd = ktime_get_boottime_ns()/1000;
 
 	INIT_WORK(&req->iova_work, iova_worker);
+	atomic_inc(&req->imgsys_pipe->imgsys_dev->ipi_pending);
 	queue_work(req->imgsys_pipe->imgsys_dev->enqueue_wq,
 			&req->iova_work);
 
@@ -6,6 +6,7 @@
  *
  */
 
+#include <linux/debugfs.h>
 #include <linux/platform_device.h>
 #include <linux/module.h>
 #include <linux/of_device.h>
@@ -26,6 +27,7 @@
 #include "mtk-hcp.h"
 #include "mtkdip.h"
 #include "mtk_imgsys-cmdq.h"
+#include "mtk_imgsys-trace.h"
 
 #include "mtk_imgsys-data.h"
 
@@ -1131,65 +1133,176 @@ static bool get_user_by_file(struct file *filp, struct mtk_imgsys_user **user)
 }
 
 #ifdef BATCH_MODE_V3
-static int mtkdip_ioc_dqbuf(struct file *filp, void *arg)
+/*
+ * Unlink up to max done packs into out, sleeping for the first one unless
+ * filp is non-blocking. Returns the number unlinked or a negative error.
+ */
+static int mtkdip_dq_done_packs(struct file *filp,
+				struct mtk_imgsys_user *user,
+				struct list_head *out, unsigned int max)
 {
-	struct mtk_imgsys_user *user = NULL;
-	int ret = 0;
-
-	if (!get_user_by_file(filp, &user))
-		return -EINVAL;
+	struct done_frame_pack *dp, *tmp;
+	unsigned long flags;
+	int n = 0;
+	int ret;
 
 	if (list_empty(&user->done_list)
 	    && user->state == DIP_STATE_STREAMON) {
-		pr_info("%s: list empty, wait", __func__);
+		if (filp->f_flags & O_NONBLOCK)
+			return -EAGAIN;
 
 		ret = wait_event_interruptible(user->done_wq,
 						!list_empty(&user->done_list)
 					|| user->state != DIP_STATE_STREAMON);
+		if (ret)
+			return ret;
 	}
 
-	if (ret == 0) {
-		struct frame_param_pack *pack = (struct frame_param_pack *)arg;
-		struct done_frame_pack *dp;
-		unsigned long flags;
+	spin_lock_irqsave(&user->lock, flags);
+	if (user->state == DIP_STATE_STREAMON && user->dqdonestate) {
+		list_for_each_entry_safe(dp, tmp, &user->done_list,
+					 done_entry) {
+			if (n == max)
+				break;
+			list_move_tail(&dp->done_entry, out);
+			n++;
+		}
+	}
+	spin_unlock_irqrestore(&user->lock, flags);
+
+	return n;
+}
+
+static int mtkdip_ioc_dqbuf(struct file *filp, void *arg)
+{
+	struct mtk_imgsys_user *user = NULL;
+	struct mtk_imgsys_pipe *pipe = video_drvdata(filp);
+	struct frame_param_pack *pack = (struct frame_param_pack *)arg;
+	struct done_frame_pack *dp;
+	LIST_HEAD(done);
+	int ret;
+
+	if (!get_user_by_file(filp, &user))
+		return -EINVAL;
+
+	ret = mtkdip_dq_done_packs(filp, user, &done, 1);
+	if (ret <= 0)
+		return ret;
+
+	dp = list_first_entry(&done, struct done_frame_pack, done_entry);
+	IMGSYS_SYSTRACE_BEGIN("DQBUF user:%d seq:%llx\n", user->id,
+			      dp->pack.seq_num);
+	memcpy(pack, &dp->pack, sizeof(struct frame_param_pack));
+	mtk_imgsys_done_pack_free(pipe->imgsys_dev, dp);
+	IMGSYS_SYSTRACE_END();
+
+	pr_debug(
+	"[dip-drv][j.deque] user(%d) deque success! frame_pack=(num_frames(%d), seq_no(%llx), cookie(%p))\n",
+	user->id, pack->num_frames, pack->seq_num, pack->cookie);
+
+	return 0;
+}
+
+static int mtkdip_ioc_dqbuf_multi(struct file *filp, void *arg)
+{
+	struct mtk_imgsys_user *user = NULL;
+	struct mtk_imgsys_pipe *pipe = video_drvdata(filp);
+	struct frame_param_pack_multi *multi = arg;
+	struct frame_param_pack __user *upacks;
+	struct done_frame_pack *dp, *tmp;
+	unsigned long flags;
+	LIST_HEAD(done);
+	int ret;
+
+	if (!get_user_by_file(filp, &user))
+		return -EINVAL;
+
+	multi->num_packs = 0;
+	upacks = (struct frame_param_pack __user *)multi->packs;
+	if (!multi->max_packs || !upacks)
+		return -EINVAL;
+
+	ret = mtkdip_dq_done_packs(filp, user, &done, multi->max_packs);
+	if (ret <= 0)
+		return ret;
+
+	IMGSYS_SYSTRACE_BEGIN("DQBUF_MULTI user:%d packs:%d\n", user->id, ret);
+	list_for_each_entry_safe(dp, tmp, &done, done_entry) {
+		if (copy_to_user(&upacks[multi->num_packs], &dp->pack,
+				 sizeof(dp->pack)))
+			break;
+		list_del(&dp->done_entry);
+		mtk_imgsys_done_pack_free(pipe->imgsys_dev, dp);
+		multi->num_packs++;
+	}
 
+	/* hand back, in order, what could not be copied out */
+	if (!list_empty(&done)) {
 		spin_lock_irqsave(&user->lock, flags);
-		if (user->state == DIP_STATE_STREAMON &&
-			(!list_empty(&user->done_list) && user->dqdonestate)) {
-			dp = list_first_entry(&user->done_list,
-				struct done_frame_pack, done_entry);
-			list_del(&dp->done_entry);
-			memcpy(pack, &dp->pack,
-			       sizeof(struct frame_param_pack));
-			vfree(dp);
-		}
+		list_splice(&done, &user->done_list);
 		spin_unlock_irqrestore(&user->lock, flags);
-
-		pr_info(
-		"[dip-drv][j.deque] user(%d) deque success! frame_pack=(num_frames(%d), seq_no(%llx), cookie(%x))\n",
-		user->id, pack->num_frames, pack->seq_num, pack->cookie);
 	}
+	IMGSYS_SYSTRACE_END();
 
-	return ret;
+	pr_debug("%s: user(%d) dequeued %u/%d packs\n", __func__, user->id,
+		 multi->num_packs, ret);
+
+	return multi->num_packs ? 0 : -EFAULT;
+}
+
+__poll_t mtk_imgsys_v4l2_fh_poll(struct file *filp, poll_table *wait)
+{
+	struct mtk_imgsys_user *user = NULL;
+	unsigned long flags;
+	__poll_t mask = 0;
+
+	/* batch mode users have their own completion list */
+	if (!get_user_by_file(filp, &user) || user->state == DIP_STATE_INIT)
+		return vb2_fop_poll(filp, wait);
+
+	poll_wait(filp, &user->done_wq, wait);
+
+	spin_lock_irqsave(&user->lock, flags);
+	if (user->state != DIP_STATE_STREAMON)
+		mask = EPOLLERR;
+	else if (!list_empty(&user->done_list) && user->dqdonestate)
+		mask = EPOLLIN | EPOLLRDNORM;
+	spin_unlock_irqrestore(&user->lock, flags);
+
+	return mask;
 }
 
 static void mtkdip_save_pack(struct frame_param_pack *pack,
 			    struct mtk_imgsys_request *imgsys_req)
 {
-	imgsys_req->done_pack = vzalloc(sizeof(struct done_frame_pack),
-				     GFP_KERNEL);
 	memcpy(&imgsys_req->done_pack->pack, pack,
 	       sizeof(struct frame_param_pack));
+}
+
+/* drop the packs nobody dequeued, outside of user->lock */
+static void mtkdip_free_done_list(struct mtk_imgsys_dev *imgsys_dev,
+				  struct mtk_imgsys_user *user)
+{
+	struct done_frame_pack *dp, *tmp;
+	unsigned long flags;
+	LIST_HEAD(done);
 
+	spin_lock_irqsave(&user->lock, flags);
+	list_splice_init(&user->done_list, &done);
+	spin_unlock_irqrestore(&user->lock, flags);
 
+	list_for_each_entry_safe(dp, tmp, &done, done_entry) {
+		list_del(&dp->done_entry);
+		mtk_imgsys_done_pack_free(imgsys_dev, dp);
+	}
 }
 
-static int mtkdip_fill_req(struct mtk_imgsys_dev *imgsys_dev,
+static void mtkdip_fill_req(struct mtk_imgsys_dev *imgsys_dev,
 			      struct mtk_imgsys_request *req,
 			      struct frame_param_pack *pack,
-			      struct mtk_imgsys_user *user)
+			      struct list_head *bufs)
 {
-	int i, ret;
+	int i;
 	struct img_ipi_frameparam *packed_frame = pack->frame_params;
 
 	req->unprocessed_count = pack->num_frames;
@@ -1203,17 +1316,10 @@ static int mtkdip_fill_req(struct mtk_imgsys_dev *imgsys_dev,
 		 *       we set offset in scp_daddr for user daemon access
 		 */
 
-		subframe = imgsys_working_buf_alloc_helper(imgsys_dev);
-		if (subframe == NULL) {
-			pr_info("%s: Failed to allocate subframe(%p), free(%d),used(%d)\n",
-				__func__,
-				subframe,
-				imgsys_dev->imgsys_freebufferlist.cnt,
-				imgsys_dev->imgsys_usedbufferlist.cnt);
-			ret = wait_event_interruptible(user->enque_wq,
-				imgsys_working_buf_alloc_helper(imgsys_dev));
-			return ret;
-		}
+		/* reserved by the caller, one per frame */
+		subframe = list_first_entry(bufs, struct mtk_imgsys_hw_subframe,
+					    list_entry);
+		list_del(&subframe->list_entry);
 
 		frame = (struct img_ipi_frameparam *)subframe->frameparam.vaddr;
 
@@ -1230,11 +1336,6 @@ static int mtkdip_fill_req(struct mtk_imgsys_dev *imgsys_dev,
 				       (void *)packed_frame,
 				       sizeof(struct img_ipi_frameparam));
 
-		spin_lock(&imgsys_dev->imgsys_usedbufferlist.lock);
-		list_del(&subframe->list_entry);
-		imgsys_dev->imgsys_usedbufferlist.cnt--;
-		spin_unlock(&imgsys_dev->imgsys_usedbufferlist.lock);
-
 		spin_lock(&req->working_buf_list.lock);
 		list_add_tail(&subframe->list_entry,
 			      &req->working_buf_list.list);
@@ -1251,7 +1352,15 @@ static int mtkdip_fill_req(struct mtk_imgsys_dev *imgsys_dev,
 					- imgsys_dev->working_buf_mem_scp_daddr;
 		frame->tuning_data.va = (u64)subframe->tuning_buf.vaddr
 			- (u64)mtk_hcp_get_reserve_mem_virt(DIP_MEM_FOR_HW_ID);
-		memset(subframe->tuning_buf.vaddr, 0, DIP_TUNING_SZ);
+
+		/*
+		 * Normally already zeroed by mtk_imgsys_notify_batch(). The
+		 * tuning copy below overwrites the whole area (copy_from_user
+		 * zero-fills what it cannot read), so it needs no clear.
+		 */
+		if (frame->tuning_data.present)
+			subframe->tuning_dirty = false;
+		mtk_imgsys_hw_working_buf_clear(subframe);
 		dev_dbg(imgsys_dev->dev,
 			"packed_frame->tuning_data.present:0x%llx, idx(%d), f_no(%d), in(%d), out(%d)\n",
 			frame->tuning_data.present,
@@ -1263,14 +1372,12 @@ static int mtkdip_fill_req(struct mtk_imgsys_dev *imgsys_dev,
 			       (void *)frame->tuning_data.present,
 			       DIP_TUNING_SZ);
 
-		memset(subframe->buffer.vaddr, 0, DIP_SUB_FRM_SZ);
-
 		frame->config_data.va = (u64)subframe->config_data.vaddr;
 		frame->config_data.pa = subframe->config_data.scp_daddr
 					- imgsys_dev->working_buf_mem_scp_daddr;
 		frame->config_data.offset = (u64)subframe->config_data.vaddr
 			- (u64)mtk_hcp_get_reserve_mem_virt(DIP_MEM_FOR_HW_ID);
-		memset(subframe->config_data.vaddr, 0, DIP_COMP_SZ);
+		mtk_imgsys_hw_working_buf_mark_dirty(subframe);
 
 		/* fill the current buffer address in the previous frame */
 		if (i > 0 && i < (req->unprocessed_count)) {
@@ -1293,7 +1400,6 @@ static int mtkdip_fill_req(struct mtk_imgsys_dev *imgsys_dev,
 		/* Get next frame in the frame_param_pack */
 		packed_frame++;
 	}
-	return 0;
 }
 
 static void init_buffer_list(struct mtk_imgsys_hw_working_buf_list *list)
@@ -1310,8 +1416,11 @@ static int mtkdip_ioc_qbuf(struct file *filp, void *arg)
 	struct mtk_imgsys_dev *imgsys_dev = pipe->imgsys_dev;
 	struct mtk_imgsys_request *imgsys_req;
 	struct frame_param_pack *pack = (struct frame_param_pack *)arg;
+	struct mtk_imgsys_hw_subframe *buf;
+	unsigned int wbuf_num;
 	int ret = 0;
 	unsigned long flag;
+	LIST_HEAD(bufs);
 
 	ret = get_user_by_file(filp, &user);
 	if (!ret) {
@@ -1325,12 +1434,19 @@ static int mtkdip_ioc_qbuf(struct file *filp, void *arg)
 	}
 
 	// generate mtk dip request, with pipe and id
-	imgsys_req = vzalloc(sizeof(*imgsys_req), GFP_KERNEL);
+	imgsys_req = mtk_imgsys_batch_req_alloc(imgsys_dev);
 	if (!imgsys_req) {
 		ret = -ENOMEM;
 		pr_info("%s: Failed to allocate dip request\n", __func__);
 		return ret;
 	}
+	/* before fill_req takes working buffers, so failing here is cheap */
+	imgsys_req->done_pack = mtk_imgsys_done_pack_alloc(imgsys_dev);
+	if (!imgsys_req->done_pack) {
+		pr_info("%s: Failed to allocate done pack\n", __func__);
+		mtk_imgsys_batch_req_free(imgsys_dev, imgsys_req);
+		return -ENOMEM;
+	}
 	imgsys_req->imgsys_pipe = pipe;
 	imgsys_req->id = mtk_imgsys_pipe_next_job_id_batch_mode(pipe, user->id);
 	init_buffer_list(&imgsys_req->working_buf_list);
@@ -1338,21 +1454,34 @@ static int mtkdip_ioc_qbuf(struct file *filp, void *arg)
 	init_buffer_list(&imgsys_req->runner_done_list);
 	init_buffer_list(&imgsys_req->mdp_done_list);
 
-	if (!mtk_imgsys_can_enqueue(imgsys_dev, pack->num_frames)) {
-		ret = wait_event_interruptible(user->enque_wq,
-			mtk_imgsys_can_enqueue(imgsys_dev, pack->num_frames));
-		if (ret == -ERESTARTSYS) {
+	/*
+	 * Admit the whole pack at once: one buffer per frame plus the
+	 * request's own, so a pack never sits on half its buffers while
+	 * waiting for the rest.
+	 */
+	wbuf_num = pack->num_frames + 1;
+	ret = mtk_imgsys_hw_working_buf_reserve(imgsys_dev, user, wbuf_num,
+						filp->f_flags & O_NONBLOCK,
+						&bufs);
+	if (ret) {
+		if (ret == -ERESTARTSYS)
 			pr_info("%s: interrupted by a signal!\n", __func__);
-			return ret;
-		}
+		else if (ret != -EAGAIN)
+			pr_info("%s: cannot reserve %u working buffers(%d)\n",
+				__func__, wbuf_num, ret);
+		goto err_free_req;
 	}
+	imgsys_req->wbuf_num = wbuf_num;
+	imgsys_req->wbuf_prio = mtk_imgsys_user_wbuf_prio(user);
+
+	buf = list_first_entry(&bufs, struct mtk_imgsys_hw_subframe,
+			       list_entry);
+	list_del(&buf->list_entry);
+	mtk_imgsys_hw_working_buf_use(imgsys_dev, buf);
+	imgsys_req->working_buf = buf;
 
 	// put frame parameter in mtk dip request
-	ret = mtkdip_fill_req(imgsys_dev, imgsys_req, pack, user);
-	if (ret) {
-		pr_info("%s: Failed to fill dip request\n", __func__);
-		return ret;
-	}
+	mtkdip_fill_req(imgsys_dev, imgsys_req, pack, &bufs);
 	mtkdip_save_pack(pack, imgsys_req);
 	imgsys_req->is_batch_mode = 1;
 	// add job to pipe->pipe_job_running_list
@@ -1363,6 +1492,11 @@ static int mtkdip_ioc_qbuf(struct file *filp, void *arg)
 
 	mtk_imgsys_hw_enqueue(imgsys_dev, imgsys_req);
 	return 0;
+
+err_free_req:
+	mtk_imgsys_done_pack_free(imgsys_dev, imgsys_req->done_pack);
+	mtk_imgsys_batch_req_free(imgsys_dev, imgsys_req);
+	return ret;
 }
 
 static int mtkdip_ioc_streamon(struct file *filp)
@@ -1406,18 +1540,16 @@ static int mtkdip_ioc_streamoff(struct file *filp)
 
 	ret = mtk_imgsys_hw_streamoff(pipe);
 	if (ret == 0) {
-		struct done_frame_pack *dp;
 		unsigned long flags;
 
 		spin_lock_irqsave(&user->lock, flags);
-		list_for_each_entry(dp, &user->done_list, done_entry) {
-			list_del(&dp->done_entry);
-			vfree(dp);
-		}
 		user->state = DIP_STATE_STREAMOFF;
 		user->dqdonestate = false;
 		spin_unlock_irqrestore(&user->lock, flags);
 		wake_up_all(&user->done_wq);
+
+		mtkdip_free_done_list(pipe->imgsys_dev, user);
+		mtk_imgsys_batch_alloc_stat_dump(pipe->imgsys_dev);
 	}
 
 	return ret;
@@ -1482,6 +1614,20 @@ static int mtkdip_ioc_set_user_enum(struct file *filp, void *arg)
 
 }
 
+/* the batch packs of the user are posted to the ring instead of DQBUF */
+static int mtkdip_ioc_s_cmpl_ring_user(struct file *filp, void *arg)
+{
+	struct mtk_imgsys_pipe *pipe = video_drvdata(filp);
+	struct mtk_imgsys_user *user;
+
+	if (!get_user_by_file(filp, &user)) {
+		pr_info("%s: cannot find user\n", __func__);
+		return -EINVAL;
+	}
+
+	return mtk_imgsys_cmpl_ring_setup(pipe, arg, user->id);
+}
+
 long mtk_imgsys_vidioc_default(struct file *file, void *fh,
 			   bool valid_prio, unsigned int cmd, void *arg)
 {
@@ -1494,6 +1640,8 @@ long mtk_imgsys_vidioc_default(struct file *file, void *fh,
 		return mtkdip_ioc_qbuf(file, arg);
 	case MTKDIP_IOC_DQBUF:
 		return mtkdip_ioc_dqbuf(file, arg);
+	case MTKDIP_IOC_DQBUF_MULTI:
+		return mtkdip_ioc_dqbuf_multi(file, arg);
 	case MTKDIP_IOC_STREAMON:
 		return mtkdip_ioc_streamon(file);
 	case MTKDIP_IOC_STREAMOFF:
@@ -1504,6 +1652,8 @@ long mtk_imgsys_vidioc_default(struct file *file, void *fh,
 		return mtkdip_ioc_g_isp_version(file, arg);
 	case MTKDIP_IOC_S_USER_ENUM:
 		return mtkdip_ioc_set_user_enum(file, arg);
+	case MTKDIP_IOC_S_CMPL_RING:
+		return mtkdip_ioc_s_cmpl_ring_user(file, arg);
 	default:
 		pr_info("%s: non-supported cmd\n", __func__);
 		return -ENOTTY;
@@ -1889,6 +2039,17 @@ static int mtkdip_ioc_set_control(struct v4l2_subdev *subdev, void *arg)
 	return ret;
 }
 
+static int mtkdip_ioc_s_cmpl_ring(struct v4l2_subdev *subdev, void *arg)
+{
+	struct mtk_imgsys_pipe *pipe = mtk_imgsys_subdev_to_pipe(subdev);
+	struct cmpl_ring_info *info = (struct cmpl_ring_info *)arg;
+
+	if (!info)
+		return -EINVAL;
+
+	return mtk_imgsys_cmpl_ring_setup(pipe, info, 0);
+}
+
 long mtk_imgsys_subdev_ioctl(struct v4l2_subdev *subdev, unsigned int cmd,
 								void *arg)
 {
@@ -1908,6 +2069,8 @@ long mtk_imgsys_subdev_ioctl(struct v4l2_subdev *subdev, unsigned int cmd,
 		return mtkdip_ioc_s_init_info(subdev, arg);
 	case MTKDIP_IOC_SET_CONTROL:
 		return mtkdip_ioc_set_control(subdev, arg);
+	case MTKDIP_IOC_S_CMPL_RING:
+		return mtkdip_ioc_s_cmpl_ring(subdev, arg);
 	default:
 		pr_info("%s: non-supported cmd(%x)\n", __func__, cmd);
 		return -ENOTTY;
@@ -1924,6 +2087,8 @@ long mtk_imgsys_subdev_compat_ioctl(struct v4l2_subdev *subdev, unsigned int cmd
 	struct fd_tbl fdtbl_data;
 	struct init_info init_data;
 	struct ctrl_info ctrl_data;
+	struct cmpl_ring_info ring_data;
+	long ret;
 
 	pr_debug("%s campat cmd: %d\n", __func__, cmd);
 	switch (cmd) {
@@ -1957,6 +2122,18 @@ long mtk_imgsys_subdev_compat_ioctl(struct v4l2_subdev *subdev, unsigned int cmd
 			return -EFAULT;
 		}
 		return subdev->ops->core->ioctl(subdev, cmd, &ctrl_data);
+	case MTKDIP_IOC_S_CMPL_RING:
+		if (copy_from_user(&ring_data, (void __user *)arg, sizeof(ring_data))) {
+			pr_info("Failed to copy from user_ptr=%pK size=%zu\n",
+				(void __user *)arg, sizeof(ring_data));
+			return -EFAULT;
+		}
+		ret = subdev->ops->core->ioctl(subdev, cmd, &ring_data);
+		if (ret)
+			return ret;
+		if (copy_to_user((void __user *)arg, &ring_data, sizeof(ring_data)))
+			return -EFAULT;
+		return 0;
 	default:
 		pr_info("%s: non-supported cmd(%x)\n", __func__, cmd);
 		return -ENOTTY;
@@ -2103,7 +2280,10 @@ int mtk_imgsys_v4l2_fh_open(struct file *filp)
 	// keep fh in user structure
 	user = vzalloc(sizeof(*user));
 	user->fh = filp->private_data;
-	user->id = ++count;
+	/* 0 stands for no owner of a completion ring */
+	if (!++count)
+		++count;
+	user->id = count;
 	init_waitqueue_head(&user->done_wq);
 	init_waitqueue_head(&user->enque_wq);
 	INIT_LIST_HEAD(&user->done_list);
@@ -2136,6 +2316,10 @@ int mtk_imgsys_v4l2_fh_release(struct file *filp)
 		list_del(&user->entry);
 		mutex_unlock(&imgsys_dev->imgsys_users.user_lock);
 		pr_debug("%s: id(%d)\n", __func__, user->id);
+		mtk_imgsys_cmpl_ring_detach_user(pipe, user->id);
+#ifdef BATCH_MODE_V3
+		mtkdip_free_done_list(imgsys_dev, user);
+#endif
 		vfree(user);
 	}
 	vb2_fop_release(filp);
@@ -2865,6 +3049,7 @@ static int mtk_imgsys_probe(struct platform_device *pdev)
 	atomic_set(&imgsys_dev->imgsys_enqueue_cnt, 0);
 	atomic_set(&imgsys_dev->imgsys_user_cnt, 0);
 	atomic_set(&imgsys_dev->num_composing, 0);
+	atomic_set(&imgsys_dev->ipi_pending, 0);
 	mutex_init(&imgsys_dev->hw_op_lock);
 	/* Limited by the co-processor side's stack size */
 	sema_init(&imgsys_dev->sem, DIP_COMPOSING_MAX_NUM);
@@ -2875,11 +3060,20 @@ static int mtk_imgsys_probe(struct platform_device *pdev)
 		return ret;
 	}
 
+#ifdef BATCH_MODE_V3
+	ret = mtk_imgsys_batch_cache_init(imgsys_dev);
+	if (ret) {
+		dev_info(&pdev->dev, "batch cache init failed(%d)\n", ret);
+
+		goto err_release_working_buf_pool;
+	}
+#endif
+
 	ret = mtk_imgsys_dev_v4l2_init(imgsys_dev);
 	if (ret) {
 		dev_info(&pdev->dev, "v4l2 init failed(%d)\n", ret);
 
-		goto err_release_working_buf_pool;
+		goto err_release_batch_cache;
 	}
 
 	ret = mtk_imgsys_res_init(pdev, imgsys_dev);
@@ -2891,6 +3085,7 @@ static int mtk_imgsys_probe(struct platform_device *pdev)
 		goto err_release_deinit_v4l2;
 	}
 
+	imgsys_dev->debugfs_root = debugfs_create_dir("mtk_imgsys", NULL);
 	imgsys_cmdq_init(imgsys_dev, 1);
 
 	#if DVFS_QOS_READY
@@ -2921,6 +3116,10 @@ static int mtk_imgsys_probe(struct platform_device *pdev)
 
 err_release_deinit_v4l2:
 	mtk_imgsys_dev_v4l2_release(imgsys_dev);
+err_release_batch_cache:
+#ifdef BATCH_MODE_V3
+	mtk_imgsys_batch_cache_release(imgsys_dev);
+#endif
 err_release_working_buf_pool:
 	mtk_imgsys_hw_working_buf_pool_release(imgsys_dev);
 	return ret;
@@ -2934,6 +3133,9 @@ static int mtk_imgsys_remove(struct platform_device *pdev)
 	pm_runtime_disable(&pdev->dev);
 	platform_driver_unregister(&mtk_imgsys_larb_driver);
 	mtk_imgsys_dev_v4l2_release(imgsys_dev);
+#ifdef BATCH_MODE_V3
+	mtk_imgsys_batch_cache_release(imgsys_dev);
+#endif
 	mtk_imgsys_hw_working_buf_pool_release(imgsys_dev);
 	mutex_destroy(&imgsys_dev->hw_op_lock);
 	#if DVFS_QOS_READY
@@ -2941,6 +3143,7 @@ static int mtk_imgsys_remove(struct platform_device *pdev)
 	mtk_imgsys_mmdvfs_uninit(imgsys_dev);
 	#endif
 	imgsys_cmdq_release(imgsys_dev);
+	debugfs_remove_recursive(imgsys_dev->debugfs_root);
 
 	return 0;
 }
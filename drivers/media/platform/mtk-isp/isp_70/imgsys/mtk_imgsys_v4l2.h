@@ -122,6 +122,7 @@ static int mtk_imgsys_vidioc_qbuf(struct file *file, void *priv,
 #ifdef BATCH_MODE_V3
 long mtk_imgsys_vidioc_default(struct file *file, void *fh,
 			bool valid_prio, unsigned int cmd, void *arg);
+__poll_t mtk_imgsys_v4l2_fh_poll(struct file *filp, poll_table *wait);
 #endif
 long mtk_imgsys_subdev_ioctl(struct v4l2_subdev *subdev, unsigned int cmd,
 								void *arg);
@@ -217,7 +218,11 @@ static const struct v4l2_file_operations mtk_imgsys_v4l2_fops = {
 	.unlocked_ioctl = video_ioctl2,
 	.open = mtk_imgsys_v4l2_fh_open,
 	.release = mtk_imgsys_v4l2_fh_release,
+#ifdef BATCH_MODE_V3
+	.poll = mtk_imgsys_v4l2_fh_poll,
+#else
 	.poll = vb2_fop_poll,
+#endif
 	.mmap = vb2_fop_mmap,
 #ifdef CONFIG_COMPAT
 	.compat_ioctl32 = v4l2_compat_ioctl32,
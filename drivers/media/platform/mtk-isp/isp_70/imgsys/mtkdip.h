@@ -65,6 +65,68 @@ struct ctrl_info {
 #define MTKDIP_IOC_SET_CONTROL _IOW('V', BASE_VIDIOC_PRIVATE + 13, struct ctrl_info)
 #define MTKDIP_IOC_GET_CONTROL _IOWR('V', BASE_VIDIOC_PRIVATE + 14, struct ctrl_info)
 
+/*
+ * Completion ring - opt-in, per pipe.
+ * Use case:
+ *    ioctl(subdev_fd, MTKDIP_IOC_S_CMPL_RING, struct cmpl_ring_info);
+ *    or, for batch mode, ioctl(video_fd, ...) by the user queueing packs;
+ *    mmap(ring_fd) -> struct mtkdip_cmpl_ring + entries[num_entries]
+ * The driver produces entries at head, userspace consumes at tail and
+ * writes tail back. event_fd (optional, -1 for none) is signaled once per
+ * posted entry for readers which want to sleep. num_entries must be a
+ * power of 2; num_entries 0 detaches the ring.
+ * Batch mode packs are only posted to a ring armed on the video node by
+ * the user which queued them, and then need no DQBUF. The packs of the
+ * other users stay on their done list.
+ */
+#define MTKDIP_CMPL_RING_MAX_ENTRIES	(1024)
+#define MTKDIP_CMPL_MAX_BUFS		(96)
+#define MTKDIP_CMPL_BUF_UNUSED		(0xFF)
+
+enum mtkdip_cmpl_status {
+	MTKDIP_CMPL_DONE = 0,
+	MTKDIP_CMPL_ERROR,
+};
+
+struct cmpl_ring_info {
+	uint32_t num_entries;
+	int32_t event_fd;
+	int32_t ring_fd;	/* returned by driver */
+	uint32_t ring_size;	/* returned by driver, mmap length */
+} __attribute__ ((__packed__));
+#define MTKDIP_IOC_S_CMPL_RING \
+			_IOWR('V', BASE_VIDIOC_PRIVATE + 15, struct cmpl_ring_info)
+
+struct mtkdip_cmpl_entry {
+	uint64_t seq;
+	int32_t req_fd;
+	uint32_t status;
+	uint32_t job_id;
+	uint32_t num_bufs;
+	uint64_t user_seq_num;	/* batch mode: frame_param_pack seq_num */
+	uint64_t cookie;	/* batch mode: frame_param_pack cookie */
+	/* vb2 index by video node id, MTKDIP_CMPL_BUF_UNUSED if not used */
+	uint8_t buf_idx[MTKDIP_CMPL_MAX_BUFS];
+	/* tstate timings, boottime in us */
+	uint64_t time_qbuf;
+	uint64_t time_composing_start;
+	uint64_t time_ipisend_start;
+	uint64_t time_send2cmq;
+	uint64_t time_mdpcb_start;
+	uint64_t time_notify_start;
+} __attribute__ ((__packed__));
+
+struct mtkdip_cmpl_ring {
+	uint32_t head;		/* written by driver */
+	uint32_t tail;		/* written by user */
+	uint32_t num_entries;
+	uint32_t entry_size;
+	/* entries not posted because the ring was full, batch packs are DQBUF'd */
+	uint32_t dropped;
+	uint32_t reserved[11];
+	struct mtkdip_cmpl_entry entries[];
+} __attribute__ ((__packed__));
+
 #define STANDARD_MODE_MAX_FRAMES (1)
 #define BATCH_MODE_MAX_FRAMES (32)
 
@@ -98,6 +160,22 @@ struct frame_param_pack {
 	void *cookie;       // used by user
 } __attribute__ ((__packed__));
 
+/*
+ * Batch mode - dequeue up to max_packs done packs in one call.
+ * Use case:
+ *    ioctl(fd, MTKDIP_IOC_DQBUF_MULTI, struct frame_param_pack_multi);
+ * Sleeps until at least one pack is done, or returns -EAGAIN right away
+ * if fd is O_NONBLOCK (so is MTKDIP_IOC_DQBUF). poll() on fd reports
+ * POLLIN once a pack can be dequeued.
+ */
+struct frame_param_pack_multi {
+	uint32_t max_packs;
+	uint32_t num_packs;	/* returned by driver */
+	struct frame_param_pack *packs;
+} __attribute__ ((__packed__));
+#define MTKDIP_IOC_DQBUF_MULTI \
+	_IOWR('V', BASE_VIDIOC_PRIVATE + 16, struct frame_param_pack_multi)
+
 
 /*
  * Used in driver internaly. (kernel driver <-> user space daemon)
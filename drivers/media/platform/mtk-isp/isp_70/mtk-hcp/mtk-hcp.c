@@ -282,6 +282,8 @@ inline int hcp_id_to_module_id(struct mtk_hcp *hcp_dev, enum hcp_id id)
 	case HCP_IMGSYS_UVA_FDS_DEL_ID:
 	case HCP_IMGSYS_SET_CONTROL_ID:
 	case HCP_IMGSYS_GET_CONTROL_ID:
+	case HCP_IMGSYS_FRAME_BATCH_ID:
+	case HCP_IMGSYS_FRAME_BATCH_DONE_ID:
 		module_id = MODULE_DIP;
 		break;
 	case HCP_RSC_INIT_ID:
@@ -60,6 +60,8 @@ enum hcp_id {
 	HCP_FD_FRAME_ID,
 	HCP_RSC_INIT_ID,
 	HCP_RSC_FRAME_ID,
+	HCP_IMGSYS_FRAME_BATCH_ID,
+	HCP_IMGSYS_FRAME_BATCH_DONE_ID,
 	HCP_MAX_ID,
 };
 
@@ -384,6 +384,16 @@ struct mtk_fine_integ_line {
 	__u32 fine_integ_line;
 };
 
+/* last AE control applied to the sensor, times in ktime_get_boottime_ns() */
+struct mtk_ae_commit {
+	__u64 queue_ns; /* staged by the control */
+	__u64 done_ns; /* its writes completed, 0 while pending */
+	__u32 seq; /* AE controls staged since stream on */
+	__u32 done_seq; /* AE controls applied since stream on */
+	__u32 n_msgs; /* i2c messages of the last commit */
+	__u32 n_xfers; /* i2c transfers of the last commit */
+};
+
 /* GET */
 
 #define VIDIOC_MTK_G_DEF_FPS_BY_SCENARIO \
@@ -497,6 +507,9 @@ struct mtk_fine_integ_line {
 #define VIDIOC_MTK_G_MAX_EXPOSURE_LINE \
 	_IOWR('M', BASE_VIDIOC_PRIVATE + 39, struct mtk_max_exp_line)
 
+#define VIDIOC_MTK_G_AE_COMMIT \
+	_IOR('M', BASE_VIDIOC_PRIVATE + 40, struct mtk_ae_commit)
+
 /* SET */
 
 #define VIDIOC_MTK_S_VIDEO_FRAMERATE \
@@ -2,6 +2,7 @@
 // Copyright (c) 2020 MediaTek Inc.
 
 #include <linux/pm_runtime.h>
+#include <linux/sched.h>
 
 #include "kd_imgsensor_define_v4l2.h"
 #include "adaptor.h"
@@ -405,7 +406,7 @@ static int set_hdr_gain_dual(struct adaptor_ctx *ctx, struct mtk_hdr_gain *info)
 	return 0;
 }
 
-static int do_set_ae_ctrl(struct adaptor_ctx *ctx,
+static int apply_ae_ctrl(struct adaptor_ctx *ctx,
 						  struct mtk_hdr_ae *ae_ctrl)
 {
 	union feature_para para;
@@ -498,10 +499,77 @@ static int do_set_ae_ctrl(struct adaptor_ctx *ctx,
 	return 0;
 }
 
+/*
+ * Shutter, gain and the frame length frame-sync writes back are staged in
+ * ctx->ae_batch and sent as one i2c_transfer(), between the group hold
+ * writes of the subdrv, instead of one transfer per register.
+ */
+static int do_set_ae_ctrl(struct adaptor_ctx *ctx,
+			  struct mtk_hdr_ae *ae_ctrl, u64 queue_ns)
+{
+	int ret;
+
+	adaptor_i2c_batch_begin(&ctx->ae_batch, ctx->subctx.i2c_client);
+	ctx->subctx.i2c_batch = &ctx->ae_batch;
+	apply_ae_ctrl(ctx, ae_ctrl);
+	ctx->subctx.i2c_batch = NULL;
+	ret = adaptor_i2c_batch_flush(&ctx->ae_batch);
+
+	spin_lock(&ctx->ae_commit_lock);
+	ctx->ae_commit.queue_ns = queue_ns;
+	ctx->ae_commit.done_ns = ktime_get_boottime_ns();
+	ctx->ae_commit.done_seq++;
+	ctx->ae_commit.n_msgs = ctx->ae_batch.msgs;
+	ctx->ae_commit.n_xfers = ctx->ae_batch.xfers;
+	spin_unlock(&ctx->ae_commit_lock);
+
+	return ret;
+}
+
+/* apply the AE controls queued for the worker, with ctx->mutex held */
+static void drain_ae_ctrl(struct adaptor_ctx *ctx)
+{
+	u32 i;
+
+	while (ctx->ae_tail != ctx->ae_head) {
+		i = ctx->ae_tail % AE_QUEUE_SIZE;
+		do_set_ae_ctrl(ctx, &ctx->ae_queue[i], ctx->ae_queue_ns[i]);
+		ctx->ae_tail++;
+	}
+}
+
+static void ae_commit_work(struct kthread_work *work)
+{
+	struct adaptor_ctx *ctx = container_of(work, struct adaptor_ctx,
+					       ae_work);
+
+	mutex_lock(&ctx->mutex);
+	if (pm_runtime_get_if_in_use(ctx->dev) == 0) {
+		ctx->ae_tail = ctx->ae_head;
+	} else {
+		drain_ae_ctrl(ctx);
+		pm_runtime_put(ctx->dev);
+	}
+	mutex_unlock(&ctx->mutex);
+}
+
+void adaptor_ae_drain(struct adaptor_ctx *ctx)
+{
+	mutex_lock(&ctx->mutex);
+	if (ctx->ae_async && ctx->ae_tail != ctx->ae_head &&
+	    pm_runtime_get_if_in_use(ctx->dev) > 0) {
+		drain_ae_ctrl(ctx);
+		pm_runtime_put(ctx->dev);
+	}
+	mutex_unlock(&ctx->mutex);
+}
+
 static int s_ae_ctrl(struct v4l2_ctrl *ctrl)
 {
 	struct adaptor_ctx *ctx = ctrl_to_ctx(ctrl);
 	struct mtk_hdr_ae *ae_ctrl = ctrl->p_new.p;
+	u64 now = ktime_get_boottime_ns();
+	u32 i;
 
 	memcpy(&ctx->ae_memento, ae_ctrl,
 		   sizeof(ctx->ae_memento));
@@ -510,7 +578,29 @@ static int s_ae_ctrl(struct v4l2_ctrl *ctrl)
 		return 0;
 	}
 
-	return do_set_ae_ctrl(ctx, ae_ctrl);
+	spin_lock(&ctx->ae_commit_lock);
+	ctx->ae_commit.seq++;
+	spin_unlock(&ctx->ae_commit_lock);
+
+	if (!ctx->ae_async)
+		return do_set_ae_ctrl(ctx, ae_ctrl, now);
+
+	/*
+	 * Leave the i2c writes to the AE worker so that the camsys sensor
+	 * worker returns right away; the worker takes ctx->mutex, so it
+	 * runs once the whole request is set up. A full queue means the
+	 * worker is a few frames behind: catch up here.
+	 */
+	if (ctx->ae_head - ctx->ae_tail == AE_QUEUE_SIZE)
+		drain_ae_ctrl(ctx);
+
+	i = ctx->ae_head % AE_QUEUE_SIZE;
+	memcpy(&ctx->ae_queue[i], ae_ctrl, sizeof(ctx->ae_queue[i]));
+	ctx->ae_queue_ns[i] = now;
+	ctx->ae_head++;
+	kthread_queue_work(ctx->ae_worker, &ctx->ae_work);
+
+	return 0;
 }
 
 static int g_volatile_temperature(struct adaptor_ctx *ctx,
@@ -800,6 +890,10 @@ static int imgsensor_set_ctrl(struct v4l2_ctrl *ctrl)
 	if (pm_runtime_get_if_in_use(dev) == 0)
 		return 0;
 
+	/* anything else goes to the sensor after the AE queued before it */
+	if (ctrl->id != V4L2_CID_MTK_STAGGER_AE_CTRL)
+		drain_ae_ctrl(ctx);
+
 	switch (ctrl->id) {
 	case V4L2_CID_VSYNC_NOTIFY:
 		subdrv_call(ctx, vsync_notify, (u64)ctrl->val);
@@ -1613,7 +1707,47 @@ void restore_ae_ctrl(struct adaptor_ctx *ctx)
 		!ctx->ae_memento.gain.le_gain) {
 		return;
 	}
-	do_set_ae_ctrl(ctx, &ctx->ae_memento);
+	spin_lock(&ctx->ae_commit_lock);
+	ctx->ae_commit.seq++;
+	spin_unlock(&ctx->ae_commit_lock);
+
+	do_set_ae_ctrl(ctx, &ctx->ae_memento, ktime_get_boottime_ns());
+}
+
+void adaptor_ae_reset(struct adaptor_ctx *ctx, bool async)
+{
+	ctx->ae_tail = ctx->ae_head;
+	ctx->ae_async = async && ctx->ae_worker;
+
+	spin_lock(&ctx->ae_commit_lock);
+	memset(&ctx->ae_commit, 0, sizeof(ctx->ae_commit));
+	spin_unlock(&ctx->ae_commit_lock);
+}
+
+int adaptor_ae_init(struct adaptor_ctx *ctx)
+{
+	spin_lock_init(&ctx->ae_commit_lock);
+	kthread_init_work(&ctx->ae_work, ae_commit_work);
+
+	ctx->ae_worker = kthread_create_worker(0, "%s-ae",
+					       dev_name(ctx->dev));
+	if (IS_ERR(ctx->ae_worker)) {
+		int ret = PTR_ERR(ctx->ae_worker);
+
+		ctx->ae_worker = NULL;
+		return ret;
+	}
+	/* same class as the camsys sensor worker feeding it */
+	sched_set_fifo(ctx->ae_worker->task);
+
+	return 0;
+}
+
+void adaptor_ae_exit(struct adaptor_ctx *ctx)
+{
+	if (ctx->ae_worker)
+		kthread_destroy_worker(ctx->ae_worker);
+	ctx->ae_worker = NULL;
 }
 
 int adaptor_init_ctrls(struct adaptor_ctx *ctx)
@@ -8,6 +8,17 @@ int adaptor_init_ctrls(struct adaptor_ctx *ctx);
 
 void restore_ae_ctrl(struct adaptor_ctx *ctx);
 
+/* AE commit worker, see do_set_ae_ctrl() */
+int adaptor_ae_init(struct adaptor_ctx *ctx);
+
+void adaptor_ae_exit(struct adaptor_ctx *ctx);
+
+/* drop queued AE controls and stats, called under ctx->mutex */
+void adaptor_ae_reset(struct adaptor_ctx *ctx, bool async);
+
+/* apply the queued AE controls before another sensor write */
+void adaptor_ae_drain(struct adaptor_ctx *ctx);
+
 void adaptor_sensor_init(struct adaptor_ctx *ctx);
 
 /* callback function for frame-sync set framelength using */
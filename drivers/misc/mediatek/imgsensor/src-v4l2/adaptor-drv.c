@@ -40,6 +40,10 @@ static struct subdrv_entry *imgsensor_subdrvs[] = {
 module_param(sensor_debug, uint, 0644);
 MODULE_PARM_DESC(sensor_debug, "imgsensor_debug");
 
+static bool ae_async;
+module_param(ae_async, bool, 0644);
+MODULE_PARM_DESC(ae_async, "apply AE controls from a per-sensor worker");
+
 static int get_outfmt_code(struct adaptor_ctx *ctx)
 {
 	int outfmt = ctx->sensor_info.SensorOutputDataFormat;
@@ -709,6 +713,8 @@ static int imgsensor_start_streaming(struct adaptor_ctx *ctx)
 
 	adaptor_sensor_init(ctx);
 
+	adaptor_ae_reset(ctx, ae_async);
+
 	control_sensor(ctx);
 
 #ifdef APPLY_CUSTOMIZED_VALUES_FROM_USER
@@ -743,6 +749,7 @@ static int imgsensor_stop_streaming(struct adaptor_ctx *ctx)
 	notify_fsync_mgr_streaming(ctx, 0);
 
 	memset(&ctx->ae_memento, 0, sizeof(ctx->ae_memento));
+	adaptor_ae_reset(ctx, false);
 
 	return 0;
 }
@@ -1242,6 +1249,11 @@ static int imgsensor_probe(struct i2c_client *client)
 		return ret;
 	}
 
+	/* AE controls still apply synchronously without it */
+	ret = adaptor_ae_init(ctx);
+	if (ret)
+		dev_info(dev, "failed to create AE worker (%d)\n", ret);
+
 	ret = media_entity_pads_init(&ctx->sd.entity, 1, &ctx->pad);
 	if (ret < 0) {
 		dev_err(dev, "failed to init entity pads: %d", ret);
@@ -1282,6 +1294,7 @@ free_entity:
 	media_entity_cleanup(&ctx->sd.entity);
 
 free_ctrl:
+	adaptor_ae_exit(ctx);
 	v4l2_ctrl_handler_free(&ctx->ctrls);
 	mutex_destroy(&ctx->mutex);
 
@@ -1295,6 +1308,7 @@ static int imgsensor_remove(struct i2c_client *client)
 
 	v4l2_async_unregister_subdev(sd);
 	media_entity_cleanup(&sd->entity);
+	adaptor_ae_exit(ctx);
 	v4l2_ctrl_handler_free(sd->ctrl_handler);
 
 	notify_fsync_mgr(ctx, 0);
@@ -458,3 +458,87 @@ int adaptor_i2c_wr_regs_u16(struct i2c_client *i2c_client,
 	return 0;
 }
 
+void adaptor_i2c_batch_begin(struct adaptor_i2c_batch *batch,
+		struct i2c_client *i2c_client)
+{
+	batch->i2c_client = i2c_client;
+	batch->n_msgs = 0;
+	batch->msgs = 0;
+	batch->xfers = 0;
+}
+
+int adaptor_i2c_batch_flush(struct adaptor_i2c_batch *batch)
+{
+	struct i2c_client *i2c_client = batch->i2c_client;
+	const struct i2c_adapter_quirks *q = i2c_client->adapter->quirks;
+	int ret, sent, cnt, max = batch->n_msgs;
+
+	/* the adapter may not take them all in one go */
+	if (q && (q->flags & I2C_AQ_NO_REP_START))
+		max = 1;
+	else if (q && q->max_num_msgs)
+		max = min_t(int, max, q->max_num_msgs);
+
+	for (sent = 0; sent < batch->n_msgs; sent += cnt) {
+		cnt = min(batch->n_msgs - sent, max);
+
+		ret = i2c_transfer(i2c_client->adapter,
+				   &batch->msg[sent], cnt);
+		batch->xfers++;
+		if (ret != cnt) {
+			dev_err(&i2c_client->dev,
+				"i2c transfer failed (%d)\n", ret);
+			batch->n_msgs = 0;
+			return -EIO;
+		}
+		batch->msgs += cnt;
+	}
+	batch->n_msgs = 0;
+
+	return 0;
+}
+
+static int adaptor_i2c_batch_add(struct adaptor_i2c_batch *batch,
+		u16 addr, u16 reg, u16 val, int val_len)
+{
+	struct i2c_msg *pmsg;
+	u8 *pbuf;
+	int ret;
+
+	if (batch->n_msgs == ARRAY_SIZE(batch->msg)) {
+		ret = adaptor_i2c_batch_flush(batch);
+		if (ret)
+			return ret;
+	}
+
+	pbuf = &batch->buf[batch->n_msgs * 4];
+	pmsg = &batch->msg[batch->n_msgs++];
+
+	pbuf[0] = reg >> 8;
+	pbuf[1] = reg & 0xff;
+	if (val_len == 2) {
+		pbuf[2] = val >> 8;
+		pbuf[3] = val & 0xff;
+	} else {
+		pbuf[2] = val & 0xff;
+	}
+
+	pmsg->addr = addr;
+	pmsg->flags = batch->i2c_client->flags;
+	pmsg->len = 2 + val_len;
+	pmsg->buf = pbuf;
+
+	return 0;
+}
+
+int adaptor_i2c_batch_wr_u8(struct adaptor_i2c_batch *batch,
+		u16 addr, u16 reg, u8 val)
+{
+	return adaptor_i2c_batch_add(batch, addr, reg, val, 1);
+}
+
+int adaptor_i2c_batch_wr_u16(struct adaptor_i2c_batch *batch,
+		u16 addr, u16 reg, u16 val)
+{
+	return adaptor_i2c_batch_add(batch, addr, reg, val, 2);
+}
@@ -4,6 +4,25 @@
 #ifndef __ADAPTOR_I2C_H__
 #define __ADAPTOR_I2C_H__
 
+#include <linux/i2c.h>
+
+#define ADAPTOR_I2C_BATCH_MSGS 64
+
+/*
+ * Single register writes staged while subctx->i2c_batch is set, then sent
+ * back to back in one i2c_transfer() by adaptor_i2c_batch_flush(). Any
+ * other access through the subdrv_i2c_* macros flushes first, so the
+ * order on the bus is the order of the calls.
+ */
+struct adaptor_i2c_batch {
+	struct i2c_client *i2c_client;
+	int n_msgs;
+	u32 msgs; /* messages sent since begin */
+	u32 xfers; /* i2c_transfer() calls since begin */
+	struct i2c_msg msg[ADAPTOR_I2C_BATCH_MSGS];
+	u8 buf[ADAPTOR_I2C_BATCH_MSGS * 4];
+};
+
 int adaptor_i2c_rd_u8(struct i2c_client *i2c_client,
 		u16 addr, u16 reg, u8 *val);
 
@@ -34,4 +53,15 @@ int adaptor_i2c_wr_regs_u8(struct i2c_client *i2c_client,
 int adaptor_i2c_wr_regs_u16(struct i2c_client *i2c_client,
 		u16 addr, u16 *list, u32 len);
 
+void adaptor_i2c_batch_begin(struct adaptor_i2c_batch *batch,
+		struct i2c_client *i2c_client);
+
+int adaptor_i2c_batch_wr_u8(struct adaptor_i2c_batch *batch,
+		u16 addr, u16 reg, u8 val);
+
+int adaptor_i2c_batch_wr_u16(struct adaptor_i2c_batch *batch,
+		u16 addr, u16 reg, u16 val);
+
+int adaptor_i2c_batch_flush(struct adaptor_i2c_batch *batch);
+
 #endif
@@ -9,6 +9,7 @@
 #include "adaptor-ioctl.h"
 #include "adaptor-common-ctrl.h"
 #include "adaptor-i2c.h"
+#include "adaptor-ctrls.h"
 
 #define GAIN_TBL_SIZE 4096
 #define sd_to_ctx(__sd) container_of(__sd, struct adaptor_ctx, sd)
@@ -1108,6 +1109,18 @@ static int g_max_exposure_line_ioctl(struct adaptor_ctx *ctx, void *arg)
 	return g_max_exposure_line(ctx, target->scenario_id, target);
 }
 
+/* no ctx->mutex: camsys polls it while the AE worker may hold it */
+static int g_ae_commit(struct adaptor_ctx *ctx, void *arg)
+{
+	struct mtk_ae_commit *info = arg;
+
+	spin_lock(&ctx->ae_commit_lock);
+	memcpy(info, &ctx->ae_commit, sizeof(*info));
+	spin_unlock(&ctx->ae_commit_lock);
+
+	return 0;
+}
+
 static int g_seamless_switch_scenario(struct adaptor_ctx *ctx, void *arg)
 {
 	struct mtk_seamless_target_scenarios *target = arg;
@@ -1382,7 +1395,11 @@ static const struct ioctl_entry ioctl_list[] = {
 	{VIDIOC_MTK_G_OUTPUT_FORMAT_BY_SCENARIO, g_output_format_by_scenario},
 	{VIDIOC_MTK_G_FINE_INTEG_LINE_BY_SCENARIO, g_fine_integ_line_by_scenario},
 	{VIDIOC_MTK_G_MAX_EXPOSURE_LINE, g_max_exposure_line_ioctl},
-	/* SET */
+	{VIDIOC_MTK_G_AE_COMMIT, g_ae_commit},
+};
+
+/* these write the sensor, after the AE controls queued before them */
+static const struct ioctl_entry ioctl_set_list[] = {
 	{VIDIOC_MTK_S_VIDEO_FRAMERATE, s_video_framerate},
 	{VIDIOC_MTK_S_MAX_FPS_BY_SCENARIO, s_max_fps_by_scenario},
 	{VIDIOC_MTK_S_FRAMERATE, s_framerate},
@@ -1403,7 +1420,14 @@ long adaptor_ioctl(struct v4l2_subdev *sd, unsigned int cmd, void *arg)
 	/* dispatch ioctl request */
 	for (i = 0; i < ARRAY_SIZE(ioctl_list); i++) {
 		if (ioctl_list[i].cmd == cmd) {
-			ret = ioctl_list[i].func(ctx, arg);
+			return ioctl_list[i].func(ctx, arg);
+		}
+	}
+
+	for (i = 0; i < ARRAY_SIZE(ioctl_set_list); i++) {
+		if (ioctl_set_list[i].cmd == cmd) {
+			adaptor_ae_drain(ctx);
+			ret = ioctl_set_list[i].func(ctx, arg);
 			break;
 		}
 	}
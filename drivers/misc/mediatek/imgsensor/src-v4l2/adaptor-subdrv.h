@@ -50,6 +50,9 @@ struct subdrv_pw_seq_entry {
 #define PDAF_CAP_DIFF_DATA_IN_VC 0x4
 #define PDAF_CAP_PDFOCUS_AREA 0x10
 
+struct sensor_mode_delta;
+struct adaptor_i2c_batch;
+
 struct subdrv_ctx {
 
 	/* for i2c */
@@ -106,6 +109,13 @@ struct subdrv_ctx {
 	u32 is_read_preload_eeprom;
 	u32 is_read_four_cell;
 	bool is_streaming;
+
+	/* mode switch deltas, see common/sensor_mode_delta.h */
+	struct sensor_mode_delta *mode_delta;
+	u8 reg_mode; /* mode table held by the sensor, 1-based, 0 unknown */
+
+	/* single writes are staged here while set, see adaptor-i2c.h */
+	struct adaptor_i2c_batch *i2c_batch;
 };
 
 struct subdrv_ops {
@@ -162,9 +172,15 @@ struct subdrv_entry {
 	__ret; \
 })
 
+/* send the writes staged in subctx->i2c_batch, if any */
+#define subdrv_i2c_sync(subctx) \
+	((subctx)->i2c_batch ? \
+		adaptor_i2c_batch_flush((subctx)->i2c_batch) : 0)
+
 #define subdrv_i2c_rd_u8(subctx, reg) \
 ({ \
 	u8 __val = 0xff; \
+	subdrv_i2c_sync(subctx); \
 	adaptor_i2c_rd_u8(subctx->i2c_client, \
 		subctx->i2c_write_id >> 1, reg, &__val); \
 	__val; \
@@ -173,38 +189,50 @@ struct subdrv_entry {
 #define subdrv_i2c_rd_u16(subctx, reg) \
 ({ \
 	u16 __val = 0xffff; \
+	subdrv_i2c_sync(subctx); \
 	adaptor_i2c_rd_u16(subctx->i2c_client, \
 		subctx->i2c_write_id >> 1, reg, &__val); \
 	__val; \
 })
 
 #define subdrv_i2c_wr_u8(subctx, reg, val) \
+	((subctx)->i2c_batch ? \
+	adaptor_i2c_batch_wr_u8((subctx)->i2c_batch, \
+		subctx->i2c_write_id >> 1, reg, val) : \
 	adaptor_i2c_wr_u8(subctx->i2c_client, \
-		subctx->i2c_write_id >> 1, reg, val)
+		subctx->i2c_write_id >> 1, reg, val))
 
 #define subdrv_i2c_wr_u16(subctx, reg, val) \
+	((subctx)->i2c_batch ? \
+	adaptor_i2c_batch_wr_u16((subctx)->i2c_batch, \
+		subctx->i2c_write_id >> 1, reg, val) : \
 	adaptor_i2c_wr_u16(subctx->i2c_client, \
-		subctx->i2c_write_id >> 1, reg, val)
+		subctx->i2c_write_id >> 1, reg, val))
 
 #define subdrv_i2c_wr_p8(subctx, reg, p_vals, n_vals) \
+	((void)subdrv_i2c_sync(subctx), \
 	adaptor_i2c_wr_p8(subctx->i2c_client, \
-		subctx->i2c_write_id >> 1, reg, p_vals, n_vals)
+		subctx->i2c_write_id >> 1, reg, p_vals, n_vals))
 
 #define subdrv_i2c_wr_p16(subctx, reg, p_vals, n_vals) \
+	((void)subdrv_i2c_sync(subctx), \
 	adaptor_i2c_wr_p16(subctx->i2c_client, \
-		subctx->i2c_write_id >> 1, reg, p_vals, n_vals)
+		subctx->i2c_write_id >> 1, reg, p_vals, n_vals))
 
 #define subdrv_i2c_wr_seq_p8(subctx, reg, p_vals, n_vals) \
+	((void)subdrv_i2c_sync(subctx), \
 	adaptor_i2c_wr_seq_p8(subctx->i2c_client, \
-		subctx->i2c_write_id >> 1, reg, p_vals, n_vals)
+		subctx->i2c_write_id >> 1, reg, p_vals, n_vals))
 
 #define subdrv_i2c_wr_regs_u8(subctx, list, len) \
+	((void)subdrv_i2c_sync(subctx), \
 	adaptor_i2c_wr_regs_u8(subctx->i2c_client, \
-		subctx->i2c_write_id >> 1, list, len)
+		subctx->i2c_write_id >> 1, list, len))
 
 #define subdrv_i2c_wr_regs_u16(subctx, list, len) \
+	((void)subdrv_i2c_sync(subctx), \
 	adaptor_i2c_wr_regs_u16(subctx->i2c_client, \
-		subctx->i2c_write_id >> 1, list, len)
+		subctx->i2c_write_id >> 1, list, len))
 
 #define FINE_INTEG_CONVERT(_shutter, _fine_integ) \
 ( \
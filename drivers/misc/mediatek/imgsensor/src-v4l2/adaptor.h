@@ -5,6 +5,8 @@
 #define __ADAPTOR_H__
 
 #include <linux/i2c.h>
+#include <linux/kthread.h>
+#include <linux/spinlock.h>
 #include <media/v4l2-ctrls.h>
 #include <media/v4l2-fwnode.h>
 #include <media/v4l2-subdev.h>
@@ -17,6 +19,7 @@
 #include <linux/pinctrl/consumer.h>
 
 #include "adaptor-def.h"
+#include "adaptor-i2c.h"
 #include "adaptor-subdrv.h"
 #include "imgsensor-user.h"
 
@@ -25,6 +28,8 @@
 
 #define to_ctx(__sd) container_of(__sd, struct adaptor_ctx, sd)
 
+#define AE_QUEUE_SIZE 4
+
 struct adaptor_ctx;
 static unsigned int sensor_debug;
 
@@ -143,6 +148,20 @@ struct adaptor_ctx {
 
 	unsigned int *sensor_debug_flag;
 	u32 shutter_for_timeout;
+
+	/* AE commit, see do_set_ae_ctrl() */
+	struct adaptor_i2c_batch ae_batch;
+	struct kthread_worker *ae_worker;
+	struct kthread_work ae_work;
+	bool ae_async; /* latched at stream on */
+	/* staged AE controls, under mutex */
+	struct mtk_hdr_ae ae_queue[AE_QUEUE_SIZE];
+	u64 ae_queue_ns[AE_QUEUE_SIZE];
+	u32 ae_head;
+	u32 ae_tail;
+	/* read by VIDIOC_MTK_G_AE_COMMIT without mutex */
+	spinlock_t ae_commit_lock;
+	struct mtk_ae_commit ae_commit;
 };
 
 #endif
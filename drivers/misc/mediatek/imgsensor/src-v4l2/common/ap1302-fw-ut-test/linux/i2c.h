@@ -0,0 +1,56 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Copyright (c) 2023 MediaTek Inc.
+ */
+
+#ifndef __AP1302_FW_UT_LINUX_I2C_H
+#define __AP1302_FW_UT_LINUX_I2C_H
+
+/*
+ * host stand-in for the kernel header, AP1302_FW_UT only. Just what
+ * ap1302_fw_xfer.h uses, i2c_transfer() is the stub adapter in the test.
+ */
+#include <errno.h>
+#include <linux/types.h>
+
+#define I2C_M_NOSTART		0x4000
+#define I2C_M_DMA_SAFE		0x0200
+
+#define I2C_FUNC_NOSTART	0x00000010
+
+#define I2C_AQ_NO_REP_START	(1 << 7)
+
+struct i2c_msg {
+	u16 addr;
+	u16 flags;
+	u16 len;
+	u8 *buf;
+};
+
+struct i2c_adapter_quirks {
+	u64 flags;
+	int max_num_msgs;
+	u16 max_write_len;
+	u16 max_read_len;
+	u16 max_comb_1st_msg_len;
+	u16 max_comb_2nd_msg_len;
+};
+
+struct i2c_adapter {
+	const struct i2c_adapter_quirks *quirks;
+	u32 functionality;
+};
+
+struct i2c_client {
+	unsigned short addr;
+	struct i2c_adapter *adapter;
+};
+
+static inline int i2c_check_functionality(struct i2c_adapter *adap, u32 func)
+{
+	return (adap->functionality & func) == func;
+}
+
+int i2c_transfer(struct i2c_adapter *adap, struct i2c_msg *msgs, int num);
+
+#endif
@@ -0,0 +1,18 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Copyright (c) 2023 MediaTek Inc.
+ */
+
+#ifndef __AP1302_FW_UT_LINUX_TYPES_H
+#define __AP1302_FW_UT_LINUX_TYPES_H
+
+/* host stand-in for the kernel header, AP1302_FW_UT only */
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+#endif
@@ -0,0 +1,349 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright (c) 2023 MediaTek Inc.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ap1302_fw_xfer.h"
+
+#define NONE           "\033[m"
+#define RED            "\033[0;32;31m"
+#define GREEN          "\033[0;32;32m"
+
+/* AR0830AP1302_FW_WINDOW_* */
+#define UT_WIN_OFFSET	0x8000
+#define UT_WIN_SIZE	0x2000
+#define UT_I2C_ADDR	0x3c
+
+#define UT_FW_MAX	(5 * UT_WIN_SIZE + 123)
+/* payload, two address bytes and a START per byte at worst */
+#define UT_BUS_MAX	(UT_FW_MAX * 4)
+
+/* a START on the bus, followed by the slave address */
+#define UT_START	0x100
+
+static int ut_fail;
+static int ut_cnt;
+
+#define UT_CHECK(cond, fmt, args...)					\
+do {									\
+	ut_cnt++;							\
+	if (!(cond)) {							\
+		ut_fail++;						\
+		printf(RED "[FAIL] %s:%d " fmt NONE "\n",		\
+		       __func__, __LINE__, ##args);			\
+	}								\
+} while (0)
+
+/* what a bus analyser would see behind the stub adapter */
+struct ut_bus {
+	u16 wire[UT_BUS_MAX];
+	unsigned int len;
+	unsigned int transfers;
+	unsigned int fail_at;	/* 1-based transfer to fail, 0 never */
+
+	/* the bootdata, to tell messages sent in place */
+	const u8 *fw;
+	u32 fw_len;
+	unsigned int in_place;
+	unsigned int bad_msg;
+};
+
+static struct ut_bus bus;
+
+int i2c_transfer(struct i2c_adapter *adap, struct i2c_msg *msgs, int num)
+{
+	const struct i2c_adapter_quirks *q = adap->quirks;
+	int i, j;
+
+	bus.transfers++;
+	if (bus.fail_at && bus.transfers == bus.fail_at)
+		return -EREMOTEIO;
+
+	/* what the i2c core would refuse */
+	if (q && q->max_num_msgs && num > q->max_num_msgs)
+		return -EOPNOTSUPP;
+	if (q && (q->flags & I2C_AQ_NO_REP_START) && num > 1)
+		return -EOPNOTSUPP;
+
+	for (i = 0; i < num; i++) {
+		struct i2c_msg *msg = &msgs[i];
+
+		if (msg->addr != UT_I2C_ADDR ||
+		    !(msg->flags & I2C_M_DMA_SAFE) ||
+		    (q && q->max_write_len && msg->len > q->max_write_len))
+			bus.bad_msg++;
+
+		if (msg->flags & I2C_M_NOSTART) {
+			if (!i || !(adap->functionality & I2C_FUNC_NOSTART))
+				bus.bad_msg++;
+		} else {
+			bus.wire[bus.len++] = UT_START | msg->addr;
+		}
+
+		if (msg->buf >= bus.fw && msg->buf < bus.fw + bus.fw_len)
+			bus.in_place++;
+
+		for (j = 0; j < msg->len; j++)
+			bus.wire[bus.len++] = msg->buf[j];
+	}
+
+	return num;
+}
+
+/* the bus the original one i2c_master_send() per chunk loader produced */
+static unsigned int ut_reference(u16 *wire, const u8 *data, u32 len,
+				 unsigned int *win_pos, unsigned int chunk_max)
+{
+	unsigned int n = 0;
+
+	while (len > 0) {
+		unsigned int write_addr = *win_pos + UT_WIN_OFFSET;
+		unsigned int write_size = len;
+
+		if (write_size > UT_WIN_SIZE - *win_pos)
+			write_size = UT_WIN_SIZE - *win_pos;
+		if (write_size > chunk_max)
+			write_size = chunk_max;
+
+		wire[n++] = UT_START | UT_I2C_ADDR;
+		wire[n++] = (write_addr >> 8) & 0xff;
+		wire[n++] = (write_addr >> 0) & 0xff;
+
+		len -= write_size;
+		*win_pos += write_size;
+		if (*win_pos >= UT_WIN_SIZE)
+			*win_pos = 0;
+		while (write_size--)
+			wire[n++] = *data++;
+	}
+
+	return n;
+}
+
+static u8 fw[UT_FW_MAX];
+static u16 ref[UT_BUS_MAX];
+
+struct ut_case {
+	const char *name;
+	u32 functionality;
+	struct i2c_adapter_quirks quirks;
+	bool has_quirks;
+	unsigned int chunk_max;	/* expected, per chunk payload */
+	unsigned int batch;	/* expected, chunks per transfer */
+	bool in_place;		/* expected */
+};
+
+static void ut_download(const struct ut_case *tc, u32 pll_size, u32 fw_len)
+{
+	struct i2c_adapter adap = {
+		.quirks = tc->has_quirks ? &tc->quirks : NULL,
+		.functionality = tc->functionality,
+	};
+	struct i2c_client client = {
+		.addr = UT_I2C_ADDR,
+		.adapter = &adap,
+	};
+	struct ap1302_fw_xfer x;
+	unsigned int ref_pos = 0, ref_len, chunks, msgs;
+	int ret;
+
+	memset(&bus, 0, sizeof(bus));
+	bus.fw = fw;
+	bus.fw_len = fw_len;
+
+	ret = ap1302_fw_xfer_init(&x, &client, UT_WIN_OFFSET, UT_WIN_SIZE);
+	UT_CHECK(!ret, "%s: init %d", tc->name, ret);
+	if (ret)
+		return;
+
+	UT_CHECK(x.chunk_max == tc->chunk_max && x.batch == tc->batch &&
+		 x.in_place == tc->in_place,
+		 "%s: chunk %u batch %u in_place %d", tc->name,
+		 x.chunk_max, x.batch, x.in_place);
+
+	/* PLL init then the rest, as the subdrvs do */
+	ret = ap1302_fw_xfer_write(&x, fw, pll_size);
+	UT_CHECK(!ret, "%s: pll write %d", tc->name, ret);
+	ret = ap1302_fw_xfer_write(&x, fw + pll_size, fw_len - pll_size);
+	UT_CHECK(!ret, "%s: bulk write %d", tc->name, ret);
+
+	ref_len = ut_reference(ref, fw, pll_size, &ref_pos, tc->chunk_max);
+	ref_len += ut_reference(ref + ref_len, fw + pll_size,
+				fw_len - pll_size, &ref_pos, tc->chunk_max);
+
+	UT_CHECK(bus.len == ref_len &&
+		 !memcmp(bus.wire, ref, ref_len * sizeof(ref[0])),
+		 "%s: pll 0x%x len 0x%x: bus differs (%u vs %u)",
+		 tc->name, pll_size, fw_len, bus.len, ref_len);
+	UT_CHECK(!bus.bad_msg, "%s: %u bad messages", tc->name, bus.bad_msg);
+
+	chunks = 0;
+	for (msgs = 0; msgs < ref_len; msgs++)
+		chunks += !!(ref[msgs] & UT_START);
+	UT_CHECK(x.chunks == chunks, "%s: chunks %u vs %u",
+		 tc->name, x.chunks, chunks);
+	UT_CHECK(x.bytes == fw_len, "%s: bytes %llu vs %u", tc->name,
+		 (unsigned long long)x.bytes, fw_len);
+	UT_CHECK(x.win_pos == ref_pos, "%s: win_pos 0x%x vs 0x%x",
+		 tc->name, x.win_pos, ref_pos);
+	UT_CHECK(x.in_place ? bus.in_place == chunks : !bus.in_place,
+		 "%s: %u chunks sent in place", tc->name, bus.in_place);
+
+	/* one transfer per batch of chunks, per write call */
+	UT_CHECK(x.xfers == bus.transfers, "%s: xfers %u vs %u",
+		 tc->name, x.xfers, bus.transfers);
+	UT_CHECK(x.xfers <= (chunks + tc->batch - 1) / tc->batch + 2,
+		 "%s: %u transfers for %u chunks", tc->name, x.xfers, chunks);
+
+	ap1302_fw_xfer_exit(&x);
+}
+
+static const struct ut_case ut_cases[] = {
+	{
+		.name = "plain",
+		.chunk_max = UT_WIN_SIZE,
+		.batch = AP1302_FW_XFER_BATCH,
+	},
+	{
+		.name = "nostart",
+		.functionality = I2C_FUNC_NOSTART,
+		.chunk_max = UT_WIN_SIZE,
+		.batch = AP1302_FW_XFER_BATCH,
+		.in_place = true,
+	},
+	{
+		.name = "max_write_len",
+		.functionality = I2C_FUNC_NOSTART,
+		.quirks = { .max_write_len = 255 },
+		.has_quirks = true,
+		.chunk_max = 253,
+		.batch = AP1302_FW_XFER_BATCH,
+		.in_place = true,
+	},
+	{
+		.name = "max_num_msgs",
+		.functionality = I2C_FUNC_NOSTART,
+		.quirks = { .max_num_msgs = 5 },
+		.has_quirks = true,
+		.chunk_max = UT_WIN_SIZE,
+		.batch = 2,
+		.in_place = true,
+	},
+	{
+		.name = "one_msg",
+		.functionality = I2C_FUNC_NOSTART,
+		.quirks = { .max_num_msgs = 1, .max_write_len = 1026 },
+		.has_quirks = true,
+		.chunk_max = 1024,
+		.batch = 1,
+	},
+	{
+		.name = "no_rep_start",
+		.functionality = I2C_FUNC_NOSTART,
+		.quirks = { .flags = I2C_AQ_NO_REP_START },
+		.has_quirks = true,
+		.chunk_max = UT_WIN_SIZE,
+		.batch = 1,
+	},
+};
+
+static void ut_stream(void)
+{
+	static const u32 plls[] = {
+		0, 1, 0x100, UT_WIN_SIZE - 1, UT_WIN_SIZE, UT_WIN_SIZE + 1,
+		2 * UT_WIN_SIZE + 77,
+	};
+	static const u32 lens[] = {
+		UT_WIN_SIZE, 3 * UT_WIN_SIZE, UT_FW_MAX,
+	};
+	unsigned int c, i, j;
+
+	for (c = 0; c < sizeof(ut_cases) / sizeof(ut_cases[0]); c++)
+		for (i = 0; i < sizeof(plls) / sizeof(plls[0]); i++)
+			for (j = 0; j < sizeof(lens) / sizeof(lens[0]); j++)
+				if (plls[i] <= lens[j])
+					ut_download(&ut_cases[c], plls[i],
+						    lens[j]);
+}
+
+static void ut_error(void)
+{
+	static const struct i2c_adapter_quirks one_msg = { .max_num_msgs = 1 };
+	static const struct i2c_adapter_quirks no_room = { .max_write_len = 2 };
+	struct i2c_adapter adap = { 0 };
+	struct i2c_client client = {
+		.addr = UT_I2C_ADDR,
+		.adapter = &adap,
+	};
+	struct ap1302_fw_xfer x;
+	int ret;
+
+	memset(&bus, 0, sizeof(bus));
+	bus.fail_at = 1;
+
+	ret = ap1302_fw_xfer_init(&x, &client, UT_WIN_OFFSET, UT_WIN_SIZE);
+	UT_CHECK(!ret, "init %d", ret);
+
+	/* first batch fails, nothing accounted */
+	ret = ap1302_fw_xfer_write(&x, fw, 0x123);
+	UT_CHECK(ret == -EREMOTEIO, "ret %d", ret);
+	UT_CHECK(x.bytes == 0 && x.win_pos == 0, "bytes %llu win_pos 0x%x",
+		 (unsigned long long)x.bytes, x.win_pos);
+
+	/* the retry starts over at the same window position */
+	memset(&bus, 0, sizeof(bus));
+	ret = ap1302_fw_xfer_write(&x, fw, 0x123);
+	UT_CHECK(!ret && x.bytes == 0x123 && x.win_pos == 0x123,
+		 "ret %d bytes %llu win_pos 0x%x", ret,
+		 (unsigned long long)x.bytes, x.win_pos);
+	UT_CHECK(bus.wire[1] == 0x80 && bus.wire[2] == 0x00,
+		 "addr 0x%02x%02x", bus.wire[1], bus.wire[2]);
+	UT_CHECK(ap1302_fw_xfer_kbps(&x) > 0, "no throughput");
+
+	ap1302_fw_xfer_exit(&x);
+
+	/* one window per transfer, the third one fails */
+	adap.quirks = &one_msg;
+	memset(&bus, 0, sizeof(bus));
+	bus.fail_at = 3;
+	ret = ap1302_fw_xfer_init(&x, &client, UT_WIN_OFFSET, UT_WIN_SIZE);
+	UT_CHECK(!ret, "init %d", ret);
+	ret = ap1302_fw_xfer_write(&x, fw, 0x100);
+	UT_CHECK(!ret, "ret %d", ret);
+	ret = ap1302_fw_xfer_write(&x, fw + 0x100, 3 * UT_WIN_SIZE);
+	UT_CHECK(ret == -EREMOTEIO, "ret %d", ret);
+	/* the first window was completed, the failed one is not counted */
+	UT_CHECK(x.bytes == UT_WIN_SIZE && x.win_pos == 0,
+		 "bytes %llu win_pos 0x%x",
+		 (unsigned long long)x.bytes, x.win_pos);
+	ap1302_fw_xfer_exit(&x);
+
+	/* a write limit that leaves no room for the payload */
+	adap.quirks = &no_room;
+	ret = ap1302_fw_xfer_init(&x, &client, UT_WIN_OFFSET, UT_WIN_SIZE);
+	UT_CHECK(ret == -EINVAL, "ret %d", ret);
+}
+
+int main(void)
+{
+	unsigned int i;
+
+	srand(0x1302);
+	for (i = 0; i < UT_FW_MAX; i++)
+		fw[i] = rand() & 0xff;
+
+	ut_stream();
+	ut_error();
+
+	if (ut_fail)
+		printf(RED "[ap1302 fw xfer] %d/%d checks failed" NONE "\n",
+		       ut_fail, ut_cnt);
+	else
+		printf(GREEN "[ap1302 fw xfer] all %d checks passed" NONE "\n",
+		       ut_cnt);
+
+	return ut_fail ? 1 : 0;
+}
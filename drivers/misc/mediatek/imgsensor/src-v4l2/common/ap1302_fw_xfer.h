@@ -0,0 +1,222 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Copyright (c) 2023 MediaTek Inc.
+ */
+
+#ifndef _AP1302_FW_XFER_H
+#define _AP1302_FW_XFER_H
+
+/*
+ * AP1302 bootdata download, shared by the ar0830/ar0430 AP1302 subdrvs.
+ *
+ * The bootdata goes through a window in the register space: writes are
+ * sequential from win_offset and wrap after win_size bytes. Each write is
+ * a 16-bit register address followed by the payload, so the download is
+ * cut into chunks that never cross the end of the window nor exceed the
+ * adapter max_write_len, and a batch of chunks is sent as one
+ * i2c_transfer() with one message per chunk.
+ *
+ * When the adapter supports I2C_M_NOSTART, each chunk is an address
+ * message followed by a message pointing into the bootdata itself, which
+ * must then be DMA-safe (kmalloc'd). Otherwise the batch is framed into a
+ * bounce buffer allocated once per download. Either way the bytes on the
+ * bus are the same.
+ *
+ * Built on the host with -DAP1302_FW_UT, see ap1302-fw-ut-test.
+ */
+
+#ifdef AP1302_FW_UT
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#define GFP_KERNEL			0
+#define kmalloc(size, flags)		malloc(size)
+#define kmalloc_array(n, size, flags)	malloc((n) * (size))
+#define kfree(p)			free(p)
+#define min_t(t, a, b)			((t)(a) < (t)(b) ? (t)(a) : (t)(b))
+#define div64_u64(a, b)			((a) / (b))
+#else
+#include <linux/kernel.h>
+#include <linux/ktime.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#endif
+
+/* ap1302-fw-ut-test provides a stub adapter */
+#include <linux/i2c.h>
+
+#ifdef AP1302_FW_UT
+static inline u64 ktime_get_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+#define AP1302_FW_XFER_BATCH		8 /* chunks per i2c_transfer */
+
+struct ap1302_fw_xfer {
+	struct i2c_client *client;
+	u16 win_offset;
+	u16 win_size;
+	u16 chunk_max;		/* payload bytes per chunk */
+	u16 batch;		/* chunks per i2c_transfer */
+	bool in_place;		/* I2C_M_NOSTART, no bounce buffer */
+	unsigned int win_pos;
+
+	struct i2c_msg *msgs;
+	u8 *buf;		/* addresses, or framed chunks */
+
+	/* throughput since init */
+	u64 bytes;
+	u64 xfer_ns;
+	u32 xfers;
+	u32 chunks;
+};
+
+static inline int ap1302_fw_xfer_init(struct ap1302_fw_xfer *x,
+				      struct i2c_client *client,
+				      u16 win_offset, u16 win_size)
+{
+	struct i2c_adapter *adap = client->adapter;
+	const struct i2c_adapter_quirks *q = adap->quirks;
+	unsigned int max_msgs = 0;
+
+	memset(x, 0, sizeof(*x));
+	x->client = client;
+	x->win_offset = win_offset;
+	x->win_size = win_size;
+	x->chunk_max = win_size;
+	x->batch = AP1302_FW_XFER_BATCH;
+	x->in_place = i2c_check_functionality(adap, I2C_FUNC_NOSTART);
+
+	if (q) {
+		/* the limit covers the register address too */
+		if (q->max_write_len)
+			x->chunk_max = min_t(unsigned int, x->chunk_max,
+					     q->max_write_len > 2 ?
+					     q->max_write_len - 2 : 0);
+		if (q->flags & I2C_AQ_NO_REP_START) {
+			/* every chunk needs its own START */
+			x->in_place = false;
+			max_msgs = 1;
+		} else if (q->max_num_msgs) {
+			max_msgs = q->max_num_msgs;
+		}
+	}
+	if (max_msgs) {
+		if (x->in_place && max_msgs < 2)
+			x->in_place = false;
+		x->batch = min_t(unsigned int, x->batch,
+				 x->in_place ? max_msgs / 2 : max_msgs);
+	}
+	if (!x->chunk_max || !x->batch)
+		return -EINVAL;
+
+	x->msgs = kmalloc_array(x->batch * 2, sizeof(*x->msgs), GFP_KERNEL);
+	x->buf = kmalloc(x->in_place ? x->batch * 2 :
+			 x->batch * (x->chunk_max + 2), GFP_KERNEL);
+	if (!x->msgs || !x->buf) {
+		kfree(x->msgs);
+		kfree(x->buf);
+		x->msgs = NULL;
+		x->buf = NULL;
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+static inline void ap1302_fw_xfer_exit(struct ap1302_fw_xfer *x)
+{
+	kfree(x->msgs);
+	kfree(x->buf);
+	x->msgs = NULL;
+	x->buf = NULL;
+}
+
+/*
+ * Write @len bytes of bootdata at the current window position. Returns 0
+ * or the i2c_transfer() error, the window position is only advanced past
+ * the batches that went through.
+ */
+static inline int ap1302_fw_xfer_write(struct ap1302_fw_xfer *x,
+				       const u8 *data, u32 len)
+{
+	u16 addr = x->client->addr;
+	int ret;
+
+	while (len > 0) {
+		unsigned int win_pos = x->win_pos;
+		unsigned int n = 0;
+		int m = 0;
+		u8 *buf = x->buf;
+		u32 done = 0;
+		u64 start;
+
+		for (; n < x->batch && done < len; n++) {
+			unsigned int write_addr = win_pos + x->win_offset;
+			unsigned int write_size;
+
+			write_size = min_t(u32, len - done,
+					   x->win_size - win_pos);
+			write_size = min_t(u32, write_size, x->chunk_max);
+
+			buf[0] = (write_addr >> 8) & 0xff;
+			buf[1] = (write_addr >> 0) & 0xff;
+
+			if (x->in_place) {
+				x->msgs[m].addr = addr;
+				x->msgs[m].flags = I2C_M_DMA_SAFE;
+				x->msgs[m].len = 2;
+				x->msgs[m++].buf = buf;
+				x->msgs[m].addr = addr;
+				x->msgs[m].flags = I2C_M_NOSTART |
+						   I2C_M_DMA_SAFE;
+				x->msgs[m].len = write_size;
+				x->msgs[m++].buf = (u8 *)data + done;
+				buf += 2;
+			} else {
+				memcpy(&buf[2], data + done, write_size);
+				x->msgs[m].addr = addr;
+				x->msgs[m].flags = I2C_M_DMA_SAFE;
+				x->msgs[m].len = write_size + 2;
+				x->msgs[m++].buf = buf;
+				buf += write_size + 2;
+			}
+
+			done += write_size;
+			win_pos += write_size;
+			if (win_pos >= x->win_size)
+				win_pos = 0;
+		}
+
+		start = ktime_get_ns();
+		ret = i2c_transfer(x->client->adapter, x->msgs, m);
+		x->xfer_ns += ktime_get_ns() - start;
+		if (ret != m)
+			return ret < 0 ? ret : -EIO;
+
+		x->bytes += done;
+		x->xfers++;
+		x->chunks += n;
+		x->win_pos = win_pos;
+		data += done;
+		len -= done;
+	}
+
+	return 0;
+}
+
+/* KiB/s over the transfers so far */
+static inline u32 ap1302_fw_xfer_kbps(const struct ap1302_fw_xfer *x)
+{
+	u64 ns = x->xfer_ns ? x->xfer_ns : 1;
+
+	/* bytes * 1e9 / 1024 / ns */
+	return (u32)div64_u64(x->bytes * 1000000000ULL, ns * 1024);
+}
+
+#endif /* _AP1302_FW_XFER_H */
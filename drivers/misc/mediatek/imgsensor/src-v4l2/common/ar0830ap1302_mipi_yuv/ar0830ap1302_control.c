@@ -12,6 +12,7 @@
 #include <linux/delay.h>
 #include <linux/firmware.h>
 #include <linux/kernel.h>
+#include <linux/ktime.h>
 #include <linux/media.h>
 #include <media/media-entity.h>
 #include <media/v4l2-ctrls.h>
@@ -20,11 +21,17 @@
 #include "adaptor.h"
 #include "adaptor-hw.h"
 #include "ar0830ap1302_control.h"
+#include "../ap1302_fw_xfer.h"
 
 #define DRIVER_NAME "ar0830ap1302"
 
 #define AR0830AP1302_FW_WINDOW_SIZE		0x2000
 #define AR0830AP1302_FW_WINDOW_OFFSET	0x8000
+#define AR0830AP1302_POLL_MIN_US		1000
+#define AR0830AP1302_POLL_MAX_US		16000
+#define AR0830AP1302_CRC_TIMEOUT_MS		40
+#define AR0830AP1302_CHECK_TIMEOUT_MS		500
+#define AR0830AP1302_STALL_TIMEOUT_MS		100
 #define AR0830AP1302_MIN_WIDTH			24U
 #define AR0830AP1302_MIN_HEIGHT			16U
 #define AR0830AP1302_MAX_WIDTH			4224U
@@ -536,6 +543,36 @@ static int ar0830ap1302_read(struct ar0830ap1302_device *ar0830ap1302, u32 reg,
 	return __ar0830ap1302_read(ar0830ap1302, reg, val);
 }
 
+/*
+ * Poll @reg until (value & @mask) == @match, backing off from
+ * AR0830AP1302_POLL_MIN_US to AR0830AP1302_POLL_MAX_US between reads.
+ * Returns -ETIMEDOUT after @timeout_ms, @val holds the last value read.
+ */
+static int ar0830ap1302_poll(struct ar0830ap1302_device *ar0830ap1302, u32 reg,
+			     u32 mask, u32 match, unsigned int timeout_ms,
+			     u32 *val)
+{
+	ktime_t timeout = ktime_add_ms(ktime_get(), timeout_ms);
+	unsigned int delay_us = AR0830AP1302_POLL_MIN_US;
+	int ret;
+
+	for (;;) {
+		ret = ar0830ap1302_read(ar0830ap1302, reg, val);
+		if (ret < 0)
+			return ret;
+
+		if ((*val & mask) == match)
+			return 0;
+
+		if (ktime_after(ktime_get(), timeout))
+			return -ETIMEDOUT;
+
+		usleep_range(delay_us, delay_us + delay_us / 4);
+		delay_us = min_t(unsigned int, delay_us * 2,
+				 AR0830AP1302_POLL_MAX_US);
+	}
+}
+
 #if ENABLE_DEBUGFS
 /* -----------------------------------------------------------------------------
  * Sensor Registers Access
@@ -785,6 +822,22 @@ DEFINE_DEBUGFS_ATTRIBUTE(ar0830ap1302_sipm_addr_fops, ar0830ap1302_sipm_addr_get
 DEFINE_DEBUGFS_ATTRIBUTE(ar0830ap1302_sipm_data_fops, ar0830ap1302_sipm_data_get,
 			 ar0830ap1302_sipm_data_set, "0x%08llx\n");
 
+static int ar0830ap1302_boot_time_show(struct seq_file *s, void *unused)
+{
+	struct ar0830ap1302_device *ar0830ap1302 = s->private;
+	struct ar0830ap1302_boot_time *bt = &ar0830ap1302->boot_time;
+
+	seq_printf(s, "request_us: %u\npll_us: %u\nload_us: %u\n",
+		   bt->request_us, bt->pll_us, bt->load_us);
+	seq_printf(s, "check_us: %u\nstall_us: %u\n",
+		   bt->check_us, bt->stall_us);
+	seq_printf(s, "fw_bytes: %u\nfw_kbps: %u\n",
+		   bt->fw_bytes, bt->fw_kbps);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(ar0830ap1302_boot_time);
+
 static void ar0830ap1302_debugfs_init(struct ar0830ap1302_device *ar0830ap1302)
 {
 	struct dentry *dir;
@@ -804,6 +857,8 @@ static void ar0830ap1302_debugfs_init(struct ar0830ap1302_device *ar0830ap1302)
 				   ar0830ap1302, &ar0830ap1302_sipm_addr_fops);
 	debugfs_create_file_unsafe("sipm_data", 0600, ar0830ap1302->debugfs.dir,
 				   ar0830ap1302, &ar0830ap1302_sipm_data_fops);
+	debugfs_create_file("boot_time", 0444, ar0830ap1302->debugfs.dir,
+			    ar0830ap1302, &ar0830ap1302_boot_time_fops);
 }
 
 static void ar0830ap1302_debugfs_cleanup(struct ar0830ap1302_device *ar0830ap1302)
@@ -895,14 +950,13 @@ static int ar0830ap1302_configure(struct ar0830ap1302_device *ar0830ap1302)
 static int ar0830ap1302_stall(struct ar0830ap1302_device *ar0830ap1302, bool stall)
 {
 	int ret = 0;
-	int i;
 	u32 value;
 
 	ret = ar0830ap1302_read(ar0830ap1302, AR0830AP1302_SYS_START, &value);
 	if (ret < 0)
 		return ret;
 
-	if ((value & AR0830AP1302_SYS_START_STALL_STATUS) == stall) {
+	if (!!(value & AR0830AP1302_SYS_START_STALL_STATUS) == stall) {
 		dev_dbg(ar0830ap1302->dev, "Stall status = 0x%x, not need to set it again", value);
 		return 0;
 	}
@@ -920,7 +974,13 @@ static int ar0830ap1302_stall(struct ar0830ap1302_device *ar0830ap1302, bool sta
 		if (ret < 0)
 			return ret;
 
-		msleep(200);
+		/* the firmware reports STALL_STATUS once it has stopped */
+		ret = ar0830ap1302_poll(ar0830ap1302, AR0830AP1302_SYS_START,
+					AR0830AP1302_SYS_START_STALL_STATUS,
+					AR0830AP1302_SYS_START_STALL_STATUS,
+					AR0830AP1302_STALL_TIMEOUT_MS, &value);
+		if (ret < 0)
+			return ret;
 
 		ar0830ap1302_write(ar0830ap1302, AR0830AP1302_ADV_IRQ_SYS_INTE,
 			     AR0830AP1302_ADV_IRQ_SYS_INTE_SIPM |
@@ -944,23 +1004,32 @@ static int ar0830ap1302_stall(struct ar0830ap1302_device *ar0830ap1302, bool sta
  * Boot & Firmware Handling
  */
 
-int ar0830ap1302_request_firmware(struct ar0830ap1302_device *ar0830ap1302)
+static void ar0830ap1302_drop_firmware(void *data)
 {
-	// static const char * const suffixes[] = {
-	//  "",
-	//  "_single",
-	//  "_dual",
-	// };
+	struct ar0830ap1302_device *ar0830ap1302 = data;
+
+	kfree(ar0830ap1302->fw_data);
+	ar0830ap1302->fw_data = NULL;
+	ar0830ap1302->fw_size = 0;
+}
 
+int ar0830ap1302_request_firmware(struct ar0830ap1302_device *ar0830ap1302)
+{
 	const struct ar0830ap1302_firmware_header *fw_hdr;
-	// unsigned int num_sensors;
+	const struct firmware *fw;
 	unsigned int fw_size;
-	// unsigned int i;
-	// char name[64];
 	char name[] = "ap1302_ar0830_single_fw.bin";
+	ktime_t start;
 	int ret;
 
-	ret = request_firmware(&ar0830ap1302->fw, name, ar0830ap1302->dev);
+	/* parsed once, later power-ons reuse it */
+	if (ar0830ap1302->fw_data) {
+		ar0830ap1302->boot_time.request_us = 0;
+		return 0;
+	}
+
+	start = ktime_get();
+	ret = request_firmware(&fw, name, ar0830ap1302->dev);
 	if (ret) {
 		dev_err(ar0830ap1302->dev, "Failed to request firmware: %d\n", ret);
 		return ret;
@@ -972,70 +1041,64 @@ int ar0830ap1302_request_firmware(struct ar0830ap1302_device *ar0830ap1302)
 	 * to as bootdata) follows the header. Perform sanity checks to ensure
 	 * the firmware is valid.
 	 */
-	fw_hdr = (const struct ar0830ap1302_firmware_header *)ar0830ap1302->fw->data;
-	fw_size = ar0830ap1302->fw->size - sizeof(*fw_hdr);
+	if (fw->size < sizeof(*fw_hdr)) {
+		dev_err(ar0830ap1302->dev, "Invalid firmware: too small\n");
+		ret = -EINVAL;
+		goto done;
+	}
+
+	fw_hdr = (const struct ar0830ap1302_firmware_header *)fw->data;
+	fw_size = fw->size - sizeof(*fw_hdr);
 
 	if (fw_hdr->pll_init_size > fw_size) {
 		dev_err(ar0830ap1302->dev,
 			"Invalid firmware: PLL init size too large\n");
-		return -EINVAL;
+		ret = -EINVAL;
+		goto done;
 	}
 
-	return 0;
+	ar0830ap1302->fw_data = kmemdup(fw->data, fw->size, GFP_KERNEL);
+	if (!ar0830ap1302->fw_data) {
+		ret = -ENOMEM;
+		goto done;
+	}
+	ar0830ap1302->fw_size = fw->size;
+
+	/* imgsensor_info outlives the i2c device, drop the cache with it */
+	ret = devm_add_action_or_reset(ar0830ap1302->dev,
+				       ar0830ap1302_drop_firmware, ar0830ap1302);
+
+	ar0830ap1302->boot_time.request_us =
+		ktime_us_delta(ktime_get(), start);
+done:
+	release_firmware(fw);
+	return ret;
 }
 
 /*
  * ar0830ap1302_write_fw_window() - Write a piece of firmware to the AR0830AP1302
- * @win_pos: Firmware load window current position
  * @data: Firmware data buffer
  * @len: Firmware data length
- * @buf: Write buffer
+ * @xfer: Download state, keeps track of the window position
  *
  * The firmware is loaded through a window in the registers space. Writes are
  * sequential starting at address 0x8000, and must wrap around when reaching
- * 0x9fff. This function writes the firmware data stored in @data to the AR0830AP1302,
- * keeping track of the window position in the @win_pos argument.
- *
- * The write buffer is used to format the data to be written to the device
- * through I2C. It must be allocated by the caller, be suitable for DMA, be at
- * least AR0830AP1302_FW_WINDOW_OFFSET + 2 bytes long, and may be reused across
- * multiple calls to this function.
+ * 0x9fff. This function writes the firmware data stored in @data to the
+ * AR0830AP1302 in as few I2C transfers as the adapter allows, see
+ * ap1302_fw_xfer.h.
  */
 static int ar0830ap1302_write_fw_window(struct ar0830ap1302_device *ar0830ap1302, const u8 *data,
-				  u32 len, unsigned int *win_pos, u8 *buf)
+				  u32 len, struct ap1302_fw_xfer *xfer)
 {
-	while (len > 0) {
-		unsigned int write_addr;
-		unsigned int write_size;
-		int ret;
-
-		/*
-		 * Write at most len bytes, from the current position to the
-		 * end of the window.
-		 */
-		write_addr = *win_pos + AR0830AP1302_FW_WINDOW_OFFSET;
-		write_size = min(len, AR0830AP1302_FW_WINDOW_SIZE - *win_pos);
-
-		buf[0] = (write_addr >> 8) & 0xff;
-		buf[1] = (write_addr >> 0) & 0xff;
-
-		memcpy(&buf[2], data, write_size);
-
-		ret = i2c_master_send_dmasafe(ar0830ap1302->client, buf,
-					      write_size + 2);
-		if (ret != write_size + 2) {
-			dev_err(ar0830ap1302->dev,
-				"%s: firmware write @0x%04x failed: %d\n",
-				__func__, write_addr, ret);
-			return ret;
-		}
-
-		data += write_size;
-		len -= write_size;
+	unsigned int write_addr = xfer->win_pos + AR0830AP1302_FW_WINDOW_OFFSET;
+	int ret;
 
-		*win_pos += write_size;
-		if (*win_pos >= AR0830AP1302_FW_WINDOW_SIZE)
-			*win_pos = 0;
+	ret = ap1302_fw_xfer_write(xfer, data, len);
+	if (ret) {
+		dev_err(ar0830ap1302->dev,
+			"%s: firmware write @0x%04x+0x%x failed: %d\n",
+			__func__, write_addr, len, ret);
+		return ret;
 	}
 
 	return 0;
@@ -1046,12 +1109,13 @@ int ar0830ap1302_load_firmware(struct ar0830ap1302_device *ar0830ap1302)
 	const struct ar0830ap1302_firmware_header *fw_hdr;
 	unsigned int fw_size;
 	const u8 *fw_data;
-	unsigned int win_pos = 0;
+	struct ap1302_fw_xfer xfer;
 	unsigned int checksum;
 	unsigned int crc;
 	unsigned int stat;
+	struct ar0830ap1302_boot_time *bt = &ar0830ap1302->boot_time;
 	unsigned int retries;
-	u8 *buf;
+	ktime_t start;
 	int ret;
 
 	/* dbg start */
@@ -1063,13 +1127,15 @@ int ar0830ap1302_load_firmware(struct ar0830ap1302_device *ar0830ap1302)
 	dev_dbg(ar0830ap1302->dev, "Check f/w revision = 0x%x", stat);
 	/* dbg end */
 
-	buf = kmalloc(AR0830AP1302_FW_WINDOW_SIZE + 2, GFP_KERNEL);
-	if (!buf)
-		return -ENOMEM;
+	ret = ap1302_fw_xfer_init(&xfer, ar0830ap1302->client,
+				  AR0830AP1302_FW_WINDOW_OFFSET,
+				  AR0830AP1302_FW_WINDOW_SIZE);
+	if (ret)
+		return ret;
 
-	fw_hdr = (const struct ar0830ap1302_firmware_header *)ar0830ap1302->fw->data;
+	fw_hdr = (const struct ar0830ap1302_firmware_header *)ar0830ap1302->fw_data;
 	fw_data = (u8 *)&fw_hdr[1];
-	fw_size = ar0830ap1302->fw->size - sizeof(*fw_hdr);
+	fw_size = ar0830ap1302->fw_size - sizeof(*fw_hdr);
 	dev_dbg(ar0830ap1302->dev, "fw_size = 0x%x", fw_size);
 
 	/* dbg start */
@@ -1096,8 +1162,9 @@ int ar0830ap1302_load_firmware(struct ar0830ap1302_device *ar0830ap1302)
 	dev_dbg(ar0830ap1302->dev, "before2 , SYS_START = 0x%x", stat);
 	/* dbg end */
 
+	start = ktime_get();
 	ret = ar0830ap1302_write_fw_window(ar0830ap1302, fw_data, fw_hdr->pll_init_size,
-				     &win_pos, buf);
+				     &xfer);
 	if (ret)
 		goto done;
 
@@ -1111,55 +1178,78 @@ int ar0830ap1302_load_firmware(struct ar0830ap1302_device *ar0830ap1302)
 	dev_dbg(ar0830ap1302->dev, "PLL Init , SYS_START = 0x%x", stat);
 	/* dbg end */
 
+	bt->pll_us = ktime_us_delta(ktime_get(), start);
+
 	/* Load the rest of the bootdata content and verify the CHECKSUM or the CRC. */
+	start = ktime_get();
 	ret = ar0830ap1302_write_fw_window(ar0830ap1302, fw_data + fw_hdr->pll_init_size,
-				     fw_size - fw_hdr->pll_init_size, &win_pos,
-				     buf);
+				     fw_size - fw_hdr->pll_init_size, &xfer);
 	if (ret)
 		goto done;
 
-	msleep(40);
+	bt->fw_bytes = xfer.bytes;
+	bt->fw_kbps = ap1302_fw_xfer_kbps(&xfer);
+	dev_dbg(ar0830ap1302->dev, "fw: %u bytes in %u transfers, %u KiB/s%s",
+		bt->fw_bytes, xfer.xfers, bt->fw_kbps,
+		xfer.in_place ? " in place" : "");
 
-	ret = ar0830ap1302_read(ar0830ap1302, AR0830AP1302_SIP_CRC, &crc);
-	if (ret)
+	/* the CRC settles shortly after the last window write */
+	ret = ar0830ap1302_poll(ar0830ap1302, AR0830AP1302_SIP_CRC, 0xffff,
+				fw_hdr->check, AR0830AP1302_CRC_TIMEOUT_MS, &crc);
+	if (ret && ret != -ETIMEDOUT)
 		goto done;
+	bt->load_us = ktime_us_delta(ktime_get(), start);
 
 	/*
 	 * Write 0xffff to the bootdata_stage register to indicate to the
 	 * AR0830AP1302 that the whole bootdata content has been loaded.
 	 */
+	start = ktime_get();
 	ret = ar0830ap1302_write(ar0830ap1302, AR0830AP1302_BOOTDATA_STAGE, 0xffff, NULL);
 	if (ret)
 		goto done;
 
-	for (retries = 0; retries < MAX_CHECK_RETRIES; ++retries) {
-		ret = ar0830ap1302_read(ar0830ap1302, AR0830AP1302_BOOTDATA_CHECKSUM, &checksum);
+	checksum = 0;
+	if (crc != fw_hdr->check) {
+		/* a zero CHECKSUM means not computed yet, it cannot match 0 */
+		ret = fw_hdr->check ?
+			ar0830ap1302_poll(ar0830ap1302, AR0830AP1302_BOOTDATA_CHECKSUM,
+					  0xffff, fw_hdr->check,
+					  AR0830AP1302_CHECK_TIMEOUT_MS, &checksum) :
+			-ETIMEDOUT;
+		if (ret == -ETIMEDOUT) {
+			dev_err(ar0830ap1302->dev,
+					 "CHECK mismatch: expected 0x%04x, got CHECKSUM 0x%04x CRC 0x%04x\n",
+					 fw_hdr->check, checksum, crc);
+			ret = ar0830ap1302_read(ar0830ap1302, AR0830AP1302_ERROR, &stat);
+			dev_err(ar0830ap1302->dev, "AR0830AP1302_ERROR = 0x%x", stat);
+			ret = -EAGAIN;
+		}
 		if (ret)
 			goto done;
-
-		if ((checksum != 0 && checksum == fw_hdr->check) || crc == fw_hdr->check)
-			break;
-		ret = ar0830ap1302_read(ar0830ap1302, AR0830AP1302_SYS_START, &stat);
-		dev_dbg(ar0830ap1302->dev, "wait bootstage , SYS_START = 0x%x", stat);
-		msleep(100);
 	}
+	bt->check_us = ktime_us_delta(ktime_get(), start);
 
-	if (retries == MAX_CHECK_RETRIES) {
-		dev_err(ar0830ap1302->dev,
-				 "CHECK mismatch: expected 0x%04x, got CHECKSUM 0x%04x CRC 0x%04x\n",
-				 fw_hdr->check, checksum, crc);
-		ret = ar0830ap1302_read(ar0830ap1302, AR0830AP1302_ERROR, &stat);
-		dev_err(ar0830ap1302->dev, "AR0830AP1302_ERROR = 0x%x", stat);
-		ret = -EAGAIN;
-		goto done;
+	/*
+	 * The AR0830AP1302 starts outputting frames right after boot, stop it.
+	 * It only takes the stall request once booted, so keep asking until it
+	 * acknowledges rather than waiting a fixed time first.
+	 */
+	start = ktime_get();
+	for (retries = 0; retries < MAX_CHECK_RETRIES; ++retries) {
+		ret = ar0830ap1302_stall(ar0830ap1302, true);
+		if (ret != -ETIMEDOUT)
+			break;
 	}
-	msleep(300);
+	bt->stall_us = ktime_us_delta(ktime_get(), start);
 
-	/* The AR0830AP1302 starts outputting frames right after boot, stop it. */
-	ret = ar0830ap1302_stall(ar0830ap1302, true);
+	dev_info(ar0830ap1302->dev,
+		 "boot %d: request %u pll %u load %u check %u stall %u us, fw %u KiB/s\n",
+		 ret, bt->request_us, bt->pll_us, bt->load_us, bt->check_us,
+		 bt->stall_us, bt->fw_kbps);
 
 done:
-	kfree(buf);
+	ap1302_fw_xfer_exit(&xfer);
 	return ret;
 }
 static const char * const ar0830ap1302_lane_states[] = {
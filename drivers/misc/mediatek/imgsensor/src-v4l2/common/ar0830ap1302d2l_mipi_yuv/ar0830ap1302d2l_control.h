@@ -22,6 +22,17 @@ struct ar0830ap1302d2l_sensor {
 	// struct media_pad pad;
 };
 
+/* boot phases of the last firmware load, in us */
+struct ar0830ap1302d2l_boot_time {
+	u32 request_us;	/* 0 when the cached bootdata was used */
+	u32 pll_us;
+	u32 load_us;
+	u32 check_us;
+	u32 stall_us;
+	u32 fw_bytes;
+	u32 fw_kbps;	/* bootdata download throughput, KiB/s */
+};
+
 struct ar0830ap1302d2l_device {
 	struct device *dev;
 	struct i2c_client *client;
@@ -31,7 +42,13 @@ struct ar0830ap1302d2l_device {
 	// struct clk *clock;
 	u32 reg_page;
 
-	const struct firmware *fw;
+	/*
+	 * bootdata, cached from the first open until the device goes away.
+	 * kmalloc'd, so the firmware download can send it in place.
+	 */
+	const u8 *fw_data;
+	size_t fw_size;
+	struct ar0830ap1302d2l_boot_time boot_time;
 
 	// struct v4l2_fwnode_endpoint bus_cfg;
 
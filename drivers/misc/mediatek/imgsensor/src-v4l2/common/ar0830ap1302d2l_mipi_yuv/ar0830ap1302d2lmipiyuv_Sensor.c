@@ -320,7 +320,6 @@ static int open(struct subdrv_ctx *ctx)
 	ret = ar0830ap1302d2l_request_firmware(&imgsensor_info.ar0830ap1302d2l);
 	if (ret) {
 		LOG_ERR("AR0830AP1302D2L Request Firmware Failed.");
-		release_firmware(imgsensor_info.ar0830ap1302d2l.fw);
 		return ret;
 	}
 	for (retries = 0; retries < 5; ++retries) {
@@ -334,7 +333,6 @@ static int open(struct subdrv_ctx *ctx)
 	}
 	if (retries == 5) {
 		LOG_DBG("Firmware load retries exceeded, aborting\n");
-		release_firmware(imgsensor_info.ar0830ap1302d2l.fw);
 		ret = ERROR_DRIVER_INIT_FAIL;
 		return ret;
 	}
@@ -355,7 +353,6 @@ static int open(struct subdrv_ctx *ctx)
 	ctx->ihdr_mode = 0;
 	ctx->test_pattern = KAL_FALSE;
 	ctx->current_fps = imgsensor_info.pre.max_framerate;
-	release_firmware(imgsensor_info.ar0830ap1302d2l.fw);
 	LOG_DBG("Open() Done. AR0830AP1302D2L LINE = %d.", __LINE__);
 	return ERROR_NONE;
 } /* open  */
@@ -383,7 +380,6 @@ static int close(struct subdrv_ctx *ctx)
 	/*No Need to implement this function*/
 
 	// Add for AR0830AP1302D2L
-	//release_firmware(imgsensor_info.ar0830ap1302d2l.fw);
 	ar0830ap1302d2l_remove(&imgsensor_info.ar0830ap1302d2l);
 	return ERROR_NONE;
 } /* close  */
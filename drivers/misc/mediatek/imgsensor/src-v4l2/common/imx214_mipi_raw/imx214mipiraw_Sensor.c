@@ -20,6 +20,7 @@
 
 #include "adaptor-subdrv.h"
 #include "adaptor-i2c.h"
+#include "../sensor_mode_delta.h"
 
 #define read_cmos_sensor_8(...) subdrv_i2c_rd_u8(__VA_ARGS__)
 #define write_cmos_sensor_8(...) subdrv_i2c_wr_u8(__VA_ARGS__)
@@ -827,116 +828,664 @@ static void sensor_init(struct subdrv_ctx *ctx)
 	//cancel 1 delay frame for gain wit CIT
 } /* sensor_init */
 
-static void preview_setting(struct subdrv_ctx *ctx)
-{
-	//Preview 2104*1560 30fps 24M MCLK 4lane 608Mbps/lane
-	// preview 30.01fps
-	write_cmos_sensor_8(ctx, 0x0100, 0x00);
-	write_cmos_sensor_8(ctx, 0x0114, 0x03);
-	write_cmos_sensor_8(ctx, 0x0220, 0x00);
-	write_cmos_sensor_8(ctx, 0x0221, 0x11);
-	write_cmos_sensor_8(ctx, 0x0222, 0x01);
-	write_cmos_sensor_8(ctx, 0x0340, 0x08);
-	write_cmos_sensor_8(ctx, 0x0341, 0x3E);
-	write_cmos_sensor_8(ctx, 0x0342, 0x13);
-	write_cmos_sensor_8(ctx, 0x0343, 0x90);
-	write_cmos_sensor_8(ctx, 0x0344, 0x00);
-	write_cmos_sensor_8(ctx, 0x0345, 0x00);
-	write_cmos_sensor_8(ctx, 0x0346, 0x00);
-	write_cmos_sensor_8(ctx, 0x0347, 0x00);
-	write_cmos_sensor_8(ctx, 0x0348, 0x10);
-	write_cmos_sensor_8(ctx, 0x0349, 0x6F);
-	write_cmos_sensor_8(ctx, 0x034A, 0x0C);
-	write_cmos_sensor_8(ctx, 0x034B, 0x2F);
-	write_cmos_sensor_8(ctx, 0x0381, 0x01);
-	write_cmos_sensor_8(ctx, 0x0383, 0x01);
-	write_cmos_sensor_8(ctx, 0x0385, 0x01);
-	write_cmos_sensor_8(ctx, 0x0387, 0x01);
-	write_cmos_sensor_8(ctx, 0x0900, 0x01);
-	write_cmos_sensor_8(ctx, 0x0901, 0x22);
-	write_cmos_sensor_8(ctx, 0x0902, 0x02);
-	write_cmos_sensor_8(ctx, 0x3000, 0x35);
-	write_cmos_sensor_8(ctx, 0x3054, 0x01);
-	write_cmos_sensor_8(ctx, 0x305C, 0x11);
+/* mode tables, written in standby between imx214_mode_head and _tail */
+enum {
+	IMX214_MODE_PREVIEW,
+	IMX214_MODE_CAPTURE_30FPS,
+	IMX214_MODE_CAPTURE_24FPS,
+	IMX214_MODE_CAPTURE_15FPS,
+	IMX214_MODE_NORMAL_VIDEO,
+	IMX214_MODE_HS_VIDEO,
+};
 
-	write_cmos_sensor_8(ctx, 0x0112, 0x0A);
-	write_cmos_sensor_8(ctx, 0x0113, 0x0A);
-	write_cmos_sensor_8(ctx, 0x034C, 0x08);
-	write_cmos_sensor_8(ctx, 0x034D, 0x38);
-	write_cmos_sensor_8(ctx, 0x034E, 0x06);
-	write_cmos_sensor_8(ctx, 0x034F, 0x18);
-	write_cmos_sensor_8(ctx, 0x0401, 0x00);
-	write_cmos_sensor_8(ctx, 0x0404, 0x00);
-	write_cmos_sensor_8(ctx, 0x0405, 0x10);
-	write_cmos_sensor_8(ctx, 0x0408, 0x00);
-	write_cmos_sensor_8(ctx, 0x0409, 0x00);
-	write_cmos_sensor_8(ctx, 0x040A, 0x00);
-	write_cmos_sensor_8(ctx, 0x040B, 0x00);
-	write_cmos_sensor_8(ctx, 0x040C, 0x08);
-	write_cmos_sensor_8(ctx, 0x040D, 0x38);
-	write_cmos_sensor_8(ctx, 0x040E, 0x06);
-	write_cmos_sensor_8(ctx, 0x040F, 0x18);
+static const u16 imx214_mode_head[] = {
+	0x0100, 0x00,
+};
 
-	write_cmos_sensor_8(ctx, 0x0301, 0x05);
-	write_cmos_sensor_8(ctx, 0x0303, 0x02);
-	write_cmos_sensor_8(ctx, 0x0305, 0x03);
-	write_cmos_sensor_8(ctx, 0x0306, 0x00);
-	write_cmos_sensor_8(ctx, 0x0307, 0x64);
-	write_cmos_sensor_8(ctx, 0x0309, 0x0A);
-	write_cmos_sensor_8(ctx, 0x030B, 0x01);
-	write_cmos_sensor_8(ctx, 0x0310, 0x00);
+static const u16 imx214_mode_tail[] = {
+	0x0100, 0x01,
+};
 
-	write_cmos_sensor_8(ctx, 0x0820, 0x0C);
-	write_cmos_sensor_8(ctx, 0x0821, 0x80);
-	write_cmos_sensor_8(ctx, 0x0822, 0x00);
-	write_cmos_sensor_8(ctx, 0x0823, 0x00);
+/* also written by the shutter, gain and frame length controls */
+static const u16 imx214_mode_volatile[] = {
+	0x0202, 0x0203,
+	0x0204, 0x0205,
+	0x0216, 0x0217,
+	0x0224, 0x0225,
+	0x0340, 0x0341,
+};
 
-	write_cmos_sensor_8(ctx, 0x3A03, 0x06);
-	write_cmos_sensor_8(ctx, 0x3A04, 0x68);
-	write_cmos_sensor_8(ctx, 0x3A05, 0x01);
+static const u16 imx214_preview_regs[] = {
+	0x0114, 0x03,
+	0x0220, 0x00,
+	0x0221, 0x11,
+	0x0222, 0x01,
+	0x0340, 0x08,
+	0x0341, 0x3E,
+	0x0342, 0x13,
+	0x0343, 0x90,
+	0x0344, 0x00,
+	0x0345, 0x00,
+	0x0346, 0x00,
+	0x0347, 0x00,
+	0x0348, 0x10,
+	0x0349, 0x6F,
+	0x034A, 0x0C,
+	0x034B, 0x2F,
+	0x0381, 0x01,
+	0x0383, 0x01,
+	0x0385, 0x01,
+	0x0387, 0x01,
+	0x0900, 0x01,
+	0x0901, 0x22,
+	0x0902, 0x02,
+	0x3000, 0x35,
+	0x3054, 0x01,
+	0x305C, 0x11,
+
+	0x0112, 0x0A,
+	0x0113, 0x0A,
+	0x034C, 0x08,
+	0x034D, 0x38,
+	0x034E, 0x06,
+	0x034F, 0x18,
+	0x0401, 0x00,
+	0x0404, 0x00,
+	0x0405, 0x10,
+	0x0408, 0x00,
+	0x0409, 0x00,
+	0x040A, 0x00,
+	0x040B, 0x00,
+	0x040C, 0x08,
+	0x040D, 0x38,
+	0x040E, 0x06,
+	0x040F, 0x18,
+
+	0x0301, 0x05,
+	0x0303, 0x02,
+	0x0305, 0x03,
+	0x0306, 0x00,
+	0x0307, 0x64,
+	0x0309, 0x0A,
+	0x030B, 0x01,
+	0x0310, 0x00,
+
+	0x0820, 0x0C,
+	0x0821, 0x80,
+	0x0822, 0x00,
+	0x0823, 0x00,
+
+	0x3A03, 0x06,
+	0x3A04, 0x68,
+	0x3A05, 0x01,
+
+	0x0B06, 0x01,
+	0x30A2, 0x00,
+
+	0x30B4, 0x00,
+
+	0x3A02, 0xFF,
+
+	0x3011, 0x00,
+	0x3013, 0x00,
+
+	0x0202, 0x08,
+	0x0203, 0x34,
+	0x0224, 0x01,
+	0x0225, 0xF4,
+
+	0x0204, 0x00,
+	0x0205, 0x00,
+	0x020E, 0x01,
+	0x020F, 0x00,
+	0x0210, 0x01,
+	0x0211, 0x00,
+	0x0212, 0x01,
+	0x0213, 0x00,
+	0x0214, 0x01,
+	0x0215, 0x00,
+	0x0216, 0x00,
+	0x0217, 0x00,
+
+	0x4170, 0x00,
+	0x4171, 0x10,
+	0x4176, 0x00,
+	0x4177, 0x3C,
+	0xAE20, 0x04,
+	0xAE21, 0x5C,
+
+	0x0138, 0x01,
+};
 
-	write_cmos_sensor_8(ctx, 0x0B06, 0x01);
-	write_cmos_sensor_8(ctx, 0x30A2, 0x00);
+static const u16 imx214_capture_30fps_regs[] = {
+	0x0114, 0x03,
+	0x0220, 0x00,
+	0x0221, 0x11,
+	0x0222, 0x01,
+	0x0340, 0x0C,
+	0x0341, 0x58,
+	0x0342, 0x13,
+	0x0343, 0x90,
+	0x0344, 0x00,
+	0x0345, 0x00,
+	0x0346, 0x00,
+	0x0347, 0x00,
+	0x0348, 0x10,
+	0x0349, 0x6F,
+	0x034A, 0x0C,
+	0x034B, 0x2F,
+	0x0381, 0x01,
+	0x0383, 0x01,
+	0x0385, 0x01,
+	0x0387, 0x01,
+	0x0900, 0x00,
+	0x0901, 0x00,
+	0x0902, 0x00,
+	0x3000, 0x35,
+	0x3054, 0x01,
+	0x305C, 0x11,
+
+	0x0112, 0x0A,
+	0x0113, 0x0A,
+	0x034C, 0x10,
+	0x034D, 0x70,
+	0x034E, 0x0C,
+	0x034F, 0x30,
+	0x0401, 0x00,
+	0x0404, 0x00,
+	0x0405, 0x10,
+	0x0408, 0x00,
+	0x0409, 0x00,
+	0x040A, 0x00,
+	0x040B, 0x00,
+	0x040C, 0x10,
+	0x040D, 0x70,
+	0x040E, 0x0C,
+	0x040F, 0x30,
+
+	0x0301, 0x05,
+	0x0303, 0x02,
+	0x0305, 0x03,
+	0x0306, 0x00,
+	0x0307, 0x96,
+	0x0309, 0x0A,
+	0x030B, 0x01,
+	0x0310, 0x00,
+
+	0x0820, 0x12,
+	0x0821, 0xC0,
+	0x0822, 0x00,
+	0x0823, 0x00,
+
+	0x3A03, 0x09,
+	0x3A04, 0x20,
+	0x3A05, 0x01,
+
+	0x0B06, 0x01,
+	0x30A2, 0x00,
+
+	0x30B4, 0x00,
+
+	0x3A02, 0xff,
+
+	0x3011, 0x00,
+	0x3013, 0x01,
+
+	0x0202, 0x0C,
+	0x0203, 0x4E,
+	0x0224, 0x01,
+	0x0225, 0xF4,
+
+	0x0204, 0x00,
+	0x0205, 0x00,
+	0x020E, 0x01,
+	0x020F, 0x00,
+	0x0210, 0x01,
+	0x0211, 0x00,
+	0x0212, 0x01,
+	0x0213, 0x00,
+	0x0214, 0x01,
+	0x0215, 0x00,
+	0x0216, 0x00,
+	0x0217, 0x00,
+
+	0x4170, 0x00,
+	0x4171, 0x10,
+	0x4176, 0x00,
+	0x4177, 0x3C,
+	0xAE20, 0x04,
+	0xAE21, 0x5C,
+
+	0x0138, 0x01,
+};
 
-	write_cmos_sensor_8(ctx, 0x30B4, 0x00);
+static const u16 imx214_capture_24fps_regs[] = {
+	0x0114, 0x03,
+	0x0220, 0x00,
+	0x0221, 0x11,
+	0x0222, 0x01,
+	0x0340, 0x0C,
+	0x0341, 0x94,
+	0x0342, 0x13,
+	0x0343, 0x90,
+	0x0344, 0x00,
+	0x0345, 0x00,
+	0x0346, 0x00,
+	0x0347, 0x00,
+	0x0348, 0x10,
+	0x0349, 0x6F,
+	0x034A, 0x0C,
+	0x034B, 0x2F,
+	0x0381, 0x01,
+	0x0383, 0x01,
+	0x0385, 0x01,
+	0x0387, 0x01,
+	0x0900, 0x00,
+	0x0901, 0x00,
+	0x0902, 0x00,
+	0x3000, 0x35,
+	0x3054, 0x01,
+	0x305C, 0x11,
+
+	0x0112, 0x0A,
+	0x0113, 0x0A,
+	0x034C, 0x10,
+	0x034D, 0x70,
+	0x034E, 0x0C,
+	0x034F, 0x30,
+	0x0401, 0x00,
+	0x0404, 0x00,
+	0x0405, 0x10,
+	0x0408, 0x00,
+	0x0409, 0x00,
+	0x040A, 0x00,
+	0x040B, 0x00,
+	0x040C, 0x10,
+	0x040D, 0x70,
+	0x040E, 0x0C,
+	0x040F, 0x30,
+
+	0x0301, 0x05,
+	0x0303, 0x02,
+	0x0305, 0x03,
+	0x0306, 0x00,
+	0x0307, 0x79,
+	0x0309, 0x0A,
+	0x030B, 0x01,
+	0x0310, 0x00,
+
+	0x0820, 0x0F,
+	0x0821, 0x20,
+	0x0822, 0x00,
+	0x0823, 0x00,
+
+	0x3A03, 0x08,
+	0x3A04, 0xC0,
+	0x3A05, 0x02,
+
+	0x0B06, 0x01,
+	0x30A2, 0x00,
+	0x30B4, 0x00,
+	0x3A02, 0xFF,
+	0x3013, 0x00,
+	0x0202, 0x0C,
+	0x0203, 0x8A,
+	0x0224, 0x01,
+	0x0225, 0xF4,
+	0x0204, 0x00,
+	0x0205, 0x00,
+	0x020E, 0x01,
+	0x020F, 0x00,
+	0x0210, 0x01,
+	0x0211, 0x00,
+	0x0212, 0x01,
+	0x0213, 0x00,
+	0x0214, 0x01,
+	0x0215, 0x00,
+	0x0216, 0x00,
+	0x0217, 0x00,
+	0x4170, 0x00,
+	0x4171, 0x10,
+	0x4176, 0x00,
+	0x4177, 0x3C,
+	0xAE20, 0x04,
+	0xAE21, 0x5C,
+
+	0x0138, 0x01,
+};
 
-	write_cmos_sensor_8(ctx, 0x3A02, 0xFF);
+static const u16 imx214_capture_15fps_regs[] = {
+	0x0114, 0x03,
+	0x0220, 0x00,
+	0x0221, 0x11,
+	0x0222, 0x01,
+	0x0340, 0x0C,
+	0x0341, 0x94,
+	0x0342, 0x13,
+	0x0343, 0x90,
+	0x0344, 0x00,
+	0x0345, 0x00,
+	0x0346, 0x00,
+	0x0347, 0x00,
+	0x0348, 0x10,
+	0x0349, 0x6F,
+	0x034A, 0x0C,
+	0x034B, 0x2F,
+	0x0381, 0x01,
+	0x0383, 0x01,
+	0x0385, 0x01,
+	0x0387, 0x01,
+	0x0900, 0x00,
+	0x0901, 0x00,
+	0x0902, 0x00,
+	0x3000, 0x35,
+	0x3054, 0x01,
+	0x305C, 0x11,
+
+	0x0112, 0x0A,
+	0x0113, 0x0A,
+	0x034C, 0x10,
+	0x034D, 0x70,
+	0x034E, 0x0C,
+	0x034F, 0x30,
+	0x0401, 0x00,
+	0x0404, 0x00,
+	0x0405, 0x10,
+	0x0408, 0x00,
+	0x0409, 0x00,
+	0x040A, 0x00,
+	0x040B, 0x00,
+	0x040C, 0x10,
+	0x040D, 0x70,
+	0x040E, 0x0C,
+	0x040F, 0x30,
+
+	0x0301, 0x05,
+	0x0303, 0x02,
+	0x0305, 0x03,
+	0x0306, 0x00,
+	0x0307, 0x4c,
+	0x0309, 0x0A,
+	0x030B, 0x01,
+	0x0310, 0x00,
+
+	0x0820, 0x09,
+	0x0821, 0x80,
+	0x0822, 0x00,
+	0x0823, 0x00,
+
+	0x3A03, 0x08,
+	0x3A04, 0xC0,
+	0x3A05, 0x02,
+
+	0x0B06, 0x01,
+	0x30A2, 0x00,
+	0x30B4, 0x00,
+	0x3A02, 0xFF,
+	0x3013, 0x00,
+	0x0202, 0x0C,
+	0x0203, 0x8A,
+	0x0224, 0x01,
+	0x0225, 0xF4,
+	0x0204, 0x00,
+	0x0205, 0x00,
+	0x020E, 0x01,
+	0x020F, 0x00,
+	0x0210, 0x01,
+	0x0211, 0x00,
+	0x0212, 0x01,
+	0x0213, 0x00,
+	0x0214, 0x01,
+	0x0215, 0x00,
+	0x0216, 0x00,
+	0x0217, 0x00,
+	0x4170, 0x00,
+	0x4171, 0x10,
+	0x4176, 0x00,
+	0x4177, 0x3C,
+	0xAE20, 0x04,
+	0xAE21, 0x5C,
+
+	0x0138, 0x01,
+};
 
-	write_cmos_sensor_8(ctx, 0x3011, 0x00);
-	write_cmos_sensor_8(ctx, 0x3013, 0x00);
+static const u16 imx214_normal_video_regs[] = {
+	0x0114, 0x03,
+	0x0220, 0x00,
+	0x0221, 0x11,
+	0x0222, 0x01,
+	0x0340, 0x0C,
+	0x0341, 0x58,
+	0x0342, 0x13,
+	0x0343, 0x90,
+	0x0344, 0x00,
+	0x0345, 0x00,
+	0x0346, 0x00,
+	0x0347, 0x00,
+	0x0348, 0x10,
+	0x0349, 0x6F,
+	0x034A, 0x0C,
+	0x034B, 0x2F,
+	0x0381, 0x01,
+	0x0383, 0x01,
+	0x0385, 0x01,
+	0x0387, 0x01,
+	0x0900, 0x00,
+	0x0901, 0x00,
+	0x0902, 0x00,
+	0x3000, 0x35,
+	0x3054, 0x01,
+	0x305C, 0x11,
+
+	0x0112, 0x0A,
+	0x0113, 0x0A,
+	0x034C, 0x10,
+	0x034D, 0x70,
+	0x034E, 0x0C,
+	0x034F, 0x30,
+	0x0401, 0x00,
+	0x0404, 0x00,
+	0x0405, 0x10,
+	0x0408, 0x00,
+	0x0409, 0x00,
+	0x040A, 0x00,
+	0x040B, 0x00,
+	0x040C, 0x10,
+	0x040D, 0x70,
+	0x040E, 0x0C,
+	0x040F, 0x30,
+
+	0x0301, 0x05,
+	0x0303, 0x02,
+	0x0305, 0x03,
+	0x0306, 0x00,
+	0x0307, 0x96,
+	0x0309, 0x0A,
+	0x030B, 0x01,
+	0x0310, 0x00,
+
+	0x0820, 0x12,
+	0x0821, 0xC0,
+	0x0822, 0x00,
+	0x0823, 0x00,
+
+	0x3A03, 0x09,
+	0x3A04, 0x20,
+	0x3A05, 0x01,
+
+	0x0B06, 0x01,
+	0x30A2, 0x00,
+
+	0x30B4, 0x00,
+
+	0x3A02, 0xff,
+
+	0x3011, 0x00,
+	0x3013, 0x01,
+
+	0x0202, 0x0C,
+	0x0203, 0x4E,
+	0x0224, 0x01,
+	0x0225, 0xF4,
+
+	0x0204, 0x00,
+	0x0205, 0x00,
+	0x020E, 0x01,
+	0x020F, 0x00,
+	0x0210, 0x01,
+	0x0211, 0x00,
+	0x0212, 0x01,
+	0x0213, 0x00,
+	0x0214, 0x01,
+	0x0215, 0x00,
+	0x0216, 0x00,
+	0x0217, 0x00,
+
+	0x4170, 0x00,
+	0x4171, 0x10,
+	0x4176, 0x00,
+	0x4177, 0x3C,
+	0xAE20, 0x04,
+	0xAE21, 0x5C,
+
+	0x0138, 0x01,
+};
 
-	write_cmos_sensor_8(ctx, 0x0202, 0x08);
-	write_cmos_sensor_8(ctx, 0x0203, 0x34);
-	write_cmos_sensor_8(ctx, 0x0224, 0x01);
-	write_cmos_sensor_8(ctx, 0x0225, 0xF4);
+static const u16 imx214_hs_video_regs[] = {
+	0x0114, 0x03,
+	0x0220, 0x00,
+	0x0221, 0x11,
+	0x0222, 0x01,
+	0x0340, 0x05,
+	0x0341, 0x08,
+	0x0342, 0x13,
+	0x0343, 0x90,
+	0x0344, 0x00,
+	0x0345, 0x00,
+	0x0346, 0x01,
+	0x0347, 0x78,
+	0x0348, 0x10,
+	0x0349, 0x6F,
+	0x034A, 0x0A,
+	0x034B, 0xB7,
+	0x0381, 0x01,
+	0x0383, 0x01,
+	0x0385, 0x01,
+	0x0387, 0x01,
+	0x0900, 0x01,
+	0x0901, 0x22,
+	0x0902, 0x02,
+	0x3000, 0x35,
+	0x3054, 0x01,
+	0x305C, 0x11,
+
+	0x0112, 0x0A,
+	0x0113, 0x0A,
+	0x034C, 0x08,
+	0x034D, 0x38,
+	0x034E, 0x04,
+	0x034F, 0xA0,
+	0x0401, 0x00,
+	0x0404, 0x00,
+	0x0405, 0x10,
+	0x0408, 0x00,
+	0x0409, 0x00,
+	0x040A, 0x00,
+	0x040B, 0x00,
+	0x040C, 0x08,
+	0x040D, 0x38,
+	0x040E, 0x04,
+	0x040F, 0xA0,
+
+	0x0301, 0x05,
+	0x0303, 0x02,
+	0x0305, 0x03,
+	0x0306, 0x00,
+	0x0307, 0x79,//79
+	0x0309, 0x0A,
+	0x030B, 0x01,
+	0x0310, 0x00,
+
+	0x0820, 0x0F,//0F
+	0x0821, 0x20,// 20
+	0x0822, 0x00,
+	0x0823, 0x00,
+	0x3A03, 0x06,
+	0x3A04, 0x68,
+	0x3A05, 0x01,
+	0x0B06, 0x01,
+	0x30A2, 0x00,
+	0x30B4, 0x00,
+	0x3A02, 0xFF,
+	0x3013, 0x00,
+	0x0202, 0x04,
+	0x0203, 0xFE,
+	0x0224, 0x01,
+	0x0225, 0xF4,
+	0x0204, 0x00,
+	0x0205, 0x00,
+	0x020E, 0x01,
+	0x020F, 0x00,
+	0x0210, 0x01,
+	0x0211, 0x00,
+	0x0212, 0x01,
+	0x0213, 0x00,
+	0x0214, 0x01,
+	0x0215, 0x00,
+	0x0216, 0x00,
+	0x0217, 0x00,
+	0x4170, 0x00,
+	0x4171, 0x10,
+	0x4176, 0x00,
+	0x4177, 0x3C,
+	0xAE20, 0x04,
+	0xAE21, 0x5C,
+
+	0x0138, 0x01,
+};
 
-	write_cmos_sensor_8(ctx, 0x0204, 0x00);
-	write_cmos_sensor_8(ctx, 0x0205, 0x00);
-	write_cmos_sensor_8(ctx, 0x020E, 0x01);
-	write_cmos_sensor_8(ctx, 0x020F, 0x00);
-	write_cmos_sensor_8(ctx, 0x0210, 0x01);
-	write_cmos_sensor_8(ctx, 0x0211, 0x00);
-	write_cmos_sensor_8(ctx, 0x0212, 0x01);
-	write_cmos_sensor_8(ctx, 0x0213, 0x00);
-	write_cmos_sensor_8(ctx, 0x0214, 0x01);
-	write_cmos_sensor_8(ctx, 0x0215, 0x00);
-	write_cmos_sensor_8(ctx, 0x0216, 0x00);
-	write_cmos_sensor_8(ctx, 0x0217, 0x00);
+static const struct sensor_mode_table imx214_modes[] = {
+	[IMX214_MODE_PREVIEW] = {
+		imx214_preview_regs, ARRAY_SIZE(imx214_preview_regs)
+	},
+	[IMX214_MODE_CAPTURE_30FPS] = {
+		imx214_capture_30fps_regs, ARRAY_SIZE(imx214_capture_30fps_regs)
+	},
+	[IMX214_MODE_CAPTURE_24FPS] = {
+		imx214_capture_24fps_regs, ARRAY_SIZE(imx214_capture_24fps_regs)
+	},
+	[IMX214_MODE_CAPTURE_15FPS] = {
+		imx214_capture_15fps_regs, ARRAY_SIZE(imx214_capture_15fps_regs)
+	},
+	[IMX214_MODE_NORMAL_VIDEO] = {
+		imx214_normal_video_regs, ARRAY_SIZE(imx214_normal_video_regs)
+	},
+	[IMX214_MODE_HS_VIDEO] = {
+		imx214_hs_video_regs, ARRAY_SIZE(imx214_hs_video_regs)
+	},
+};
 
-	write_cmos_sensor_8(ctx, 0x4170, 0x00);
-	write_cmos_sensor_8(ctx, 0x4171, 0x10);
-	write_cmos_sensor_8(ctx, 0x4176, 0x00);
-	write_cmos_sensor_8(ctx, 0x4177, 0x3C);
-	write_cmos_sensor_8(ctx, 0xAE20, 0x04);
-	write_cmos_sensor_8(ctx, 0xAE21, 0x5C);
+static const struct sensor_mode_desc imx214_mode_desc = {
+	.modes = imx214_modes,
+	.n_modes = ARRAY_SIZE(imx214_modes),
+	.head = { imx214_mode_head, ARRAY_SIZE(imx214_mode_head) },
+	.tail = { imx214_mode_tail, ARRAY_SIZE(imx214_mode_tail) },
+	.volatile_regs = imx214_mode_volatile,
+	.n_volatile = ARRAY_SIZE(imx214_mode_volatile),
+};
 
-	write_cmos_sensor_8(ctx, 0x0138, 0x01);
-	write_cmos_sensor_8(ctx, 0x0100, 0x01);
+static void preview_setting(struct subdrv_ctx *ctx)
+{
+	//Preview 2104*1560 30fps 24M MCLK 4lane 608Mbps/lane
+	// preview 30.01fps
+	sensor_mode_delta_apply(ctx, &imx214_mode_desc, IMX214_MODE_PREVIEW);
 }   /*  preview_setting  */
 
 static void preview_setting_HDR(struct subdrv_ctx *ctx)
 {
 	LOG_INFO("preview_setting_mHDR\n");
+	/* outside the mode tables */
+	ctx->reg_mode = 0;
 	write_cmos_sensor_8(ctx, 0x0100, 0x00);
 	write_cmos_sensor_8(ctx, 0x0114, 0x03);
 	write_cmos_sensor_8(ctx, 0x0220, 0x01);
@@ -1099,302 +1648,14 @@ static void capture_setting(struct subdrv_ctx *ctx, kal_uint16 currefps)
 	if (currefps == 300) {
 		LOG_DBG("E 30fps setting\n");
 		// full size 30.33ps
-		write_cmos_sensor_8(ctx, 0x0100, 0x00);
-		write_cmos_sensor_8(ctx, 0x0114, 0x03);
-		write_cmos_sensor_8(ctx, 0x0220, 0x00);
-		write_cmos_sensor_8(ctx, 0x0221, 0x11);
-		write_cmos_sensor_8(ctx, 0x0222, 0x01);
-		write_cmos_sensor_8(ctx, 0x0340, 0x0C);
-		write_cmos_sensor_8(ctx, 0x0341, 0x58);
-		write_cmos_sensor_8(ctx, 0x0342, 0x13);
-		write_cmos_sensor_8(ctx, 0x0343, 0x90);
-		write_cmos_sensor_8(ctx, 0x0344, 0x00);
-		write_cmos_sensor_8(ctx, 0x0345, 0x00);
-		write_cmos_sensor_8(ctx, 0x0346, 0x00);
-		write_cmos_sensor_8(ctx, 0x0347, 0x00);
-		write_cmos_sensor_8(ctx, 0x0348, 0x10);
-		write_cmos_sensor_8(ctx, 0x0349, 0x6F);
-		write_cmos_sensor_8(ctx, 0x034A, 0x0C);
-		write_cmos_sensor_8(ctx, 0x034B, 0x2F);
-		write_cmos_sensor_8(ctx, 0x0381, 0x01);
-		write_cmos_sensor_8(ctx, 0x0383, 0x01);
-		write_cmos_sensor_8(ctx, 0x0385, 0x01);
-		write_cmos_sensor_8(ctx, 0x0387, 0x01);
-		write_cmos_sensor_8(ctx, 0x0900, 0x00);
-		write_cmos_sensor_8(ctx, 0x0901, 0x00);
-		write_cmos_sensor_8(ctx, 0x0902, 0x00);
-		write_cmos_sensor_8(ctx, 0x3000, 0x35);
-		write_cmos_sensor_8(ctx, 0x3054, 0x01);
-		write_cmos_sensor_8(ctx, 0x305C, 0x11);
-
-		write_cmos_sensor_8(ctx, 0x0112, 0x0A);
-		write_cmos_sensor_8(ctx, 0x0113, 0x0A);
-		write_cmos_sensor_8(ctx, 0x034C, 0x10);
-		write_cmos_sensor_8(ctx, 0x034D, 0x70);
-		write_cmos_sensor_8(ctx, 0x034E, 0x0C);
-		write_cmos_sensor_8(ctx, 0x034F, 0x30);
-		write_cmos_sensor_8(ctx, 0x0401, 0x00);
-		write_cmos_sensor_8(ctx, 0x0404, 0x00);
-		write_cmos_sensor_8(ctx, 0x0405, 0x10);
-		write_cmos_sensor_8(ctx, 0x0408, 0x00);
-		write_cmos_sensor_8(ctx, 0x0409, 0x00);
-		write_cmos_sensor_8(ctx, 0x040A, 0x00);
-		write_cmos_sensor_8(ctx, 0x040B, 0x00);
-		write_cmos_sensor_8(ctx, 0x040C, 0x10);
-		write_cmos_sensor_8(ctx, 0x040D, 0x70);
-		write_cmos_sensor_8(ctx, 0x040E, 0x0C);
-		write_cmos_sensor_8(ctx, 0x040F, 0x30);
-
-		write_cmos_sensor_8(ctx, 0x0301, 0x05);
-		write_cmos_sensor_8(ctx, 0x0303, 0x02);
-		write_cmos_sensor_8(ctx, 0x0305, 0x03);
-		write_cmos_sensor_8(ctx, 0x0306, 0x00);
-		write_cmos_sensor_8(ctx, 0x0307, 0x96);
-		write_cmos_sensor_8(ctx, 0x0309, 0x0A);
-		write_cmos_sensor_8(ctx, 0x030B, 0x01);
-		write_cmos_sensor_8(ctx, 0x0310, 0x00);
-
-		write_cmos_sensor_8(ctx, 0x0820, 0x12);
-		write_cmos_sensor_8(ctx, 0x0821, 0xC0);
-		write_cmos_sensor_8(ctx, 0x0822, 0x00);
-		write_cmos_sensor_8(ctx, 0x0823, 0x00);
-
-		write_cmos_sensor_8(ctx, 0x3A03, 0x09);
-		write_cmos_sensor_8(ctx, 0x3A04, 0x20);
-		write_cmos_sensor_8(ctx, 0x3A05, 0x01);
-
-		write_cmos_sensor_8(ctx, 0x0B06, 0x01);
-		write_cmos_sensor_8(ctx, 0x30A2, 0x00);
-
-		write_cmos_sensor_8(ctx, 0x30B4, 0x00);
-
-		write_cmos_sensor_8(ctx, 0x3A02, 0xff);
-
-		write_cmos_sensor_8(ctx, 0x3011, 0x00);
-		write_cmos_sensor_8(ctx, 0x3013, 0x01);
-
-		write_cmos_sensor_8(ctx, 0x0202, 0x0C);
-		write_cmos_sensor_8(ctx, 0x0203, 0x4E);
-		write_cmos_sensor_8(ctx, 0x0224, 0x01);
-		write_cmos_sensor_8(ctx, 0x0225, 0xF4);
-
-		write_cmos_sensor_8(ctx, 0x0204, 0x00);
-		write_cmos_sensor_8(ctx, 0x0205, 0x00);
-		write_cmos_sensor_8(ctx, 0x020E, 0x01);
-		write_cmos_sensor_8(ctx, 0x020F, 0x00);
-		write_cmos_sensor_8(ctx, 0x0210, 0x01);
-		write_cmos_sensor_8(ctx, 0x0211, 0x00);
-		write_cmos_sensor_8(ctx, 0x0212, 0x01);
-		write_cmos_sensor_8(ctx, 0x0213, 0x00);
-		write_cmos_sensor_8(ctx, 0x0214, 0x01);
-		write_cmos_sensor_8(ctx, 0x0215, 0x00);
-		write_cmos_sensor_8(ctx, 0x0216, 0x00);
-		write_cmos_sensor_8(ctx, 0x0217, 0x00);
-
-		write_cmos_sensor_8(ctx, 0x4170, 0x00);
-		write_cmos_sensor_8(ctx, 0x4171, 0x10);
-		write_cmos_sensor_8(ctx, 0x4176, 0x00);
-		write_cmos_sensor_8(ctx, 0x4177, 0x3C);
-		write_cmos_sensor_8(ctx, 0xAE20, 0x04);
-		write_cmos_sensor_8(ctx, 0xAE21, 0x5C);
-
-		write_cmos_sensor_8(ctx, 0x0138, 0x01);
-		write_cmos_sensor_8(ctx, 0x0100, 0x01);
+		sensor_mode_delta_apply(ctx, &imx214_mode_desc, IMX214_MODE_CAPTURE_30FPS);
 
 	} else if (currefps == 240) {
 		// full siez 24pfs
-		write_cmos_sensor_8(ctx, 0x0100, 0x00);
-
-		write_cmos_sensor_8(ctx, 0x0114, 0x03);
-		write_cmos_sensor_8(ctx, 0x0220, 0x00);
-		write_cmos_sensor_8(ctx, 0x0221, 0x11);
-		write_cmos_sensor_8(ctx, 0x0222, 0x01);
-		write_cmos_sensor_8(ctx, 0x0340, 0x0C);
-		write_cmos_sensor_8(ctx, 0x0341, 0x94);
-		write_cmos_sensor_8(ctx, 0x0342, 0x13);
-		write_cmos_sensor_8(ctx, 0x0343, 0x90);
-		write_cmos_sensor_8(ctx, 0x0344, 0x00);
-		write_cmos_sensor_8(ctx, 0x0345, 0x00);
-		write_cmos_sensor_8(ctx, 0x0346, 0x00);
-		write_cmos_sensor_8(ctx, 0x0347, 0x00);
-		write_cmos_sensor_8(ctx, 0x0348, 0x10);
-		write_cmos_sensor_8(ctx, 0x0349, 0x6F);
-		write_cmos_sensor_8(ctx, 0x034A, 0x0C);
-		write_cmos_sensor_8(ctx, 0x034B, 0x2F);
-		write_cmos_sensor_8(ctx, 0x0381, 0x01);
-		write_cmos_sensor_8(ctx, 0x0383, 0x01);
-		write_cmos_sensor_8(ctx, 0x0385, 0x01);
-		write_cmos_sensor_8(ctx, 0x0387, 0x01);
-		write_cmos_sensor_8(ctx, 0x0900, 0x00);
-		write_cmos_sensor_8(ctx, 0x0901, 0x00);
-		write_cmos_sensor_8(ctx, 0x0902, 0x00);
-		write_cmos_sensor_8(ctx, 0x3000, 0x35);
-		write_cmos_sensor_8(ctx, 0x3054, 0x01);
-		write_cmos_sensor_8(ctx, 0x305C, 0x11);
-
-		write_cmos_sensor_8(ctx, 0x0112, 0x0A);
-		write_cmos_sensor_8(ctx, 0x0113, 0x0A);
-		write_cmos_sensor_8(ctx, 0x034C, 0x10);
-		write_cmos_sensor_8(ctx, 0x034D, 0x70);
-		write_cmos_sensor_8(ctx, 0x034E, 0x0C);
-		write_cmos_sensor_8(ctx, 0x034F, 0x30);
-		write_cmos_sensor_8(ctx, 0x0401, 0x00);
-		write_cmos_sensor_8(ctx, 0x0404, 0x00);
-		write_cmos_sensor_8(ctx, 0x0405, 0x10);
-		write_cmos_sensor_8(ctx, 0x0408, 0x00);
-		write_cmos_sensor_8(ctx, 0x0409, 0x00);
-		write_cmos_sensor_8(ctx, 0x040A, 0x00);
-		write_cmos_sensor_8(ctx, 0x040B, 0x00);
-		write_cmos_sensor_8(ctx, 0x040C, 0x10);
-		write_cmos_sensor_8(ctx, 0x040D, 0x70);
-		write_cmos_sensor_8(ctx, 0x040E, 0x0C);
-		write_cmos_sensor_8(ctx, 0x040F, 0x30);
-
-		write_cmos_sensor_8(ctx, 0x0301, 0x05);
-		write_cmos_sensor_8(ctx, 0x0303, 0x02);
-		write_cmos_sensor_8(ctx, 0x0305, 0x03);
-		write_cmos_sensor_8(ctx, 0x0306, 0x00);
-		write_cmos_sensor_8(ctx, 0x0307, 0x79);
-		write_cmos_sensor_8(ctx, 0x0309, 0x0A);
-		write_cmos_sensor_8(ctx, 0x030B, 0x01);
-		write_cmos_sensor_8(ctx, 0x0310, 0x00);
-
-		write_cmos_sensor_8(ctx, 0x0820, 0x0F);
-		write_cmos_sensor_8(ctx, 0x0821, 0x20);
-		write_cmos_sensor_8(ctx, 0x0822, 0x00);
-		write_cmos_sensor_8(ctx, 0x0823, 0x00);
-
-		write_cmos_sensor_8(ctx, 0x3A03, 0x08);
-		write_cmos_sensor_8(ctx, 0x3A04, 0xC0);
-		write_cmos_sensor_8(ctx, 0x3A05, 0x02);
-
-		write_cmos_sensor_8(ctx, 0x0B06, 0x01);
-		write_cmos_sensor_8(ctx, 0x30A2, 0x00);
-		write_cmos_sensor_8(ctx, 0x30B4, 0x00);
-		write_cmos_sensor_8(ctx, 0x3A02, 0xFF);
-		write_cmos_sensor_8(ctx, 0x3013, 0x00);
-		write_cmos_sensor_8(ctx, 0x0202, 0x0C);
-		write_cmos_sensor_8(ctx, 0x0203, 0x8A);
-		write_cmos_sensor_8(ctx, 0x0224, 0x01);
-		write_cmos_sensor_8(ctx, 0x0225, 0xF4);
-		write_cmos_sensor_8(ctx, 0x0204, 0x00);
-		write_cmos_sensor_8(ctx, 0x0205, 0x00);
-		write_cmos_sensor_8(ctx, 0x020E, 0x01);
-		write_cmos_sensor_8(ctx, 0x020F, 0x00);
-		write_cmos_sensor_8(ctx, 0x0210, 0x01);
-		write_cmos_sensor_8(ctx, 0x0211, 0x00);
-		write_cmos_sensor_8(ctx, 0x0212, 0x01);
-		write_cmos_sensor_8(ctx, 0x0213, 0x00);
-		write_cmos_sensor_8(ctx, 0x0214, 0x01);
-		write_cmos_sensor_8(ctx, 0x0215, 0x00);
-		write_cmos_sensor_8(ctx, 0x0216, 0x00);
-		write_cmos_sensor_8(ctx, 0x0217, 0x00);
-		write_cmos_sensor_8(ctx, 0x4170, 0x00);
-		write_cmos_sensor_8(ctx, 0x4171, 0x10);
-		write_cmos_sensor_8(ctx, 0x4176, 0x00);
-		write_cmos_sensor_8(ctx, 0x4177, 0x3C);
-		write_cmos_sensor_8(ctx, 0xAE20, 0x04);
-		write_cmos_sensor_8(ctx, 0xAE21, 0x5C);
-
-		write_cmos_sensor_8(ctx, 0x0138, 0x01);
-		write_cmos_sensor_8(ctx, 0x0100, 0x01);
+		sensor_mode_delta_apply(ctx, &imx214_mode_desc, IMX214_MODE_CAPTURE_24FPS);
 	} else {
 		// full siez 15pfs
-		write_cmos_sensor_8(ctx, 0x0100, 0x00);
-
-		write_cmos_sensor_8(ctx, 0x0114, 0x03);
-		write_cmos_sensor_8(ctx, 0x0220, 0x00);
-		write_cmos_sensor_8(ctx, 0x0221, 0x11);
-		write_cmos_sensor_8(ctx, 0x0222, 0x01);
-		write_cmos_sensor_8(ctx, 0x0340, 0x0C);
-		write_cmos_sensor_8(ctx, 0x0341, 0x94);
-		write_cmos_sensor_8(ctx, 0x0342, 0x13);
-		write_cmos_sensor_8(ctx, 0x0343, 0x90);
-		write_cmos_sensor_8(ctx, 0x0344, 0x00);
-		write_cmos_sensor_8(ctx, 0x0345, 0x00);
-		write_cmos_sensor_8(ctx, 0x0346, 0x00);
-		write_cmos_sensor_8(ctx, 0x0347, 0x00);
-		write_cmos_sensor_8(ctx, 0x0348, 0x10);
-		write_cmos_sensor_8(ctx, 0x0349, 0x6F);
-		write_cmos_sensor_8(ctx, 0x034A, 0x0C);
-		write_cmos_sensor_8(ctx, 0x034B, 0x2F);
-		write_cmos_sensor_8(ctx, 0x0381, 0x01);
-		write_cmos_sensor_8(ctx, 0x0383, 0x01);
-		write_cmos_sensor_8(ctx, 0x0385, 0x01);
-		write_cmos_sensor_8(ctx, 0x0387, 0x01);
-		write_cmos_sensor_8(ctx, 0x0900, 0x00);
-		write_cmos_sensor_8(ctx, 0x0901, 0x00);
-		write_cmos_sensor_8(ctx, 0x0902, 0x00);
-		write_cmos_sensor_8(ctx, 0x3000, 0x35);
-		write_cmos_sensor_8(ctx, 0x3054, 0x01);
-		write_cmos_sensor_8(ctx, 0x305C, 0x11);
-
-		write_cmos_sensor_8(ctx, 0x0112, 0x0A);
-		write_cmos_sensor_8(ctx, 0x0113, 0x0A);
-		write_cmos_sensor_8(ctx, 0x034C, 0x10);
-		write_cmos_sensor_8(ctx, 0x034D, 0x70);
-		write_cmos_sensor_8(ctx, 0x034E, 0x0C);
-		write_cmos_sensor_8(ctx, 0x034F, 0x30);
-		write_cmos_sensor_8(ctx, 0x0401, 0x00);
-		write_cmos_sensor_8(ctx, 0x0404, 0x00);
-		write_cmos_sensor_8(ctx, 0x0405, 0x10);
-		write_cmos_sensor_8(ctx, 0x0408, 0x00);
-		write_cmos_sensor_8(ctx, 0x0409, 0x00);
-		write_cmos_sensor_8(ctx, 0x040A, 0x00);
-		write_cmos_sensor_8(ctx, 0x040B, 0x00);
-		write_cmos_sensor_8(ctx, 0x040C, 0x10);
-		write_cmos_sensor_8(ctx, 0x040D, 0x70);
-		write_cmos_sensor_8(ctx, 0x040E, 0x0C);
-		write_cmos_sensor_8(ctx, 0x040F, 0x30);
-
-		write_cmos_sensor_8(ctx, 0x0301, 0x05);
-		write_cmos_sensor_8(ctx, 0x0303, 0x02);
-		write_cmos_sensor_8(ctx, 0x0305, 0x03);
-		write_cmos_sensor_8(ctx, 0x0306, 0x00);
-		write_cmos_sensor_8(ctx, 0x0307, 0x4c);
-		write_cmos_sensor_8(ctx, 0x0309, 0x0A);
-		write_cmos_sensor_8(ctx, 0x030B, 0x01);
-		write_cmos_sensor_8(ctx, 0x0310, 0x00);
-
-		write_cmos_sensor_8(ctx, 0x0820, 0x09);
-		write_cmos_sensor_8(ctx, 0x0821, 0x80);
-		write_cmos_sensor_8(ctx, 0x0822, 0x00);
-		write_cmos_sensor_8(ctx, 0x0823, 0x00);
-
-		write_cmos_sensor_8(ctx, 0x3A03, 0x08);
-		write_cmos_sensor_8(ctx, 0x3A04, 0xC0);
-		write_cmos_sensor_8(ctx, 0x3A05, 0x02);
-
-		write_cmos_sensor_8(ctx, 0x0B06, 0x01);
-		write_cmos_sensor_8(ctx, 0x30A2, 0x00);
-		write_cmos_sensor_8(ctx, 0x30B4, 0x00);
-		write_cmos_sensor_8(ctx, 0x3A02, 0xFF);
-		write_cmos_sensor_8(ctx, 0x3013, 0x00);
-		write_cmos_sensor_8(ctx, 0x0202, 0x0C);
-		write_cmos_sensor_8(ctx, 0x0203, 0x8A);
-		write_cmos_sensor_8(ctx, 0x0224, 0x01);
-		write_cmos_sensor_8(ctx, 0x0225, 0xF4);
-		write_cmos_sensor_8(ctx, 0x0204, 0x00);
-		write_cmos_sensor_8(ctx, 0x0205, 0x00);
-		write_cmos_sensor_8(ctx, 0x020E, 0x01);
-		write_cmos_sensor_8(ctx, 0x020F, 0x00);
-		write_cmos_sensor_8(ctx, 0x0210, 0x01);
-		write_cmos_sensor_8(ctx, 0x0211, 0x00);
-		write_cmos_sensor_8(ctx, 0x0212, 0x01);
-		write_cmos_sensor_8(ctx, 0x0213, 0x00);
-		write_cmos_sensor_8(ctx, 0x0214, 0x01);
-		write_cmos_sensor_8(ctx, 0x0215, 0x00);
-		write_cmos_sensor_8(ctx, 0x0216, 0x00);
-		write_cmos_sensor_8(ctx, 0x0217, 0x00);
-		write_cmos_sensor_8(ctx, 0x4170, 0x00);
-		write_cmos_sensor_8(ctx, 0x4171, 0x10);
-		write_cmos_sensor_8(ctx, 0x4176, 0x00);
-		write_cmos_sensor_8(ctx, 0x4177, 0x3C);
-		write_cmos_sensor_8(ctx, 0xAE20, 0x04);
-		write_cmos_sensor_8(ctx, 0xAE21, 0x5C);
-
-		write_cmos_sensor_8(ctx, 0x0138, 0x01);
-		write_cmos_sensor_8(ctx, 0x0100, 0x01);
+		sensor_mode_delta_apply(ctx, &imx214_mode_desc, IMX214_MODE_CAPTURE_15FPS);
 	}
 }
 
@@ -1402,112 +1663,14 @@ static void normal_video_setting(struct subdrv_ctx *ctx, kal_uint16 currefps)
 {
 	LOG_INFO("E! currefps:%u\n", currefps);
 	// full size 30.33ps
-	write_cmos_sensor_8(ctx, 0x0100, 0x00);
-	write_cmos_sensor_8(ctx, 0x0114, 0x03);
-	write_cmos_sensor_8(ctx, 0x0220, 0x00);
-	write_cmos_sensor_8(ctx, 0x0221, 0x11);
-	write_cmos_sensor_8(ctx, 0x0222, 0x01);
-	write_cmos_sensor_8(ctx, 0x0340, 0x0C);
-	write_cmos_sensor_8(ctx, 0x0341, 0x58);
-	write_cmos_sensor_8(ctx, 0x0342, 0x13);
-	write_cmos_sensor_8(ctx, 0x0343, 0x90);
-	write_cmos_sensor_8(ctx, 0x0344, 0x00);
-	write_cmos_sensor_8(ctx, 0x0345, 0x00);
-	write_cmos_sensor_8(ctx, 0x0346, 0x00);
-	write_cmos_sensor_8(ctx, 0x0347, 0x00);
-	write_cmos_sensor_8(ctx, 0x0348, 0x10);
-	write_cmos_sensor_8(ctx, 0x0349, 0x6F);
-	write_cmos_sensor_8(ctx, 0x034A, 0x0C);
-	write_cmos_sensor_8(ctx, 0x034B, 0x2F);
-	write_cmos_sensor_8(ctx, 0x0381, 0x01);
-	write_cmos_sensor_8(ctx, 0x0383, 0x01);
-	write_cmos_sensor_8(ctx, 0x0385, 0x01);
-	write_cmos_sensor_8(ctx, 0x0387, 0x01);
-	write_cmos_sensor_8(ctx, 0x0900, 0x00);
-	write_cmos_sensor_8(ctx, 0x0901, 0x00);
-	write_cmos_sensor_8(ctx, 0x0902, 0x00);
-	write_cmos_sensor_8(ctx, 0x3000, 0x35);
-	write_cmos_sensor_8(ctx, 0x3054, 0x01);
-	write_cmos_sensor_8(ctx, 0x305C, 0x11);
-
-	write_cmos_sensor_8(ctx, 0x0112, 0x0A);
-	write_cmos_sensor_8(ctx, 0x0113, 0x0A);
-	write_cmos_sensor_8(ctx, 0x034C, 0x10);
-	write_cmos_sensor_8(ctx, 0x034D, 0x70);
-	write_cmos_sensor_8(ctx, 0x034E, 0x0C);
-	write_cmos_sensor_8(ctx, 0x034F, 0x30);
-	write_cmos_sensor_8(ctx, 0x0401, 0x00);
-	write_cmos_sensor_8(ctx, 0x0404, 0x00);
-	write_cmos_sensor_8(ctx, 0x0405, 0x10);
-	write_cmos_sensor_8(ctx, 0x0408, 0x00);
-	write_cmos_sensor_8(ctx, 0x0409, 0x00);
-	write_cmos_sensor_8(ctx, 0x040A, 0x00);
-	write_cmos_sensor_8(ctx, 0x040B, 0x00);
-	write_cmos_sensor_8(ctx, 0x040C, 0x10);
-	write_cmos_sensor_8(ctx, 0x040D, 0x70);
-	write_cmos_sensor_8(ctx, 0x040E, 0x0C);
-	write_cmos_sensor_8(ctx, 0x040F, 0x30);
-
-	write_cmos_sensor_8(ctx, 0x0301, 0x05);
-	write_cmos_sensor_8(ctx, 0x0303, 0x02);
-	write_cmos_sensor_8(ctx, 0x0305, 0x03);
-	write_cmos_sensor_8(ctx, 0x0306, 0x00);
-	write_cmos_sensor_8(ctx, 0x0307, 0x96);
-	write_cmos_sensor_8(ctx, 0x0309, 0x0A);
-	write_cmos_sensor_8(ctx, 0x030B, 0x01);
-	write_cmos_sensor_8(ctx, 0x0310, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x0820, 0x12);
-	write_cmos_sensor_8(ctx, 0x0821, 0xC0);
-	write_cmos_sensor_8(ctx, 0x0822, 0x00);
-	write_cmos_sensor_8(ctx, 0x0823, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x3A03, 0x09);
-	write_cmos_sensor_8(ctx, 0x3A04, 0x20);
-	write_cmos_sensor_8(ctx, 0x3A05, 0x01);
-
-	write_cmos_sensor_8(ctx, 0x0B06, 0x01);
-	write_cmos_sensor_8(ctx, 0x30A2, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x30B4, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x3A02, 0xff);
-
-	write_cmos_sensor_8(ctx, 0x3011, 0x00);
-	write_cmos_sensor_8(ctx, 0x3013, 0x01);
-
-	write_cmos_sensor_8(ctx, 0x0202, 0x0C);
-	write_cmos_sensor_8(ctx, 0x0203, 0x4E);
-	write_cmos_sensor_8(ctx, 0x0224, 0x01);
-	write_cmos_sensor_8(ctx, 0x0225, 0xF4);
-
-	write_cmos_sensor_8(ctx, 0x0204, 0x00);
-	write_cmos_sensor_8(ctx, 0x0205, 0x00);
-	write_cmos_sensor_8(ctx, 0x020E, 0x01);
-	write_cmos_sensor_8(ctx, 0x020F, 0x00);
-	write_cmos_sensor_8(ctx, 0x0210, 0x01);
-	write_cmos_sensor_8(ctx, 0x0211, 0x00);
-	write_cmos_sensor_8(ctx, 0x0212, 0x01);
-	write_cmos_sensor_8(ctx, 0x0213, 0x00);
-	write_cmos_sensor_8(ctx, 0x0214, 0x01);
-	write_cmos_sensor_8(ctx, 0x0215, 0x00);
-	write_cmos_sensor_8(ctx, 0x0216, 0x00);
-	write_cmos_sensor_8(ctx, 0x0217, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x4170, 0x00);
-	write_cmos_sensor_8(ctx, 0x4171, 0x10);
-	write_cmos_sensor_8(ctx, 0x4176, 0x00);
-	write_cmos_sensor_8(ctx, 0x4177, 0x3C);
-	write_cmos_sensor_8(ctx, 0xAE20, 0x04);
-	write_cmos_sensor_8(ctx, 0xAE21, 0x5C);
-
-	write_cmos_sensor_8(ctx, 0x0138, 0x01);
-	write_cmos_sensor_8(ctx, 0x0100, 0x01);
+	sensor_mode_delta_apply(ctx, &imx214_mode_desc, IMX214_MODE_NORMAL_VIDEO);
 }
 
 static void fullsize_setting_HDR(struct subdrv_ctx *ctx, kal_uint16 currefps)
 {
 	LOG_INFO("E! currefps:%u\n", currefps);
+	/* outside the mode tables */
+	ctx->reg_mode = 0;
 	// full size 30.33ps
 	write_cmos_sensor_8(ctx, 0x0100, 0x00);
 	write_cmos_sensor_8(ctx, 0x0114, 0x03);
@@ -1661,98 +1824,7 @@ static void hs_video_setting(struct subdrv_ctx *ctx)
 {
 	LOG_INFO("E\n");
 	//1080p 60fps
-	write_cmos_sensor_8(ctx, 0x0100, 0x00);
-	write_cmos_sensor_8(ctx, 0x0114, 0x03);
-	write_cmos_sensor_8(ctx, 0x0220, 0x00);
-	write_cmos_sensor_8(ctx, 0x0221, 0x11);
-	write_cmos_sensor_8(ctx, 0x0222, 0x01);
-	write_cmos_sensor_8(ctx, 0x0340, 0x05);
-	write_cmos_sensor_8(ctx, 0x0341, 0x08);
-	write_cmos_sensor_8(ctx, 0x0342, 0x13);
-	write_cmos_sensor_8(ctx, 0x0343, 0x90);
-	write_cmos_sensor_8(ctx, 0x0344, 0x00);
-	write_cmos_sensor_8(ctx, 0x0345, 0x00);
-	write_cmos_sensor_8(ctx, 0x0346, 0x01);
-	write_cmos_sensor_8(ctx, 0x0347, 0x78);
-	write_cmos_sensor_8(ctx, 0x0348, 0x10);
-	write_cmos_sensor_8(ctx, 0x0349, 0x6F);
-	write_cmos_sensor_8(ctx, 0x034A, 0x0A);
-	write_cmos_sensor_8(ctx, 0x034B, 0xB7);
-	write_cmos_sensor_8(ctx, 0x0381, 0x01);
-	write_cmos_sensor_8(ctx, 0x0383, 0x01);
-	write_cmos_sensor_8(ctx, 0x0385, 0x01);
-	write_cmos_sensor_8(ctx, 0x0387, 0x01);
-	write_cmos_sensor_8(ctx, 0x0900, 0x01);
-	write_cmos_sensor_8(ctx, 0x0901, 0x22);
-	write_cmos_sensor_8(ctx, 0x0902, 0x02);
-	write_cmos_sensor_8(ctx, 0x3000, 0x35);
-	write_cmos_sensor_8(ctx, 0x3054, 0x01);
-	write_cmos_sensor_8(ctx, 0x305C, 0x11);
-
-	write_cmos_sensor_8(ctx, 0x0112, 0x0A);
-	write_cmos_sensor_8(ctx, 0x0113, 0x0A);
-	write_cmos_sensor_8(ctx, 0x034C, 0x08);
-	write_cmos_sensor_8(ctx, 0x034D, 0x38);
-	write_cmos_sensor_8(ctx, 0x034E, 0x04);
-	write_cmos_sensor_8(ctx, 0x034F, 0xA0);
-	write_cmos_sensor_8(ctx, 0x0401, 0x00);
-	write_cmos_sensor_8(ctx, 0x0404, 0x00);
-	write_cmos_sensor_8(ctx, 0x0405, 0x10);
-	write_cmos_sensor_8(ctx, 0x0408, 0x00);
-	write_cmos_sensor_8(ctx, 0x0409, 0x00);
-	write_cmos_sensor_8(ctx, 0x040A, 0x00);
-	write_cmos_sensor_8(ctx, 0x040B, 0x00);
-	write_cmos_sensor_8(ctx, 0x040C, 0x08);
-	write_cmos_sensor_8(ctx, 0x040D, 0x38);
-	write_cmos_sensor_8(ctx, 0x040E, 0x04);
-	write_cmos_sensor_8(ctx, 0x040F, 0xA0);
-
-	write_cmos_sensor_8(ctx, 0x0301, 0x05);
-	write_cmos_sensor_8(ctx, 0x0303, 0x02);
-	write_cmos_sensor_8(ctx, 0x0305, 0x03);
-	write_cmos_sensor_8(ctx, 0x0306, 0x00);
-	write_cmos_sensor_8(ctx, 0x0307, 0x79);//79
-	write_cmos_sensor_8(ctx, 0x0309, 0x0A);
-	write_cmos_sensor_8(ctx, 0x030B, 0x01);
-	write_cmos_sensor_8(ctx, 0x0310, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x0820, 0x0F);//0F
-	write_cmos_sensor_8(ctx, 0x0821, 0x20);// 20
-	write_cmos_sensor_8(ctx, 0x0822, 0x00);
-	write_cmos_sensor_8(ctx, 0x0823, 0x00);
-	write_cmos_sensor_8(ctx, 0x3A03, 0x06);
-	write_cmos_sensor_8(ctx, 0x3A04, 0x68);
-	write_cmos_sensor_8(ctx, 0x3A05, 0x01);
-	write_cmos_sensor_8(ctx, 0x0B06, 0x01);
-	write_cmos_sensor_8(ctx, 0x30A2, 0x00);
-	write_cmos_sensor_8(ctx, 0x30B4, 0x00);
-	write_cmos_sensor_8(ctx, 0x3A02, 0xFF);
-	write_cmos_sensor_8(ctx, 0x3013, 0x00);
-	write_cmos_sensor_8(ctx, 0x0202, 0x04);
-	write_cmos_sensor_8(ctx, 0x0203, 0xFE);
-	write_cmos_sensor_8(ctx, 0x0224, 0x01);
-	write_cmos_sensor_8(ctx, 0x0225, 0xF4);
-	write_cmos_sensor_8(ctx, 0x0204, 0x00);
-	write_cmos_sensor_8(ctx, 0x0205, 0x00);
-	write_cmos_sensor_8(ctx, 0x020E, 0x01);
-	write_cmos_sensor_8(ctx, 0x020F, 0x00);
-	write_cmos_sensor_8(ctx, 0x0210, 0x01);
-	write_cmos_sensor_8(ctx, 0x0211, 0x00);
-	write_cmos_sensor_8(ctx, 0x0212, 0x01);
-	write_cmos_sensor_8(ctx, 0x0213, 0x00);
-	write_cmos_sensor_8(ctx, 0x0214, 0x01);
-	write_cmos_sensor_8(ctx, 0x0215, 0x00);
-	write_cmos_sensor_8(ctx, 0x0216, 0x00);
-	write_cmos_sensor_8(ctx, 0x0217, 0x00);
-	write_cmos_sensor_8(ctx, 0x4170, 0x00);
-	write_cmos_sensor_8(ctx, 0x4171, 0x10);
-	write_cmos_sensor_8(ctx, 0x4176, 0x00);
-	write_cmos_sensor_8(ctx, 0x4177, 0x3C);
-	write_cmos_sensor_8(ctx, 0xAE20, 0x04);
-	write_cmos_sensor_8(ctx, 0xAE21, 0x5C);
-
-	write_cmos_sensor_8(ctx, 0x0138, 0x01);
-	write_cmos_sensor_8(ctx, 0x0100, 0x01);
+	sensor_mode_delta_apply(ctx, &imx214_mode_desc, IMX214_MODE_HS_VIDEO);
 }
 
 static void slim_video_setting(struct subdrv_ctx *ctx)
@@ -1840,6 +1912,8 @@ static int open(struct subdrv_ctx *ctx)
 
 	/* initail sequence write in  */
 	sensor_init(ctx);
+	/* power on reset, the next mode is written in full */
+	ctx->reg_mode = 0;
 
 	ctx->autoflicker_en = KAL_FALSE;
 	ctx->sensor_mode = IMGSENSOR_MODE_INIT;
@@ -2805,6 +2879,8 @@ static int init_ctx(struct subdrv_ctx *ctx,
 	memcpy(ctx, &defctx, sizeof(*ctx));
 	ctx->i2c_client = i2c_client;
 	ctx->i2c_write_id = i2c_write_id;
+	ctx->mode_delta = sensor_mode_delta_devm_compile(&i2c_client->dev,
+							 &imx214_mode_desc);
 	return 0;
 }
 
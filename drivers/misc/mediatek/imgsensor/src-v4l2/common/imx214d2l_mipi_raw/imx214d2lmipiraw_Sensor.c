@@ -20,6 +20,7 @@
 
 #include "adaptor-subdrv.h"
 #include "adaptor-i2c.h"
+#include "../sensor_mode_delta.h"
 
 #define read_cmos_sensor_8(...) subdrv_i2c_rd_u8(__VA_ARGS__)
 #define write_cmos_sensor_8(...) subdrv_i2c_wr_u8(__VA_ARGS__)
@@ -828,111 +829,362 @@ static void sensor_init(struct subdrv_ctx *ctx)
 	//cancel 1 delay frame for gain wit CIT
 } /* sensor_init */
 
+/* mode tables, written in standby between imx214d2l_mode_head and _tail */
+enum {
+	IMX214D2L_MODE_PREVIEW,
+	IMX214D2L_MODE_CAPTURE,
+	IMX214D2L_MODE_NORMAL_VIDEO,
+};
+
+static const u16 imx214d2l_mode_head[] = {
+	0x0100, 0x00,
+};
+
+static const u16 imx214d2l_mode_tail[] = {
+	0x0100, 0x01,
+};
+
+/* also written by the shutter, gain and frame length controls */
+static const u16 imx214d2l_mode_volatile[] = {
+	0x0202, 0x0203,
+	0x0204, 0x0205,
+	0x0216, 0x0217,
+	0x0224, 0x0225,
+	0x0340, 0x0341,
+};
+
+static const u16 imx214d2l_preview_regs[] = {
+	0x0114, 0x01,
+	0x0220, 0x00,
+	0x0221, 0x11,
+	0x0222, 0x01,
+	0x0340, 0x06,
+	0x0341, 0x40,
+	0x0342, 0x13,
+	0x0343, 0x90,
+	0x0344, 0x00,
+	0x0345, 0x00,
+	0x0346, 0x00,
+	0x0347, 0x00,
+	0x0348, 0x10,
+	0x0349, 0x6F,
+	0x034A, 0x0C,
+	0x034B, 0x2F,
+	0x0381, 0x01,
+	0x0383, 0x01,
+	0x0385, 0x01,
+	0x0387, 0x01,
+	0x0900, 0x01,
+	0x0901, 0x22,
+	0x0902, 0x02,
+	0x3000, 0x35,
+	0x3054, 0x01,
+	0x305C, 0x11,
+
+	0x0112, 0x0A,
+	0x0113, 0x0A,
+	0x034C, 0x08,
+	0x034D, 0x38,
+	0x034E, 0x06,
+	0x034F, 0x18,
+	0x0401, 0x00,
+	0x0404, 0x00,
+	0x0405, 0x10,
+	0x0408, 0x00,
+	0x0409, 0x00,
+	0x040A, 0x00,
+	0x040B, 0x00,
+	0x040C, 0x08,
+	0x040D, 0x38,
+	0x040E, 0x06,
+	0x040F, 0x18,
+
+	0x0301, 0x05,
+	0x0303, 0x04,
+	0x0305, 0x03,
+	0x0306, 0x00,
+	0x0307, 0x96,
+	0x0309, 0x0A,
+	0x030B, 0x01,
+	0x0310, 0x00,
+
+	0x0820, 0x09,
+	0x0821, 0x60,
+	0x0822, 0x00,
+	0x0823, 0x00,
+
+	0x3A03, 0x06,
+	0x3A04, 0x68,
+	0x3A05, 0x01,
+
+	0x0B06, 0x01,
+	0x30A2, 0x00,
+
+	0x30B4, 0x00,
+
+	0x3A02, 0xFF,
+
+	0x3011, 0x00,
+	0x3013, 0x00,
+
+	0x0202, 0x06,
+	0x0203, 0x00,
+	0x0224, 0x01,
+	0x0225, 0xF4,
+
+	0x0204, 0x00,
+	0x0205, 0x00,
+	0x020E, 0x01,
+	0x020F, 0x00,
+	0x0210, 0x01,
+	0x0211, 0x00,
+	0x0212, 0x01,
+	0x0213, 0x00,
+	0x0214, 0x01,
+	0x0215, 0x00,
+	0x0216, 0x00,
+	0x0217, 0x00,
+
+	0x4170, 0x00,
+	0x4171, 0x10,
+	0x4176, 0x00,
+	0x4177, 0x3C,
+	0xAE20, 0x04,
+	0xAE21, 0x5C,
+
+	0x0138, 0x01,
+};
+
+static const u16 imx214d2l_capture_regs[] = {
+	0x0114, 0x01,
+	0x0220, 0x00,
+	0x0221, 0x11,
+	0x0222, 0x01,
+	0x0340, 0x0C,
+	0x0341, 0x58,
+	0x0342, 0x13,
+	0x0343, 0x90,
+	0x0344, 0x00,
+	0x0345, 0x00,
+	0x0346, 0x00,
+	0x0347, 0x00,
+	0x0348, 0x10,
+	0x0349, 0x6F,
+	0x034A, 0x0C,
+	0x034B, 0x2F,
+	0x0381, 0x01,
+	0x0383, 0x01,
+	0x0385, 0x01,
+	0x0387, 0x01,
+	0x0900, 0x00,
+	0x0901, 0x00,
+	0x0902, 0x00,
+	0x3000, 0x35,
+	0x3054, 0x01,
+	0x305C, 0x11,
+
+	0x0112, 0x0A,
+	0x0113, 0x0A,
+	0x034C, 0x10,
+	0x034D, 0x70,
+	0x034E, 0x0C,
+	0x034F, 0x30,
+	0x0401, 0x00,
+	0x0404, 0x00,
+	0x0405, 0x10,
+	0x0408, 0x00,
+	0x0409, 0x00,
+	0x040A, 0x00,
+	0x040B, 0x00,
+	0x040C, 0x10,
+	0x040D, 0x70,
+	0x040E, 0x0C,
+	0x040F, 0x30,
+
+	0x0301, 0x05,
+	0x0303, 0x04,
+	0x0305, 0x03,
+	0x0306, 0x00,
+	0x0307, 0x96,
+	0x0309, 0x0A,
+	0x030B, 0x01,
+	0x0310, 0x00,
+
+	0x0820, 0x09,
+	0x0821, 0x60,
+	0x0822, 0x00,
+	0x0823, 0x00,
+
+	0x3A03, 0x08,
+	0x3A04, 0x70,
+	0x3A05, 0x02,
+
+	0x0B06, 0x01,
+	0x30A2, 0x00,
+
+	0x30B4, 0x00,
+
+	0x3A02, 0xff,
+
+	0x3011, 0x00,
+	0x3013, 0x01,
+
+	0x0202, 0x0C,
+	0x0203, 0x4E,
+	0x0224, 0x01,
+	0x0225, 0xF4,
+
+	0x0204, 0x00,
+	0x0205, 0x00,
+	0x020E, 0x01,
+	0x020F, 0x00,
+	0x0210, 0x01,
+	0x0211, 0x00,
+	0x0212, 0x01,
+	0x0213, 0x00,
+	0x0214, 0x01,
+	0x0215, 0x00,
+	0x0216, 0x00,
+	0x0217, 0x00,
+
+	0x4170, 0x00,
+	0x4171, 0x10,
+	0x4176, 0x00,
+	0x4177, 0x3C,
+	0xAE20, 0x04,
+	0xAE21, 0x5C,
+
+	0x0138, 0x01,
+};
+
+static const u16 imx214d2l_normal_video_regs[] = {
+	0x0114, 0x01,
+	0x0220, 0x00,
+	0x0221, 0x11,
+	0x0222, 0x01,
+	0x0340, 0x0C,
+	0x0341, 0x58,
+	0x0342, 0x13,
+	0x0343, 0x90,
+	0x0344, 0x00,
+	0x0345, 0x00,
+	0x0346, 0x00,
+	0x0347, 0x00,
+	0x0348, 0x10,
+	0x0349, 0x6F,
+	0x034A, 0x0C,
+	0x034B, 0x2F,
+	0x0381, 0x01,
+	0x0383, 0x01,
+	0x0385, 0x01,
+	0x0387, 0x01,
+	0x0900, 0x00,
+	0x0901, 0x00,
+	0x0902, 0x00,
+	0x3000, 0x35,
+	0x3054, 0x01,
+	0x305C, 0x11,
+
+	0x0112, 0x0A,
+	0x0113, 0x0A,
+	0x034C, 0x10,
+	0x034D, 0x70,
+	0x034E, 0x0C,
+	0x034F, 0x30,
+	0x0401, 0x00,
+	0x0404, 0x00,
+	0x0405, 0x10,
+	0x0408, 0x00,
+	0x0409, 0x00,
+	0x040A, 0x00,
+	0x040B, 0x00,
+	0x040C, 0x10,
+	0x040D, 0x70,
+	0x040E, 0x0C,
+	0x040F, 0x30,
+
+	0x0301, 0x05,
+	0x0303, 0x04,
+	0x0305, 0x03,
+	0x0306, 0x00,
+	0x0307, 0x96,
+	0x0309, 0x0A,
+	0x030B, 0x01,
+	0x0310, 0x00,
+
+	0x0820, 0x09,
+	0x0821, 0x60,
+	0x0822, 0x00,
+	0x0823, 0x00,
+
+	0x3A03, 0x08,
+	0x3A04, 0x70,
+	0x3A05, 0x02,
+
+	0x0B06, 0x01,
+	0x30A2, 0x00,
+
+	0x30B4, 0x00,
+
+	0x3A02, 0xff,
+
+	0x3011, 0x00,
+	0x3013, 0x01,
+
+	0x0202, 0x0C,
+	0x0203, 0x4E,
+	0x0224, 0x01,
+	0x0225, 0xF4,
+
+	0x0204, 0x00,
+	0x0205, 0x00,
+	0x020E, 0x01,
+	0x020F, 0x00,
+	0x0210, 0x01,
+	0x0211, 0x00,
+	0x0212, 0x01,
+	0x0213, 0x00,
+	0x0214, 0x01,
+	0x0215, 0x00,
+	0x0216, 0x00,
+	0x0217, 0x00,
+
+	0x4170, 0x00,
+	0x4171, 0x10,
+	0x4176, 0x00,
+	0x4177, 0x3C,
+	0xAE20, 0x04,
+	0xAE21, 0x5C,
+
+	0x0138, 0x01,
+};
+
+static const struct sensor_mode_table imx214d2l_modes[] = {
+	[IMX214D2L_MODE_PREVIEW] = {
+		imx214d2l_preview_regs, ARRAY_SIZE(imx214d2l_preview_regs)
+	},
+	[IMX214D2L_MODE_CAPTURE] = {
+		imx214d2l_capture_regs, ARRAY_SIZE(imx214d2l_capture_regs)
+	},
+	[IMX214D2L_MODE_NORMAL_VIDEO] = {
+		imx214d2l_normal_video_regs, ARRAY_SIZE(imx214d2l_normal_video_regs)
+	},
+};
+
+static const struct sensor_mode_desc imx214d2l_mode_desc = {
+	.modes = imx214d2l_modes,
+	.n_modes = ARRAY_SIZE(imx214d2l_modes),
+	.head = { imx214d2l_mode_head, ARRAY_SIZE(imx214d2l_mode_head) },
+	.tail = { imx214d2l_mode_tail, ARRAY_SIZE(imx214d2l_mode_tail) },
+	.volatile_regs = imx214d2l_mode_volatile,
+	.n_volatile = ARRAY_SIZE(imx214d2l_mode_volatile),
+};
+
 static void preview_setting(struct subdrv_ctx *ctx)
 {
 	//Preview 2104*1560 24M MCLK 2lane 1200Mbps/lane
 	// preview 30fps
-	write_cmos_sensor_8(ctx, 0x0100, 0x00);
-	write_cmos_sensor_8(ctx, 0x0114, 0x01);
-	write_cmos_sensor_8(ctx, 0x0220, 0x00);
-	write_cmos_sensor_8(ctx, 0x0221, 0x11);
-	write_cmos_sensor_8(ctx, 0x0222, 0x01);
-	write_cmos_sensor_8(ctx, 0x0340, 0x06);
-	write_cmos_sensor_8(ctx, 0x0341, 0x40);
-	write_cmos_sensor_8(ctx, 0x0342, 0x13);
-	write_cmos_sensor_8(ctx, 0x0343, 0x90);
-	write_cmos_sensor_8(ctx, 0x0344, 0x00);
-	write_cmos_sensor_8(ctx, 0x0345, 0x00);
-	write_cmos_sensor_8(ctx, 0x0346, 0x00);
-	write_cmos_sensor_8(ctx, 0x0347, 0x00);
-	write_cmos_sensor_8(ctx, 0x0348, 0x10);
-	write_cmos_sensor_8(ctx, 0x0349, 0x6F);
-	write_cmos_sensor_8(ctx, 0x034A, 0x0C);
-	write_cmos_sensor_8(ctx, 0x034B, 0x2F);
-	write_cmos_sensor_8(ctx, 0x0381, 0x01);
-	write_cmos_sensor_8(ctx, 0x0383, 0x01);
-	write_cmos_sensor_8(ctx, 0x0385, 0x01);
-	write_cmos_sensor_8(ctx, 0x0387, 0x01);
-	write_cmos_sensor_8(ctx, 0x0900, 0x01);
-	write_cmos_sensor_8(ctx, 0x0901, 0x22);
-	write_cmos_sensor_8(ctx, 0x0902, 0x02);
-	write_cmos_sensor_8(ctx, 0x3000, 0x35);
-	write_cmos_sensor_8(ctx, 0x3054, 0x01);
-	write_cmos_sensor_8(ctx, 0x305C, 0x11);
-
-	write_cmos_sensor_8(ctx, 0x0112, 0x0A);
-	write_cmos_sensor_8(ctx, 0x0113, 0x0A);
-	write_cmos_sensor_8(ctx, 0x034C, 0x08);
-	write_cmos_sensor_8(ctx, 0x034D, 0x38);
-	write_cmos_sensor_8(ctx, 0x034E, 0x06);
-	write_cmos_sensor_8(ctx, 0x034F, 0x18);
-	write_cmos_sensor_8(ctx, 0x0401, 0x00);
-	write_cmos_sensor_8(ctx, 0x0404, 0x00);
-	write_cmos_sensor_8(ctx, 0x0405, 0x10);
-	write_cmos_sensor_8(ctx, 0x0408, 0x00);
-	write_cmos_sensor_8(ctx, 0x0409, 0x00);
-	write_cmos_sensor_8(ctx, 0x040A, 0x00);
-	write_cmos_sensor_8(ctx, 0x040B, 0x00);
-	write_cmos_sensor_8(ctx, 0x040C, 0x08);
-	write_cmos_sensor_8(ctx, 0x040D, 0x38);
-	write_cmos_sensor_8(ctx, 0x040E, 0x06);
-	write_cmos_sensor_8(ctx, 0x040F, 0x18);
-
-	write_cmos_sensor_8(ctx, 0x0301, 0x05);
-	write_cmos_sensor_8(ctx, 0x0303, 0x04);
-	write_cmos_sensor_8(ctx, 0x0305, 0x03);
-	write_cmos_sensor_8(ctx, 0x0306, 0x00);
-	write_cmos_sensor_8(ctx, 0x0307, 0x96);
-	write_cmos_sensor_8(ctx, 0x0309, 0x0A);
-	write_cmos_sensor_8(ctx, 0x030B, 0x01);
-	write_cmos_sensor_8(ctx, 0x0310, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x0820, 0x09);
-	write_cmos_sensor_8(ctx, 0x0821, 0x60);
-	write_cmos_sensor_8(ctx, 0x0822, 0x00);
-	write_cmos_sensor_8(ctx, 0x0823, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x3A03, 0x06);
-	write_cmos_sensor_8(ctx, 0x3A04, 0x68);
-	write_cmos_sensor_8(ctx, 0x3A05, 0x01);
-
-	write_cmos_sensor_8(ctx, 0x0B06, 0x01);
-	write_cmos_sensor_8(ctx, 0x30A2, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x30B4, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x3A02, 0xFF);
-
-	write_cmos_sensor_8(ctx, 0x3011, 0x00);
-	write_cmos_sensor_8(ctx, 0x3013, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x0202, 0x06);
-	write_cmos_sensor_8(ctx, 0x0203, 0x00);
-	write_cmos_sensor_8(ctx, 0x0224, 0x01);
-	write_cmos_sensor_8(ctx, 0x0225, 0xF4);
-
-	write_cmos_sensor_8(ctx, 0x0204, 0x00);
-	write_cmos_sensor_8(ctx, 0x0205, 0x00);
-	write_cmos_sensor_8(ctx, 0x020E, 0x01);
-	write_cmos_sensor_8(ctx, 0x020F, 0x00);
-	write_cmos_sensor_8(ctx, 0x0210, 0x01);
-	write_cmos_sensor_8(ctx, 0x0211, 0x00);
-	write_cmos_sensor_8(ctx, 0x0212, 0x01);
-	write_cmos_sensor_8(ctx, 0x0213, 0x00);
-	write_cmos_sensor_8(ctx, 0x0214, 0x01);
-	write_cmos_sensor_8(ctx, 0x0215, 0x00);
-	write_cmos_sensor_8(ctx, 0x0216, 0x00);
-	write_cmos_sensor_8(ctx, 0x0217, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x4170, 0x00);
-	write_cmos_sensor_8(ctx, 0x4171, 0x10);
-	write_cmos_sensor_8(ctx, 0x4176, 0x00);
-	write_cmos_sensor_8(ctx, 0x4177, 0x3C);
-	write_cmos_sensor_8(ctx, 0xAE20, 0x04);
-	write_cmos_sensor_8(ctx, 0xAE21, 0x5C);
-
-	write_cmos_sensor_8(ctx, 0x0138, 0x01);
-	write_cmos_sensor_8(ctx, 0x0100, 0x01);
+	sensor_mode_delta_apply(ctx, &imx214d2l_mode_desc, IMX214D2L_MODE_PREVIEW);
 }   /*  preview_setting  */
 
 static void preview_setting_HDR(struct subdrv_ctx *ctx)
@@ -947,214 +1199,14 @@ static void capture_setting(struct subdrv_ctx *ctx, kal_uint16 currefps)
 
 	LOG_DBG("E 15fps setting\n");
 	// full size 15fps
-	write_cmos_sensor_8(ctx, 0x0100, 0x00);
-	write_cmos_sensor_8(ctx, 0x0114, 0x01);
-	write_cmos_sensor_8(ctx, 0x0220, 0x00);
-	write_cmos_sensor_8(ctx, 0x0221, 0x11);
-	write_cmos_sensor_8(ctx, 0x0222, 0x01);
-	write_cmos_sensor_8(ctx, 0x0340, 0x0C);
-	write_cmos_sensor_8(ctx, 0x0341, 0x58);
-	write_cmos_sensor_8(ctx, 0x0342, 0x13);
-	write_cmos_sensor_8(ctx, 0x0343, 0x90);
-	write_cmos_sensor_8(ctx, 0x0344, 0x00);
-	write_cmos_sensor_8(ctx, 0x0345, 0x00);
-	write_cmos_sensor_8(ctx, 0x0346, 0x00);
-	write_cmos_sensor_8(ctx, 0x0347, 0x00);
-	write_cmos_sensor_8(ctx, 0x0348, 0x10);
-	write_cmos_sensor_8(ctx, 0x0349, 0x6F);
-	write_cmos_sensor_8(ctx, 0x034A, 0x0C);
-	write_cmos_sensor_8(ctx, 0x034B, 0x2F);
-	write_cmos_sensor_8(ctx, 0x0381, 0x01);
-	write_cmos_sensor_8(ctx, 0x0383, 0x01);
-	write_cmos_sensor_8(ctx, 0x0385, 0x01);
-	write_cmos_sensor_8(ctx, 0x0387, 0x01);
-	write_cmos_sensor_8(ctx, 0x0900, 0x00);
-	write_cmos_sensor_8(ctx, 0x0901, 0x00);
-	write_cmos_sensor_8(ctx, 0x0902, 0x00);
-	write_cmos_sensor_8(ctx, 0x3000, 0x35);
-	write_cmos_sensor_8(ctx, 0x3054, 0x01);
-	write_cmos_sensor_8(ctx, 0x305C, 0x11);
-
-	write_cmos_sensor_8(ctx, 0x0112, 0x0A);
-	write_cmos_sensor_8(ctx, 0x0113, 0x0A);
-	write_cmos_sensor_8(ctx, 0x034C, 0x10);
-	write_cmos_sensor_8(ctx, 0x034D, 0x70);
-	write_cmos_sensor_8(ctx, 0x034E, 0x0C);
-	write_cmos_sensor_8(ctx, 0x034F, 0x30);
-	write_cmos_sensor_8(ctx, 0x0401, 0x00);
-	write_cmos_sensor_8(ctx, 0x0404, 0x00);
-	write_cmos_sensor_8(ctx, 0x0405, 0x10);
-	write_cmos_sensor_8(ctx, 0x0408, 0x00);
-	write_cmos_sensor_8(ctx, 0x0409, 0x00);
-	write_cmos_sensor_8(ctx, 0x040A, 0x00);
-	write_cmos_sensor_8(ctx, 0x040B, 0x00);
-	write_cmos_sensor_8(ctx, 0x040C, 0x10);
-	write_cmos_sensor_8(ctx, 0x040D, 0x70);
-	write_cmos_sensor_8(ctx, 0x040E, 0x0C);
-	write_cmos_sensor_8(ctx, 0x040F, 0x30);
-
-	write_cmos_sensor_8(ctx, 0x0301, 0x05);
-	write_cmos_sensor_8(ctx, 0x0303, 0x04);
-	write_cmos_sensor_8(ctx, 0x0305, 0x03);
-	write_cmos_sensor_8(ctx, 0x0306, 0x00);
-	write_cmos_sensor_8(ctx, 0x0307, 0x96);
-	write_cmos_sensor_8(ctx, 0x0309, 0x0A);
-	write_cmos_sensor_8(ctx, 0x030B, 0x01);
-	write_cmos_sensor_8(ctx, 0x0310, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x0820, 0x09);
-	write_cmos_sensor_8(ctx, 0x0821, 0x60);
-	write_cmos_sensor_8(ctx, 0x0822, 0x00);
-	write_cmos_sensor_8(ctx, 0x0823, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x3A03, 0x08);
-	write_cmos_sensor_8(ctx, 0x3A04, 0x70);
-	write_cmos_sensor_8(ctx, 0x3A05, 0x02);
-
-	write_cmos_sensor_8(ctx, 0x0B06, 0x01);
-	write_cmos_sensor_8(ctx, 0x30A2, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x30B4, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x3A02, 0xff);
-
-	write_cmos_sensor_8(ctx, 0x3011, 0x00);
-	write_cmos_sensor_8(ctx, 0x3013, 0x01);
-
-	write_cmos_sensor_8(ctx, 0x0202, 0x0C);
-	write_cmos_sensor_8(ctx, 0x0203, 0x4E);
-	write_cmos_sensor_8(ctx, 0x0224, 0x01);
-	write_cmos_sensor_8(ctx, 0x0225, 0xF4);
-
-	write_cmos_sensor_8(ctx, 0x0204, 0x00);
-	write_cmos_sensor_8(ctx, 0x0205, 0x00);
-	write_cmos_sensor_8(ctx, 0x020E, 0x01);
-	write_cmos_sensor_8(ctx, 0x020F, 0x00);
-	write_cmos_sensor_8(ctx, 0x0210, 0x01);
-	write_cmos_sensor_8(ctx, 0x0211, 0x00);
-	write_cmos_sensor_8(ctx, 0x0212, 0x01);
-	write_cmos_sensor_8(ctx, 0x0213, 0x00);
-	write_cmos_sensor_8(ctx, 0x0214, 0x01);
-	write_cmos_sensor_8(ctx, 0x0215, 0x00);
-	write_cmos_sensor_8(ctx, 0x0216, 0x00);
-	write_cmos_sensor_8(ctx, 0x0217, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x4170, 0x00);
-	write_cmos_sensor_8(ctx, 0x4171, 0x10);
-	write_cmos_sensor_8(ctx, 0x4176, 0x00);
-	write_cmos_sensor_8(ctx, 0x4177, 0x3C);
-	write_cmos_sensor_8(ctx, 0xAE20, 0x04);
-	write_cmos_sensor_8(ctx, 0xAE21, 0x5C);
-
-	write_cmos_sensor_8(ctx, 0x0138, 0x01);
-	write_cmos_sensor_8(ctx, 0x0100, 0x01);
+	sensor_mode_delta_apply(ctx, &imx214d2l_mode_desc, IMX214D2L_MODE_CAPTURE);
 }
 
 static void normal_video_setting(struct subdrv_ctx *ctx, kal_uint16 currefps)
 {
 	LOG_INFO("E! currefps:%u\n", currefps);
 	// full size 15fps
-	write_cmos_sensor_8(ctx, 0x0100, 0x00);
-	write_cmos_sensor_8(ctx, 0x0114, 0x01);
-	write_cmos_sensor_8(ctx, 0x0220, 0x00);
-	write_cmos_sensor_8(ctx, 0x0221, 0x11);
-	write_cmos_sensor_8(ctx, 0x0222, 0x01);
-	write_cmos_sensor_8(ctx, 0x0340, 0x0C);
-	write_cmos_sensor_8(ctx, 0x0341, 0x58);
-	write_cmos_sensor_8(ctx, 0x0342, 0x13);
-	write_cmos_sensor_8(ctx, 0x0343, 0x90);
-	write_cmos_sensor_8(ctx, 0x0344, 0x00);
-	write_cmos_sensor_8(ctx, 0x0345, 0x00);
-	write_cmos_sensor_8(ctx, 0x0346, 0x00);
-	write_cmos_sensor_8(ctx, 0x0347, 0x00);
-	write_cmos_sensor_8(ctx, 0x0348, 0x10);
-	write_cmos_sensor_8(ctx, 0x0349, 0x6F);
-	write_cmos_sensor_8(ctx, 0x034A, 0x0C);
-	write_cmos_sensor_8(ctx, 0x034B, 0x2F);
-	write_cmos_sensor_8(ctx, 0x0381, 0x01);
-	write_cmos_sensor_8(ctx, 0x0383, 0x01);
-	write_cmos_sensor_8(ctx, 0x0385, 0x01);
-	write_cmos_sensor_8(ctx, 0x0387, 0x01);
-	write_cmos_sensor_8(ctx, 0x0900, 0x00);
-	write_cmos_sensor_8(ctx, 0x0901, 0x00);
-	write_cmos_sensor_8(ctx, 0x0902, 0x00);
-	write_cmos_sensor_8(ctx, 0x3000, 0x35);
-	write_cmos_sensor_8(ctx, 0x3054, 0x01);
-	write_cmos_sensor_8(ctx, 0x305C, 0x11);
-
-	write_cmos_sensor_8(ctx, 0x0112, 0x0A);
-	write_cmos_sensor_8(ctx, 0x0113, 0x0A);
-	write_cmos_sensor_8(ctx, 0x034C, 0x10);
-	write_cmos_sensor_8(ctx, 0x034D, 0x70);
-	write_cmos_sensor_8(ctx, 0x034E, 0x0C);
-	write_cmos_sensor_8(ctx, 0x034F, 0x30);
-	write_cmos_sensor_8(ctx, 0x0401, 0x00);
-	write_cmos_sensor_8(ctx, 0x0404, 0x00);
-	write_cmos_sensor_8(ctx, 0x0405, 0x10);
-	write_cmos_sensor_8(ctx, 0x0408, 0x00);
-	write_cmos_sensor_8(ctx, 0x0409, 0x00);
-	write_cmos_sensor_8(ctx, 0x040A, 0x00);
-	write_cmos_sensor_8(ctx, 0x040B, 0x00);
-	write_cmos_sensor_8(ctx, 0x040C, 0x10);
-	write_cmos_sensor_8(ctx, 0x040D, 0x70);
-	write_cmos_sensor_8(ctx, 0x040E, 0x0C);
-	write_cmos_sensor_8(ctx, 0x040F, 0x30);
-
-	write_cmos_sensor_8(ctx, 0x0301, 0x05);
-	write_cmos_sensor_8(ctx, 0x0303, 0x04);
-	write_cmos_sensor_8(ctx, 0x0305, 0x03);
-	write_cmos_sensor_8(ctx, 0x0306, 0x00);
-	write_cmos_sensor_8(ctx, 0x0307, 0x96);
-	write_cmos_sensor_8(ctx, 0x0309, 0x0A);
-	write_cmos_sensor_8(ctx, 0x030B, 0x01);
-	write_cmos_sensor_8(ctx, 0x0310, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x0820, 0x09);
-	write_cmos_sensor_8(ctx, 0x0821, 0x60);
-	write_cmos_sensor_8(ctx, 0x0822, 0x00);
-	write_cmos_sensor_8(ctx, 0x0823, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x3A03, 0x08);
-	write_cmos_sensor_8(ctx, 0x3A04, 0x70);
-	write_cmos_sensor_8(ctx, 0x3A05, 0x02);
-
-	write_cmos_sensor_8(ctx, 0x0B06, 0x01);
-	write_cmos_sensor_8(ctx, 0x30A2, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x30B4, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x3A02, 0xff);
-
-	write_cmos_sensor_8(ctx, 0x3011, 0x00);
-	write_cmos_sensor_8(ctx, 0x3013, 0x01);
-
-	write_cmos_sensor_8(ctx, 0x0202, 0x0C);
-	write_cmos_sensor_8(ctx, 0x0203, 0x4E);
-	write_cmos_sensor_8(ctx, 0x0224, 0x01);
-	write_cmos_sensor_8(ctx, 0x0225, 0xF4);
-
-	write_cmos_sensor_8(ctx, 0x0204, 0x00);
-	write_cmos_sensor_8(ctx, 0x0205, 0x00);
-	write_cmos_sensor_8(ctx, 0x020E, 0x01);
-	write_cmos_sensor_8(ctx, 0x020F, 0x00);
-	write_cmos_sensor_8(ctx, 0x0210, 0x01);
-	write_cmos_sensor_8(ctx, 0x0211, 0x00);
-	write_cmos_sensor_8(ctx, 0x0212, 0x01);
-	write_cmos_sensor_8(ctx, 0x0213, 0x00);
-	write_cmos_sensor_8(ctx, 0x0214, 0x01);
-	write_cmos_sensor_8(ctx, 0x0215, 0x00);
-	write_cmos_sensor_8(ctx, 0x0216, 0x00);
-	write_cmos_sensor_8(ctx, 0x0217, 0x00);
-
-	write_cmos_sensor_8(ctx, 0x4170, 0x00);
-	write_cmos_sensor_8(ctx, 0x4171, 0x10);
-	write_cmos_sensor_8(ctx, 0x4176, 0x00);
-	write_cmos_sensor_8(ctx, 0x4177, 0x3C);
-	write_cmos_sensor_8(ctx, 0xAE20, 0x04);
-	write_cmos_sensor_8(ctx, 0xAE21, 0x5C);
-
-	write_cmos_sensor_8(ctx, 0x0138, 0x01);
-	write_cmos_sensor_8(ctx, 0x0100, 0x01);
+	sensor_mode_delta_apply(ctx, &imx214d2l_mode_desc, IMX214D2L_MODE_NORMAL_VIDEO);
 }
 
 static void fullsize_setting_HDR(struct subdrv_ctx *ctx, kal_uint16 currefps)
@@ -1251,6 +1303,8 @@ static int open(struct subdrv_ctx *ctx)
 
 	/* initail sequence write in  */
 	sensor_init(ctx);
+	/* power on reset, the next mode is written in full */
+	ctx->reg_mode = 0;
 
 	ctx->autoflicker_en = KAL_FALSE;
 	ctx->sensor_mode = IMGSENSOR_MODE_INIT;
@@ -2216,6 +2270,8 @@ static int init_ctx(struct subdrv_ctx *ctx,
 	memcpy(ctx, &defctx, sizeof(*ctx));
 	ctx->i2c_client = i2c_client;
 	ctx->i2c_write_id = i2c_write_id;
+	ctx->mode_delta = sensor_mode_delta_devm_compile(&i2c_client->dev,
+							 &imx214d2l_mode_desc);
 	return 0;
 }
 
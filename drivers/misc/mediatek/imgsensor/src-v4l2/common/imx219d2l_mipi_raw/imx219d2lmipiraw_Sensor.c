@@ -20,6 +20,7 @@
 
 #include "adaptor-subdrv.h"
 #include "adaptor-i2c.h"
+#include "../sensor_mode_delta.h"
 
 #define read_cmos_sensor_8(...) subdrv_i2c_rd_u8(__VA_ARGS__)
 #define write_cmos_sensor_8(...) subdrv_i2c_wr_u8(__VA_ARGS__)
@@ -433,68 +434,212 @@ static void sensor_init(struct subdrv_ctx *ctx)
 	write_cmos_sensor_8(ctx, 0x0163, 0x78);
 } /* sensor_init */
 
+/* mode tables, written in standby between imx219d2l_mode_head and _tail */
+enum {
+	IMX219D2L_MODE_PREVIEW,
+	IMX219D2L_MODE_CAPTURE,
+	IMX219D2L_MODE_NORMAL_VIDEO,
+};
+
+static const u16 imx219d2l_mode_head[] = {
+	0x0100, 0x00,
+	0x30eb, 0x05,
+	0x30eb, 0x0c,
+	0x300a, 0xff,
+	0x300b, 0xff,
+	0x30eb, 0x05,
+	0x30eb, 0x09,
+};
+
+static const u16 imx219d2l_preview_regs[] = {
+	0x0114, 0x01,
+	0x0128, 0x00,
+	0x012a, 0x18,
+	0x012b, 0x00,
+	0x0160, 0x06,
+	0x0161, 0xe4,
+	0x0162, 0x0d,
+	0x0163, 0x78,
+	0x0164, 0x02,
+	0x0165, 0xa8,
+	0x0166, 0x0a,
+	0x0167, 0x27,
+	0x0168, 0x02,
+	0x0169, 0xb4,
+	0x016a, 0x06,
+	0x016b, 0xeb,
+	0x016c, 0x07,
+	0x016d, 0x80,
+	0x016e, 0x04,
+	0x016f, 0x38,
+	0x0170, 0x01,
+	0x0171, 0x01,
+	0x0174, 0x00,
+	0x0175, 0x00,
+	0x0301, 0x05,
+	0x0303, 0x01,
+	0x0304, 0x03,
+	0x0305, 0x03,
+	0x0306, 0x00,
+	0x0307, 0x39,
+	0x030b, 0x01,
+	0x030c, 0x00,
+	0x030d, 0x72,
+	0x0624, 0x07,
+	0x0625, 0x80,
+	0x0626, 0x04,
+	0x0627, 0x38,
+	0x455e, 0x00,
+	0x471e, 0x4b,
+	0x4767, 0x0f,
+	0x4750, 0x14,
+	0x4540, 0x00,
+	0x47b4, 0x14,
+	0x4713, 0x30,
+	0x478b, 0x10,
+	0x478f, 0x10,
+	0x4793, 0x10,
+	0x4797, 0x0e,
+	0x479b, 0x0e,
+	0x0160, 0x06,
+	0x0161, 0xe4,
+	0x0162, 0x0d,
+	0x0163, 0x78,
+};
+
+static const u16 imx219d2l_capture_regs[] = {
+	0x0114, 0x01,
+	0x0128, 0x00,
+	0x012a, 0x18,
+	0x012b, 0x00,
+	0x0160, 0x06,
+	0x0161, 0xe4,
+	0x0162, 0x0d,
+	0x0163, 0x78,
+	0x0164, 0x02,
+	0x0165, 0xa8,
+	0x0166, 0x0a,
+	0x0167, 0x27,
+	0x0168, 0x02,
+	0x0169, 0xb4,
+	0x016a, 0x06,
+	0x016b, 0xeb,
+	0x016c, 0x07,
+	0x016d, 0x80,
+	0x016e, 0x04,
+	0x016f, 0x38,
+	0x0170, 0x01,
+	0x0171, 0x01,
+	0x0174, 0x00,
+	0x0175, 0x00,
+	0x0301, 0x05,
+	0x0303, 0x01,
+	0x0304, 0x03,
+	0x0305, 0x03,
+	0x0306, 0x00,
+	0x0307, 0x39,
+	0x030b, 0x01,
+	0x030c, 0x00,
+	0x030d, 0x72,
+	0x0624, 0x07,
+	0x0625, 0x80,
+	0x0626, 0x04,
+	0x0627, 0x38,
+	0x455e, 0x00,
+	0x471e, 0x4b,
+	0x4767, 0x0f,
+	0x4750, 0x14,
+	0x4540, 0x00,
+	0x47b4, 0x14,
+	0x4713, 0x30,
+	0x478b, 0x10,
+	0x478f, 0x10,
+	0x4793, 0x10,
+	0x4797, 0x0e,
+	0x479b, 0x0e,
+	0x0160, 0x06,
+	0x0161, 0xe4,
+	0x0162, 0x0d,
+	0x0163, 0x78,
+};
+
+static const u16 imx219d2l_normal_video_regs[] = {
+	0x0114, 0x01,
+	0x0128, 0x00,
+	0x012a, 0x18,
+	0x012b, 0x00,
+	0x0160, 0x06,
+	0x0161, 0xe4,
+	0x0162, 0x0d,
+	0x0163, 0x78,
+	0x0164, 0x02,
+	0x0165, 0xa8,
+	0x0166, 0x0a,
+	0x0167, 0x27,
+	0x0168, 0x02,
+	0x0169, 0xb4,
+	0x016a, 0x06,
+	0x016b, 0xeb,
+	0x016c, 0x07,
+	0x016d, 0x80,
+	0x016e, 0x04,
+	0x016f, 0x38,
+	0x0170, 0x01,
+	0x0171, 0x01,
+	0x0174, 0x00,
+	0x0175, 0x00,
+	0x0301, 0x05,
+	0x0303, 0x01,
+	0x0304, 0x03,
+	0x0305, 0x03,
+	0x0306, 0x00,
+	0x0307, 0x39,
+	0x030b, 0x01,
+	0x030c, 0x00,
+	0x030d, 0x72,
+	0x0624, 0x07,
+	0x0625, 0x80,
+	0x0626, 0x04,
+	0x0627, 0x38,
+	0x455e, 0x00,
+	0x471e, 0x4b,
+	0x4767, 0x0f,
+	0x4750, 0x14,
+	0x4540, 0x00,
+	0x47b4, 0x14,
+	0x4713, 0x30,
+	0x478b, 0x10,
+	0x478f, 0x10,
+	0x4793, 0x10,
+	0x4797, 0x0e,
+	0x479b, 0x0e,
+	0x0160, 0x06,
+	0x0161, 0xe4,
+	0x0162, 0x0d,
+	0x0163, 0x78,
+};
+
+static const struct sensor_mode_table imx219d2l_modes[] = {
+	[IMX219D2L_MODE_PREVIEW] = {
+		imx219d2l_preview_regs, ARRAY_SIZE(imx219d2l_preview_regs)
+	},
+	[IMX219D2L_MODE_CAPTURE] = {
+		imx219d2l_capture_regs, ARRAY_SIZE(imx219d2l_capture_regs)
+	},
+	[IMX219D2L_MODE_NORMAL_VIDEO] = {
+		imx219d2l_normal_video_regs, ARRAY_SIZE(imx219d2l_normal_video_regs)
+	},
+};
+
+static const struct sensor_mode_desc imx219d2l_mode_desc = {
+	.modes = imx219d2l_modes,
+	.n_modes = ARRAY_SIZE(imx219d2l_modes),
+	.head = { imx219d2l_mode_head, ARRAY_SIZE(imx219d2l_mode_head) },
+};
+
 static void preview_setting(struct subdrv_ctx *ctx)
 {
-	write_cmos_sensor_8(ctx, 0x0100, 0x00);
-	write_cmos_sensor_8(ctx, 0x30eb, 0x05);
-	write_cmos_sensor_8(ctx, 0x30eb, 0x0c);
-	write_cmos_sensor_8(ctx, 0x300a, 0xff);
-	write_cmos_sensor_8(ctx, 0x300b, 0xff);
-	write_cmos_sensor_8(ctx, 0x30eb, 0x05);
-	write_cmos_sensor_8(ctx, 0x30eb, 0x09);
-	write_cmos_sensor_8(ctx, 0x0114, 0x01);
-	write_cmos_sensor_8(ctx, 0x0128, 0x00);
-	write_cmos_sensor_8(ctx, 0x012a, 0x18);
-	write_cmos_sensor_8(ctx, 0x012b, 0x00);
-	write_cmos_sensor_8(ctx, 0x0160, 0x06);
-	write_cmos_sensor_8(ctx, 0x0161, 0xe4);
-	write_cmos_sensor_8(ctx, 0x0162, 0x0d);
-	write_cmos_sensor_8(ctx, 0x0163, 0x78);
-	write_cmos_sensor_8(ctx, 0x0164, 0x02);
-	write_cmos_sensor_8(ctx, 0x0165, 0xa8);
-	write_cmos_sensor_8(ctx, 0x0166, 0x0a);
-	write_cmos_sensor_8(ctx, 0x0167, 0x27);
-	write_cmos_sensor_8(ctx, 0x0168, 0x02);
-	write_cmos_sensor_8(ctx, 0x0169, 0xb4);
-	write_cmos_sensor_8(ctx, 0x016a, 0x06);
-	write_cmos_sensor_8(ctx, 0x016b, 0xeb);
-	write_cmos_sensor_8(ctx, 0x016c, 0x07);
-	write_cmos_sensor_8(ctx, 0x016d, 0x80);
-	write_cmos_sensor_8(ctx, 0x016e, 0x04);
-	write_cmos_sensor_8(ctx, 0x016f, 0x38);
-	write_cmos_sensor_8(ctx, 0x0170, 0x01);
-	write_cmos_sensor_8(ctx, 0x0171, 0x01);
-	write_cmos_sensor_8(ctx, 0x0174, 0x00);
-	write_cmos_sensor_8(ctx, 0x0175, 0x00);
-	write_cmos_sensor_8(ctx, 0x0301, 0x05);
-	write_cmos_sensor_8(ctx, 0x0303, 0x01);
-	write_cmos_sensor_8(ctx, 0x0304, 0x03);
-	write_cmos_sensor_8(ctx, 0x0305, 0x03);
-	write_cmos_sensor_8(ctx, 0x0306, 0x00);
-	write_cmos_sensor_8(ctx, 0x0307, 0x39);
-	write_cmos_sensor_8(ctx, 0x030b, 0x01);
-	write_cmos_sensor_8(ctx, 0x030c, 0x00);
-	write_cmos_sensor_8(ctx, 0x030d, 0x72);
-	write_cmos_sensor_8(ctx, 0x0624, 0x07);
-	write_cmos_sensor_8(ctx, 0x0625, 0x80);
-	write_cmos_sensor_8(ctx, 0x0626, 0x04);
-	write_cmos_sensor_8(ctx, 0x0627, 0x38);
-	write_cmos_sensor_8(ctx, 0x455e, 0x00);
-	write_cmos_sensor_8(ctx, 0x471e, 0x4b);
-	write_cmos_sensor_8(ctx, 0x4767, 0x0f);
-	write_cmos_sensor_8(ctx, 0x4750, 0x14);
-	write_cmos_sensor_8(ctx, 0x4540, 0x00);
-	write_cmos_sensor_8(ctx, 0x47b4, 0x14);
-	write_cmos_sensor_8(ctx, 0x4713, 0x30);
-	write_cmos_sensor_8(ctx, 0x478b, 0x10);
-	write_cmos_sensor_8(ctx, 0x478f, 0x10);
-	write_cmos_sensor_8(ctx, 0x4793, 0x10);
-	write_cmos_sensor_8(ctx, 0x4797, 0x0e);
-	write_cmos_sensor_8(ctx, 0x479b, 0x0e);
-	write_cmos_sensor_8(ctx, 0x0160, 0x06);
-	write_cmos_sensor_8(ctx, 0x0161, 0xe4);
-	write_cmos_sensor_8(ctx, 0x0162, 0x0d);
-	write_cmos_sensor_8(ctx, 0x0163, 0x78);
+	sensor_mode_delta_apply(ctx, &imx219d2l_mode_desc, IMX219D2L_MODE_PREVIEW);
 }   /*  preview_setting  */
 
 static void preview_setting_HDR(struct subdrv_ctx *ctx)
@@ -504,130 +649,12 @@ static void preview_setting_HDR(struct subdrv_ctx *ctx)
 
 static void capture_setting(struct subdrv_ctx *ctx, kal_uint16 currefps)
 {
-	write_cmos_sensor_8(ctx, 0x0100, 0x00);
-	write_cmos_sensor_8(ctx, 0x30eb, 0x05);
-	write_cmos_sensor_8(ctx, 0x30eb, 0x0c);
-	write_cmos_sensor_8(ctx, 0x300a, 0xff);
-	write_cmos_sensor_8(ctx, 0x300b, 0xff);
-	write_cmos_sensor_8(ctx, 0x30eb, 0x05);
-	write_cmos_sensor_8(ctx, 0x30eb, 0x09);
-	write_cmos_sensor_8(ctx, 0x0114, 0x01);
-	write_cmos_sensor_8(ctx, 0x0128, 0x00);
-	write_cmos_sensor_8(ctx, 0x012a, 0x18);
-	write_cmos_sensor_8(ctx, 0x012b, 0x00);
-	write_cmos_sensor_8(ctx, 0x0160, 0x06);
-	write_cmos_sensor_8(ctx, 0x0161, 0xe4);
-	write_cmos_sensor_8(ctx, 0x0162, 0x0d);
-	write_cmos_sensor_8(ctx, 0x0163, 0x78);
-	write_cmos_sensor_8(ctx, 0x0164, 0x02);
-	write_cmos_sensor_8(ctx, 0x0165, 0xa8);
-	write_cmos_sensor_8(ctx, 0x0166, 0x0a);
-	write_cmos_sensor_8(ctx, 0x0167, 0x27);
-	write_cmos_sensor_8(ctx, 0x0168, 0x02);
-	write_cmos_sensor_8(ctx, 0x0169, 0xb4);
-	write_cmos_sensor_8(ctx, 0x016a, 0x06);
-	write_cmos_sensor_8(ctx, 0x016b, 0xeb);
-	write_cmos_sensor_8(ctx, 0x016c, 0x07);
-	write_cmos_sensor_8(ctx, 0x016d, 0x80);
-	write_cmos_sensor_8(ctx, 0x016e, 0x04);
-	write_cmos_sensor_8(ctx, 0x016f, 0x38);
-	write_cmos_sensor_8(ctx, 0x0170, 0x01);
-	write_cmos_sensor_8(ctx, 0x0171, 0x01);
-	write_cmos_sensor_8(ctx, 0x0174, 0x00);
-	write_cmos_sensor_8(ctx, 0x0175, 0x00);
-	write_cmos_sensor_8(ctx, 0x0301, 0x05);
-	write_cmos_sensor_8(ctx, 0x0303, 0x01);
-	write_cmos_sensor_8(ctx, 0x0304, 0x03);
-	write_cmos_sensor_8(ctx, 0x0305, 0x03);
-	write_cmos_sensor_8(ctx, 0x0306, 0x00);
-	write_cmos_sensor_8(ctx, 0x0307, 0x39);
-	write_cmos_sensor_8(ctx, 0x030b, 0x01);
-	write_cmos_sensor_8(ctx, 0x030c, 0x00);
-	write_cmos_sensor_8(ctx, 0x030d, 0x72);
-	write_cmos_sensor_8(ctx, 0x0624, 0x07);
-	write_cmos_sensor_8(ctx, 0x0625, 0x80);
-	write_cmos_sensor_8(ctx, 0x0626, 0x04);
-	write_cmos_sensor_8(ctx, 0x0627, 0x38);
-	write_cmos_sensor_8(ctx, 0x455e, 0x00);
-	write_cmos_sensor_8(ctx, 0x471e, 0x4b);
-	write_cmos_sensor_8(ctx, 0x4767, 0x0f);
-	write_cmos_sensor_8(ctx, 0x4750, 0x14);
-	write_cmos_sensor_8(ctx, 0x4540, 0x00);
-	write_cmos_sensor_8(ctx, 0x47b4, 0x14);
-	write_cmos_sensor_8(ctx, 0x4713, 0x30);
-	write_cmos_sensor_8(ctx, 0x478b, 0x10);
-	write_cmos_sensor_8(ctx, 0x478f, 0x10);
-	write_cmos_sensor_8(ctx, 0x4793, 0x10);
-	write_cmos_sensor_8(ctx, 0x4797, 0x0e);
-	write_cmos_sensor_8(ctx, 0x479b, 0x0e);
-	write_cmos_sensor_8(ctx, 0x0160, 0x06);
-	write_cmos_sensor_8(ctx, 0x0161, 0xe4);
-	write_cmos_sensor_8(ctx, 0x0162, 0x0d);
-	write_cmos_sensor_8(ctx, 0x0163, 0x78);
+	sensor_mode_delta_apply(ctx, &imx219d2l_mode_desc, IMX219D2L_MODE_CAPTURE);
 }
 
 static void normal_video_setting(struct subdrv_ctx *ctx, kal_uint16 currefps)
 {
-	write_cmos_sensor_8(ctx, 0x0100, 0x00);
-	write_cmos_sensor_8(ctx, 0x30eb, 0x05);
-	write_cmos_sensor_8(ctx, 0x30eb, 0x0c);
-	write_cmos_sensor_8(ctx, 0x300a, 0xff);
-	write_cmos_sensor_8(ctx, 0x300b, 0xff);
-	write_cmos_sensor_8(ctx, 0x30eb, 0x05);
-	write_cmos_sensor_8(ctx, 0x30eb, 0x09);
-	write_cmos_sensor_8(ctx, 0x0114, 0x01);
-	write_cmos_sensor_8(ctx, 0x0128, 0x00);
-	write_cmos_sensor_8(ctx, 0x012a, 0x18);
-	write_cmos_sensor_8(ctx, 0x012b, 0x00);
-	write_cmos_sensor_8(ctx, 0x0160, 0x06);
-	write_cmos_sensor_8(ctx, 0x0161, 0xe4);
-	write_cmos_sensor_8(ctx, 0x0162, 0x0d);
-	write_cmos_sensor_8(ctx, 0x0163, 0x78);
-	write_cmos_sensor_8(ctx, 0x0164, 0x02);
-	write_cmos_sensor_8(ctx, 0x0165, 0xa8);
-	write_cmos_sensor_8(ctx, 0x0166, 0x0a);
-	write_cmos_sensor_8(ctx, 0x0167, 0x27);
-	write_cmos_sensor_8(ctx, 0x0168, 0x02);
-	write_cmos_sensor_8(ctx, 0x0169, 0xb4);
-	write_cmos_sensor_8(ctx, 0x016a, 0x06);
-	write_cmos_sensor_8(ctx, 0x016b, 0xeb);
-	write_cmos_sensor_8(ctx, 0x016c, 0x07);
-	write_cmos_sensor_8(ctx, 0x016d, 0x80);
-	write_cmos_sensor_8(ctx, 0x016e, 0x04);
-	write_cmos_sensor_8(ctx, 0x016f, 0x38);
-	write_cmos_sensor_8(ctx, 0x0170, 0x01);
-	write_cmos_sensor_8(ctx, 0x0171, 0x01);
-	write_cmos_sensor_8(ctx, 0x0174, 0x00);
-	write_cmos_sensor_8(ctx, 0x0175, 0x00);
-	write_cmos_sensor_8(ctx, 0x0301, 0x05);
-	write_cmos_sensor_8(ctx, 0x0303, 0x01);
-	write_cmos_sensor_8(ctx, 0x0304, 0x03);
-	write_cmos_sensor_8(ctx, 0x0305, 0x03);
-	write_cmos_sensor_8(ctx, 0x0306, 0x00);
-	write_cmos_sensor_8(ctx, 0x0307, 0x39);
-	write_cmos_sensor_8(ctx, 0x030b, 0x01);
-	write_cmos_sensor_8(ctx, 0x030c, 0x00);
-	write_cmos_sensor_8(ctx, 0x030d, 0x72);
-	write_cmos_sensor_8(ctx, 0x0624, 0x07);
-	write_cmos_sensor_8(ctx, 0x0625, 0x80);
-	write_cmos_sensor_8(ctx, 0x0626, 0x04);
-	write_cmos_sensor_8(ctx, 0x0627, 0x38);
-	write_cmos_sensor_8(ctx, 0x455e, 0x00);
-	write_cmos_sensor_8(ctx, 0x471e, 0x4b);
-	write_cmos_sensor_8(ctx, 0x4767, 0x0f);
-	write_cmos_sensor_8(ctx, 0x4750, 0x14);
-	write_cmos_sensor_8(ctx, 0x4540, 0x00);
-	write_cmos_sensor_8(ctx, 0x47b4, 0x14);
-	write_cmos_sensor_8(ctx, 0x4713, 0x30);
-	write_cmos_sensor_8(ctx, 0x478b, 0x10);
-	write_cmos_sensor_8(ctx, 0x478f, 0x10);
-	write_cmos_sensor_8(ctx, 0x4793, 0x10);
-	write_cmos_sensor_8(ctx, 0x4797, 0x0e);
-	write_cmos_sensor_8(ctx, 0x479b, 0x0e);
-	write_cmos_sensor_8(ctx, 0x0160, 0x06);
-	write_cmos_sensor_8(ctx, 0x0161, 0xe4);
-	write_cmos_sensor_8(ctx, 0x0162, 0x0d);
-	write_cmos_sensor_8(ctx, 0x0163, 0x78);
+	sensor_mode_delta_apply(ctx, &imx219d2l_mode_desc, IMX219D2L_MODE_NORMAL_VIDEO);
 }
 
 static void fullsize_setting_HDR(struct subdrv_ctx *ctx, kal_uint16 currefps)
@@ -723,6 +750,8 @@ static int open(struct subdrv_ctx *ctx)
 
 	/* initail sequence write in  */
 	sensor_init(ctx);
+	/* power on reset, the next mode is written in full */
+	ctx->reg_mode = 0;
 
 	ctx->autoflicker_en = KAL_FALSE;
 	ctx->sensor_mode = IMGSENSOR_MODE_INIT;
@@ -1661,6 +1690,8 @@ static int init_ctx(struct subdrv_ctx *ctx,
 	memcpy(ctx, &defctx, sizeof(*ctx));
 	ctx->i2c_client = i2c_client;
 	ctx->i2c_write_id = i2c_write_id;
+	ctx->mode_delta = sensor_mode_delta_devm_compile(&i2c_client->dev,
+							 &imx219d2l_mode_desc);
 	return 0;
 }
 
@@ -0,0 +1,320 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright (c) 2023 MediaTek Inc.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sensor_mode_delta.h"
+
+#define NONE           "\033[m"
+#define RED            "\033[0;32;31m"
+#define GREEN          "\033[0;32;32m"
+
+#define UT_MODES	6
+#define UT_TABLE_MAX	512	/* {addr, val} pairs */
+#define UT_ROUNDS	200
+
+static int ut_fail;
+static int ut_cnt;
+
+#define UT_CHECK(cond, fmt, args...)					\
+do {									\
+	ut_cnt++;							\
+	if (!(cond)) {							\
+		ut_fail++;						\
+		printf(RED "[FAIL] %s:%d " fmt NONE "\n",		\
+		       __func__, __LINE__, ##args);			\
+	}								\
+} while (0)
+
+/* the sensor register space, as written over i2c */
+static u8 sensor[0x10000];
+static u8 expect[0x10000];
+
+/* imx214 style: shutter, gain and frame length */
+static const u16 ut_volatile[] = {
+	0x0202, 0x0203, 0x0204, 0x0205, 0x0340, 0x0341,
+};
+
+static u16 ut_lists[UT_MODES][UT_TABLE_MAX * 2];
+static struct sensor_mode_table ut_tables[UT_MODES];
+
+static void ut_write_table(u8 *regs, const struct sensor_mode_table *t)
+{
+	u32 i;
+
+	for (i = 0; i + 1 < t->len; i += 2)
+		regs[t->list[i]] = t->list[i + 1];
+}
+
+static void ut_write_step(u8 *regs, const struct sensor_mode_step *s)
+{
+	u32 i, j;
+
+	for (i = 0; i < s->n_bursts; i++)
+		for (j = 0; j < s->bursts[i].len; j++)
+			regs[(u16)(s->bursts[i].reg + j)] = s->bursts[i].vals[j];
+}
+
+/* what the shutter and gain controls do while streaming */
+static void ut_runtime(u8 *a, u8 *b)
+{
+	u32 i;
+
+	for (i = 0; i < sizeof(ut_volatile) / sizeof(ut_volatile[0]); i++)
+		if (rand() & 1)
+			a[ut_volatile[i]] = b[ut_volatile[i]] = rand();
+}
+
+/*
+ * Clusters of consecutive registers as in the Sony mode tables, each
+ * mode sharing most of them with a few values, holes, repeats and extra
+ * registers of its own.
+ */
+static void ut_gen_tables(void)
+{
+	static const u16 clusters[][2] = {
+		{ 0x0112, 4 }, { 0x0202, 4 }, { 0x020e, 10 }, { 0x0220, 3 },
+		{ 0x0301, 12 }, { 0x0340, 16 }, { 0x0381, 7 }, { 0x0401, 16 },
+		{ 0x0820, 4 }, { 0x0900, 3 }, { 0x3a02, 4 }, { 0x4170, 8 },
+		{ 0xae20, 2 }, { 0xfffe, 2 },
+	};
+	u32 m, c, r, n;
+
+	for (m = 0; m < UT_MODES; m++) {
+		n = 0;
+		for (c = 0; c < sizeof(clusters) / sizeof(clusters[0]); c++) {
+			for (r = 0; r < clusters[c][1]; r++) {
+				u16 reg = clusters[c][0] + r;
+				u8 val = reg * 7 + c;
+
+				/* some registers only in some modes */
+				if (m && rand() % 10 == 0)
+					continue;
+				/* and a few values of its own */
+				if (m && rand() % 4 == 0)
+					val = rand();
+				ut_lists[m][n++] = reg;
+				ut_lists[m][n++] = val;
+				/* an earlier value overwritten later */
+				if (rand() % 16 == 0) {
+					ut_lists[m][n++] = reg;
+					ut_lists[m][n++] = rand();
+					ut_lists[m][n++] = reg;
+					ut_lists[m][n++] = val;
+				}
+			}
+		}
+		/* out of order, as the tables group by function */
+		for (r = 0; r < 8; r++) {
+			ut_lists[m][n++] = 0x3000 + rand() % 0x100;
+			ut_lists[m][n++] = rand();
+		}
+		ut_tables[m].list = ut_lists[m];
+		ut_tables[m].len = n;
+	}
+	/* two identical modes, as slim and hs video */
+	memcpy(ut_lists[UT_MODES - 1], ut_lists[UT_MODES - 2],
+	       sizeof(ut_lists[0]));
+	ut_tables[UT_MODES - 1].len = ut_tables[UT_MODES - 2].len;
+}
+
+static void ut_check_step(const struct sensor_mode_delta *d, u32 a, u32 b)
+{
+	const struct sensor_mode_step *s = &d->steps[a * UT_MODES + b];
+	u32 i, n_vals = 0;
+	int round;
+
+	for (round = 0; round < 4; round++) {
+		for (i = 0; i < sizeof(sensor); i++)
+			sensor[i] = rand();
+
+		/* a full write of "a", then streaming */
+		ut_write_table(sensor, &ut_tables[a]);
+		memcpy(expect, sensor, sizeof(sensor));
+		ut_runtime(sensor, expect);
+
+		/* what writing all of "b" gives, against the delta */
+		ut_write_table(expect, &ut_tables[b]);
+		ut_write_step(sensor, s);
+
+		UT_CHECK(!memcmp(sensor, expect, sizeof(sensor)),
+			 "%u -> %u: register state differs", a, b);
+	}
+
+	for (i = 0; i < s->n_bursts; i++) {
+		n_vals += s->bursts[i].len;
+		/* sorted, apart and not wrapping */
+		UT_CHECK(s->bursts[i].len &&
+			 s->bursts[i].reg + s->bursts[i].len <= 0x10000,
+			 "%u -> %u: burst %u 0x%04x+%u", a, b, i,
+			 s->bursts[i].reg, s->bursts[i].len);
+		if (i)
+			UT_CHECK(s->bursts[i - 1].reg + s->bursts[i - 1].len +
+				 SENSOR_MODE_DELTA_GAP < s->bursts[i].reg ||
+				 s->bursts[i - 1].reg + s->bursts[i - 1].len <
+				 s->bursts[i].reg,
+				 "%u -> %u: bursts %u/%u overlap", a, b, i - 1,
+				 i);
+	}
+	UT_CHECK(n_vals == s->n_vals, "%u -> %u: n_vals %u vs %u", a, b,
+		 n_vals, s->n_vals);
+	UT_CHECK(s->n_vals <= ut_tables[b].len / 2, "%u -> %u: %u regs",
+		 a, b, s->n_vals);
+}
+
+static void ut_deltas(void)
+{
+	const struct sensor_mode_desc desc = {
+		.modes = ut_tables,
+		.n_modes = UT_MODES,
+		.volatile_regs = ut_volatile,
+		.n_volatile = sizeof(ut_volatile) / sizeof(ut_volatile[0]),
+	};
+	struct sensor_mode_delta d;
+	const struct sensor_mode_step *s;
+	u32 a, b;
+	int ret;
+
+	ut_gen_tables();
+
+	ret = sensor_mode_delta_compile(&d, &desc);
+	UT_CHECK(!ret, "compile %d", ret);
+	if (ret)
+		return;
+
+	for (a = 0; a < UT_MODES; a++)
+		for (b = 0; b < UT_MODES; b++)
+			ut_check_step(&d, a, b);
+
+	/* staying in a mode only rewrites what runtime controls touched */
+	for (a = 0; a < UT_MODES; a++) {
+		s = &d.steps[a * UT_MODES + a];
+		UT_CHECK(s->n_vals <= desc.n_volatile + SENSOR_MODE_DELTA_GAP,
+			 "%u -> %u: %u regs", a, a, s->n_vals);
+	}
+	/* and so does switching between two identical modes */
+	s = &d.steps[(UT_MODES - 2) * UT_MODES + UT_MODES - 1];
+	UT_CHECK(s->n_vals ==
+		 d.steps[(UT_MODES - 2) * UT_MODES + UT_MODES - 2].n_vals,
+		 "identical modes: %u regs", s->n_vals);
+
+	sensor_mode_delta_free(&d);
+}
+
+/* no volatile registers and two equal modes: nothing to write */
+static void ut_identical(void)
+{
+	static const u16 list[] = {
+		0x0100, 0x00, 0x0114, 0x01, 0x0160, 0x06, 0x0161, 0xe4,
+		0x0160, 0x07,
+	};
+	static const u16 other[] = {
+		0x0114, 0x01, 0x0160, 0x07, 0x0161, 0xe4, 0x0162, 0x0d,
+		0x0164, 0x02,
+	};
+	const struct sensor_mode_table tables[] = {
+		{ list, sizeof(list) / sizeof(list[0]) },
+		{ list, sizeof(list) / sizeof(list[0]) },
+		{ other, sizeof(other) / sizeof(other[0]) },
+	};
+	const struct sensor_mode_desc desc = {
+		.modes = tables,
+		.n_modes = 3,
+	};
+	struct sensor_mode_delta d;
+	const struct sensor_mode_step *s;
+	int ret;
+
+	ret = sensor_mode_delta_compile(&d, &desc);
+	UT_CHECK(!ret, "compile %d", ret);
+	if (ret)
+		return;
+
+	s = &d.steps[0 * 3 + 1];
+	UT_CHECK(!s->n_bursts && !s->n_vals && !s->bursts,
+		 "%u bursts %u regs", s->n_bursts, s->n_vals);
+
+	/* 0x0162 and 0x0164 are new, 0x0163 is unknown so not bridged */
+	s = &d.steps[1 * 3 + 2];
+	UT_CHECK(s->n_bursts == 2 && s->n_vals == 2,
+		 "%u bursts %u regs", s->n_bursts, s->n_vals);
+	UT_CHECK(s->n_bursts == 2 && s->bursts[0].reg == 0x0162 &&
+		 s->bursts[0].vals[0] == 0x0d && s->bursts[1].reg == 0x0164,
+		 "bursts at 0x%04x 0x%04x", s->bursts[0].reg,
+		 s->bursts[1].reg);
+
+	/* the other way, only 0x0100 which "other" does not write */
+	s = &d.steps[2 * 3 + 0];
+	UT_CHECK(s->n_bursts == 1 && s->n_vals == 1 &&
+		 s->bursts[0].reg == 0x0100 && !s->bursts[0].vals[0],
+		 "%u bursts %u regs", s->n_bursts, s->n_vals);
+
+	sensor_mode_delta_free(&d);
+}
+
+/* known unchanged registers are bridged, up to the gap */
+static void ut_gap(void)
+{
+	static const u16 from[] = {
+		0x0340, 0x08, 0x0341, 0x3e, 0x0342, 0x13, 0x0343, 0x90,
+		0x0344, 0x00, 0x0345, 0x00, 0x0346, 0x00, 0x0347, 0x00,
+	};
+	static const u16 to[] = {
+		0x0340, 0x0c, 0x0341, 0x3e, 0x0342, 0x13, 0x0343, 0x91,
+		0x0344, 0x00, 0x0345, 0x00, 0x0346, 0x00, 0x0347, 0x01,
+	};
+	const struct sensor_mode_table tables[] = {
+		{ from, sizeof(from) / sizeof(from[0]) },
+		{ to, sizeof(to) / sizeof(to[0]) },
+	};
+	const struct sensor_mode_desc desc = {
+		.modes = tables,
+		.n_modes = 2,
+	};
+	struct sensor_mode_delta d;
+	const struct sensor_mode_step *s;
+	int ret;
+
+	ret = sensor_mode_delta_compile(&d, &desc);
+	UT_CHECK(!ret, "compile %d", ret);
+	if (ret)
+		return;
+
+	/* 0x0340..0x0343 in one, 0x0347 three registers later on its own */
+	s = &d.steps[1];
+	UT_CHECK(s->n_bursts == 2 && s->n_vals == 5,
+		 "%u bursts %u regs", s->n_bursts, s->n_vals);
+	UT_CHECK(s->n_bursts == 2 && s->bursts[0].reg == 0x0340 &&
+		 s->bursts[0].len == 4 && s->bursts[1].reg == 0x0347 &&
+		 s->bursts[1].len == 1,
+		 "0x%04x+%u 0x%04x+%u", s->bursts[0].reg, s->bursts[0].len,
+		 s->bursts[1].reg, s->bursts[1].len);
+	UT_CHECK(s->n_bursts == 2 && s->bursts[0].vals[1] == 0x3e &&
+		 s->bursts[0].vals[2] == 0x13 && s->bursts[0].vals[3] == 0x91,
+		 "bridged values");
+
+	sensor_mode_delta_free(&d);
+}
+
+int main(void)
+{
+	int i;
+
+	srand(0x214);
+	for (i = 0; i < UT_ROUNDS; i++)
+		ut_deltas();
+	ut_identical();
+	ut_gap();
+
+	if (ut_fail)
+		printf(RED "[mode delta] %d/%d checks failed" NONE "\n",
+		       ut_fail, ut_cnt);
+	else
+		printf(GREEN "[mode delta] all %d checks passed" NONE "\n",
+		       ut_cnt);
+
+	return ut_fail ? 1 : 0;
+}
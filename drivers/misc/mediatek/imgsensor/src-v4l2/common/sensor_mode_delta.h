@@ -0,0 +1,352 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Copyright (c) 2023 MediaTek Inc.
+ */
+
+#ifndef _SENSOR_MODE_DELTA_H
+#define _SENSOR_MODE_DELTA_H
+
+/*
+ * Register deltas between sensor modes, for the 8-bit register subdrvs.
+ *
+ * A mode is a table of {addr, val} pairs written in standby, framed by a
+ * head and a tail shared by all modes (standby, unlock sequences, stream
+ * on) that are always written as is. At init_ctx the subdrv compiles, for
+ * every (from, to) pair of modes, the registers whose final value in
+ * "to" differs from "from", plus the volatile registers the subdrv also
+ * writes at runtime (shutter, gain, frame length), whose value no longer
+ * is the table one. Runs of consecutive addresses are packed into bursts,
+ * bridging gaps of up to SENSOR_MODE_DELTA_GAP registers whose value is
+ * known to be unchanged, and sent with one sequential write each.
+ *
+ * ctx->reg_mode records the mode held by the sensor, 1-based. It is 0
+ * after power on or any write outside the tables, then the next switch
+ * writes the whole table in its original order.
+ *
+ * Built on the host with -DSENSOR_MODE_DELTA_UT, see mode-delta-ut-test.
+ */
+
+#ifdef SENSOR_MODE_DELTA_UT
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#define GFP_KERNEL			0
+#define kcalloc(n, size, flags)		calloc(n, size)
+#define kfree(p)			free(p)
+#else
+#include <linux/device.h>
+#include <linux/kernel.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include "adaptor-subdrv.h"
+#endif
+
+/* mode-delta-ut-test provides its own linux/types.h */
+#include <linux/types.h>
+
+#define SENSOR_MODE_DELTA_GAP		2
+
+struct sensor_mode_table {
+	const u16 *list;	/* {addr, val} pairs */
+	u32 len;		/* in u16, as ARRAY_SIZE() */
+};
+
+struct sensor_mode_burst {
+	u16 reg;
+	u16 len;
+	u8 *vals;
+};
+
+struct sensor_mode_step {
+	struct sensor_mode_burst *bursts;
+	u32 n_bursts;
+	u32 n_vals;		/* registers written, gaps included */
+};
+
+/* static per subdrv */
+struct sensor_mode_desc {
+	const struct sensor_mode_table *modes;
+	u32 n_modes;
+	struct sensor_mode_table head;
+	struct sensor_mode_table tail;
+	const u16 *volatile_regs;
+	u32 n_volatile;
+};
+
+/* compiled per sensor, in ctx->mode_delta */
+struct sensor_mode_delta {
+	const struct sensor_mode_desc *desc;
+	struct sensor_mode_step *steps;	/* [from * n_modes + to] */
+};
+
+/* final value of each register, sorted by address */
+struct sensor_mode_reg {
+	u16 reg;
+	u8 val;
+	bool flag;
+};
+
+static inline u32 sensor_mode_delta_finals(const struct sensor_mode_table *t,
+					   struct sensor_mode_reg *regs)
+{
+	u32 i, n = 0;
+
+	for (i = 0; i + 1 < t->len; i += 2) {
+		u16 reg = t->list[i];
+		u32 lo = 0, hi = n;
+
+		while (lo < hi) {
+			u32 mid = (lo + hi) / 2;
+
+			if (regs[mid].reg < reg)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if (lo == n || regs[lo].reg != reg) {
+			memmove(&regs[lo + 1], &regs[lo],
+				(n - lo) * sizeof(*regs));
+			regs[lo].reg = reg;
+			n++;
+		}
+		/* the last write wins */
+		regs[lo].val = t->list[i + 1] & 0xff;
+	}
+
+	return n;
+}
+
+static inline bool sensor_mode_delta_volatile(const u16 *regs, u32 n, u16 reg)
+{
+	u32 i;
+
+	for (i = 0; i < n; i++)
+		if (regs[i] == reg)
+			return true;
+
+	return false;
+}
+
+/* flag what @to must write over @from, then pack the flagged runs */
+static inline int sensor_mode_delta_step(struct sensor_mode_step *s,
+					 const struct sensor_mode_reg *from,
+					 u32 n_from,
+					 struct sensor_mode_reg *to, u32 n_to,
+					 const u16 *volatile_regs,
+					 u32 n_volatile)
+{
+	u32 i, j = 0, k, n_bursts = 0, n_vals = 0;
+	int last = -1;
+	u8 *vals;
+
+	for (i = 0; i < n_to; i++) {
+		while (j < n_from && from[j].reg < to[i].reg)
+			j++;
+		to[i].flag = j == n_from || from[j].reg != to[i].reg ||
+			     from[j].val != to[i].val ||
+			     sensor_mode_delta_volatile(volatile_regs,
+							n_volatile, to[i].reg);
+	}
+
+	/* first pass sizes the bursts, the second fills them */
+	for (k = 0; k < 2; k++) {
+		struct sensor_mode_burst *b = NULL;
+
+		n_bursts = 0;
+		n_vals = 0;
+		last = -1;
+		for (i = 0; i < n_to; i++) {
+			if (!to[i].flag)
+				continue;
+
+			/* a known unchanged gap costs less than a new write */
+			if (last >= 0 &&
+			    (u32)(to[i].reg - to[last].reg) == i - last &&
+			    i - last <= SENSOR_MODE_DELTA_GAP + 1) {
+				for (j = last + 1; j <= i; j++) {
+					if (b)
+						b->vals[b->len++] = to[j].val;
+					n_vals++;
+				}
+			} else {
+				if (k) {
+					b = &s->bursts[n_bursts];
+					b->reg = to[i].reg;
+					b->len = 0;
+					b->vals = s->bursts[0].vals + n_vals;
+					b->vals[b->len++] = to[i].val;
+				}
+				n_bursts++;
+				n_vals++;
+			}
+			last = i;
+		}
+
+		if (k || !n_bursts)
+			break;
+
+		/* one allocation for the values, hung off the first burst */
+		s->bursts = kcalloc(n_bursts, sizeof(*s->bursts), GFP_KERNEL);
+		vals = kcalloc(n_vals, sizeof(*vals), GFP_KERNEL);
+		if (!s->bursts || !vals) {
+			kfree(s->bursts);
+			kfree(vals);
+			s->bursts = NULL;
+			return -ENOMEM;
+		}
+		s->bursts[0].vals = vals;
+	}
+
+	s->n_bursts = n_bursts;
+	s->n_vals = n_vals;
+
+	return 0;
+}
+
+static inline void sensor_mode_delta_free(struct sensor_mode_delta *d)
+{
+	u32 i;
+
+	if (d->steps) {
+		for (i = 0; i < d->desc->n_modes * d->desc->n_modes; i++) {
+			if (d->steps[i].bursts)
+				kfree(d->steps[i].bursts[0].vals);
+			kfree(d->steps[i].bursts);
+		}
+	}
+	kfree(d->steps);
+	d->steps = NULL;
+}
+
+/* compile the steps between all the modes of @desc, which must outlive @d */
+static inline int sensor_mode_delta_compile(struct sensor_mode_delta *d,
+					    const struct sensor_mode_desc *desc)
+{
+	const struct sensor_mode_table *modes = desc->modes;
+	u32 n_modes = desc->n_modes;
+	struct sensor_mode_reg **finals;
+	u32 *n_finals;
+	u32 a, b;
+	int ret = -ENOMEM;
+
+	memset(d, 0, sizeof(*d));
+	d->desc = desc;
+
+	finals = kcalloc(n_modes, sizeof(*finals), GFP_KERNEL);
+	n_finals = kcalloc(n_modes, sizeof(*n_finals), GFP_KERNEL);
+	d->steps = kcalloc(n_modes * n_modes, sizeof(*d->steps), GFP_KERNEL);
+	if (!finals || !n_finals || !d->steps)
+		goto out;
+
+	for (a = 0; a < n_modes; a++) {
+		finals[a] = kcalloc(modes[a].len / 2 + 1, sizeof(**finals),
+				    GFP_KERNEL);
+		if (!finals[a])
+			goto out;
+		n_finals[a] = sensor_mode_delta_finals(&modes[a], finals[a]);
+	}
+
+	for (a = 0; a < n_modes; a++) {
+		for (b = 0; b < n_modes; b++) {
+			ret = sensor_mode_delta_step(&d->steps[a * n_modes + b],
+						     finals[a], n_finals[a],
+						     finals[b], n_finals[b],
+						     desc->volatile_regs,
+						     desc->n_volatile);
+			if (ret)
+				goto out;
+		}
+	}
+	ret = 0;
+out:
+	if (finals)
+		for (a = 0; a < n_modes; a++)
+			kfree(finals[a]);
+	kfree(finals);
+	kfree(n_finals);
+	if (ret)
+		sensor_mode_delta_free(d);
+
+	return ret;
+}
+
+#ifndef SENSOR_MODE_DELTA_UT
+static inline void sensor_mode_delta_release(void *data)
+{
+	sensor_mode_delta_free(data);
+}
+
+/*
+ * Compile the deltas of @desc for the sensor behind @dev, for init_ctx.
+ * NULL on failure, the subdrv then writes whole tables.
+ */
+static inline struct sensor_mode_delta *
+sensor_mode_delta_devm_compile(struct device *dev,
+			       const struct sensor_mode_desc *desc)
+{
+	struct sensor_mode_delta *d;
+	u32 i, n_bursts = 0, n_vals = 0;
+
+	d = devm_kzalloc(dev, sizeof(*d), GFP_KERNEL);
+	if (!d || sensor_mode_delta_compile(d, desc))
+		return NULL;
+	if (devm_add_action_or_reset(dev, sensor_mode_delta_release, d))
+		return NULL;
+
+	for (i = 0; i < desc->n_modes * desc->n_modes; i++) {
+		n_bursts += d->steps[i].n_bursts;
+		n_vals += d->steps[i].n_vals;
+	}
+	dev_dbg(dev, "%u modes, %u bursts of %u regs for all switches\n",
+		desc->n_modes, n_bursts, n_vals);
+
+	return d;
+}
+
+/*
+ * Switch the sensor to mode @to of @desc, only writing the delta from the
+ * mode it holds when that is known and ctx->mode_delta was compiled.
+ */
+static inline int sensor_mode_delta_apply(struct subdrv_ctx *ctx,
+					  const struct sensor_mode_desc *desc,
+					  u32 to)
+{
+	const struct sensor_mode_delta *d = ctx->mode_delta;
+	const struct sensor_mode_table *t = &desc->modes[to];
+	u32 from = ctx->reg_mode;
+	int ret = 0;
+	u32 i;
+
+	ctx->reg_mode = 0;
+
+	if (desc->head.len)
+		ret = subdrv_i2c_wr_regs_u8(ctx, (u16 *)desc->head.list,
+					    desc->head.len);
+
+	if (!from || from > desc->n_modes || !d || d->desc != desc ||
+	    !d->steps) {
+		if (!ret)
+			ret = subdrv_i2c_wr_regs_u8(ctx, (u16 *)t->list, t->len);
+	} else {
+		const struct sensor_mode_step *s =
+			&d->steps[(from - 1) * desc->n_modes + to];
+
+		for (i = 0; i < s->n_bursts && !ret; i++)
+			ret = subdrv_i2c_wr_seq_p8(ctx, s->bursts[i].reg,
+						   s->bursts[i].vals,
+						   s->bursts[i].len);
+	}
+
+	if (!ret && desc->tail.len)
+		ret = subdrv_i2c_wr_regs_u8(ctx, (u16 *)desc->tail.list,
+					    desc->tail.len);
+
+	/* a failed switch leaves the registers unknown */
+	if (!ret)
+		ctx->reg_mode = to + 1;
+
+	return ret;
+}
+#endif
+
+#endif /* _SENSOR_MODE_DELTA_H */
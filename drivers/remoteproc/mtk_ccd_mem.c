@@ -5,6 +5,7 @@
 #include <linux/err.h>
 #include <linux/kernel.h>
 #include <linux/compiler.h>
+#include <linux/debugfs.h>
 #include <linux/dma-buf.h>
 #include <linux/dma-mapping.h>
 #include <linux/module.h>
@@ -12,7 +13,10 @@
 #include <linux/uaccess.h>
 #include <linux/sched/signal.h>
 #include <linux/sched/task.h>
+#include <linux/seq_file.h>
+#include <linux/sizes.h>
 #include <linux/slab.h>
+#include <linux/xarray.h>
 #include <linux/platform_data/mtk_ccd.h>
 #include <linux/remoteproc/mtk_ccd_mem.h>
 #include <linux/rpmsg/mtk_ccd_rpmsg.h>
@@ -20,6 +24,15 @@
 
 #define CCD_ALLOCATE_MAX_BUFFER_SIZE 0x20000000UL /*512MB*/
 
+/*
+ * Released buffers are parked per page order instead of going back to the
+ * DMA allocator, so the next stream-on gets them without a new
+ * dma_alloc_attrs()/iommu map. This caps how much memory may sit there.
+ */
+static unsigned long ccd_mem_cache_max = SZ_64M;
+module_param(ccd_mem_cache_max, ulong, 0644);
+MODULE_PARM_DESC(ccd_mem_cache_max, "bytes of released CCD buffers kept for reuse");
+
 struct mtk_ccd_buf;
 
 struct mtk_ccd_buf_vmarea_handler {
@@ -51,6 +64,12 @@ struct mtk_ccd_buf {
 	/* DMABUF related */
 	struct dma_buf *dbuf;
 	struct dma_buf_attachment *db_attach;
+
+	/* registry related */
+	struct mtk_ccd_memory *mem;
+	u32 handle;
+	unsigned int len;	/* length asked for, matched on put */
+	struct list_head list;	/* free_list entry while cached */
 };
 
 static void mtk_ccd_buf_vm_open(struct vm_area_struct *vma)
@@ -98,10 +117,18 @@ static void *mtk_ccd_buf_get_vaddr(struct mtk_ccd_buf *buf)
 	return buf->vaddr;
 }
 
-static void mtk_ccd_buf_put(struct mtk_ccd_buf *buf)
+static void mtk_ccd_mem_free(struct kref *kref)
 {
-	if (!refcount_dec_and_test(&buf->refcount))
-		return;
+	struct mtk_ccd_memory *ccd_memory =
+		container_of(kref, struct mtk_ccd_memory, kref);
+
+	mutex_destroy(&ccd_memory->mmap_lock);
+	kfree(ccd_memory);
+}
+
+static void mtk_ccd_buf_free(struct mtk_ccd_buf *buf)
+{
+	struct mtk_ccd_memory *mem = buf->mem;
 
 	if (buf->sgt_base) {
 		sg_free_table(buf->sgt_base);
@@ -112,6 +139,34 @@ static void mtk_ccd_buf_put(struct mtk_ccd_buf *buf)
 		       buf->attrs);
 	put_device(buf->dev);
 	kfree(buf);
+
+	if (mem)
+		kref_put(&mem->kref, mtk_ccd_mem_free);
+}
+
+static void mtk_ccd_buf_put(struct mtk_ccd_buf *buf)
+{
+	struct mtk_ccd_memory *mem = buf->mem;
+
+	if (!refcount_dec_and_test(&buf->refcount))
+		return;
+
+	buf->dbuf = NULL;
+	buf->db_attach = NULL;
+
+	/* keep it for the next mtk_ccd_get_buffer() of this size class */
+	spin_lock(&mem->cache_lock);
+	mem->live_bytes -= buf->size;
+	if (!mem->closing &&
+	    mem->cached_bytes + buf->size <= READ_ONCE(ccd_mem_cache_max)) {
+		list_add(&buf->list, &mem->free_list[get_order(buf->size)]);
+		mem->cached_bytes += buf->size;
+		buf = NULL;
+	}
+	spin_unlock(&mem->cache_lock);
+
+	if (buf)
+		mtk_ccd_buf_free(buf);
 }
 
 static struct mtk_ccd_buf *mtk_ccd_buf_alloc(struct device *dev,
@@ -154,6 +209,93 @@ static struct mtk_ccd_buf *mtk_ccd_buf_alloc(struct device *dev,
 	return buf;
 }
 
+/* best fit among the cached buffers of the same page order */
+static struct mtk_ccd_buf *mtk_ccd_buf_reuse(struct mtk_ccd_memory *mem,
+					     unsigned long size)
+{
+	struct mtk_ccd_buf *buf, *best = NULL;
+
+	spin_lock(&mem->cache_lock);
+	list_for_each_entry(buf, &mem->free_list[get_order(size)], list) {
+		if (buf->size < size || (best && buf->size >= best->size))
+			continue;
+		best = buf;
+		if (best->size == size)
+			break;
+	}
+	if (best) {
+		list_del(&best->list);
+		mem->cached_bytes -= best->size;
+		mem->live_bytes += best->size;
+		mem->cache_hit++;
+	}
+	spin_unlock(&mem->cache_lock);
+
+	if (!best)
+		return NULL;
+
+	/* dma_alloc_attrs() hands out zeroed memory, keep that contract */
+	if (best->vaddr)
+		memset(best->vaddr, 0, best->size);
+	refcount_set(&best->refcount, 1);
+
+	return best;
+}
+
+/* give every cached buffer back to the DMA allocator, returns bytes freed */
+static size_t mtk_ccd_mem_drain(struct mtk_ccd_memory *mem)
+{
+	struct mtk_ccd_buf *buf, *tmp;
+	LIST_HEAD(drain);
+	size_t bytes;
+	unsigned int i;
+
+	spin_lock(&mem->cache_lock);
+	for (i = 0; i < MTK_CCD_MEM_CLASS_NUM; i++)
+		list_splice_init(&mem->free_list[i], &drain);
+	bytes = mem->cached_bytes;
+	mem->cached_bytes = 0;
+	spin_unlock(&mem->cache_lock);
+
+	list_for_each_entry_safe(buf, tmp, &drain, list) {
+		list_del(&buf->list);
+		mtk_ccd_buf_free(buf);
+	}
+
+	return bytes;
+}
+
+static struct mtk_ccd_buf *mtk_ccd_buf_obtain(struct mtk_ccd_memory *mem,
+					      unsigned long size)
+{
+	struct mtk_ccd_buf *buf;
+
+	buf = mtk_ccd_buf_reuse(mem, size);
+	if (buf)
+		return buf;
+
+	buf = mtk_ccd_buf_alloc(mem->dev, 0, size, 0, 0);
+	if (IS_ERR(buf)) {
+		if (!mtk_ccd_mem_drain(mem))
+			return buf;
+		buf = mtk_ccd_buf_alloc(mem->dev, 0, size, 0, 0);
+		if (IS_ERR(buf))
+			return buf;
+	}
+
+	buf->mem = mem;
+	kref_get(&mem->kref);
+
+	spin_lock(&mem->cache_lock);
+	mem->live_bytes += buf->size;
+	mem->peak_bytes = max(mem->peak_bytes,
+			      mem->live_bytes + mem->cached_bytes);
+	mem->cache_miss++;
+	spin_unlock(&mem->cache_lock);
+
+	return buf;
+}
+
 static int mtk_ccd_buf_mmap(struct mtk_ccd_buf *buf, struct vm_area_struct *vma)
 {
 	int ret;
@@ -284,7 +426,11 @@ static void mtk_ccd_dmabuf_ops_unmap(struct dma_buf_attachment *db_attach,
 
 static void mtk_ccd_dmabuf_ops_release(struct dma_buf *dbuf)
 {
-	mtk_ccd_buf_put(dbuf->priv);
+	struct mtk_ccd_buf *buf = dbuf->priv;
+
+	if (buf->dbuf == dbuf)
+		buf->dbuf = NULL;
+	mtk_ccd_buf_put(buf);
 }
 
 /* Bibby: unused function
@@ -380,9 +526,59 @@ struct dma_buf *mtk_ccd_get_buffer_dmabuf(struct mtk_ccd *ccd, void *mem_priv)
 }
 EXPORT_SYMBOL_GPL(mtk_ccd_get_buffer_dmabuf);
 
+static int mtk_ccd_mem_stats_show(struct seq_file *s, void *unused)
+{
+	struct mtk_ccd_memory *ccd_memory = s->private;
+	size_t live, cached, peak;
+	unsigned long hit, miss;
+
+	spin_lock(&ccd_memory->cache_lock);
+	live = ccd_memory->live_bytes;
+	cached = ccd_memory->cached_bytes;
+	peak = ccd_memory->peak_bytes;
+	hit = ccd_memory->cache_hit;
+	miss = ccd_memory->cache_miss;
+	spin_unlock(&ccd_memory->cache_lock);
+
+	seq_printf(s, "buffers:      %u\n", READ_ONCE(ccd_memory->num_buffers));
+	seq_printf(s, "live_bytes:   %zu\n", live);
+	seq_printf(s, "cached_bytes: %zu\n", cached);
+	seq_printf(s, "peak_bytes:   %zu\n", peak);
+	seq_printf(s, "cache_max:    %lu\n", READ_ONCE(ccd_mem_cache_max));
+	seq_printf(s, "cache_hit:    %lu\n", hit);
+	seq_printf(s, "cache_miss:   %lu\n", miss);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(mtk_ccd_mem_stats);
+
+static inline unsigned long mtk_ccd_va_key(const void *va)
+{
+	return (unsigned long)va >> PAGE_SHIFT;
+}
+
+/* called with mmap_lock held */
+static struct mtk_ccd_buf *mtk_ccd_buf_lookup(struct mtk_ccd_memory *ccd_memory,
+					      const struct mem_obj *mem_buff_data)
+{
+	struct mtk_ccd_buf *buf;
+
+	buf = xa_load(&ccd_memory->bufs_by_va,
+		      mtk_ccd_va_key(mem_buff_data->va));
+	if (!buf || buf->vaddr != mem_buff_data->va ||
+	    buf->len != mem_buff_data->len)
+		return NULL;
+
+	return buf;
+}
+
 struct mtk_ccd_memory *mtk_ccd_mem_init(struct device *dev)
 {
 	struct mtk_ccd_memory *ccd_memory;
+	unsigned int i;
+
+	BUILD_BUG_ON(get_order(CCD_ALLOCATE_MAX_BUFFER_SIZE) >=
+		     MTK_CCD_MEM_CLASS_NUM);
 
 	ccd_memory = kzalloc(sizeof(*ccd_memory), GFP_KERNEL);
 	if (!ccd_memory)
@@ -391,6 +587,16 @@ struct mtk_ccd_memory *mtk_ccd_mem_init(struct device *dev)
 	ccd_memory->dev = dev;
 	ccd_memory->num_buffers = 0;
 	mutex_init(&ccd_memory->mmap_lock);
+	xa_init_flags(&ccd_memory->bufs, XA_FLAGS_ALLOC1);
+	xa_init(&ccd_memory->bufs_by_va);
+	spin_lock_init(&ccd_memory->cache_lock);
+	for (i = 0; i < MTK_CCD_MEM_CLASS_NUM; i++)
+		INIT_LIST_HEAD(&ccd_memory->free_list[i]);
+	kref_init(&ccd_memory->kref);
+
+	ccd_memory->debugfs = debugfs_create_file("mtk_ccd_mem", 0444, NULL,
+						  ccd_memory,
+						  &mtk_ccd_mem_stats_fops);
 
 	return ccd_memory;
 }
@@ -399,58 +605,100 @@ EXPORT_SYMBOL_GPL(mtk_ccd_mem_init);
 void mtk_ccd_mem_release(struct mtk_ccd *ccd)
 {
 	struct mtk_ccd_memory *ccd_memory = ccd->ccd_memory;
+	struct mtk_ccd_buf *buf;
+	unsigned long handle;
 
-	kfree(ccd_memory);
+	if (!ccd_memory)
+		return;
+
+	debugfs_remove(ccd_memory->debugfs);
+
+	spin_lock(&ccd_memory->cache_lock);
+	ccd_memory->closing = true;
+	spin_unlock(&ccd_memory->cache_lock);
+	mtk_ccd_mem_drain(ccd_memory);
+
+	mutex_lock(&ccd_memory->mmap_lock);
+	xa_for_each(&ccd_memory->bufs, handle, buf) {
+		dev_info(ccd_memory->dev,
+			 "%s: buffer %lu va %p len %u was not put\n",
+			 __func__, handle, buf->vaddr, buf->len);
+		xa_erase(&ccd_memory->bufs_by_va, mtk_ccd_va_key(buf->vaddr));
+		xa_erase(&ccd_memory->bufs, handle);
+		mtk_ccd_buf_put(buf);
+	}
+	ccd_memory->num_buffers = 0;
+	mutex_unlock(&ccd_memory->mmap_lock);
+
+	dev_dbg(ccd_memory->dev, "%s: peak %zu bytes, cache hit %lu miss %lu\n",
+		__func__, ccd_memory->peak_bytes, ccd_memory->cache_hit,
+		ccd_memory->cache_miss);
+
+	xa_destroy(&ccd_memory->bufs);
+	xa_destroy(&ccd_memory->bufs_by_va);
+	ccd->ccd_memory = NULL;
+
+	/* buffers still exported as dma-buf hold the rest */
+	kref_put(&ccd_memory->kref, mtk_ccd_mem_free);
 }
 EXPORT_SYMBOL_GPL(mtk_ccd_mem_release);
 
 void *mtk_ccd_get_buffer(struct mtk_ccd *ccd,
 			 struct mem_obj *mem_buff_data)
 {
-	unsigned int buffers;
 	struct mtk_ccd_buf *buf;
-	struct mtk_ccd_mem *ccd_buffer;
 	struct mtk_ccd_memory *ccd_memory = ccd->ccd_memory;
+	int ret;
 
 	mem_buff_data->iova = 0;
 	mem_buff_data->va = NULL;
 
-	mutex_lock(&ccd_memory->mmap_lock);
-	buffers = ccd_memory->num_buffers;
 	if (mem_buff_data->len > CCD_ALLOCATE_MAX_BUFFER_SIZE ||
-	    mem_buff_data->len == 0U ||
-	    buffers >= MAX_NUMBER_OF_BUFFER) {
+	    mem_buff_data->len == 0U) {
 		dev_err(ccd_memory->dev,
 			"%s: Failed: buffer len = %u num_buffers = %d !!\n",
-			 __func__, mem_buff_data->len, buffers);
-		mutex_unlock(&ccd_memory->mmap_lock);
+			 __func__, mem_buff_data->len,
+			 READ_ONCE(ccd_memory->num_buffers));
 		return ERR_PTR(-EINVAL);
 	}
 
-	ccd_buffer = &ccd_memory->bufs[buffers];
-	buf = mtk_ccd_buf_alloc(ccd_memory->dev, 0, mem_buff_data->len, 0, 0);
-	ccd_buffer->mem_priv = buf;
-	ccd_buffer->size = mem_buff_data->len;
-	if (IS_ERR(ccd_buffer->mem_priv)) {
+	buf = mtk_ccd_buf_obtain(ccd_memory, PAGE_ALIGN(mem_buff_data->len));
+	if (IS_ERR(buf)) {
 		dev_err(ccd_memory->dev, "%s: CCD buf allocation failed\n",
 			__func__);
-		mutex_unlock(&ccd_memory->mmap_lock);
 		return ERR_PTR(-ENOMEM);
 	}
+	buf->len = mem_buff_data->len;
+
+	mutex_lock(&ccd_memory->mmap_lock);
+	ret = xa_alloc(&ccd_memory->bufs, &buf->handle, buf, xa_limit_32b,
+		       GFP_KERNEL);
+	if (!ret) {
+		ret = xa_insert(&ccd_memory->bufs_by_va,
+				mtk_ccd_va_key(buf->vaddr), buf, GFP_KERNEL);
+		if (ret)
+			xa_erase(&ccd_memory->bufs, buf->handle);
+	}
+	if (!ret)
+		ccd_memory->num_buffers++;
+	mutex_unlock(&ccd_memory->mmap_lock);
+
+	if (ret) {
+		dev_err(ccd_memory->dev, "%s: CCD buf register failed %d\n",
+			__func__, ret);
+		mtk_ccd_buf_put(buf);
+		return ERR_PTR(ret);
+	}
 
 	mem_buff_data->iova = mtk_ccd_buf_get_daddr(buf);
 	mem_buff_data->va = mtk_ccd_buf_get_vaddr(buf);
-	ccd_memory->num_buffers++;
-	mutex_unlock(&ccd_memory->mmap_lock);
 
 	dev_dbg(ccd_memory->dev,
-		"Num_bufs = %d iova = %pad va = %p size = %d priv = %p\n",
-		 ccd_memory->num_buffers, &mem_buff_data->iova,
-		 mem_buff_data->va,
-		 (unsigned int)ccd_buffer->size,
-		 ccd_buffer->mem_priv);
+		"Num_bufs = %d handle = %u iova = %pad va = %p size = %d priv = %p\n",
+		 ccd_memory->num_buffers, buf->handle, &mem_buff_data->iova,
+		 mem_buff_data->va, buf->len, buf);
 
-	return ccd_buffer->mem_priv;
+	return buf;
 }
 EXPORT_SYMBOL_GPL(mtk_ccd_get_buffer);
 
@@ -458,52 +706,32 @@ int mtk_ccd_put_buffer(struct mtk_ccd *ccd,
 			struct mem_obj *mem_buff_data)
 {
 	struct mtk_ccd_buf *buf;
-	void *va;
-	dma_addr_t da;
-	int ret = -EINVAL;
-	struct mtk_ccd_mem *ccd_buffer;
-	unsigned int buffer, num_buffers, last_buffer;
 	struct mtk_ccd_memory *ccd_memory = ccd->ccd_memory;
 
 	mutex_lock(&ccd_memory->mmap_lock);
-	num_buffers = ccd_memory->num_buffers;
-	if (num_buffers != 0U) {
-		for (buffer = 0; buffer < num_buffers; buffer++) {
-			ccd_buffer = &ccd_memory->bufs[buffer];
-			buf = (struct mtk_ccd_buf *)ccd_buffer->mem_priv;
-			va = mtk_ccd_buf_get_vaddr(buf);
-			da = mtk_ccd_buf_get_daddr(buf);
-
-			if (mem_buff_data->va == va &&
-				mem_buff_data->len == ccd_buffer->size) {
-				dev_dbg(ccd_memory->dev,
-					"Free buff = %d iova = %pad va = %p, queue_num = %d\n",
-					 buffer, &mem_buff_data->iova,
-					 mem_buff_data->va,
-					 num_buffers);
-				mtk_ccd_buf_put(buf);
-				last_buffer = num_buffers - 1U;
-				if (last_buffer != buffer)
-					ccd_memory->bufs[buffer] =
-						ccd_memory->bufs[last_buffer];
-
-				ccd_memory->bufs[last_buffer].mem_priv = NULL;
-				ccd_memory->bufs[last_buffer].size = 0;
-				ccd_memory->num_buffers--;
-				ret = 0;
-				break;
-			}
-		}
+	buf = mtk_ccd_buf_lookup(ccd_memory, mem_buff_data);
+	if (buf) {
+		xa_erase(&ccd_memory->bufs_by_va, mtk_ccd_va_key(buf->vaddr));
+		xa_erase(&ccd_memory->bufs, buf->handle);
+		ccd_memory->num_buffers--;
 	}
 	mutex_unlock(&ccd_memory->mmap_lock);
 
-	if (ret != 0)
+	if (!buf) {
 		dev_info(ccd_memory->dev,
 			"Can not free memory va %p iova %pad len %u!\n",
 			 mem_buff_data->va, &mem_buff_data->iova,
 			 mem_buff_data->len);
+		return -EINVAL;
+	}
 
-	return ret;
+	dev_dbg(ccd_memory->dev,
+		"Free buff = %u iova = %pad va = %p, queue_num = %d\n",
+		 buf->handle, &mem_buff_data->iova, mem_buff_data->va,
+		 READ_ONCE(ccd_memory->num_buffers));
+	mtk_ccd_buf_put(buf);
+
+	return 0;
 }
 EXPORT_SYMBOL_GPL(mtk_ccd_put_buffer);
 
@@ -543,54 +771,39 @@ int mtk_ccd_put_fd(struct mtk_ccd *ccd,
 			struct mem_obj *mem_buff_data,
 			unsigned int target_fd)
 {
-	unsigned int i, num_buffers;
-	dma_addr_t da;
-	void *va = NULL;
-	struct mtk_ccd_buf *buf = NULL;
-	struct mtk_ccd_mem *ccd_buffer = NULL;
+	struct dma_buf *dbuf = NULL;
+	struct mtk_ccd_buf *buf;
 	struct mtk_ccd_memory *ccd_memory = ccd->ccd_memory;
 
-	num_buffers = ccd_memory->num_buffers;
-
-	if (unlikely(!num_buffers)) {
-		dev_dbg(ccd_memory->dev, "buffer queue is empty");
-		return -EINVAL;
-	}
-
-	for (i = 0; i < num_buffers; i++) {
-		ccd_buffer = &ccd_memory->bufs[i];
-		buf = (struct mtk_ccd_buf *)ccd_buffer->mem_priv;
-		va = mtk_ccd_buf_get_vaddr(buf);
-		da = mtk_ccd_buf_get_daddr(buf);
-
-		if (mem_buff_data->va == va &&
-			mem_buff_data->len == ccd_buffer->size) {
-
-			if (atomic_long_read(&buf->dbuf->file->f_count) > 1 &&
-			    current->files)
-				close_fd(target_fd);
-			else
-				dev_info(ccd_memory->dev,
-						 "%s user space signal exit to close fd already",
-						 __func__);
-
-			dma_buf_put(buf->dbuf);
-
-			dev_dbg(ccd_memory->dev,
-					"put dma buf : %d, iova = %p, va = %p, fd = %d",
-					i, &mem_buff_data->iova, mem_buff_data->va, target_fd);
-
-			break;
-		}
-	}
+	mutex_lock(&ccd_memory->mmap_lock);
+	buf = mtk_ccd_buf_lookup(ccd_memory, mem_buff_data);
+	if (buf)
+		dbuf = buf->dbuf;
 
-	if (unlikely(i == num_buffers)) {
+	if (unlikely(!dbuf)) {
+		mutex_unlock(&ccd_memory->mmap_lock);
 		dev_info(ccd_memory->dev,
 				"mismatch dma buf iova = %p, va = %p",
 				&mem_buff_data->iova, mem_buff_data->va);
 		return -EINVAL;
 	}
 
+	if (atomic_long_read(&dbuf->file->f_count) > 1 &&
+	    current->files)
+		close_fd(target_fd);
+	else
+		dev_info(ccd_memory->dev,
+				 "%s user space signal exit to close fd already",
+				 __func__);
+
+	dma_buf_put(dbuf);
+
+	dev_dbg(ccd_memory->dev,
+			"put dma buf : %u, iova = %p, va = %p, fd = %d",
+			buf->handle, &mem_buff_data->iova, mem_buff_data->va,
+			target_fd);
+	mutex_unlock(&ccd_memory->mmap_lock);
+
 	return 0;
 }
 
@@ -6,19 +6,17 @@
 #ifndef __MTK_RPMSG_CCD_MEM_H__
 #define __MTK_RPMSG_CCD_MEM_H__
 
-#define MAX_NUMBER_OF_BUFFER (128)
-struct vb2_mem_ops;
+#include <linux/kref.h>
+#include <linux/list.h>
+#include <linux/mutex.h>
+#include <linux/spinlock.h>
+#include <linux/xarray.h>
 
-/**
- * struct mtk_ccd_mem - memory buffer allocated in kernel
- *
- * @mem_priv:   vb2_dc_buf
- * @size:       allocated buffer size
- */
-struct mtk_ccd_mem {
-	void *mem_priv;
-	size_t size;
-};
+/* free list per page order, 4KB .. 512MB (CCD_ALLOCATE_MAX_BUFFER_SIZE) */
+#define MTK_CCD_MEM_CLASS_NUM (18)
+
+struct vb2_mem_ops;
+struct dentry;
 
 /**
  * struct mtk_ccd_memory
@@ -28,7 +26,18 @@ struct mtk_ccd_mem {
  * @dev:        device
  * @num_buffers:allocated buffer number
  * @mem_ops:    the file operation of memory allocated
- * @bufs:       store the information of allocated buffers
+ * @bufs:       allocated buffers, keyed by handle
+ * @bufs_by_va: allocated buffers, keyed by va >> PAGE_SHIFT
+ * @cache_lock: protects the free lists and the byte counters
+ * @free_list:  released buffers kept for reuse, one list per page order
+ * @live_bytes: bytes of buffers handed out and still referenced
+ * @cached_bytes: bytes parked in the free lists
+ * @peak_bytes: high-water mark of live_bytes + cached_bytes
+ * @cache_hit:  allocations served from the free lists
+ * @cache_miss: allocations that went to the DMA allocator
+ * @closing:    set by mtk_ccd_mem_release(), stop caching
+ * @kref:       held by mtk_ccd_mem_init() and by every allocated buffer
+ * @debugfs:    "mtk_ccd_mem" stats entry
  */
 struct mtk_ccd_memory {
 	void *priv;
@@ -36,7 +45,19 @@ struct mtk_ccd_memory {
 	struct device *dev;
 	unsigned int num_buffers;
 	const struct vb2_mem_ops *mem_ops;
-	struct mtk_ccd_mem bufs[MAX_NUMBER_OF_BUFFER];
+	struct xarray bufs;
+	struct xarray bufs_by_va;
+
+	spinlock_t cache_lock;
+	struct list_head free_list[MTK_CCD_MEM_CLASS_NUM];
+	size_t live_bytes;
+	size_t cached_bytes;
+	size_t peak_bytes;
+	unsigned long cache_hit;
+	unsigned long cache_miss;
+	bool closing;
+	struct kref kref;
+	struct dentry *debugfs;
 };
 
 struct mtk_ccd_memory *mtk_ccd_mem_init(struct device *dev);